@@ -0,0 +1,8 @@
+#ifndef TEST_TIMER_HEAP_H
+#define TEST_TIMER_HEAP_H
+
+enum {
+  NUM_VIRTUAL_TIMERS = 32,
+};
+
+#endif
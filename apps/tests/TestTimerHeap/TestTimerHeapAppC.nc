@@ -0,0 +1,22 @@
+/**
+ * Runs the same timers on VirtualizeTimerC and VirtualizeTimerHeapC,
+ * side by side. See README.
+ */
+
+#include "TestTimerHeap.h"
+
+configuration TestTimerHeapAppC {}
+implementation {
+  components MainC, TestTimerHeapC as App;
+  components new TimerMilliC() as ScanFrom;
+  components new TimerMilliC() as HeapFrom;
+  components new VirtualizeTimerC(TMilli, NUM_VIRTUAL_TIMERS) as Scan;
+  components new VirtualizeTimerHeapC(TMilli, NUM_VIRTUAL_TIMERS) as Heap;
+
+  App.Boot -> MainC.Boot;
+  App.Scan -> Scan;
+  App.Heap -> Heap;
+  Scan.TimerFrom -> ScanFrom;
+  Heap.TimerFrom -> HeapFrom;
+}
+
@@ -0,0 +1,123 @@
+/**
+ * Drives NUM_VIRTUAL_TIMERS timers of VirtualizeTimerC (Scan) and of
+ * VirtualizeTimerHeapC (Heap) with the same pseudo-random workload:
+ * periodic and one-shot timers, restarts and stops from within fired
+ * events, and periodic timers started with a t0 in the past. Each side
+ * has its own random number generator with the same seed, so as long
+ * as both fire the same timers in the same order, they do the same
+ * things. Every firing is logged on the TestTimerHeap channel with the
+ * timer, the time and the timer's t0, for script.py to compare.
+ */
+
+#include "TestTimerHeap.h"
+
+module TestTimerHeapC {
+  uses {
+    interface Boot;
+    interface Timer<TMilli> as Scan[uint8_t num];
+    interface Timer<TMilli> as Heap[uint8_t num];
+  }
+}
+implementation {
+
+  enum {
+    SCAN = 0,
+    HEAP = 1,
+  };
+
+  uint32_t m_rand[2] = { 1, 1 };
+
+  uint32_t next(uint8_t side) {
+    uint32_t x = m_rand[side];
+
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    return m_rand[side] = x;
+  }
+
+  void startPeriodic(uint8_t side, uint8_t num, uint32_t dt) {
+    if (side == SCAN)
+      call Scan.startPeriodic[num](dt);
+    else
+      call Heap.startPeriodic[num](dt);
+  }
+
+  void startPeriodicAt(uint8_t side, uint8_t num, uint32_t t0, uint32_t dt) {
+    if (side == SCAN)
+      call Scan.startPeriodicAt[num](t0, dt);
+    else
+      call Heap.startPeriodicAt[num](t0, dt);
+  }
+
+  void startOneShot(uint8_t side, uint8_t num, uint32_t dt) {
+    if (side == SCAN)
+      call Scan.startOneShot[num](dt);
+    else
+      call Heap.startOneShot[num](dt);
+  }
+
+  void stop(uint8_t side, uint8_t num) {
+    if (side == SCAN)
+      call Scan.stop[num]();
+    else
+      call Heap.stop[num]();
+  }
+
+  bool isRunning(uint8_t side, uint8_t num) {
+    return side == SCAN ? call Scan.isRunning[num]()
+      : call Heap.isRunning[num]();
+  }
+
+  void fired(uint8_t side, uint8_t num) {
+    uint32_t now = side == SCAN ? call Scan.getNow[num]()
+      : call Heap.getNow[num]();
+    uint32_t t0 = side == SCAN ? call Scan.gett0[num]()
+      : call Heap.gett0[num]();
+    uint32_t r = next(side) % 100;
+
+    dbg("TestTimerHeap", "%s %hhu %lu %lu\n",
+	side == SCAN ? "scan" : "heap", num, now, t0);
+
+    if (r < 30) {
+      /* keep the timer going */
+      if (!isRunning(side, num))
+	startPeriodic(side, num, 1 + next(side) % 150);
+    }
+    else if (r < 70)
+      startOneShot(side, num, next(side) % 50);
+    else if (r < 75)
+      stop(side, next(side) % NUM_VIRTUAL_TIMERS);
+    else if (r < 90)
+      startPeriodic(side, next(side) % NUM_VIRTUAL_TIMERS,
+		    1 + next(side) % 100);
+    else
+      startPeriodicAt(side, next(side) % NUM_VIRTUAL_TIMERS,
+		      now - next(side) % 20, 1 + next(side) % 60);
+  }
+
+  event void Boot.booted() {
+    uint8_t num;
+    uint8_t side;
+
+    for (side = SCAN; side <= HEAP; side++)
+      for (num = 0; num < NUM_VIRTUAL_TIMERS; num++) {
+	uint32_t periodic = next(side) & 1;
+	uint32_t dt = next(side) % 200;
+
+	if (periodic)
+	  startPeriodic(side, num, 1 + dt);
+	else
+	  startOneShot(side, num, dt);
+      }
+  }
+
+  event void Scan.fired[uint8_t num]() {
+    fired(SCAN, num);
+  }
+
+  event void Heap.fired[uint8_t num]() {
+    fired(HEAP, num);
+  }
+}
+
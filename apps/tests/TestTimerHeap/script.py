@@ -0,0 +1,43 @@
+# Runs TestTimerHeap and checks that VirtualizeTimerC and
+# VirtualizeTimerHeapC fired the same timers at the same times.
+#
+#   python script.py [events]
+
+from TOSSIM import *
+import sys
+
+events = 200000
+if len(sys.argv) > 1:
+    events = int(sys.argv[1])
+
+t = Tossim([])
+log = open("firings.txt", "w")
+t.addChannel("TestTimerHeap", log)
+
+m = t.getNode(0)
+m.bootAtTime(345321)
+
+for i in range(0, events):
+    if not t.runNextEvent():
+        break
+log.close()
+
+# DEBUG (0): scan <timer> <now> <t0>
+fired = { "scan": [], "heap": [] }
+for line in open("firings.txt"):
+    fields = line.split()
+    if len(fields) == 6 and fields[2] in fired:
+        fired[fields[2]].append(tuple(fields[3:]))
+
+scan = fired["scan"]
+heap = fired["heap"]
+for i in range(0, min(len(scan), len(heap))):
+    if scan[i] != heap[i]:
+        print("Firing %d differs: VirtualizeTimerC fired timer %s at %s (t0 %s), VirtualizeTimerHeapC timer %s at %s (t0 %s)." % ((i,) + scan[i] + heap[i]))
+        sys.exit(1)
+
+if len(scan) != len(heap) or len(scan) == 0:
+    print("VirtualizeTimerC fired %d times, VirtualizeTimerHeapC %d times." % (len(scan), len(heap)))
+    sys.exit(1)
+
+print("%d firings, the same for both." % len(scan))
@@ -58,139 +58,124 @@
  */
 
 #include <stdlib.h>
+#include <string.h>
+#include <limits.h>
 #include "in_cksum.h"
 #include "lib6lowpan.h"
 #include "nwbyte.h"
 
+/*
+ * Each ip_iovec is summed in the machine's byte order as if it started
+ * on an even byte of the message, with an odd trailing byte padded
+ * with zero.  A piece that really starts on an odd byte has its sum
+ * byte swapped before it is added (RFC 1071, section 2), so any piece
+ * of a chain may have an odd length.
+ */
+
+static uint16_t swap16(uint16_t x) {
+  return (x << 8) | (x >> 8);
+}
+
+#if UINT_MAX > 0xffff && !defined(IN_CKSUM_16BIT)
+/* 32 and 64 bit machines: 32-bit loads into a 64-bit accumulator,
+   which cannot overflow for any packet.  Compilers vectorize the main
+   loop where they can. */
+static uint16_t chunk_sum(const uint8_t *w, size_t len) {
+  uint64_t sum = 0;
+  uint32_t v[4];
+  uint16_t h;
+
+  while (len >= 16) {
+    memcpy(v, w, 16);
+    sum += (uint64_t)v[0] + v[1] + v[2] + v[3];
+    w += 16;
+    len -= 16;
+  }
+  while (len >= 4) {
+    memcpy(v, w, 4);
+    sum += v[0];
+    w += 4;
+    len -= 4;
+  }
+  if (len >= 2) {
+    memcpy(&h, w, 2);
+    sum += h;
+    w += 2;
+    len -= 2;
+  }
+  if (len) {
+    uint8_t last[2] = { w[0], 0 };
+    memcpy(&h, last, 2);
+    sum += h;
+  }
+
+  sum = (sum & 0xffffffff) + (sum >> 32);
+  sum = (sum & 0xffffffff) + (sum >> 32);
+  sum = (sum & 0xffff) + (sum >> 16);
+  sum = (sum & 0xffff) + (sum >> 16);
+  sum = (sum & 0xffff) + (sum >> 16);
+  return sum;
+}
+#else
+/* 16 bit machines (MSP430, AVR): 16-bit adds with end-around carry,
+   word loads only from even addresses */
+static uint16_t chunk_sum(const uint8_t *w, size_t len) {
+  uint16_t sum = 0, v;
+  int swapped = 0;
 
-#define ADDCARRY(x)  (x > 65535 ? x -= 65535 : x)
-#define REDUCE {l_util.l = sum; sum = l_util.s[0] + l_util.s[1]; ADDCARRY(sum);}
+#define ADD16(x) do { v = (x); sum += v; if (sum < v) sum++; } while (0)
+  if (((uintptr_t)w & 1) && len > 0) {
+    // sum the rest from the next even address and swap the result
+    // back; the first byte goes in swapped so it comes out in place
+    uint8_t first[2] = { w[0], 0 };
+    memcpy(&v, first, 2);
+    ADD16(swap16(v));
+    w++;
+    len--;
+    swapped = 1;
+  }
+  while (len >= 8) {
+    const uint16_t *p = (const uint16_t *)w;
+    ADD16(p[0]);
+    ADD16(p[1]);
+    ADD16(p[2]);
+    ADD16(p[3]);
+    w += 8;
+    len -= 8;
+  }
+  while (len >= 2) {
+    ADD16(*(const uint16_t *)w);
+    w += 2;
+    len -= 2;
+  }
+  if (len) {
+    uint8_t last[2] = { w[0], 0 };
+    memcpy(&v, last, 2);
+    ADD16(v);
+  }
+#undef ADD16
+  return swapped ? swap16(sum) : sum;
+}
+#endif
 
 int
 in_cksum(const struct ip_iovec *vec) {
-#if 1
-  /* This will break horribly if the length of any but the last ip_iovec is odd! */
-
   uint32_t sum = 0;
-  uint16_t cur = 0;
-  int i;
-  uint8_t *w;
- 
-  for (; vec != NULL;  vec = vec->iov_next) {
+  int odd = 0;
+
+  for (; vec != NULL; vec = vec->iov_next) {
+    uint16_t part;
     if (vec->iov_len == 0)
       continue;
-   
-    w = vec->iov_base;
-    for (i = 0; i < vec->iov_len; i++) {
-      if (i % 2 == 0) {
-        cur |= ((uint16_t)w[i]) << 8;
-        if (i + 1 == vec->iov_len) {
-          goto finish;
-        }
-      } else {
-        cur |= w[i];
-      finish:
-        sum += cur;
-        cur = 0;
-      }
-    }
+    part = chunk_sum(vec->iov_base, vec->iov_len);
+    sum += odd ? swap16(part) : part;
+    odd ^= vec->iov_len & 1;
   }
   while (sum > 0xffff) {
     sum = (sum & 0xffff) + (sum >> 16);
   }
-  return ~((uint16_t)sum);
-#else
-	register const uint16_t *w;
-	register uint32_t sum = 0;
-	register uint32_t mlen = 0;
-	int byte_swapped = 0;
-
-	union {
-		uint8_t	c[2];
-		uint16_t	s;
-	} s_util;
-	union {
-		uint16_t s[2];
-		uint32_t	l;
-	} l_util;
-
-	for (; vec != NULL; vec = vec->iov_next) {
-
-		if (vec->iov_len == 0)
-			continue;
-		w = (const uint16_t *)vec->iov_base;
-		if (mlen == -1) {
-			/*
-			 * The first byte of this chunk is the continuation
-			 * of a word spanning between this chunk and the
-			 * last chunk.
-			 *
-			 * s_util.c[0] is already saved when scanning previous
-			 * chunk.
-			 */
-			s_util.c[1] = *(const uint8_t *)w;
-			sum += s_util.s;
-			w = (const uint16_t *)((const uint8_t *)w + 1);
-			mlen = vec->iov_len - 1;
-		} else
-			mlen = vec->iov_len;
-		/*
-		 * Force to even boundary.
-		 */
-		if ((1 & (int) w) && (mlen > 0)) {
-			REDUCE;
-			sum <<= 8;
-			s_util.c[0] = *(const uint8_t *)w;
-			w = (const uint16_t *)((const uint8_t *)w + 1);
-			mlen--;
-			byte_swapped = 1;
-		}
-		/*
-		 * Unroll the loop to make overhead from
-		 * branches &c small.
-		 */
-		while ((mlen -= 32) >= 0) {
-			sum += w[0]; sum += w[1]; sum += w[2]; sum += w[3];
-			sum += w[4]; sum += w[5]; sum += w[6]; sum += w[7];
-			sum += w[8]; sum += w[9]; sum += w[10]; sum += w[11];
-			sum += w[12]; sum += w[13]; sum += w[14]; sum += w[15];
-			w += 16;
-		}
-		mlen += 32;
-		while ((mlen -= 8) >= 0) {
-			sum += w[0]; sum += w[1]; sum += w[2]; sum += w[3];
-			w += 4;
-		}
-		mlen += 8;
-		if (mlen == 0 && byte_swapped == 0)
-			continue;
-		REDUCE;
-		while ((mlen -= 2) >= 0) {
-			sum += *w++;
-		}
-		if (byte_swapped) {
-			REDUCE;
-			sum <<= 8;
-			byte_swapped = 0;
-			if (mlen == -1) {
-				s_util.c[1] = *(const uint8_t *)w;
-				sum += s_util.s;
-				mlen = 0;
-			} else
-				mlen = -1;
-		} else if (mlen == -1)
-			s_util.c[0] = *(const uint8_t *)w;
-	}
-	if (mlen == -1) {
-		/* The last mbuf has odd # of bytes. Follow the
-		   standard (the odd byte may be shifted left by 8 bits
-		   or not as determined by endian-ness of the machine) */
-		s_util.c[1] = 0;
-		sum += s_util.s;
-	}
-	REDUCE;
-	return (~sum & 0xffff);
-#endif
+  // the sum is in machine order; return it as a number like ntohs does
+  return (uint16_t)~ntohs((uint16_t)sum);
 }
 
 /* SDH : Added to allow for friendly message checksumming */
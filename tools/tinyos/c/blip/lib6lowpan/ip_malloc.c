@@ -22,71 +22,230 @@
 #ifndef NO_IP_MALLOC
 #include <stdint.h>
 #include <stdio.h>
+#include <string.h>
 #include "ip_malloc.h"
 
 uint8_t heap[IP_MALLOC_HEAP_SIZE];
 
+#define NIL        0xffff
+#define TAG_SIZE   sizeof(bndrt_t)
+// tag, two list links and the trailing length of a free block
+#define MIN_BLOCK  (4 * TAG_SIZE)
+
+#define TAG(off)       (*(bndrt_t *)(heap + (off)))
+#define NEXT_FREE(off) (*(bndrt_t *)(heap + (off) + TAG_SIZE))
+#define PREV_FREE(off) (*(bndrt_t *)(heap + (off) + 2 * TAG_SIZE))
+#define FOOTER(off)    (*(bndrt_t *)(heap + (off) + (TAG(off) & IP_MALLOC_LEN) - TAG_SIZE))
+
+#if IP_MALLOC_HEAP_SIZE > IP_MALLOC_LEN || IP_MALLOC_HEAP_SIZE % IP_MALLOC_ALIGN
+#error "IP_MALLOC_HEAP_SIZE must fit in IP_MALLOC_LEN and be aligned"
+#endif
+
+static uint16_t fl_bitmap;
+static uint8_t sl_bitmap[IP_MALLOC_FL_COUNT];
+static uint16_t free_head[IP_MALLOC_FL_COUNT][IP_MALLOC_SL_COUNT];
+static struct ip_malloc_stats stats;
+
+static int msb(unsigned x) {
+  return (int)(sizeof(unsigned) * 8 - 1) - __builtin_clz(x);
+}
+
+static int lsb(unsigned x) {
+  return __builtin_ctz(x);
+}
+
+/* blocks below 16 bytes share the first level, four bytes per list;
+   above that each power of two is split into IP_MALLOC_SL_COUNT lists */
+static void mapping(uint16_t size, int *fl, int *sl) {
+  if (size < (1 << (IP_MALLOC_SL_LOG2 + 2))) {
+    *fl = 0;
+    *sl = size >> 2;
+  } else {
+    int m = msb(size);
+    *fl = m - (IP_MALLOC_SL_LOG2 + 1);
+    *sl = (size >> (m - IP_MALLOC_SL_LOG2)) & (IP_MALLOC_SL_COUNT - 1);
+  }
+}
+
+static void insert_free(uint16_t off) {
+  int fl, sl;
+  uint16_t head;
+
+  mapping(TAG(off) & IP_MALLOC_LEN, &fl, &sl);
+  head = free_head[fl][sl];
+  NEXT_FREE(off) = head;
+  PREV_FREE(off) = NIL;
+  if (head != NIL)
+    PREV_FREE(head) = off;
+  free_head[fl][sl] = off;
+  fl_bitmap |= 1 << fl;
+  sl_bitmap[fl] |= 1 << sl;
+  stats.free_blocks++;
+}
+
+static void remove_free(uint16_t off) {
+  int fl, sl;
+  uint16_t next = NEXT_FREE(off), prev = PREV_FREE(off);
+
+  mapping(TAG(off) & IP_MALLOC_LEN, &fl, &sl);
+  if (next != NIL)
+    PREV_FREE(next) = prev;
+  if (prev != NIL)
+    NEXT_FREE(prev) = next;
+  else
+    free_head[fl][sl] = next;
+  if (free_head[fl][sl] == NIL) {
+    sl_bitmap[fl] &= ~(1 << sl);
+    if (sl_bitmap[fl] == 0)
+      fl_bitmap &= ~(1 << fl);
+  }
+  stats.free_blocks--;
+}
+
+/* Returns: a free block of at least size bytes, or NIL.  The request
+   is rounded up to the next list so that any block found there fits;
+   only if no such list has a block is the request's own list searched. */
+static uint16_t find_free(uint16_t size) {
+  int fl, sl;
+  unsigned map;
+  uint16_t off;
+
+  if (size < (1 << (IP_MALLOC_SL_LOG2 + 2)))
+    mapping(size + 3, &fl, &sl);
+  else
+    mapping(size + (1 << (msb(size) - IP_MALLOC_SL_LOG2)) - 1, &fl, &sl);
+
+  if (fl < IP_MALLOC_FL_COUNT) {
+    map = sl_bitmap[fl] & (~0U << sl);
+    if (map == 0) {
+      map = fl_bitmap & (~0U << (fl + 1));
+      if (map != 0) {
+        fl = lsb(map);
+        map = sl_bitmap[fl];
+      }
+    }
+    if (map != 0)
+      return free_head[fl][lsb(map)];
+  }
+
+  mapping(size, &fl, &sl);
+  for (off = free_head[fl][sl]; off != NIL; off = NEXT_FREE(off))
+    if ((TAG(off) & IP_MALLOC_LEN) >= size)
+      return off;
+  return NIL;
+}
+
 void ip_malloc_init() {
-  bndrt_t *b = (bndrt_t *)heap;
-  *b = IP_MALLOC_HEAP_SIZE  & IP_MALLOC_LEN;
+  int i, j;
+
+  fl_bitmap = 0;
+  for (i = 0; i < IP_MALLOC_FL_COUNT; i++) {
+    sl_bitmap[i] = 0;
+    for (j = 0; j < IP_MALLOC_SL_COUNT; j++)
+      free_head[i][j] = NIL;
+  }
+  memset(&stats, 0, sizeof(stats));
+
+  TAG(0) = IP_MALLOC_HEAP_SIZE & IP_MALLOC_LEN;
+  FOOTER(0) = IP_MALLOC_HEAP_SIZE;
+  insert_free(0);
+  stats.free = stats.low_water = IP_MALLOC_HEAP_SIZE;
 }
 
 void *ip_malloc(uint16_t sz) {
-  bndrt_t *cur = (bndrt_t *)heap;
-
-  sz += sizeof(bndrt_t) * 2;
-  sz += (sz % IP_MALLOC_ALIGN);
+  uint16_t size, off, len;
 
-  while (((*cur & IP_MALLOC_LEN) < sz || (*cur & IP_MALLOC_INUSE) != 0)
-         && (uint8_t *)cur - heap < IP_MALLOC_HEAP_SIZE) {
-    cur = (bndrt_t *)(((uint8_t *)cur) + ((*cur) & IP_MALLOC_LEN));
+  if (sz > IP_MALLOC_HEAP_SIZE - TAG_SIZE) {
+    stats.failures++;
+    return NULL;
   }
+  size = sz + TAG_SIZE;
+  size += (size % IP_MALLOC_ALIGN);
+  if (size < MIN_BLOCK)
+    size = MIN_BLOCK;
 
-  if ((uint8_t *)cur < heap + IP_MALLOC_HEAP_SIZE) {
-    uint16_t oldsize = *cur & IP_MALLOC_LEN;
-    bndrt_t *next;
-    sz -= sizeof(bndrt_t);
-    next = ((bndrt_t *)(((uint8_t *)cur) + sz));
+  off = find_free(size);
+  if (off == NIL) {
+    stats.failures++;
+    return NULL;
+  }
+  remove_free(off);
+  len = TAG(off) & IP_MALLOC_LEN;
 
-    *cur = (sz & IP_MALLOC_LEN) | IP_MALLOC_INUSE;
-    *next = (oldsize - sz) & IP_MALLOC_LEN;
+  if (len >= size + MIN_BLOCK) {
+    // the rest stays free; the block after it still has PREVFREE set
+    uint16_t rest = off + size;
+    TAG(rest) = (len - size) & IP_MALLOC_LEN;
+    FOOTER(rest) = len - size;
+    insert_free(rest);
+    len = size;
+  } else if (off + len < IP_MALLOC_HEAP_SIZE) {
+    TAG(off + len) &= ~IP_MALLOC_PREVFREE;
+  }
+  // the block before a free block is never free, so no PREVFREE here
+  TAG(off) = (len & IP_MALLOC_LEN) | IP_MALLOC_INUSE;
 
-    return cur + 1;
-  } else return NULL;
+  stats.free -= len;
+  if (stats.free < stats.low_water)
+    stats.low_water = stats.free;
+  stats.used_blocks++;
+  stats.allocs++;
+  return heap + off + TAG_SIZE;
 }
 
 void ip_free(void *ptr) {
-  bndrt_t *prev = NULL, *cur, *next = NULL;
-  cur = (bndrt_t *)heap;
+  uint16_t off, len, next;
 
-  while (cur + 1 != ptr && (uint8_t *)cur - heap < IP_MALLOC_HEAP_SIZE) {
-    prev = cur;
-    cur = (bndrt_t *)(((uint8_t *)cur) + ((*cur) & IP_MALLOC_LEN));
-  }
-  if (cur + 1 == ptr) {
-    next = (bndrt_t *)((*cur & IP_MALLOC_LEN) + ((uint8_t *)cur));
+  if ((uint8_t *)ptr < heap + TAG_SIZE ||
+      (uint8_t *)ptr >= heap + IP_MALLOC_HEAP_SIZE)
+    return;
+  off = (uint8_t *)ptr - heap - TAG_SIZE;
+  if ((TAG(off) & IP_MALLOC_INUSE) == 0)
+    return;
 
-    *cur &= ~IP_MALLOC_INUSE;
-    if ((((uint8_t *)next) - heap) < IP_MALLOC_HEAP_SIZE &&
-        (*next & IP_MALLOC_INUSE) == 0) {
-      *cur = (*cur & IP_MALLOC_LEN) + (*next & IP_MALLOC_LEN);
-    }
-    if (prev != NULL && (*prev & IP_MALLOC_INUSE) == 0) {
-      *prev = (*prev & IP_MALLOC_LEN) + (*cur & IP_MALLOC_LEN);
-    }
+  len = TAG(off) & IP_MALLOC_LEN;
+  stats.free += len;
+  stats.used_blocks--;
+  stats.frees++;
+
+  next = off + len;
+  if (next < IP_MALLOC_HEAP_SIZE && (TAG(next) & IP_MALLOC_INUSE) == 0) {
+    remove_free(next);
+    len += TAG(next) & IP_MALLOC_LEN;
+  }
+  if (TAG(off) & IP_MALLOC_PREVFREE) {
+    off -= *(bndrt_t *)(heap + off - TAG_SIZE);
+    remove_free(off);
+    len += TAG(off) & IP_MALLOC_LEN;
   }
+
+  TAG(off) = len & IP_MALLOC_LEN;
+  FOOTER(off) = len;
+  if (off + len < IP_MALLOC_HEAP_SIZE)
+    TAG(off + len) |= IP_MALLOC_PREVFREE;
+  insert_free(off);
 }
 
 uint16_t ip_malloc_freespace() {
-  uint16_t ret = 0;
-  bndrt_t *cur = (bndrt_t *)heap;
+  return stats.free;
+}
 
-  while ((uint8_t *)cur - heap < IP_MALLOC_HEAP_SIZE) {
-    if ((*cur & IP_MALLOC_INUSE) == 0)
-      ret += *cur & IP_MALLOC_LEN;
-    cur = (bndrt_t *)(((uint8_t *)cur) + ((*cur) & IP_MALLOC_LEN));
+void ip_malloc_stats(struct ip_malloc_stats *s) {
+  uint16_t off;
+  int fl, sl;
+
+  *s = stats;
+  s->largest = 0;
+  if (fl_bitmap != 0) {
+    // the largest block is in the highest non-empty list
+    fl = msb(fl_bitmap);
+    sl = msb(sl_bitmap[fl]);
+    for (off = free_head[fl][sl]; off != NIL; off = NEXT_FREE(off))
+      if ((TAG(off) & IP_MALLOC_LEN) > s->largest)
+        s->largest = TAG(off) & IP_MALLOC_LEN;
   }
-  return ret;
+  s->fragmentation = s->free == 0 ? 0 :
+    100 - (uint8_t)(((uint32_t)s->largest * 100) / s->free);
 }
 
 #ifdef PC
@@ -105,8 +264,9 @@ void dump_heap() {
 void ip_print_heap() {
   bndrt_t *cur = (bndrt_t *)heap;
   while (((uint8_t *)cur)  - heap < IP_MALLOC_HEAP_SIZE) {
-    printf ("heap region start: %p length: %i used: %i\n",
-            cur, (*cur & IP_MALLOC_LEN), (*cur & IP_MALLOC_INUSE) >> 15);
+    printf ("heap region start: %p length: %i used: %i prev free: %i\n",
+            cur, (*cur & IP_MALLOC_LEN), (*cur & IP_MALLOC_INUSE) >> 15,
+            (*cur & IP_MALLOC_PREVFREE) != 0);
     if ((*cur & IP_MALLOC_LEN) == 0) {
       printf("ERROR: zero length cell detected!\n");
       dump_heap();
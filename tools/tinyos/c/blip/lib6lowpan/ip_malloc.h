@@ -25,20 +25,56 @@
 
 #include <stdint.h>
 
-// align on this number of byte boundarie#s
+/*
+ * Two-level segregated fit (TLSF) allocator over a static heap.
+ *
+ * Every block starts with a bndrt_t tag holding its length (tag
+ * included) and flags, so the heap can still be walked from the start.
+ * Free blocks also hold the offsets of their neighbours in their free
+ * list and repeat their length in their last two bytes, which lets
+ * ip_free merge with both physical neighbours without a walk.  Free
+ * lists are segregated by size and found through two bitmaps, so
+ * ip_malloc and ip_free take constant time.
+ */
+
+// align on this number of byte boundaries
 #define IP_MALLOC_ALIGN   2
 #define IP_MALLOC_LEN     0x0fff
 #define IP_MALLOC_FLAGS   0x7000
+#define IP_MALLOC_PREVFREE 0x4000
 #define IP_MALLOC_INUSE   0x8000
+// hosts which reassemble several datagrams at once can make it larger,
+// up to IP_MALLOC_LEN
+#ifndef IP_MALLOC_HEAP_SIZE
 #define IP_MALLOC_HEAP_SIZE 1500
+#endif
+
+// second level lists per power of two, and first levels for blocks
+// up to IP_MALLOC_LEN bytes
+#define IP_MALLOC_SL_LOG2  2
+#define IP_MALLOC_SL_COUNT (1 << IP_MALLOC_SL_LOG2)
+#define IP_MALLOC_FL_COUNT 9
 
 extern uint8_t heap[IP_MALLOC_HEAP_SIZE];
 typedef uint16_t bndrt_t;
 
+struct ip_malloc_stats {
+  uint16_t free;          // bytes in free blocks, tags included
+  uint16_t low_water;     // least free since ip_malloc_init
+  uint16_t largest;       // longest free block
+  uint16_t free_blocks;
+  uint16_t used_blocks;
+  uint8_t  fragmentation; // percent of free space outside the largest block
+  uint32_t allocs;
+  uint32_t frees;
+  uint32_t failures;      // ip_malloc calls that returned NULL
+};
+
 void ip_malloc_init();
 void *ip_malloc(uint16_t sz);
 void ip_free(void *ptr);
 uint16_t ip_malloc_freespace();
+void ip_malloc_stats(struct ip_malloc_stats *stats);
 
 #ifdef PC
 void ip_print_heap();
@@ -50,6 +50,10 @@
    (ADDR)->s6_addr16[6] == 0 && \
    (ADDR)->s6_addr16[7] == 0)
 
+/* the most lowpan_pack_headers writes: dispatch, traffic class and
+   flow label, next header, hop limit and two inline addresses */
+#define LOWPAN_IPHC_MAX_LEN (2 + 4 + 1 + 1 + 16 + 16)
+
 #if ! defined(HAVE_LOWPAN_EXTERN_MATCH_CONTEXT)
 int lowpan_extern_read_context(struct in6_addr *addr, int context) {
   return -1;
@@ -374,8 +378,6 @@ int pack_nhc_ipv6_ext(uint8_t **dest,
     return -1;
   }
 
-  if (ext.ip6e_len > *dlen) return -1;
-
   (*dest)[0] = LOWPAN_NHC_IPV6_PATTERN;
   switch (*type) {
   case IPV6_HOP:      (*dest)[0] |= LOWPAN_NHC_EID_HOP; break;
@@ -388,6 +390,8 @@ int pack_nhc_ipv6_ext(uint8_t **dest,
 
   real_len = __ipnh_real_length(*type, packet->ip6_data, offset);
   if (real_len == 0) return -1;
+  /* NHC byte, maybe an inline next header, length and the options */
+  if (*dlen < 1 + 1 + 1 + real_len - 2) return -1;
 
   /* store the next header type */
   /*  if it's compressable, we will compress it */
@@ -453,6 +457,9 @@ uint8_t * lowpan_pack_headers(struct ip6_packet *packet,
   if ((packet->ip6_hdr.ip6_vfc & IPV6_VERSION_MASK) != IPV6_VERSION) {
     return NULL;
   }
+  if (cnt < LOWPAN_IPHC_MAX_LEN) {
+    return NULL;
+  }
 
   /* Packing strategy: */
   /*   1. we never create 6lowpan broadcast or mesh frames */
@@ -884,6 +891,7 @@ int unpack_nhc_ipv6_ext(uint8_t **dest,
     } else if (extra > 1) {
       (*dest)[0] = IPV6_TLV_PADN;
       (*dest)[1] = extra - 2;
+      memset(*dest + 2, 0, extra - 2);
       *dest += extra; *dlen -= extra;
     }
   }
@@ -51,17 +51,43 @@ struct packed_lowmsg {
 
 struct lowpan_reconstruct {
   uint16_t r_tag;            /* datagram label */
-  uint16_t r_source_key;     /*  */
+  uint16_t r_source_key;     /* ieee154_hashaddr of the link source */
+  uint16_t r_dest_key;       /* ieee154_hashaddr of the link destination */
   uint16_t r_size;           /* the size of the packet we are reconstructing */
-  uint8_t *r_buf;            /* the reconstruction location */
+  uint8_t *r_buf;            /* the reconstruction location; for fragmented
+                                packets, followed by the bitmap of received
+                                8-octet units */
   uint16_t r_bytes_rcvd;     /* how many bytes from the packet we have
                               received so far */
   uint8_t  r_timeout;
+  uint8_t  r_flags;
   uint16_t *r_app_len;
   uint8_t  *r_transport_header;
   struct ip6_metadata       r_meta;
 };
 
+/* bytes of r_buf used by the bitmap of a fragmented datagram */
+#define LOWPAN_RECON_BITMAP_LEN(size) ((((size) + 7) / 8 + 7) / 8)
+
+/*
+ * Reassembly of fragmented datagrams from many senders at once.
+ *
+ * Datagrams are found by (source, destination, tag, size) in an
+ * open-addressed table over caller-provided slots.  Fragments are
+ * written straight into the datagram's buffer and recorded in its
+ * bitmap, so duplicates and overlaps are harmless and fragments may
+ * arrive in any order.  Buffers come from ip_malloc; at most mem_budget
+ * bytes are held by partial datagrams, and datagrams not completed
+ * within two calls to lowpan_recon_age are dropped.
+ */
+struct lowpan_recon_table {
+  struct lowpan_reconstruct *slots;
+  uint16_t n_slots;
+  uint16_t n_used;
+  uint16_t mem_used;         /* bytes of ip_malloc held by partial datagrams */
+  uint16_t mem_budget;       /* 0 for no limit but the heap */
+};
+
 struct lowpan_ctx {
   uint16_t tag;    /* the label of the datagram */
   uint16_t offset; /* how far into the packet we have sent, in bytes */
@@ -184,6 +210,31 @@ int lowpan_recon_start(struct ieee154_frame_addr *frame_addr,
 int lowpan_recon_add(struct lowpan_reconstruct *recon,
                      uint8_t *pkt, size_t len);
 
+void lowpan_recon_init(struct lowpan_recon_table *table,
+                       struct lowpan_reconstruct *slots, uint16_t n_slots,
+                       uint16_t mem_budget);
+
+/*
+ * Add a FRAG1 or FRAGN fragment to its datagram in table.
+ *
+ * @pkt    the 6LoWPAN header onwards
+ * @recon  set to the datagram the fragment belongs to, or NULL
+ * @return 1 if the datagram is now complete, 0 if more fragments are
+ *         needed, < 0 if the fragment was dropped.  Complete datagrams
+ *         must be passed to lowpan_recon_release once delivered.
+ */
+int lowpan_recon_input(struct lowpan_recon_table *table,
+                       struct ieee154_frame_addr *frame_addr,
+                       uint8_t *pkt, size_t len,
+                       struct lowpan_reconstruct **recon);
+
+/* free a datagram's buffer and remove it from table */
+void lowpan_recon_release(struct lowpan_recon_table *table,
+                          struct lowpan_reconstruct *recon);
+
+/* call periodically: drops datagrams untouched since the last call */
+void lowpan_recon_age(struct lowpan_recon_table *table);
+
 enum {
   T_FAILED1 = 0,
   T_FAILED2 = 1,
@@ -62,7 +62,8 @@ inline uint8_t *getLowpanPayload(struct packed_lowmsg *lowmsg) {
 
 /*
  * Return a bitmap indicating which lowpan headers are
- *  present in the message pointed to by lowmsg.
+ *  present in the message pointed to by lowmsg.  A header cut
+ *  short by the end of the message is not reported.
  *
  */
 inline uint16_t getHeaderBitmap(struct packed_lowmsg *lowmsg) {
@@ -76,7 +77,7 @@ inline uint16_t getHeaderBitmap(struct packed_lowmsg *lowmsg) {
   }
 
 #if LIB6LOWPAN_FULL
-  if (len > 0 && ((*buf) >> 6) == LOWPAN_MESH_PATTERN) {
+  if (len >= LOWMSG_MESH_LEN && ((*buf) >> 6) == LOWPAN_MESH_PATTERN) {
     if (!(*buf & LOWPAN_MESH_V_MASK) ||
         !(*buf & LOWPAN_MESH_F_MASK)) {
       // we will not parse a packet with 64-bit addressing.
@@ -86,19 +87,19 @@ inline uint16_t getHeaderBitmap(struct packed_lowmsg *lowmsg) {
     buf += LOWMSG_MESH_LEN;
     len -= LOWMSG_MESH_LEN;
   }
-  if (len > 0 && (*buf) == LOWPAN_BCAST_PATTERN) {
+  if (len >= LOWMSG_BCAST_LEN && (*buf) == LOWPAN_BCAST_PATTERN) {
     headers |= LOWMSG_BCAST_HDR;
     buf += LOWMSG_BCAST_LEN;
     len -= LOWMSG_BCAST_LEN;
   }
 #endif
 
-  if (len > 0 && ((*buf) >> 3) == LOWPAN_FRAG1_PATTERN) {
+  if (len >= LOWMSG_FRAG1_LEN && ((*buf) >> 3) == LOWPAN_FRAG1_PATTERN) {
     headers |= LOWMSG_FRAG1_HDR;
     buf += LOWMSG_FRAG1_LEN;
     len -= LOWMSG_FRAG1_LEN;
   }
-  if (len > 0 && ((*buf) >> 3) == LOWPAN_FRAGN_PATTERN) {
+  if (len >= LOWMSG_FRAGN_LEN && ((*buf) >> 3) == LOWPAN_FRAGN_PATTERN) {
     headers |= LOWMSG_FRAGN_HDR;
     buf += LOWMSG_FRAGN_LEN;
     len -= LOWMSG_FRAGN_LEN;
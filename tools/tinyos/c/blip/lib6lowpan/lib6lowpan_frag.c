@@ -9,45 +9,107 @@
 #include "nwbyte.h"
 #include "ip_malloc.h"
 #include "iovec.h"
+#include "in_cksum.h"
 #include "ieee154_header.h"
 
-int lowpan_recon_start(struct ieee154_frame_addr *frame_addr,
-                       struct lowpan_reconstruct *recon,
-                       uint8_t *pkt,
-                       size_t len) {
-  uint8_t *unpack_point;
-  struct packed_lowmsg msg;
-  uint8_t recalculate_checksum = 0;
-  int ret;
-  uint16_t unpacked_len = 0;
+enum {
+  R_RECALCULATE_CHECKSUM = 0x1,
+};
+
+/* Effects: records bytes [offset, offset + len) of a fragmented
+     datagram as received.
+   Returns: the number of bytes not received before, or -1 if the range
+     does not end on an 8-octet unit or the end of the datagram */
+static int recon_mark(struct lowpan_reconstruct *recon,
+                      uint16_t offset, uint16_t len) {
+  uint8_t *bitmap = recon->r_buf + recon->r_size;
+  uint16_t unit, end = offset + len, fresh = 0;
+
+  if ((offset % 8) != 0 || ((end % 8) != 0 && end != recon->r_size))
+    return -1;
+  for (unit = offset / 8; unit * 8 < end; unit++) {
+    if (bitmap[unit / 8] & (1 << (unit % 8)))
+      continue;
+    bitmap[unit / 8] |= 1 << (unit % 8);
+    fresh += (unit * 8 + 8 <= recon->r_size) ? 8 : recon->r_size - unit * 8;
+  }
+  return fresh;
+}
 
-  msg.data = pkt;
-  msg.len  = len;
-  msg.headers = getHeaderBitmap(&msg);
-  if (msg.headers == LOWMSG_NALP) return -1;
+static int recon_has(struct lowpan_reconstruct *recon, uint16_t offset) {
+  uint16_t unit = offset / 8;
+  return recon->r_buf[recon->r_size + unit / 8] & (1 << (unit % 8));
+}
 
-  /* remove the 6lowpan frag headers from the payload */
-  unpack_point = getLowpanPayload(&msg);
-  len -= (unpack_point - pkt);
+/* Effects: sets up recon for a datagram of size bytes with nothing
+     received yet.  Only the bitmap is cleared: every byte of the
+     datagram is written by some fragment before it is complete. */
+static int recon_alloc(struct lowpan_reconstruct *recon, uint16_t size,
+                       int fragmented) {
+  uint16_t bitmap_len = fragmented ? LOWPAN_RECON_BITMAP_LEN(size) : 0;
 
-  if (len <= 0) {
-    return -4;
+  recon->r_size = size;
+  recon->r_buf = ip_malloc(size + bitmap_len);
+  if (!recon->r_buf) return -2;
+  memset(recon->r_buf + size, 0, bitmap_len);
+  recon->r_bytes_rcvd = 0;
+  recon->r_app_len = NULL;
+  recon->r_transport_header = NULL;
+  recon->r_flags = 0;
+  return 0;
+}
+
+/* Effects: fills in the fields elided by compression once the whole
+     datagram is there */
+static void recon_finish(struct lowpan_reconstruct *recon) {
+  ((struct ip6_hdr *)(recon->r_buf))->ip6_plen =
+    htons(recon->r_size - sizeof(struct ip6_hdr));
+  /* fill in any elided app data length fields */
+  if (recon->r_app_len) {
+    *recon->r_app_len =
+      htons(recon->r_size - (recon->r_transport_header - recon->r_buf));
   }
 
-  /* set up the reconstruction, or just fill in the packet length */
-  if (hasFrag1Header(&msg)) {
-    getFragDgramTag(&msg, &recon->r_tag);
-    getFragDgramSize(&msg, &recon->r_size);
-  } else {
-    recon->r_size = LIB6LOWPAN_MAX_LEN + LOWPAN_LINK_MTU;
+  /* Check if we used stateful uncompression with the ipv6 source or destination
+   * addresses. If so, we probably need to recalculate checksums because when
+   * the checksum was originally calculated the full source or destination
+   * address may not have been known. In that case, the checksum will fail
+   * at the packet's destination.
+   */
+  if (recon->r_flags & R_RECALCULATE_CHECKSUM) {
+    struct ip6_hdr *hdr = (struct ip6_hdr *) recon->r_buf;
+
+    /* Right now only handle the only header being UDP */
+    if (hdr->ip6_nxt == IANA_UDP && recon->r_app_len) {
+      struct ip_iovec v[2];
+      struct udp_hdr *udph;
+
+      udph = (struct udp_hdr *) recon->r_transport_header;
+      udph->chksum = 0;
+
+      v[0].iov_base = (uint8_t *) udph;
+      v[0].iov_len  = sizeof(struct udp_hdr);
+      v[0].iov_next = v+1;
+      v[1].iov_base = (uint8_t*) (udph + 1);
+      v[1].iov_len  = ntohs(*recon->r_app_len) - sizeof(struct udp_hdr);
+      v[1].iov_next = NULL;
+
+      udph->chksum = htons(msg_cksum(hdr, v, IANA_UDP));
+    }
   }
-  recon->r_buf = ip_malloc(recon->r_size);
-  if (!recon->r_buf) return -2;
-  memset(recon->r_buf, 0, recon->r_size);
-  recon->r_app_len = NULL;
+}
+
+/* Effects: unpacks the first fragment, or an unfragmented packet, into
+     the start of recon->r_buf */
+static int recon_first(struct ieee154_frame_addr *frame_addr,
+                       struct lowpan_reconstruct *recon,
+                       uint8_t *unpack_point, size_t len,
+                       int fragmented) {
+  uint8_t recalculate_checksum = 0;
+  uint16_t unpacked_len = 0;
+  int ret;
 
   if (len < 1) {
-    ip_free(recon->r_buf);
     return -5;
   }
   if (*unpack_point == LOWPAN_IPV6_PATTERN) {
@@ -55,11 +117,9 @@ int lowpan_recon_start(struct ieee154_frame_addr *frame_addr,
     unpack_point++; len--;
     if (len < sizeof(struct ip6_hdr)) {
       // Uncompressed packet must be at least the size of the ipv6 header
-      ip_free(recon->r_buf);
       return -7;
     }
     if (len > recon->r_size) {
-      ip_free(recon->r_buf);
       return -6;
     }
     memcpy(recon->r_buf, unpack_point, len);
@@ -73,61 +133,96 @@ int lowpan_recon_start(struct ieee154_frame_addr *frame_addr,
                                 &recalculate_checksum,
                                 &unpacked_len);
     if (ret < 0) {
-      ip_free(recon->r_buf);
       return -3;
     }
   }
+  if (recalculate_checksum)
+    recon->r_flags |= R_RECALCULATE_CHECKSUM;
 
-  if (!hasFrag1Header(&msg)) {
+  if (!fragmented) {
     recon->r_size = unpacked_len;
-  }
-  recon->r_bytes_rcvd = unpacked_len;
-  ((struct ip6_hdr *)(recon->r_buf))->ip6_plen =
-    htons(recon->r_size - sizeof(struct ip6_hdr));
-  /* fill in any elided app data length fields */
-  if (recon->r_app_len) {
-    *recon->r_app_len =
-      htons(recon->r_size - (recon->r_transport_header - recon->r_buf));
+    recon->r_bytes_rcvd = unpacked_len;
+  } else {
+    ret = recon_mark(recon, 0, unpacked_len);
+    if (ret < 0) return -8;
+    recon->r_bytes_rcvd += ret;
   }
 
-  /* Check if we used stateful uncompression with the ipv6 source or destination
-   * addresses. If so, we probably need to recalculate checksums because when
-   * the checksum was originally calculated the full source or destination
-   * address may not have been known. In that case, the checksum will fail
-   * at the packet's destination.
-   */
-  if (recalculate_checksum) {
-    struct ip6_hdr *hdr = (struct ip6_hdr *) recon->r_buf;
+  /* reconstruction is complete if r_bytes_rcvd == r_size */
+  if (recon->r_bytes_rcvd == recon->r_size)
+    recon_finish(recon);
+  return 0;
+}
 
-    /* Right now only handle the only header being UDP */
-    if (hdr->ip6_nxt == IANA_UDP) {
-      struct ip_iovec v[2];
-      struct udp_hdr *udph;
+/* Effects: copies a FRAGN payload to its offset in recon->r_buf */
+static int recon_next(struct lowpan_reconstruct *recon,
+                      struct packed_lowmsg *msg, uint8_t *pkt, size_t len) {
+  uint8_t *buf, offset8;
+  uint16_t offset;
+  int fresh;
 
-      udph = (struct udp_hdr *) recon->r_transport_header;
-      udph->chksum = 0;
+  if (getFragDgramOffset(msg, &offset8)) return -2;
+  offset = (uint16_t)offset8 * 8;
+  buf = getLowpanPayload(msg);
+  len -= (buf - pkt);
 
-      v[0].iov_base = (uint8_t *) udph;
-      v[0].iov_len  = sizeof(struct udp_hdr);
-      v[0].iov_next = v+1;
-      v[1].iov_base = (uint8_t*) (udph + 1);
-      v[1].iov_len  = ntohs(*recon->r_app_len) - sizeof(struct udp_hdr);
-      v[1].iov_next = NULL;
+  if (offset + len > recon->r_size) return -3;
+  if (len == 0) return 0;
+
+  fresh = recon_mark(recon, offset, len);
+  if (fresh < 0) return -4;
+  if (fresh > 0) {
+    /* overlapping bytes are rewritten with the same data */
+    memcpy(recon->r_buf + offset, buf, len);
+    recon->r_bytes_rcvd += fresh;
+    if (recon->r_bytes_rcvd == recon->r_size)
+      recon_finish(recon);
+  }
+  return 0;
+}
 
-      udph->chksum = htons(msg_cksum(hdr, v, IANA_UDP));
-    }
+int lowpan_recon_start(struct ieee154_frame_addr *frame_addr,
+                       struct lowpan_reconstruct *recon,
+                       uint8_t *pkt,
+                       size_t len) {
+  uint8_t *unpack_point;
+  struct packed_lowmsg msg;
+  uint16_t size;
+  int ret;
+
+  msg.data = pkt;
+  msg.len  = len;
+  msg.headers = getHeaderBitmap(&msg);
+  if (msg.headers == LOWMSG_NALP) return -1;
 
+  /* remove the 6lowpan frag headers from the payload */
+  unpack_point = getLowpanPayload(&msg);
+  if (unpack_point - pkt >= len) {
+    return -4;
   }
+  len -= (unpack_point - pkt);
 
-  /* done, updated all the fields */
-  /* reconstruction is complete if r_bytes_rcvd == r_size */
+  /* set up the reconstruction, or just fill in the packet length */
+  if (hasFrag1Header(&msg)) {
+    getFragDgramTag(&msg, &recon->r_tag);
+    getFragDgramSize(&msg, &size);
+  } else {
+    size = LIB6LOWPAN_MAX_LEN + LOWPAN_LINK_MTU;
+  }
+  if (recon_alloc(recon, size, hasFrag1Header(&msg)) < 0) return -2;
+
+  ret = recon_first(frame_addr, recon, unpack_point, len,
+                    hasFrag1Header(&msg));
+  if (ret < 0) {
+    ip_free(recon->r_buf);
+    return ret;
+  }
   return 0;
 }
 
 int lowpan_recon_add(struct lowpan_reconstruct *recon,
                      uint8_t *pkt, size_t len) {
   struct packed_lowmsg msg;
-  uint8_t *buf;
 
   msg.data = pkt;
   msg.len  = len;
@@ -138,18 +233,211 @@ int lowpan_recon_add(struct lowpan_reconstruct *recon,
     return -2;
   }
 
-  buf = getLowpanPayload(&msg);
-  len -= (buf - pkt);
+  return recon_next(recon, &msg, pkt, len);
+}
 
-  if (recon->r_size < recon->r_bytes_rcvd + len) return -3;
+/*
+ * The reassembly table: linear probing from a hash of the key, and
+ * deletion by moving later entries of the same probe sequence back,
+ * so lookups stop at the first unused slot.
+ */
+
+static uint16_t recon_hash(struct lowpan_recon_table *table,
+                           uint16_t src, uint16_t dst,
+                           uint16_t tag, uint16_t size) {
+  uint16_t h = src ^ ((dst << 5) | (dst >> 11)) ^ (tag * 31) ^ (size * 7);
+  return h % table->n_slots;
+}
+
+static uint16_t recon_mem(struct lowpan_reconstruct *recon) {
+  return recon->r_size + LOWPAN_RECON_BITMAP_LEN(recon->r_size);
+}
+
+void lowpan_recon_init(struct lowpan_recon_table *table,
+                       struct lowpan_reconstruct *slots, uint16_t n_slots,
+                       uint16_t mem_budget) {
+  uint16_t i;
+
+  table->slots = slots;
+  table->n_slots = n_slots;
+  table->n_used = 0;
+  table->mem_used = 0;
+  table->mem_budget = mem_budget;
+  for (i = 0; i < n_slots; i++) {
+    memset(&slots[i], 0, sizeof(struct lowpan_reconstruct));
+    slots[i].r_timeout = T_UNUSED;
+  }
+}
+
+void lowpan_recon_release(struct lowpan_recon_table *table,
+                          struct lowpan_reconstruct *recon) {
+  uint16_t i = recon - table->slots, j = i, home;
+
+  if (recon->r_timeout == T_UNUSED) return;
+  if (recon->r_buf != NULL) {
+    table->mem_used -= recon_mem(recon);
+    ip_free(recon->r_buf);
+    recon->r_buf = NULL;
+  }
+
+  recon->r_timeout = T_UNUSED;
+  for (;;) {
+    struct lowpan_reconstruct *next;
+    j = (j + 1) % table->n_slots;
+    next = &table->slots[j];
+    if (next->r_timeout == T_UNUSED)
+      break;
+    home = recon_hash(table, next->r_source_key, next->r_dest_key,
+                      next->r_tag, next->r_size);
+    /* move next into the hole unless its home lies cyclically in (i, j] */
+    if ((i <= j) ? (i < home && home <= j) : (i < home || home <= j))
+      continue;
+    table->slots[i] = *next;
+    next->r_timeout = T_UNUSED;
+    next->r_buf = NULL;
+    i = j;
+  }
+  table->n_used--;
+}
 
-  /* just need to copy the new payload in and return */
-  memcpy(recon->r_buf + recon->r_bytes_rcvd, buf, len);
-  recon->r_bytes_rcvd += len;
+void lowpan_recon_age(struct lowpan_recon_table *table) {
+  uint16_t i = 0;
+
+  // drop what was already old, looking at slot i again whenever
+  // another entry moves into it
+  while (i < table->n_slots) {
+    struct lowpan_reconstruct *recon = &table->slots[i];
+    if (recon->r_timeout == T_ZOMBIE || recon->r_timeout == T_FAILED2)
+      lowpan_recon_release(table, recon);
+    else
+      i++;
+  }
+  // then age the rest
+  for (i = 0; i < table->n_slots; i++) {
+    struct lowpan_reconstruct *recon = &table->slots[i];
+    if (recon->r_timeout == T_ACTIVE)
+      recon->r_timeout = T_ZOMBIE;
+    else if (recon->r_timeout == T_FAILED1)
+      recon->r_timeout = T_FAILED2;
+  }
+}
 
+/* Effects: releases a datagram nothing arrived for since the last
+     lowpan_recon_age.  Failing that, if headless is set, releases a
+     datagram whose first fragment has not arrived: a stray or late
+     FRAGN must not hold its buffer against a datagram that starts.
+   Returns: 1 if one was released */
+static int recon_evict(struct lowpan_recon_table *table, int headless) {
+  uint16_t i;
+
+  for (i = 0; i < table->n_slots; i++) {
+    if (table->slots[i].r_timeout == T_ZOMBIE ||
+        table->slots[i].r_timeout == T_FAILED2) {
+      lowpan_recon_release(table, &table->slots[i]);
+      return 1;
+    }
+  }
+  for (i = 0; headless && i < table->n_slots; i++) {
+    struct lowpan_reconstruct *recon = &table->slots[i];
+    if (recon->r_timeout == T_ACTIVE && recon->r_buf != NULL &&
+        !recon_has(recon, 0)) {
+      lowpan_recon_release(table, recon);
+      return 1;
+    }
+  }
   return 0;
 }
 
+int lowpan_recon_input(struct lowpan_recon_table *table,
+                       struct ieee154_frame_addr *frame_addr,
+                       uint8_t *pkt, size_t len,
+                       struct lowpan_reconstruct **out) {
+  struct lowpan_reconstruct *recon;
+  struct packed_lowmsg msg;
+  uint16_t src, dst, tag, size, i, h;
+  int ret;
+
+  *out = NULL;
+  msg.data = pkt;
+  msg.len  = len;
+  msg.headers = getHeaderBitmap(&msg);
+  if (msg.headers == LOWMSG_NALP) return -1;
+  if (!hasFrag1Header(&msg) && !hasFragNHeader(&msg)) return -1;
+  if (getFragDgramTag(&msg, &tag) || getFragDgramSize(&msg, &size) ||
+      size < sizeof(struct ip6_hdr))
+    return -1;
+  src = ieee154_hashaddr(&frame_addr->ieee_src);
+  dst = ieee154_hashaddr(&frame_addr->ieee_dst);
+
+  h = recon_hash(table, src, dst, tag, size);
+  for (i = 0; i < table->n_slots; i++) {
+    recon = &table->slots[(h + i) % table->n_slots];
+    if (recon->r_timeout == T_UNUSED)
+      break;
+    if (recon->r_source_key == src && recon->r_dest_key == dst &&
+        recon->r_tag == tag && recon->r_size == size)
+      goto found;
+  }
+
+  /* a new datagram: make room for it, then look for a slot again
+     since evicting moves entries.  Only a first fragment may push out
+     datagrams still waiting for theirs. */
+  while ((table->n_used == table->n_slots ||
+          (table->mem_budget &&
+           table->mem_used + size + LOWPAN_RECON_BITMAP_LEN(size) >
+           table->mem_budget)) &&
+         recon_evict(table, hasFrag1Header(&msg)))
+    ;
+  if (table->n_used == table->n_slots) return -3;
+  for (i = 0; ; i++) {
+    recon = &table->slots[(h + i) % table->n_slots];
+    if (recon->r_timeout == T_UNUSED)
+      break;
+  }
+  recon->r_source_key = src;
+  recon->r_dest_key = dst;
+  recon->r_tag = tag;
+  recon->r_size = size;
+  recon->r_buf = NULL;
+  table->n_used++;
+  if ((table->mem_budget &&
+       table->mem_used + size + LOWPAN_RECON_BITMAP_LEN(size) >
+       table->mem_budget) ||
+      recon_alloc(recon, size, 1) < 0) {
+    // drop the rest of this datagram too
+    recon->r_timeout = T_FAILED1;
+    *out = recon;
+    return -2;
+  }
+  table->mem_used += recon_mem(recon);
+
+ found:
+  *out = recon;
+  if (recon->r_timeout < T_UNUSED) {
+    // we have already tried and failed; drop remaining fragments.
+    return -4;
+  }
+  recon->r_timeout = T_ACTIVE;
+
+  if (hasFrag1Header(&msg)) {
+    uint8_t *unpack_point = getLowpanPayload(&msg);
+    if (recon_has(recon, 0))
+      return recon->r_bytes_rcvd == recon->r_size;
+    ret = recon_first(frame_addr, recon, unpack_point,
+                      len - (unpack_point - pkt), 1);
+  } else {
+    ret = recon_next(recon, &msg, pkt, len);
+  }
+  if (ret < 0) {
+    table->mem_used -= recon_mem(recon);
+    ip_free(recon->r_buf);
+    recon->r_buf = NULL;
+    recon->r_timeout = T_FAILED1;
+    return ret;
+  }
+  return recon->r_bytes_rcvd == recon->r_size;
+}
+
 int lowpan_frag_get(uint8_t *frag, size_t len,
                     struct ip6_packet *packet,
                     struct ieee154_frame_addr *frame,
@@ -185,6 +473,7 @@ int lowpan_frag_get(uint8_t *frag, size_t len,
     /* may need to fragment -- insert a FRAG1 header if so */
     if (extra_payload > len - (buf - ieee_buf)) {
       struct packed_lowmsg lowmsg;
+      if (buf - ieee_buf + LOWMSG_FRAG1_LEN > len) return -1;
       memmove(lowpan_buf + LOWMSG_FRAG1_LEN,
                 lowpan_buf,
                 buf - lowpan_buf);
@@ -0,0 +1,254 @@
+#include <stdint.h>
+#include <string.h>
+
+#include "route_trie.h"
+
+#define NODE(i) (t->nodes[i])
+
+static const uint8_t *key_of(struct route_trie *t, uint16_t value) {
+  return t->keys + (size_t)value * t->key_stride;
+}
+
+static int bit_at(const uint8_t *p, uint8_t i) {
+  return (p[i / 8] >> (7 - i % 8)) & 1;
+}
+
+/* Returns: how many leading bits of a and b agree, at most max.  The
+     bits before from are known to agree. */
+static uint8_t common_bits(const uint8_t *a, const uint8_t *b,
+                           uint8_t from, uint8_t max) {
+  int i;
+
+  for (i = from / 8; i * 8 < max; i++) {
+    uint8_t diff = a[i] ^ b[i];
+    if (diff) {
+      int n = i * 8;
+      while (!(diff & 0x80)) {
+        diff <<= 1;
+        n++;
+      }
+      return n < max ? n : max;
+    }
+  }
+  return max;
+}
+
+static uint16_t node_new(struct route_trie *t, uint16_t value, uint16_t key,
+                         uint8_t bits) {
+  uint16_t n = t->free;
+  if (n == ROUTE_TRIE_NONE) return ROUTE_TRIE_NONE;
+  t->free = NODE(n).child[0];
+  NODE(n).child[0] = NODE(n).child[1] = ROUTE_TRIE_NONE;
+  NODE(n).value = value;
+  NODE(n).key = key;
+  NODE(n).bits = bits;
+  return n;
+}
+
+static void node_free(struct route_trie *t, uint16_t n) {
+  NODE(n).child[0] = t->free;
+  t->free = n;
+}
+
+/* Effects: invalidates every cached lookup */
+static void changed(struct route_trie *t) {
+  if (++t->generation == 0) {
+    uint16_t i;
+    for (i = 0; i < t->cache_size; i++)
+      t->cache[i].generation = 0;
+    t->generation = 1;
+  }
+}
+
+void route_trie_init(struct route_trie *t,
+                     struct route_trie_node *nodes, uint16_t n_nodes,
+                     const void *keys, size_t key_stride,
+                     struct route_cache_entry *cache, uint16_t cache_size) {
+  uint16_t i;
+
+  t->nodes = nodes;
+  t->n_nodes = n_nodes;
+  t->root = ROUTE_TRIE_NONE;
+  t->free = ROUTE_TRIE_NONE;
+  for (i = n_nodes; i > 0; i--)
+    node_free(t, i - 1);
+  t->keys = keys;
+  t->key_stride = key_stride;
+  t->cache = cache;
+  t->cache_size = cache ? cache_size : 0;
+  for (i = 0; i < t->cache_size; i++)
+    t->cache[i].generation = 0;
+  t->generation = 1;
+}
+
+int route_trie_insert(struct route_trie *t, uint16_t value, uint8_t bits) {
+  const uint8_t *p = key_of(t, value);
+  uint16_t *link = &t->root, n, m;
+  uint8_t matched = 0;
+
+  if (bits > 128) return -1;
+
+  while ((n = *link) != ROUTE_TRIE_NONE) {
+    struct route_trie_node *node = &NODE(n);
+    const uint8_t *node_key = key_of(t, node->key);
+    uint8_t c = common_bits(p, node_key, matched,
+                            node->bits < bits ? node->bits : bits);
+
+    if (c == node->bits) {
+      if (node->bits == bits) {
+        /* a branch at exactly this prefix becomes the route */
+        if (node->value != ROUTE_TRIE_NONE) return -1;
+        node->value = node->key = value;
+        changed(t);
+        return 0;
+      }
+      matched = c;
+      link = &node->child[bit_at(p, node->bits)];
+      continue;
+    }
+
+    if (c == bits) {
+      /* the new prefix covers node: it goes above it */
+      m = node_new(t, value, value, bits);
+      if (m == ROUTE_TRIE_NONE) return -2;
+      NODE(m).child[bit_at(node_key, bits)] = n;
+    } else {
+      /* the prefixes part at bit c: a branch with both below it */
+      uint16_t leaf;
+      if (t->free == ROUTE_TRIE_NONE ||
+          NODE(t->free).child[0] == ROUTE_TRIE_NONE)
+        return -2;
+      leaf = node_new(t, value, value, bits);
+      m = node_new(t, ROUTE_TRIE_NONE, node->key, c);
+      NODE(m).child[bit_at(p, c)] = leaf;
+      NODE(m).child[bit_at(node_key, c)] = n;
+    }
+    *link = m;
+    changed(t);
+    return 0;
+  }
+
+  m = node_new(t, value, value, bits);
+  if (m == ROUTE_TRIE_NONE) return -2;
+  *link = m;
+  changed(t);
+  return 0;
+}
+
+/* Effects: removes node n, reached through link, if it is a branch
+     that no longer has two children */
+static void splice(struct route_trie *t, uint16_t *link, uint16_t n) {
+  struct route_trie_node *node = &NODE(n);
+
+  if (node->value != ROUTE_TRIE_NONE ||
+      (node->child[0] != ROUTE_TRIE_NONE && node->child[1] != ROUTE_TRIE_NONE))
+    return;
+  *link = node->child[0] != ROUTE_TRIE_NONE ? node->child[0] : node->child[1];
+  node_free(t, n);
+}
+
+/* Returns: some route at or below n */
+static uint16_t live_key(struct route_trie *t, uint16_t n) {
+  while (NODE(n).value == ROUTE_TRIE_NONE) {
+    uint16_t *child = NODE(n).child;
+    n = child[0] != ROUTE_TRIE_NONE ? child[0] : child[1];
+  }
+  return NODE(n).value;
+}
+
+uint16_t route_trie_remove(struct route_trie *t,
+                           const uint8_t *prefix, uint8_t bits) {
+  uint16_t *link = &t->root, *parent_link = NULL, n, value;
+  uint8_t matched = 0;
+
+  while ((n = *link) != ROUTE_TRIE_NONE) {
+    struct route_trie_node *node = &NODE(n);
+    if (node->bits > bits ||
+        common_bits(prefix, key_of(t, node->key), matched,
+                    node->bits) < node->bits)
+      return ROUTE_TRIE_NONE;
+    if (node->bits == bits)
+      break;
+    matched = node->bits;
+    parent_link = link;
+    link = &node->child[bit_at(prefix, node->bits)];
+  }
+  if (n == ROUTE_TRIE_NONE || NODE(n).value == ROUTE_TRIE_NONE)
+    return ROUTE_TRIE_NONE;
+
+  value = NODE(n).value;
+  NODE(n).value = ROUTE_TRIE_NONE;
+  splice(t, link, n);
+  if (parent_link)
+    splice(t, parent_link, *parent_link);
+
+  /* only nodes on the path to prefix can have borrowed its key */
+  for (n = t->root; n != ROUTE_TRIE_NONE; ) {
+    struct route_trie_node *node = &NODE(n);
+    if (node->key == value)
+      node->key = live_key(t, n);
+    if (node->bits >= bits)
+      break;
+    n = node->child[bit_at(prefix, node->bits)];
+  }
+  changed(t);
+  return value;
+}
+
+uint16_t route_trie_exact(struct route_trie *t,
+                          const uint8_t *prefix, uint8_t bits) {
+  uint16_t n = t->root;
+  uint8_t matched = 0;
+
+  while (n != ROUTE_TRIE_NONE && NODE(n).bits <= bits) {
+    struct route_trie_node *node = &NODE(n);
+    if (common_bits(prefix, key_of(t, node->key), matched,
+                    node->bits) < node->bits)
+      return ROUTE_TRIE_NONE;
+    if (node->bits == bits)
+      return node->value;
+    matched = node->bits;
+    n = node->child[bit_at(prefix, node->bits)];
+  }
+  return ROUTE_TRIE_NONE;
+}
+
+uint16_t route_trie_lookup(struct route_trie *t,
+                           const uint8_t *addr, uint8_t bits) {
+  uint16_t n = t->root, best = ROUTE_TRIE_NONE;
+  uint8_t matched = 0;
+
+  while (n != ROUTE_TRIE_NONE && NODE(n).bits <= bits) {
+    struct route_trie_node *node = &NODE(n);
+    if (common_bits(addr, key_of(t, node->key), matched,
+                    node->bits) < node->bits)
+      break;
+    if (node->value != ROUTE_TRIE_NONE)
+      best = node->value;
+    if (node->bits == bits)
+      break;
+    matched = node->bits;
+    n = node->child[bit_at(addr, node->bits)];
+  }
+  return best;
+}
+
+uint16_t route_trie_lookup_cached(struct route_trie *t, const uint8_t *dst) {
+  struct route_cache_entry *e;
+  uint16_t h = 0;
+  int i;
+
+  if (t->cache_size == 0)
+    return route_trie_lookup(t, dst, 128);
+  for (i = 0; i < 16; i++)
+    h = h * 31 + dst[i];
+  e = &t->cache[h % t->cache_size];
+  if (e->generation != t->generation || memcmp(e->dst, dst, 16) != 0) {
+    memcpy(e->dst, dst, 16);
+    e->value = route_trie_lookup(t, dst, 128);
+    e->generation = t->generation;
+  }
+  return e->value;
+}
+
+#undef NODE
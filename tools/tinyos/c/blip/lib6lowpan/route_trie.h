@@ -0,0 +1,85 @@
+#ifndef ROUTE_TRIE_H_
+#define ROUTE_TRIE_H_
+
+#include <stdint.h>
+#include <stddef.h>
+
+/*
+ * Longest-prefix match over IPv6 prefixes, with a route cache.
+ *
+ * A path-compressed binary trie over a fixed pool of nodes.  The trie
+ * does not store prefixes: route i's prefix is read from the caller's
+ * table at keys + i * key_stride, so a forwarding table can be indexed
+ * in place.  Each node is either a route or a branch; every node also
+ * names some route below it whose prefix agrees with the node's bits.
+ * With n routes the trie needs at most 2n nodes, and a lookup visits at
+ * most one node per distinct prefix length on the path.
+ *
+ * Destination lookups can go through a small direct-mapped cache of
+ * full addresses.  Every change to the trie bumps a generation counter,
+ * which invalidates the whole cache at once.
+ */
+
+#define ROUTE_TRIE_NONE 0xffff
+
+struct route_trie_node {
+  uint16_t child[2];   /* next bit 0 and 1, or ROUTE_TRIE_NONE */
+  uint16_t value;      /* the route at this node, or ROUTE_TRIE_NONE */
+  uint16_t key;        /* a route whose prefix shares this node's bits */
+  uint8_t  bits;       /* prefix length of this node */
+};
+
+struct route_cache_entry {
+  uint8_t  dst[16];
+  uint16_t value;
+  uint16_t generation; /* 0 is never current */
+};
+
+struct route_trie {
+  struct route_trie_node *nodes;
+  uint16_t n_nodes;
+  uint16_t root;
+  uint16_t free;       /* free nodes, linked through child[0] */
+  const uint8_t *keys;
+  uint16_t key_stride;
+  struct route_cache_entry *cache;
+  uint16_t cache_size;
+  uint16_t generation;
+};
+
+/* nodes should hold twice as many entries as there are routes; cache
+   may be NULL */
+void route_trie_init(struct route_trie *t,
+                     struct route_trie_node *nodes, uint16_t n_nodes,
+                     const void *keys, size_t key_stride,
+                     struct route_cache_entry *cache, uint16_t cache_size);
+
+/*
+ * Add route value, whose prefix is already in the keys table, with a
+ * prefix length of bits.
+ *
+ * @return 0 on success, -1 if a route to the same prefix exists, -2 if
+ *         the node pool is exhausted.
+ */
+int route_trie_insert(struct route_trie *t, uint16_t value, uint8_t bits);
+
+/* @return the route removed, or ROUTE_TRIE_NONE if there was none */
+uint16_t route_trie_remove(struct route_trie *t,
+                           const uint8_t *prefix, uint8_t bits);
+
+/* @return the route to exactly prefix/bits, or ROUTE_TRIE_NONE */
+uint16_t route_trie_exact(struct route_trie *t,
+                          const uint8_t *prefix, uint8_t bits);
+
+/*
+ * @return the route with the longest prefix no longer than bits that
+ *         matches addr, or ROUTE_TRIE_NONE.  addr may be NULL if bits
+ *         is 0.
+ */
+uint16_t route_trie_lookup(struct route_trie *t,
+                           const uint8_t *addr, uint8_t bits);
+
+/* route_trie_lookup(t, dst, 128), through the cache */
+uint16_t route_trie_lookup_cached(struct route_trie *t, const uint8_t *dst);
+
+#endif
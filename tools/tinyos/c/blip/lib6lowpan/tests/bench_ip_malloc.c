@@ -0,0 +1,271 @@
+/* Stress test and benchmark for ip_malloc.
+ *
+ * bench_ip_malloc [operations]
+ *
+ * Runs a random mix of allocations shaped like blip's (small table
+ * entries, fragments, reassembly buffers up to the IPv6 MTU) against
+ * ip_malloc and against the first-fit walk it replaced, on equal heaps.
+ * Every block is filled with a pattern that is checked when it is
+ * freed, and the heap is walked regularly to check the boundary tags,
+ * the PREVFREE bits, the trailing lengths of free blocks and the
+ * statistics.  Reports time per operation, allocation failures while
+ * enough bytes were free, and the fragmentation seen along the way.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/time.h>
+
+#include "ip_malloc.h"
+
+#define SLOTS 24
+
+static int total, success;
+
+static double now(void) {
+  struct timeval tv;
+  gettimeofday(&tv, NULL);
+  return tv.tv_sec + tv.tv_usec / 1e6;
+}
+
+/* the first-fit allocator ip_malloc used to be, on its own heap */
+static uint8_t ff_heap[IP_MALLOC_HEAP_SIZE];
+
+static void ff_init(void) {
+  *(bndrt_t *)ff_heap = IP_MALLOC_HEAP_SIZE & IP_MALLOC_LEN;
+}
+
+static void *ff_malloc(uint16_t sz) {
+  bndrt_t *cur = (bndrt_t *)ff_heap;
+
+  sz += sizeof(bndrt_t) * 2;
+  sz += (sz % IP_MALLOC_ALIGN);
+  while (((*cur & IP_MALLOC_LEN) < sz || (*cur & IP_MALLOC_INUSE) != 0)
+         && (uint8_t *)cur - ff_heap < IP_MALLOC_HEAP_SIZE) {
+    cur = (bndrt_t *)(((uint8_t *)cur) + ((*cur) & IP_MALLOC_LEN));
+  }
+  if ((uint8_t *)cur < ff_heap + IP_MALLOC_HEAP_SIZE) {
+    uint16_t oldsize = *cur & IP_MALLOC_LEN;
+    bndrt_t *next;
+    sz -= sizeof(bndrt_t);
+    next = ((bndrt_t *)(((uint8_t *)cur) + sz));
+    *cur = (sz & IP_MALLOC_LEN) | IP_MALLOC_INUSE;
+    *next = (oldsize - sz) & IP_MALLOC_LEN;
+    return cur + 1;
+  }
+  return NULL;
+}
+
+static void ff_free(void *ptr) {
+  bndrt_t *prev = NULL, *cur = (bndrt_t *)ff_heap, *next;
+
+  while (cur + 1 != ptr && (uint8_t *)cur - ff_heap < IP_MALLOC_HEAP_SIZE) {
+    prev = cur;
+    cur = (bndrt_t *)(((uint8_t *)cur) + ((*cur) & IP_MALLOC_LEN));
+  }
+  if (cur + 1 == ptr) {
+    next = (bndrt_t *)((*cur & IP_MALLOC_LEN) + ((uint8_t *)cur));
+    *cur &= ~IP_MALLOC_INUSE;
+    if ((((uint8_t *)next) - ff_heap) < IP_MALLOC_HEAP_SIZE &&
+        (*next & IP_MALLOC_INUSE) == 0)
+      *cur = (*cur & IP_MALLOC_LEN) + (*next & IP_MALLOC_LEN);
+    if (prev != NULL && (*prev & IP_MALLOC_INUSE) == 0)
+      *prev = (*prev & IP_MALLOC_LEN) + (*cur & IP_MALLOC_LEN);
+  }
+}
+
+static uint16_t ff_freespace(void) {
+  uint16_t ret = 0;
+  bndrt_t *cur = (bndrt_t *)ff_heap;
+
+  while ((uint8_t *)cur - ff_heap < IP_MALLOC_HEAP_SIZE) {
+    if ((*cur & IP_MALLOC_INUSE) == 0)
+      ret += *cur & IP_MALLOC_LEN;
+    cur = (bndrt_t *)(((uint8_t *)cur) + ((*cur) & IP_MALLOC_LEN));
+  }
+  return ret;
+}
+
+struct allocator {
+  const char *name;
+  void (*init)(void);
+  void *(*alloc)(uint16_t);
+  void (*release)(void *);
+  uint16_t (*freespace)(void);
+};
+
+static const struct allocator allocators[] = {
+  { "ip_malloc", ip_malloc_init, ip_malloc, ip_free, ip_malloc_freespace },
+  { "first fit", ff_init, ff_malloc, ff_free, ff_freespace },
+};
+
+static uint16_t random_size(void) {
+  int r = rand() % 16;
+  if (r < 8) return rand() % 48 + 4;     // table entries, timers
+  if (r < 15) return rand() % 128 + 64;  // fragments
+  return rand() % 1000 + 280;            // reassembly buffers
+}
+
+/* Returns: 1 if the tags, footers and statistics of heap agree */
+static int check_heap(void) {
+  struct ip_malloc_stats s;
+  uint16_t off = 0, free = 0, free_blocks = 0, used_blocks = 0, largest = 0;
+  int prev_free = 0;
+
+  ip_malloc_stats(&s);
+  while (off < IP_MALLOC_HEAP_SIZE) {
+    bndrt_t tag = *(bndrt_t *)(heap + off);
+    uint16_t len = tag & IP_MALLOC_LEN;
+
+    if (len < 4 * sizeof(bndrt_t) || off + len > IP_MALLOC_HEAP_SIZE) {
+      printf("bad length %u at %u\n", len, off);
+      return 0;
+    }
+    if (((tag & IP_MALLOC_PREVFREE) != 0) != prev_free) {
+      printf("bad PREVFREE at %u\n", off);
+      return 0;
+    }
+    if (tag & IP_MALLOC_INUSE) {
+      used_blocks++;
+      prev_free = 0;
+    } else {
+      if (prev_free) {
+        printf("adjacent free blocks at %u\n", off);
+        return 0;
+      }
+      if (*(bndrt_t *)(heap + off + len - sizeof(bndrt_t)) != len) {
+        printf("bad trailing length at %u\n", off);
+        return 0;
+      }
+      free += len;
+      free_blocks++;
+      if (len > largest) largest = len;
+      prev_free = 1;
+    }
+    off += len;
+  }
+  if (off != IP_MALLOC_HEAP_SIZE || free != s.free ||
+      free != ip_malloc_freespace() || free_blocks != s.free_blocks ||
+      used_blocks != s.used_blocks || largest != s.largest) {
+    printf("statistics: free %u/%u blocks %u/%u used %u/%u largest %u/%u\n",
+           free, s.free, free_blocks, s.free_blocks,
+           used_blocks, s.used_blocks, largest, s.largest);
+    return 0;
+  }
+  return 1;
+}
+
+static void run(const struct allocator *a, int ops, int check) {
+  uint8_t *ptr[SLOTS];
+  uint16_t len[SLOTS];
+  long failures = 0, frag_failures = 0, frag_sum = 0;
+  int i, slot, ok = 1;
+  double t0;
+
+  memset(ptr, 0, sizeof(ptr));
+  a->init();
+  srand(1);
+  t0 = now();
+  for (i = 0; i < ops && ok; i++) {
+    slot = rand() % SLOTS;
+    if (ptr[slot] != NULL) {
+      if (check && ((ptr[slot][0] != (uint8_t)slot ||
+                     ptr[slot][len[slot] - 1] != (uint8_t)~slot))) {
+        printf("%s: block %i overwritten\n", a->name, slot);
+        ok = 0;
+      }
+      a->release(ptr[slot]);
+      ptr[slot] = NULL;
+    } else {
+      len[slot] = random_size();
+      ptr[slot] = a->alloc(len[slot]);
+      if (ptr[slot] == NULL) {
+        failures++;
+        if (check && a->freespace() >= len[slot] + 2 * sizeof(bndrt_t))
+          frag_failures++;
+      } else if (check) {
+        memset(ptr[slot], (uint8_t)slot, len[slot]);
+        ptr[slot][len[slot] - 1] = ~slot;
+      }
+    }
+    if (check && a->alloc == ip_malloc) {
+      struct ip_malloc_stats s;
+      ip_malloc_stats(&s);
+      frag_sum += s.fragmentation;
+      if (i % 64 == 0 && !check_heap()) {
+        ip_print_heap();
+        ok = 0;
+      }
+    }
+  }
+
+  if (!check) {
+    printf("%s: %.0f ns per operation\n", a->name, (now() - t0) * 1e9 / ops);
+    return;
+  }
+  for (slot = 0; slot < SLOTS; slot++)
+    if (ptr[slot] != NULL) a->release(ptr[slot]);
+  if (a->freespace() != IP_MALLOC_HEAP_SIZE) {
+    printf("%s: %u bytes free after freeing everything\n",
+           a->name, a->freespace());
+    ok = 0;
+  }
+  printf("%s: %ld failures, %ld with enough free bytes", a->name,
+         failures, frag_failures);
+  if (a->alloc == ip_malloc) {
+    struct ip_malloc_stats s;
+    ip_malloc_stats(&s);
+    ok = ok && check_heap() && s.free_blocks == 1 && s.used_blocks == 0;
+    printf(", mean fragmentation %ld%%, low water %u",
+           frag_sum / ops, s.low_water);
+  }
+  printf("\n");
+
+  total++;
+  if (ok) {
+    printf("test: success\n");
+    success++;
+  }
+}
+
+/* every size from 0 up, until the heap is full, then free odd then even */
+static void exhaust(void) {
+  void *p[IP_MALLOC_HEAP_SIZE / 8];
+  int n = 0, i, ok = 1;
+  uint16_t sz = 0;
+
+  ip_malloc_init();
+  while ((p[n] = ip_malloc(sz)) != NULL) {
+    n++;
+    sz = (sz + 1) % 40;
+  }
+  ok = check_heap() && ip_malloc(IP_MALLOC_HEAP_SIZE) == NULL;
+  for (i = 1; i < n; i += 2) ip_free(p[i]);
+  ok = ok && check_heap();
+  for (i = 0; i < n; i += 2) ip_free(p[i]);
+  ip_free(NULL);
+  ok = ok && check_heap() &&
+    ip_malloc_freespace() == IP_MALLOC_HEAP_SIZE &&
+    ip_malloc(IP_MALLOC_HEAP_SIZE - sizeof(bndrt_t)) != NULL;
+
+  total++;
+  printf("exhaust: %i blocks\n", n);
+  if (ok) {
+    printf("test: success\n");
+    success++;
+  }
+}
+
+int main(int argc, char **argv) {
+  int ops = argc > 1 ? atoi(argv[1]) : 200000;
+  int i;
+
+  exhaust();
+  for (i = 0; i < (int)(sizeof(allocators) / sizeof(allocators[0])); i++)
+    run(&allocators[i], ops, 1);
+  for (i = 0; i < (int)(sizeof(allocators) / sizeof(allocators[0])); i++)
+    run(&allocators[i], ops, 0);
+
+  printf("%s: %i/%i tests succeeded\n", __FILE__, success, total);
+  return success != total;
+}
@@ -0,0 +1,357 @@
+/* Throughput benchmark for 6LoWPAN compression and fragmentation.
+ *
+ * bench_lowpan [packets] [rounds]
+ *
+ * Builds a mix of packets like the ones a border router forwards:
+ * link-local UDP with addresses derived from short and extended 802.15.4
+ * addresses, global UDP under a context, global ICMP with no context,
+ * multicast UDP, hop-by-hop (RPL option) and destination option chains,
+ * and TCP, with payloads from a few bytes to several fragments.  Reports
+ * ns/packet for header compression (lowpan_pack_headers and
+ * pack_nhc_chain), fragmentation (lowpan_frag_get over the whole
+ * packet) and decompression (lowpan_recon_start of the first frame).
+ * Every packet is also reassembled with lowpan_recon_start and
+ * lowpan_recon_add and compared against what was sent.
+ */
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/time.h>
+
+#include "Ieee154.h"
+#include "ip.h"
+#include "lib6lowpan.h"
+#include "nwbyte.h"
+#include "6lowpan.h"
+#include "iovec.h"
+#include "ip_malloc.h"
+#include "ieee154_header.h"
+#include "in_cksum.h"
+
+#define MAX_PKTS  512
+#define MAX_FRAGS 16
+#define FRAME_LEN IEEE154_LINK_MTU
+
+enum {
+  MIX_LL_SHORT,     /* link-local UDP, IIDs from short addresses */
+  MIX_LL_EXT,       /* link-local UDP, IIDs from EUI-64s */
+  MIX_CTX_UDP,      /* global UDP under context 0 */
+  MIX_GLOBAL_ICMP,  /* global ICMP, no context */
+  MIX_MCAST_UDP,    /* UDP to ff02::1a */
+  MIX_HOP_UDP,      /* hop-by-hop RPL option, then UDP */
+  MIX_DEST_UDP,     /* destination options with PadN, then UDP */
+  MIX_TCP,          /* TCP, carried inline */
+  MIX_COUNT
+};
+
+static const char *mix_names[MIX_COUNT] = {
+  "ll short", "ll ext", "ctx udp", "icmp", "mcast", "hop udp", "dest udp",
+  "tcp",
+};
+
+struct bench_pkt {
+  struct ip6_packet packet;
+  struct ieee154_frame_addr frame;
+  struct ip_iovec v;
+  uint8_t data[1280];
+  uint8_t flat[1280 + sizeof(struct ip6_hdr)];
+  int flat_len, mix;
+  struct {
+    uint8_t buf[FRAME_LEN];
+    int len;
+  } frags[MAX_FRAGS];
+  int n_frags;
+};
+
+static struct bench_pkt pkts[MAX_PKTS];
+
+/* one /64 context, 2001:db8:1234:5678::/64 */
+static const uint8_t ctx_prefix[8] = {0x20, 0x01, 0x0d, 0xb8,
+                                      0x12, 0x34, 0x56, 0x78};
+
+int lowpan_extern_read_context(struct in6_addr *addr, int context) {
+  memset(addr->s6_addr, 0, 16);
+  memcpy(addr->s6_addr, ctx_prefix, 8);
+  return 64;
+}
+
+int lowpan_extern_match_context(struct in6_addr *addr, uint8_t *ctx_id) {
+  *ctx_id = 0;
+  return memcmp(addr->s6_addr, ctx_prefix, 8) == 0 ? 64 : 0;
+}
+
+static double now(void) {
+  struct timeval tv;
+  gettimeofday(&tv, NULL);
+  return tv.tv_sec + tv.tv_usec / 1e6;
+}
+
+static void set_ll_short(struct in6_addr *a, ieee154_addr_t *l2, uint16_t s) {
+  inet_pton6("fe80::ff:fe00:0", a);
+  a->s6_addr[14] = s >> 8;
+  a->s6_addr[15] = s;
+  l2->ieee_mode = IEEE154_ADDR_SHORT;
+  l2->i_saddr = htole16(s);
+}
+
+static void set_ll_ext(struct in6_addr *a, ieee154_addr_t *l2) {
+  int i;
+  inet_pton6("fe80::", a);
+  l2->ieee_mode = IEEE154_ADDR_EXT;
+  for (i = 0; i < 8; i++)
+    l2->i_laddr.data[i] = rand();
+  for (i = 0; i < 8; i++)
+    a->s6_addr[8 + i] = l2->i_laddr.data[7 - i];
+  a->s6_addr[8] ^= 0x2;
+}
+
+/* Returns: bytes of UDP header written to buf for a payload of len */
+static int put_udp(uint8_t *buf, int len) {
+  struct udp_hdr *udp = (struct udp_hdr *)buf;
+  udp->srcport = htons(rand() % 2 ? 0xf0b0 + rand() % 16 : 1024 + rand());
+  udp->dstport = htons(rand() % 2 ? 0xf0b0 + rand() % 16 : 5683);
+  udp->len = htons(len);
+  udp->chksum = 0;
+  return sizeof(struct udp_hdr);
+}
+
+/* a payload size: mostly one frame, sometimes several */
+static int payload_len(void) {
+  int r = rand() % 8;
+  if (r < 5) return rand() % 60 + 4;
+  if (r < 7) return rand() % 200 + 60;
+  return rand() % 900 + 260;
+}
+
+static void make_packet(struct bench_pkt *p, int mix) {
+  struct ip6_hdr *hdr = &p->packet.ip6_hdr;
+  int len = payload_len(), off = 0, udp_off = -1, i;
+
+  memset(&p->packet, 0, sizeof(p->packet));
+  memset(&p->frame, 0, sizeof(p->frame));
+  p->mix = mix;
+  p->frame.ieee_dstpan = htole16(0x22);
+  hdr->ip6_flow = htonl(0x6 << 28 | (rand() % 4 == 0 ? rand() & 0xfffff : 0));
+  hdr->ip6_hlim = rand() % 2 ? 64 : rand();
+
+  switch (mix) {
+  case MIX_LL_EXT:
+    set_ll_ext(&hdr->ip6_src, &p->frame.ieee_src);
+    set_ll_ext(&hdr->ip6_dst, &p->frame.ieee_dst);
+    break;
+  case MIX_CTX_UDP:
+  case MIX_GLOBAL_ICMP:
+    set_ll_short(&hdr->ip6_src, &p->frame.ieee_src, rand());
+    set_ll_short(&hdr->ip6_dst, &p->frame.ieee_dst, rand());
+    if (mix == MIX_CTX_UDP) {
+      memcpy(hdr->ip6_src.s6_addr, ctx_prefix, 8);
+      memcpy(hdr->ip6_dst.s6_addr, ctx_prefix, 8);
+    } else {
+      inet_pton6("2607:f140:400:a00::", &hdr->ip6_src);
+      hdr->ip6_src.s6_addr[15] = rand();
+      inet_pton6("2001:470:66:3f9::2", &hdr->ip6_dst);
+    }
+    break;
+  case MIX_MCAST_UDP:
+    set_ll_short(&hdr->ip6_src, &p->frame.ieee_src, rand());
+    inet_pton6("ff02::1a", &hdr->ip6_dst);
+    p->frame.ieee_dst.ieee_mode = IEEE154_ADDR_SHORT;
+    p->frame.ieee_dst.i_saddr = htole16(IEEE154_BROADCAST_ADDR);
+    break;
+  default:
+    set_ll_short(&hdr->ip6_src, &p->frame.ieee_src, rand());
+    set_ll_short(&hdr->ip6_dst, &p->frame.ieee_dst, rand());
+    break;
+  }
+
+  switch (mix) {
+  case MIX_GLOBAL_ICMP:
+    hdr->ip6_nxt = IANA_ICMP;
+    break;
+  case MIX_TCP:
+    hdr->ip6_nxt = IANA_TCP;
+    len += 20;
+    break;
+  case MIX_HOP_UDP:
+    /* RPL option: fills the header exactly */
+    hdr->ip6_nxt = IPV6_HOP;
+    p->data[off++] = IANA_UDP;
+    p->data[off++] = 0;
+    p->data[off++] = 0x63;
+    p->data[off++] = 4;
+    for (i = 0; i < 4; i++)
+      p->data[off++] = rand();
+    udp_off = off;
+    off += put_udp(p->data + off, len + sizeof(struct udp_hdr));
+    break;
+  case MIX_DEST_UDP:
+    /* one 6-byte option, then PadN to 16 bytes */
+    hdr->ip6_nxt = IPV6_DEST;
+    p->data[off++] = IANA_UDP;
+    p->data[off++] = 1;
+    p->data[off++] = 0x1e;
+    p->data[off++] = 6;
+    for (i = 0; i < 6; i++)
+      p->data[off++] = rand();
+    p->data[off++] = IPV6_TLV_PADN;
+    p->data[off++] = 4;
+    for (i = 0; i < 4; i++)
+      p->data[off++] = 0;
+    udp_off = off;
+    off += put_udp(p->data + off, len + sizeof(struct udp_hdr));
+    break;
+  default:
+    hdr->ip6_nxt = IANA_UDP;
+    udp_off = off;
+    off += put_udp(p->data + off, len + sizeof(struct udp_hdr));
+    break;
+  }
+  for (i = 0; i < len; i++)
+    p->data[off++] = rand();
+
+  hdr->ip6_plen = htons(off);
+  p->v.iov_base = p->data;
+  p->v.iov_len = off;
+  p->v.iov_next = NULL;
+  p->packet.ip6_data = &p->v;
+  if (udp_off >= 0) {
+    struct udp_hdr *udp = (struct udp_hdr *)(p->data + udp_off);
+    struct ip_iovec v;
+
+    v.iov_base = (uint8_t *)udp;
+    v.iov_len = off - udp_off;
+    v.iov_next = NULL;
+    udp->chksum = htons(msg_cksum(hdr, &v, IANA_UDP));
+  }
+
+  memcpy(p->flat, hdr, sizeof(struct ip6_hdr));
+  memcpy(p->flat + sizeof(struct ip6_hdr), p->data, off);
+  p->flat_len = sizeof(struct ip6_hdr) + off;
+}
+
+/* Returns: number of frames, or -1 if lowpan_frag_get failed */
+static int fragment(struct bench_pkt *p) {
+  struct lowpan_ctx ctx;
+  int rv;
+
+  ctx.offset = 0;
+  ctx.tag = rand();
+  p->n_frags = 0;
+  while (p->n_frags < MAX_FRAGS &&
+         (rv = lowpan_frag_get(p->frags[p->n_frags].buf, FRAME_LEN,
+                               &p->packet, &p->frame, &ctx)) > 0) {
+    p->frags[p->n_frags++].len = rv;
+  }
+  return rv < 0 ? -1 : p->n_frags;
+}
+
+/* Returns: 1 if the frames of p reassemble to exactly what was sent */
+static int reassemble(struct bench_pkt *p) {
+  struct lowpan_reconstruct recon;
+  struct ieee154_frame_addr fr;
+  uint8_t *buf;
+  size_t len;
+  int i, ok;
+
+  buf = p->frags[0].buf;
+  len = p->frags[0].len;
+  if (unpack_ieee154_hdr(&buf, &len, &fr) < 0 ||
+      lowpan_recon_start(&fr, &recon, buf, len) < 0)
+    return 0;
+  for (i = 1; i < p->n_frags; i++) {
+    buf = p->frags[i].buf;
+    len = p->frags[i].len;
+    if (unpack_ieee154_hdr(&buf, &len, &fr) < 0 ||
+        lowpan_recon_add(&recon, buf, len) < 0)
+      break;
+  }
+  ok = i == p->n_frags && recon.r_bytes_rcvd == recon.r_size &&
+    recon.r_size == p->flat_len &&
+    memcmp(recon.r_buf, p->flat, p->flat_len) == 0;
+  ip_free(recon.r_buf);
+  return ok;
+}
+
+int main(int argc, char **argv) {
+  int n = argc > 1 ? atoi(argv[1]) : MAX_PKTS;
+  int rounds = argc > 2 ? atoi(argv[2]) : 200;
+  int i, r, success = 0, total = 0, frames = 0, bytes = 0, hdr_bytes = 0;
+  int mix_ok[MIX_COUNT], mix_total[MIX_COUNT];
+  uint8_t out[FRAME_LEN], *buf;
+  volatile int sink = 0;
+  double t0, t_pack, t_frag, t_unpack;
+  struct ieee154_frame_addr frames_fr[MAX_PKTS];
+  uint8_t *first[MAX_PKTS];
+  size_t first_len[MAX_PKTS];
+
+  if (n > MAX_PKTS) n = MAX_PKTS;
+  ip_malloc_init();
+  srand(1);
+  memset(mix_ok, 0, sizeof(mix_ok));
+  memset(mix_total, 0, sizeof(mix_total));
+
+  for (i = 0; i < n; i++) {
+    struct bench_pkt *p = &pkts[i];
+    make_packet(p, i % MIX_COUNT);
+    total++;
+    mix_total[p->mix]++;
+    if (fragment(p) > 0 && reassemble(p)) {
+      success++;
+      mix_ok[p->mix]++;
+    }
+    frames += p->n_frags;
+    bytes += p->flat_len;
+    buf = p->frags[0].buf;
+    first_len[i] = p->frags[0].len;
+    unpack_ieee154_hdr(&buf, &first_len[i], &frames_fr[i]);
+    first[i] = buf;
+  }
+  for (i = 0; i < MIX_COUNT; i++)
+    printf("%-9s %i/%i reassembled\n", mix_names[i], mix_ok[i], mix_total[i]);
+  if (success == total)
+    printf("test: success\n");
+
+  t0 = now();
+  for (r = 0; r < rounds; r++) {
+    for (i = 0; i < n; i++) {
+      size_t left;
+      buf = lowpan_pack_headers(&pkts[i].packet, &pkts[i].frame,
+                                out, sizeof(out));
+      left = sizeof(out) - (buf - out);
+      sink += pack_nhc_chain(&buf, &left, &pkts[i].packet);
+      hdr_bytes += buf - out;
+    }
+  }
+  t_pack = now() - t0;
+
+  t0 = now();
+  for (r = 0; r < rounds; r++)
+    for (i = 0; i < n; i++)
+      sink += fragment(&pkts[i]);
+  t_frag = now() - t0;
+
+  t0 = now();
+  for (r = 0; r < rounds; r++) {
+    for (i = 0; i < n; i++) {
+      struct lowpan_reconstruct recon;
+      if (lowpan_recon_start(&frames_fr[i], &recon, first[i],
+                             first_len[i]) == 0) {
+        sink += recon.r_bytes_rcvd;
+        ip_free(recon.r_buf);
+      }
+    }
+  }
+  t_unpack = now() - t0;
+
+  printf("%i packets, %i bytes, %i frames, %.1f bytes of compressed "
+         "headers per packet\n", n, bytes, frames,
+         (double)hdr_bytes / rounds / n);
+  printf("compress:   %.0f ns/packet\n", t_pack * 1e9 / rounds / n);
+  printf("fragment:   %.0f ns/packet, %.0f ns/frame\n",
+         t_frag * 1e9 / rounds / n, t_frag * 1e9 / rounds / frames);
+  printf("decompress: %.0f ns/packet\n", t_unpack * 1e9 / rounds / n);
+
+  printf("%s: %i/%i tests succeeded\n", __FILE__, success, total);
+  return success != total;
+}
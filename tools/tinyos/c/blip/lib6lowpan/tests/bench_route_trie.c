@@ -0,0 +1,280 @@
+/* Test and benchmark for the route_trie longest-prefix match.
+ *
+ * bench_route_trie [lookups]
+ *
+ * Fills a table shaped like a border router's in a 500-node network: a
+ * /128 per node under the mesh /64, a few more /64s, a /48 and a default
+ * route.  Lookups of hosts in the table, missing hosts, addresses under
+ * the other prefixes and random addresses are checked against a linear
+ * scan of the table, with and without the route cache, and again while
+ * routes are deleted and added at random.  Reports ns/lookup for the
+ * linear scan (what IPForwardingEngineP did), the trie and the cache on
+ * a destination stream where most packets go to a few nodes.
+ */
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/time.h>
+
+#include "route_trie.h"
+
+#define N_HOSTS  500
+#define N_ROUTES 600
+#define N_CACHE  8
+#define N_HOT    6
+
+struct route {
+  uint8_t prefix[16];
+  uint8_t prefixlen;
+  uint8_t valid;
+};
+
+static struct route table[N_ROUTES];
+static struct route_trie_node nodes[2 * N_ROUTES];
+static struct route_cache_entry cache[N_CACHE];
+static struct route_trie trie;
+static int total, success;
+
+static double now(void) {
+  struct timeval tv;
+  gettimeofday(&tv, NULL);
+  return tv.tv_sec + tv.tv_usec / 1e6;
+}
+
+static int prefix_match(const uint8_t *a, const uint8_t *b, int bits) {
+  if (bits >= 8 && memcmp(a, b, bits / 8) != 0)
+    return 0;
+  if (bits % 8 == 0)
+    return 1;
+  return ((a[bits / 8] ^ b[bits / 8]) & (0xff << (8 - bits % 8)) & 0xff) == 0;
+}
+
+/* the sorted table scan the trie replaces */
+static uint16_t linear_lookup(const uint8_t *addr, int bits) {
+  int i, best = -1;
+  for (i = 0; i < N_ROUTES; i++) {
+    if (table[i].valid && table[i].prefixlen <= bits &&
+        prefix_match(addr, table[i].prefix, table[i].prefixlen) &&
+        (best < 0 || table[i].prefixlen > table[best].prefixlen))
+      best = i;
+  }
+  return best < 0 ? ROUTE_TRIE_NONE : best;
+}
+
+static uint16_t linear_exact(const uint8_t *prefix, int bits) {
+  int i;
+  for (i = 0; i < N_ROUTES; i++) {
+    if (table[i].valid && table[i].prefixlen == bits &&
+        prefix_match(prefix, table[i].prefix, bits))
+      return i;
+  }
+  return ROUTE_TRIE_NONE;
+}
+
+static void mesh_prefix(uint8_t *a, int subnet) {
+  static const uint8_t p[6] = {0x20, 0x01, 0x0d, 0xb8, 0x00, 0x01};
+  memset(a, 0, 16);
+  memcpy(a, p, 6);
+  a[7] = subnet;
+}
+
+/* a node's address under the mesh /64, from its short address */
+static void host_addr(uint8_t *a, uint16_t saddr) {
+  mesh_prefix(a, 0);
+  a[11] = 0xff;
+  a[12] = 0xfe;
+  a[14] = saddr >> 8;
+  a[15] = saddr;
+}
+
+static void random_addr(uint8_t *a) {
+  int i;
+  switch (rand() % 5) {
+  case 0: host_addr(a, rand() % N_HOSTS); break;
+  case 1: host_addr(a, N_HOSTS + rand() % 100); break;
+  case 2: mesh_prefix(a, rand() % 16); a[15] = rand(); break;
+  case 3: mesh_prefix(a, rand()); a[5] ^= rand() % 2; a[15] = rand(); break;
+  default:
+    for (i = 0; i < 16; i++)
+      a[i] = rand();
+  }
+}
+
+static int add_route(const uint8_t *prefix, int bits) {
+  int i, rc;
+  for (i = 0; i < N_ROUTES; i++)
+    if (!table[i].valid)
+      break;
+  if (i == N_ROUTES)
+    return -1;
+  memset(table[i].prefix, 0, 16);
+  memcpy(table[i].prefix, prefix, (bits + 7) / 8);
+  if (bits % 8)
+    table[i].prefix[bits / 8] &= 0xff << (8 - bits % 8);
+  table[i].prefixlen = bits;
+  rc = route_trie_insert(&trie, i, bits);
+  if (rc == 0)
+    table[i].valid = 1;
+  return rc;
+}
+
+static int check_lookups(int n) {
+  uint8_t a[16];
+  int i, bits;
+  for (i = 0; i < n; i++) {
+    random_addr(a);
+    bits = rand() % 4 ? 128 : rand() % 129;
+    if (route_trie_lookup(&trie, a, bits) != linear_lookup(a, bits) ||
+        route_trie_lookup_cached(&trie, a) != linear_lookup(a, 128) ||
+        route_trie_exact(&trie, a, bits) != linear_exact(a, bits))
+      return 0;
+  }
+  return route_trie_lookup(&trie, NULL, 0) == linear_lookup(NULL, 0);
+}
+
+static void check(const char *what, int ok) {
+  total++;
+  if (ok) {
+    success++;
+    printf("test: success\n");
+  } else {
+    printf("%s: failed\n", what);
+  }
+}
+
+static void fill(void) {
+  uint8_t a[16];
+  int i, ok = 1;
+
+  memset(table, 0, sizeof(table));
+  route_trie_init(&trie, nodes, 2 * N_ROUTES, table[0].prefix,
+                  sizeof(struct route), cache, N_CACHE);
+  memset(a, 0, sizeof(a));
+  ok &= add_route(a, 0) == 0;
+  mesh_prefix(a, 0);
+  ok &= add_route(a, 48) == 0;
+  for (i = 0; i < 8; i++) {
+    mesh_prefix(a, i);
+    ok &= add_route(a, 64) == 0;
+  }
+  for (i = 0; i < N_HOSTS; i++) {
+    host_addr(a, i);
+    ok &= add_route(a, 128) == 0;
+  }
+  /* a second route to the same prefix is refused */
+  host_addr(a, 7);
+  ok &= add_route(a, 128) == -1;
+  check("fill", ok);
+}
+
+static void churn(int ops) {
+  uint8_t a[16];
+  int i, ok = 1, bits;
+
+  for (i = 0; i < ops && ok; i++) {
+    random_addr(a);
+    bits = rand() % 3 ? 128 : (rand() % 2 ? 64 : rand() % 129);
+    if (rand() % 2) {
+      uint16_t want = linear_exact(a, bits);
+      uint16_t got = route_trie_remove(&trie, a, bits);
+      ok &= got == want;
+      if (got != ROUTE_TRIE_NONE)
+        table[got].valid = 0;
+    } else {
+      int had = linear_exact(a, bits) != ROUTE_TRIE_NONE;
+      int rc = add_route(a, bits);
+      /* the pool holds two nodes per route, so it never runs out */
+      ok &= had ? rc == -1 : (rc == 0 || rc == -1);
+    }
+    ok &= check_lookups(8);
+  }
+  check("churn", ok);
+
+  /* empty the table, then it must be usable again */
+  for (i = 0; i < N_ROUTES; i++) {
+    if (table[i].valid) {
+      ok &= route_trie_remove(&trie, table[i].prefix, table[i].prefixlen) == i;
+      table[i].valid = 0;
+    }
+  }
+  memset(a, 0, sizeof(a));
+  ok &= trie.root == ROUTE_TRIE_NONE && route_trie_lookup(&trie, a, 128) ==
+    ROUTE_TRIE_NONE && route_trie_lookup_cached(&trie, a) == ROUTE_TRIE_NONE;
+  check("drain", ok);
+}
+
+/* a full node pool refuses routes and leaves the trie as it was */
+static void exhaust(void) {
+  uint8_t a[16];
+  int i, rc, ok = 1, refused = 0;
+
+  memset(table, 0, sizeof(table));
+  route_trie_init(&trie, nodes, 9, table[0].prefix, sizeof(struct route),
+                  cache, N_CACHE);
+  for (i = 0; i < 64; i++) {
+    random_addr(a);
+    rc = add_route(a, rand() % 2 ? 128 : rand() % 129);
+    refused += rc == -2;
+    ok &= check_lookups(16);
+  }
+  check("exhaust", ok && refused > 0);
+}
+
+int main(int argc, char **argv) {
+  int n = argc > 1 ? atoi(argv[1]) : 1000000;
+  int i, hits = 0;
+  uint8_t (*dst)[16];
+  volatile unsigned sink = 0;
+  double t0, t_linear, t_trie, t_cached;
+
+  srand(1);
+  fill();
+  check("lookups", check_lookups(100000));
+  churn(20000);
+  exhaust();
+  fill();
+
+  /* most traffic goes to a few nodes, the rest anywhere */
+  dst = malloc(4096 * sizeof(*dst));
+  for (i = 0; i < 4096; i++) {
+    if (rand() % 5)
+      host_addr(dst[i], 17 * (rand() % N_HOT));
+    else
+      random_addr(dst[i]);
+  }
+
+  t0 = now();
+  for (i = 0; i < n / 10; i++)
+    sink += linear_lookup(dst[i % 4096], 128);
+  t_linear = (now() - t0) * 10;
+
+  t0 = now();
+  for (i = 0; i < n; i++)
+    sink += route_trie_lookup(&trie, dst[i % 4096], 128);
+  t_trie = now() - t0;
+
+  t0 = now();
+  for (i = 0; i < n; i++)
+    sink += route_trie_lookup_cached(&trie, dst[i % 4096]);
+  t_cached = now() - t0;
+
+  /* a hit is a current cache entry for the destination */
+  for (i = 0; i < 4096; i++) {
+    struct route_cache_entry *e;
+    for (e = cache; e < cache + N_CACHE; e++)
+      if (e->generation == trie.generation && !memcmp(e->dst, dst[i], 16))
+        hits++;
+    route_trie_lookup_cached(&trie, dst[i]);
+  }
+
+  printf("%i routes, %i-entry cache\n", N_HOSTS + 10, N_CACHE);
+  printf("linear: %.1f ns/lookup\n", t_linear * 1e9 / n);
+  printf("trie:   %.1f ns/lookup\n", t_trie * 1e9 / n);
+  printf("cached: %.1f ns/lookup, %.0f%% hits\n", t_cached * 1e9 / n,
+         100.0 * hits / 4096);
+  free(dst);
+
+  printf("%s: %i/%i tests succeeded\n", __FILE__, success, total);
+  return success != total;
+}
@@ -0,0 +1,135 @@
+/* libFuzzer entry point for 6LoWPAN compression and fragmentation.
+ *
+ * The input is read as a frame size, the link-layer address modes, a
+ * 40-byte IPv6 header and the rest of the packet, split into up to
+ * three ip_iovecs.  lowpan_frag_get is called until the packet is sent;
+ * every frame must fit in the frame size and the offsets must advance.
+ * The frames are then reassembled, and a packet with no extension
+ * headers and a consistent UDP length must come back exactly as sent.
+ */
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "Ieee154.h"
+#include "ip.h"
+#include "lib6lowpan.h"
+#include "6lowpan.h"
+#include "iovec.h"
+#include "ip_malloc.h"
+#include "ieee154_header.h"
+
+#define FUZZ_MAX_FRAGS 64
+
+static void fuzz_l2addr(ieee154_addr_t *addr, const uint8_t *in, int mode) {
+  if (mode & 1) {
+    addr->ieee_mode = IEEE154_ADDR_EXT;
+    memcpy(addr->i_laddr.data, in, 8);
+  } else {
+    addr->ieee_mode = IEEE154_ADDR_SHORT;
+    memcpy(&addr->i_saddr, in, 2);
+  }
+}
+
+int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size) {
+  static uint8_t frames[FUZZ_MAX_FRAGS][IEEE154_LINK_MTU];
+  static int frame_lens[FUZZ_MAX_FRAGS];
+  struct ieee154_frame_addr frame;
+  struct ip6_packet packet;
+  struct lowpan_ctx ctx;
+  struct lowpan_reconstruct recon;
+  struct ip_iovec v[3];
+  uint8_t *payload, *flat;
+  size_t plen, cut[2];
+  int frame_len, n = 0, rv, i, exact;
+  uint16_t last_offset = 0;
+
+  if (size < 2 + 16 + sizeof(struct ip6_hdr))
+    return 0;
+  frame_len = 40 + data[0] % (IEEE154_LINK_MTU - 40 + 1);
+  memset(&frame, 0, sizeof(frame));
+  fuzz_l2addr(&frame.ieee_src, data + 2, data[1]);
+  fuzz_l2addr(&frame.ieee_dst, data + 10, data[1] >> 1);
+  memcpy(&frame.ieee_dstpan, data + 2, 2);
+  data += 18; size -= 18;
+
+  memset(&packet, 0, sizeof(packet));
+  memcpy(&packet.ip6_hdr, data, sizeof(struct ip6_hdr));
+  data += sizeof(struct ip6_hdr); size -= sizeof(struct ip6_hdr);
+  packet.ip6_hdr.ip6_vfc = (packet.ip6_hdr.ip6_vfc & 0x0f) | IPV6_VERSION;
+  plen = size > 1280 ? 1280 : size;
+  packet.ip6_hdr.ip6_plen = htons(plen);
+
+  /* each piece is its own allocation, for the sanitizers */
+  payload = malloc(plen ? plen : 1);
+  memcpy(payload, data, plen);
+  cut[0] = plen ? data[0] % (plen + 1) : 0;
+  cut[1] = plen ? cut[0] + data[plen - 1] % (plen - cut[0] + 1) : 0;
+  v[0].iov_base = payload;
+  v[0].iov_len = cut[0];
+  v[0].iov_next = &v[1];
+  v[1].iov_base = payload + cut[0];
+  v[1].iov_len = cut[1] - cut[0];
+  v[1].iov_next = &v[2];
+  v[2].iov_base = payload + cut[1];
+  v[2].iov_len = plen - cut[1];
+  v[2].iov_next = NULL;
+  packet.ip6_data = v;
+
+  ctx.tag = 0x1234;
+  ctx.offset = 0;
+  while (n < FUZZ_MAX_FRAGS &&
+         (rv = lowpan_frag_get(frames[n], frame_len, &packet, &frame,
+                               &ctx)) > 0) {
+    if (rv > frame_len || (n > 0 && ctx.offset <= last_offset))
+      abort();
+    last_offset = ctx.offset;
+    frame_lens[n++] = rv;
+  }
+  if (n == 0 || n == FUZZ_MAX_FRAGS) {
+    free(payload);
+    return 0;
+  }
+
+  /* reassemble what was sent */
+  ip_malloc_init();
+  for (i = 0; i < n; i++) {
+    struct ieee154_frame_addr fr;
+    uint8_t *buf = frames[i];
+    size_t len = frame_lens[i];
+
+    if (unpack_ieee154_hdr(&buf, &len, &fr) < 0)
+      abort();
+    rv = i == 0 ? lowpan_recon_start(&fr, &recon, buf, len) :
+      lowpan_recon_add(&recon, buf, len);
+    if (rv < 0)
+      break;
+  }
+  if (i == 0) {
+    free(payload);
+    return 0;
+  }
+
+  exact = packet.ip6_hdr.ip6_nxt != IPV6_HOP &&
+    packet.ip6_hdr.ip6_nxt != IPV6_ROUTING &&
+    packet.ip6_hdr.ip6_nxt != IPV6_FRAG &&
+    packet.ip6_hdr.ip6_nxt != IPV6_DEST &&
+    packet.ip6_hdr.ip6_nxt != IPV6_MOBILITY &&
+    packet.ip6_hdr.ip6_nxt != IPV6_IPV6 &&
+    (packet.ip6_hdr.ip6_nxt != IANA_UDP ||
+     (plen >= sizeof(struct udp_hdr) &&
+      ntohs(((struct udp_hdr *)payload)->len) == plen));
+  if (i == n && exact) {
+    flat = malloc(sizeof(struct ip6_hdr) + plen);
+    memcpy(flat, &packet.ip6_hdr, sizeof(struct ip6_hdr));
+    memcpy(flat + sizeof(struct ip6_hdr), payload, plen);
+    if (recon.r_bytes_rcvd != recon.r_size ||
+        recon.r_size != sizeof(struct ip6_hdr) + plen ||
+        memcmp(recon.r_buf, flat, recon.r_size) != 0)
+      abort();
+    free(flat);
+  }
+  ip_free(recon.r_buf);
+  free(payload);
+  return 0;
+}
@@ -0,0 +1,77 @@
+/* libFuzzer entry point for 6LoWPAN decompression and reassembly.
+ *
+ * The input is a list of 802.15.4 frames, each preceded by its length
+ * in one byte.  The first frame goes to lowpan_recon_start and the rest
+ * to lowpan_recon_add, and all of them also go through a
+ * lowpan_recon_table.  Each frame is copied to a buffer of exactly its
+ * length so the sanitizers see any overread.  Aborts if a complete
+ * datagram is inconsistent or ip_malloc memory is leaked.
+ */
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "Ieee154.h"
+#include "ip.h"
+#include "lib6lowpan.h"
+#include "6lowpan.h"
+#include "ip_malloc.h"
+#include "ieee154_header.h"
+
+#define FUZZ_SLOTS 4
+
+static void check_complete(struct lowpan_reconstruct *recon) {
+  if (recon->r_bytes_rcvd != recon->r_size ||
+      recon->r_size < sizeof(struct ip6_hdr) ||
+      ntohs(((struct ip6_hdr *)recon->r_buf)->ip6_plen) !=
+      recon->r_size - sizeof(struct ip6_hdr))
+    abort();
+}
+
+int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size) {
+  static struct lowpan_reconstruct slots[FUZZ_SLOTS];
+  struct lowpan_recon_table table;
+  struct lowpan_reconstruct recon, *done;
+  int started = 0, i;
+
+  ip_malloc_init();
+  lowpan_recon_init(&table, slots, FUZZ_SLOTS, 0);
+
+  while (size > 0) {
+    struct ieee154_frame_addr fr;
+    size_t len = data[0], flen;
+    uint8_t *frame, *buf;
+
+    data++; size--;
+    if (len > size) len = size;
+    frame = malloc(len ? len : 1);
+    memcpy(frame, data, len);
+    data += len; size -= len;
+
+    buf = frame;
+    flen = len;
+    if (unpack_ieee154_hdr(&buf, &flen, &fr) >= 0) {
+      if (!started) {
+        started = lowpan_recon_start(&fr, &recon, buf, flen) == 0;
+        if (started && recon.r_bytes_rcvd == recon.r_size)
+          check_complete(&recon);
+      } else {
+        lowpan_recon_add(&recon, buf, flen);
+      }
+      if (lowpan_recon_input(&table, &fr, buf, flen, &done) > 0) {
+        check_complete(done);
+        lowpan_recon_release(&table, done);
+      }
+    }
+    free(frame);
+  }
+
+  if (started)
+    ip_free(recon.r_buf);
+  for (i = 0; i < 3; i++)
+    lowpan_recon_age(&table);
+  if (table.n_used != 0 || table.mem_used != 0 ||
+      ip_malloc_freespace() != IP_MALLOC_HEAP_SIZE)
+    abort();
+  return 0;
+}
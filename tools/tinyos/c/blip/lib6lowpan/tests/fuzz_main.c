@@ -0,0 +1,66 @@
+/* Runs a libFuzzer entry point without libFuzzer.
+ *
+ * fuzz_target [file ...]
+ *
+ * With files (a crash reproducer, or a corpus), runs each of them once.
+ * With none, runs a fixed number of random inputs, a few of which are
+ * made of 802.15.4 frames so they get past the header parsing.
+ */
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#define RANDOM_RUNS 20000
+
+int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size);
+
+static size_t random_input(uint8_t *buf, size_t room) {
+  size_t len = 0;
+
+  while (len + 1 + 127 < room && rand() % 4) {
+    size_t n = rand() % 128, i;
+    buf[len++] = n;
+    /* data frame, PAN ID compression, short or long addresses */
+    for (i = 0; i < n; i++)
+      buf[len + i] = rand() % 3 ? rand() : (i == 1 ? 0x41 : 0x88 + i % 3);
+    if (n > 24 && rand() % 2) {
+      static const uint8_t dispatch[] = {0x60, 0x78, 0x7b, 0xc0, 0xe0, 0x41};
+      int hdr = rand() % 2 ? 9 : 21;
+      buf[len] = 0x41;
+      buf[len + 1] = hdr == 9 ? 0x88 : 0xcc;
+      buf[len + hdr] = (buf[len + hdr] & 0x1f) | dispatch[rand() % 6];
+    }
+    len += n;
+  }
+  return len;
+}
+
+int main(int argc, char **argv) {
+  static uint8_t buf[1 << 16];
+  int i, runs = 0;
+
+  if (argc > 1) {
+    for (i = 1; i < argc; i++) {
+      FILE *fp = fopen(argv[i], "rb");
+      size_t len;
+      if (!fp) {
+        perror(argv[i]);
+        return 1;
+      }
+      len = fread(buf, 1, sizeof(buf), fp);
+      fclose(fp);
+      LLVMFuzzerTestOneInput(buf, len);
+      runs++;
+    }
+  } else {
+    srand(1);
+    for (i = 0; i < RANDOM_RUNS; i++) {
+      size_t len = random_input(buf, sizeof(buf));
+      LLVMFuzzerTestOneInput(buf, len);
+      runs++;
+    }
+  }
+  printf("test: success\n");
+  printf("%s: %i/%i tests succeeded\n", argv[0], runs, runs);
+  return 0;
+}
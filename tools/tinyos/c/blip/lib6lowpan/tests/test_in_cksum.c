@@ -0,0 +1,122 @@
+/* Property test and benchmark for in_cksum.
+ *
+ * test_in_cksum [chains] [megabytes]
+ *
+ * Checksums random ip_iovec chains (odd and even pieces, empty pieces,
+ * unaligned bases, runs of 0x00 and 0xff) and checks each result
+ * against a byte-at-a-time sum of the flattened message.  Then reports
+ * the throughput of both over full-MTU packets in three pieces.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/time.h>
+
+#include "in_cksum.h"
+
+#define PIECES 8
+
+static double now(void) {
+  struct timeval tv;
+  gettimeofday(&tv, NULL);
+  return tv.tv_sec + tv.tv_usec / 1e6;
+}
+
+/* RFC 1071 over one flat buffer, one byte at a time */
+static uint16_t reference_cksum(const uint8_t *buf, int len) {
+  uint32_t sum = 0;
+  int i;
+
+  for (i = 0; i < len; i++)
+    sum += (i % 2 == 0) ? (uint32_t)buf[i] << 8 : buf[i];
+  while (sum > 0xffff)
+    sum = (sum & 0xffff) + (sum >> 16);
+  return ~sum & 0xffff;
+}
+
+static void fill(uint8_t *buf, int len) {
+  int i, mode = rand() % 4;
+
+  for (i = 0; i < len; i++)
+    buf[i] = mode == 0 ? 0xff : mode == 1 && rand() % 2 ? 0 : rand();
+}
+
+/* Returns: 1 if in_cksum agrees with the reference on a random chain */
+static int check_chain(void) {
+  static uint8_t store[PIECES][2048 + 8];
+  uint8_t flat[PIECES * 2048];
+  struct ip_iovec v[PIECES];
+  int n = rand() % PIECES + 1, i, len = 0;
+  uint16_t got, want;
+
+  for (i = 0; i < n; i++) {
+    int piece = rand() % 4 == 0 ? rand() % 2048 : rand() % 64;
+    v[i].iov_base = store[i] + rand() % 8;
+    v[i].iov_len = piece;
+    v[i].iov_next = i + 1 < n ? &v[i + 1] : NULL;
+    fill(v[i].iov_base, piece);
+    memcpy(flat + len, v[i].iov_base, piece);
+    len += piece;
+  }
+  got = in_cksum(v);
+  want = reference_cksum(flat, len);
+  if (got != want) {
+    printf("in_cksum: 0x%04x, expected 0x%04x; pieces:", got, want);
+    for (i = 0; i < n; i++)
+      printf(" %i", (int)v[i].iov_len);
+    printf("\n");
+    return 0;
+  }
+  return 1;
+}
+
+static void throughput(int megabytes) {
+  static uint8_t pkt[1280];
+  struct ip_iovec v[3];
+  long n, count = (long)megabytes * 1000000 / sizeof(pkt);
+  double t0, t_ref, t_new;
+  volatile uint16_t sink = 0;
+
+  fill(pkt, sizeof(pkt));
+  v[0].iov_base = pkt;
+  v[0].iov_len = 40;
+  v[0].iov_next = &v[1];
+  v[1].iov_base = pkt + 40;
+  v[1].iov_len = 7;
+  v[1].iov_next = &v[2];
+  v[2].iov_base = pkt + 47;
+  v[2].iov_len = sizeof(pkt) - 47;
+  v[2].iov_next = NULL;
+
+  t0 = now();
+  for (n = 0; n < count; n++)
+    sink += reference_cksum(pkt, sizeof(pkt));
+  t_ref = now() - t0;
+  t0 = now();
+  for (n = 0; n < count; n++)
+    sink += in_cksum(v);
+  t_new = now() - t0;
+  printf("byte at a time: %.1f MB/s\n", count * sizeof(pkt) / t_ref / 1e6);
+  printf("in_cksum: %.1f MB/s\n", count * sizeof(pkt) / t_new / 1e6);
+}
+
+int main(int argc, char **argv) {
+  int chains = argc > 1 ? atoi(argv[1]) : 100000;
+  int megabytes = argc > 2 ? atoi(argv[2]) : 200;
+  int i, success = 0, total = 0;
+
+  srand(1);
+  for (i = 0; i < chains; i++) {
+    total++;
+    if (check_chain())
+      success++;
+    else if (total - success >= 10)
+      break;
+  }
+  if (success == total)
+    printf("test: success\n");
+  throughput(megabytes);
+
+  printf("%s: %i/%i tests succeeded\n", __FILE__, success, total);
+  return success != total;
+}
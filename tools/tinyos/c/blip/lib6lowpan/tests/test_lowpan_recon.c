@@ -0,0 +1,271 @@
+/* Tests for the 6LoWPAN reassembly table.
+ *
+ * Fragments packets from several senders with lowpan_frag_get, then
+ * feeds the fragments of all of them to lowpan_recon_input interleaved,
+ * shuffled and with duplicates, and checks every packet comes out
+ * once and intact.  Also checks that FRAGN before FRAG1 works, that
+ * partial packets time out, that the memory budget is kept, that a
+ * stray FRAGN does not block the next packet and that the table
+ * survives more senders than it has slots.
+ */
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "Ieee154.h"
+#include "ip.h"
+#include "lib6lowpan.h"
+#include "nwbyte.h"
+#include "6lowpan.h"
+#include "iovec.h"
+#include "ip_malloc.h"
+#include "ieee154_header.h"
+
+#define MAX_FRAGS 16
+#define MAX_PKTS  8
+
+struct frag {
+  uint8_t buf[128];
+  int len;
+};
+
+struct test_pkt {
+  uint8_t  expected[1280];
+  int      len;
+  struct frag frags[MAX_FRAGS];
+  int      n_frags;
+  int      delivered;
+};
+
+static struct test_pkt pkts[MAX_PKTS];
+static struct lowpan_reconstruct slots[MAX_PKTS];
+static struct lowpan_recon_table table;
+
+/* Effects: builds the fragments of an ICMP packet of plen payload
+     bytes from short address src */
+static void make_packet(struct test_pkt *t, uint16_t src, uint16_t tag,
+                        int plen) {
+  struct ip6_packet packet;
+  struct ieee154_frame_addr fr;
+  struct lowpan_ctx ctx;
+  struct ip_iovec v;
+  uint8_t payload[1280];
+  int i, rv;
+
+  for (i = 0; i < plen; i++)
+    payload[i] = rand();
+  v.iov_base = payload;
+  v.iov_len = plen;
+  v.iov_next = NULL;
+
+  memset(&packet, 0, sizeof(packet));
+  packet.ip6_data = &v;
+  packet.ip6_hdr.ip6_flow = htonl(0x6 << 28);
+  packet.ip6_hdr.ip6_nxt = IANA_ICMP;
+  packet.ip6_hdr.ip6_plen = htons(plen);
+  packet.ip6_hdr.ip6_hlim = 64;
+  inet_pton6("fe80::ff:fe00:1", &packet.ip6_hdr.ip6_src);
+  inet_pton6("fe80::ff:fe00:2", &packet.ip6_hdr.ip6_dst);
+  packet.ip6_hdr.ip6_src.s6_addr[14] = src >> 8;
+  packet.ip6_hdr.ip6_src.s6_addr[15] = src;
+
+  memset(&fr, 0, sizeof(fr));
+  fr.ieee_src.ieee_mode = IEEE154_ADDR_SHORT;
+  fr.ieee_src.i_saddr = htole16(src);
+  fr.ieee_dst.ieee_mode = IEEE154_ADDR_SHORT;
+  fr.ieee_dst.i_saddr = htole16(2);
+  fr.ieee_dstpan = htole16(0x22);
+
+  memcpy(t->expected, &packet.ip6_hdr, sizeof(struct ip6_hdr));
+  memcpy(t->expected + sizeof(struct ip6_hdr), payload, plen);
+  t->len = sizeof(struct ip6_hdr) + plen;
+  t->n_frags = 0;
+  t->delivered = 0;
+
+  ctx.offset = 0;
+  ctx.tag = tag;
+  while (t->n_frags < MAX_FRAGS &&
+         (rv = lowpan_frag_get(t->frags[t->n_frags].buf, 100, &packet, &fr,
+                               &ctx)) > 0) {
+    t->frags[t->n_frags].len = rv;
+    t->n_frags++;
+  }
+}
+
+/* Returns: what lowpan_recon_input returned for fragment f of t, after
+     delivering and releasing a completed packet */
+static int feed(struct test_pkt *t, int f) {
+  struct ieee154_frame_addr fr;
+  struct lowpan_reconstruct *recon;
+  uint8_t copy[128], *buf = copy;
+  size_t len = t->frags[f].len;
+  int rv, i;
+
+  memcpy(copy, t->frags[f].buf, len);
+  if (unpack_ieee154_hdr(&buf, &len, &fr) < 0)
+    return -100;
+  rv = lowpan_recon_input(&table, &fr, buf, len, &recon);
+  if (rv > 0) {
+    for (i = 0; i < MAX_PKTS; i++) {
+      if (recon->r_size == pkts[i].len &&
+          memcmp(recon->r_buf, pkts[i].expected, pkts[i].len) == 0) {
+        pkts[i].delivered++;
+        break;
+      }
+    }
+    if (i == MAX_PKTS)
+      printf("delivered a packet that was never sent\n");
+    lowpan_recon_release(&table, recon);
+  }
+  return rv;
+}
+
+static int check(int ok, const char *what) {
+  printf("%s: %s\n", what, ok ? "test: success" : "FAILED");
+  return ok;
+}
+
+/* all fragments of n packets, shuffled, each maybe twice.  A packet
+   whose every fragment came twice may rightly be delivered twice. */
+static int test_interleaved(int n) {
+  int order[MAX_PKTS * MAX_FRAGS * 2][2], count = 0, i, j, ok = 1;
+  int dups[MAX_PKTS];
+
+  lowpan_recon_init(&table, slots, MAX_PKTS, 0);
+  for (i = 0; i < n; i++) {
+    make_packet(&pkts[i], 0x10 + i, 7 + i % 2, 120 + rand() % 180);
+    dups[i] = 0;
+    for (j = 0; j < pkts[i].n_frags; j++) {
+      order[count][0] = i;
+      order[count++][1] = j;
+      if (rand() % 3 == 0) {
+        order[count][0] = i;
+        order[count++][1] = j;
+        dups[i]++;
+      }
+    }
+  }
+  for (i = count - 1; i > 0; i--) {
+    int k = rand() % (i + 1), a = order[i][0], b = order[i][1];
+    order[i][0] = order[k][0];
+    order[i][1] = order[k][1];
+    order[k][0] = a;
+    order[k][1] = b;
+  }
+  for (i = 0; i < count; i++)
+    feed(&pkts[order[i][0]], order[i][1]);
+  // duplicates after delivery look like new packets until they time out
+  lowpan_recon_age(&table);
+  lowpan_recon_age(&table);
+  for (i = 0; i < n; i++)
+    ok = ok && pkts[i].n_frags > 1 && pkts[i].delivered >= 1 &&
+      (pkts[i].delivered == 1 || dups[i] == pkts[i].n_frags);
+  return ok && table.n_used == 0 && table.mem_used == 0 &&
+    ip_malloc_freespace() == IP_MALLOC_HEAP_SIZE;
+}
+
+static int test_timeout(void) {
+  int ok;
+
+  lowpan_recon_init(&table, slots, MAX_PKTS, 0);
+  make_packet(&pkts[0], 0x30, 1, 200);
+  ok = feed(&pkts[0], 1) == 0 && table.n_used == 1;
+  lowpan_recon_age(&table);
+  ok = ok && feed(&pkts[0], 0) == 0 && table.n_used == 1;
+  lowpan_recon_age(&table);
+  lowpan_recon_age(&table);
+  ok = ok && table.n_used == 0 && table.mem_used == 0 &&
+    ip_malloc_freespace() == IP_MALLOC_HEAP_SIZE;
+  return ok;
+}
+
+static int test_budget(void) {
+  int ok, i;
+
+  make_packet(&pkts[0], 0x40, 1, 200);
+  make_packet(&pkts[1], 0x41, 1, 200);
+  pkts[2] = pkts[1];
+  lowpan_recon_init(&table, slots, MAX_PKTS, 300);
+  ok = feed(&pkts[0], 0) == 0;
+  // no room for a second packet, and its later fragments are dropped
+  ok = ok && feed(&pkts[1], 0) < 0 && feed(&pkts[1], 1) < 0;
+  for (i = 1; i < pkts[0].n_frags; i++)
+    feed(&pkts[0], i);
+  ok = ok && pkts[0].delivered == 1 && table.mem_used == 0;
+  // once the first packet is stale, it makes way for a new one
+  lowpan_recon_age(&table);
+  lowpan_recon_age(&table);
+  ok = ok && feed(&pkts[0], 0) == 0;
+  lowpan_recon_age(&table);
+  ok = ok && feed(&pkts[1], 0) == 0 && table.mem_used <= 300;
+  lowpan_recon_age(&table);
+  lowpan_recon_age(&table);
+  return ok && table.n_used == 0 &&
+    ip_malloc_freespace() == IP_MALLOC_HEAP_SIZE;
+}
+
+/* a stray FRAGN, e.g. a late duplicate of a delivered packet, does not
+   keep the next packet out of a tight budget */
+static int test_stray(void) {
+  int ok, i;
+
+  make_packet(&pkts[0], 0x50, 1, 200);
+  make_packet(&pkts[1], 0x51, 1, 200);
+  lowpan_recon_init(&table, slots, MAX_PKTS, 300);
+  ok = feed(&pkts[1], 1) == 0 && table.n_used == 1;
+  for (i = 0; i < pkts[0].n_frags; i++)
+    feed(&pkts[0], i);
+  ok = ok && pkts[0].delivered == 1 && table.n_used == 0;
+  // FRAGN before FRAG1 of the same packet still works
+  for (i = pkts[1].n_frags - 1; i >= 0; i--)
+    feed(&pkts[1], i);
+  ok = ok && pkts[1].delivered == 1;
+  return ok && table.n_used == 0 && table.mem_used == 0 &&
+    ip_malloc_freespace() == IP_MALLOC_HEAP_SIZE;
+}
+
+/* many senders through few slots: every complete packet is right */
+static int test_churn(void) {
+  int i, f, ok = 1;
+
+  lowpan_recon_init(&table, slots, 4, 0);
+  for (i = 0; i < 2000 && ok; i++) {
+    struct test_pkt *t = &pkts[i % MAX_PKTS];
+    if (i % 50 == 0)
+      lowpan_recon_age(&table);
+    make_packet(t, rand() % 300, rand(), 120 + rand() % 60);
+    for (f = 0; f < t->n_frags; f++)
+      if (rand() % 8)
+        feed(t, f);
+    ok = table.n_used <= 4;
+  }
+  lowpan_recon_age(&table);
+  lowpan_recon_age(&table);
+  return ok && table.n_used == 0 &&
+    ip_malloc_freespace() == IP_MALLOC_HEAP_SIZE;
+}
+
+int main() {
+  int success = 0, total = 0, i;
+
+  ip_malloc_init();
+  srand(1);
+  for (i = 0; i < 200; i++) {
+    total++;
+    if (!test_interleaved(1 + i % 4)) {
+      printf("interleaved %i: FAILED\n", i);
+      break;
+    }
+    success++;
+  }
+  if (i == 200)
+    printf("interleaved: test: success\n");
+  total++; success += check(test_timeout(), "timeout");
+  total++; success += check(test_budget(), "budget");
+  total++; success += check(test_stray(), "stray");
+  total++; success += check(test_churn(), "churn");
+
+  printf("%s: %i/%i tests succeeded\n", __FILE__, success, total);
+  return success != total;
+}
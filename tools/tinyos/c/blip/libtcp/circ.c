@@ -45,6 +45,11 @@ int circ_buf_init(void *data, int len, uint32_t seqno) {
   return 0;
 }
 
+int circ_get_window(void *buf) {
+  struct circ_buf *b = (struct circ_buf *)buf;
+  return b->data_len;
+}
+
 uint32_t circ_get_seqno(void *buf) {
   struct circ_buf *b = (struct circ_buf *)buf;
   return b->head_seqno;
@@ -109,6 +114,18 @@ int circ_buf_read(void *buf, uint32_t sseqno,
   return rc;
 }
 
+int circ_buf_map(void *buf, uint32_t sseqno, int len,
+                 uint8_t *data[2], int data_len[2]) {
+  struct circ_buf *b = (struct circ_buf *)buf;
+
+  get_ptr_off_1(b, sseqno, len, &data[0], &data_len[0]);
+  data[1] = b->data_start;
+  data_len[1] = 0;
+  if (data_len[0] != len)
+    data_len[1] = min(len - data_len[0], b->data_head - b->data_start);
+  return data_len[0] + data_len[1];
+}
+
 int circ_buf_write(char *buf, uint32_t sseqno,
                    uint8_t *data, int len) {
   struct circ_buf *b = (struct circ_buf *)buf;
@@ -35,6 +35,13 @@ int circ_buf_read(void *buf, uint32_t sseqno,
                   uint8_t *data, int len);
 
 
+/* point data at the bytes from sseqno in place, rather than copying
+   them out: data[1] holds whatever wraps around the end of the buffer,
+   and is empty otherwise.  returns the number of bytes mapped. */
+int circ_buf_map(void *buf, uint32_t sseqno, int len,
+                 uint8_t *data[2], int data_len[2]);
+
+
 int circ_shorten_head(void *buf, uint32_t seqno);
 
 /* read from the head of the buffer, moving the data pointer forward */
@@ -42,6 +49,9 @@ int circ_shorten_head(void *buf, uint32_t seqno);
 
 void circ_buf_dump(void *buf);
 
+/* how many bytes the buffer holds */
+int circ_get_window(void *buf);
+
 uint32_t circ_get_seqno(void *buf);
 void circ_set_seqno(void *buf, uint32_t seqno);
 
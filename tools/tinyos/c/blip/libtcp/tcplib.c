@@ -30,7 +30,6 @@
 
 #include <stdio.h>
 #include <string.h>
-#include "lib6lowpan/ip_malloc.h"
 #include "lib6lowpan/in_cksum.h"
 #include "lib6lowpan/6lowpan.h"
 #include "lib6lowpan/ip.h"
@@ -39,9 +38,20 @@
 #include "libtcp/circ.h"
 
 static struct tcplib_sock *conns = NULL;
+/* connected sockets, by remote endpoint */
+static struct tcplib_sock *conn_table[TCPLIB_HASH_SZ];
 
 #define ONE_SEGMENT(X)  ((X)->mss)
 
+/* TCP option kinds */
+enum {
+  TCPOPT_EOL = 0,
+  TCPOPT_NOP = 1,
+  TCPOPT_MSS = 2,
+  TCPOPT_SACK_PERMITTED = 4,
+  TCPOPT_SACK = 5,
+};
+
 #ifdef PC
 uint16_t alloc_local_port() {
   return (time(NULL) & 0xffff) | 0x8000;
@@ -93,25 +103,81 @@ void print_headers(struct ip6_hdr *iph, struct tcp_hdr *tcph) {
   printf(" remote ep: %s port: %u\n", addr_buf, ntohs(tcph->dstport));
   printf(" tcp seqno: %u ackno: %u\n", ntohl(tcph->seqno), ntohl(tcph->ackno));
 }
-#else 
+#endif
+
+/* tracing is compiled in on the PC with TCPLIB_DEBUG, and never on
+   motes: it is on the path of every segment. */
+#if !defined(PC) || !defined(TCPLIB_DEBUG)
 #undef printf
 #define printf(FMT, args ...) ;
 #endif
 
+/* the local address may be unspecified, so only the remote endpoint
+   is hashed */
+static int conn_hash_key(struct in6_addr *raddr, uint16_t rport) {
+  uint16_t h = rport;
+  int i;
+  for (i = 0; i < 8; i++)
+    h ^= raddr->s6_addr16[i];
+  h ^= h >> 8;
+  return h & (TCPLIB_HASH_SZ - 1);
+}
+
+static void conn_hash_del(struct tcplib_sock *sock) {
+  struct tcplib_sock **p =
+    &conn_table[conn_hash_key(&sock->r_ep.sin6_addr, sock->r_ep.sin6_port)];
+  for (; *p != NULL; p = &(*p)->hash_next) {
+    if (*p == sock) {
+      *p = sock->hash_next;
+      break;
+    }
+  }
+}
+
+/* sockets with no remote endpoint are found through conns */
+static void conn_hash_add(struct tcplib_sock *sock) {
+  struct tcplib_sock **p;
+  if (sock->r_ep.sin6_port == 0)
+    return;
+  p = &conn_table[conn_hash_key(&sock->r_ep.sin6_addr, sock->r_ep.sin6_port)];
+  sock->hash_next = *p;
+  *p = sock;
+}
+
+/* r_ep may only change with the socket out of conn_table */
+static void conn_set_remote(struct tcplib_sock *sock,
+                            struct in6_addr *addr, uint16_t port) {
+  conn_hash_del(sock);
+  if (addr != NULL)
+    memcpy(&sock->r_ep.sin6_addr, addr, 16);
+  else
+    memset(&sock->r_ep.sin6_addr, 0, 16);
+  sock->r_ep.sin6_port = port;
+  conn_hash_add(sock);
+}
+
+static int conn_local_match(struct tcplib_sock *sock, struct ip6_hdr *iph,
+                            struct tcp_hdr *tcph) {
+  return tcph->dstport == sock->l_ep.sin6_port &&
+    (isInaddrAny(&sock->l_ep.sin6_addr) ||
+     memcmp(iph->ip6_dst.s6_addr, sock->l_ep.sin6_addr.s6_addr, 16) == 0);
+}
+
 static struct tcplib_sock *conn_lookup(struct ip6_hdr *iph, 
                                        struct tcp_hdr *tcph) {
   struct tcplib_sock *iter;
-  //printf("looking up conns: %p %p\n", iph, tcph);
-  // print_headers(iph, tcph);
+
+  for (iter = conn_table[conn_hash_key(&iph->ip6_src, tcph->srcport)];
+       iter != NULL; iter = iter->hash_next) {
+    if (tcph->srcport == iter->r_ep.sin6_port &&
+        memcmp(&iph->ip6_src, &iter->r_ep.sin6_addr, 16) == 0 &&
+        conn_local_match(iter, iph, tcph))
+      return iter;
+  }
+
+  /* no connection: a socket listening on the port */
   for (iter = conns; iter != NULL; iter = iter->next) {
-    // print_conn(iter);
-    printf("conn lport: %i\n", ntohs(iter->l_ep.sin6_port));
-    if (((memcmp(iph->ip6_dst.s6_addr, iter->l_ep.sin6_addr.s6_addr, 16) == 0) ||
-         isInaddrAny(&iter->l_ep.sin6_addr)) &&
-        tcph->dstport == iter->l_ep.sin6_port &&
-        (iter->r_ep.sin6_port == 0 ||
-         (memcmp(&iph->ip6_src, &iter->r_ep.sin6_addr, 16) == 0 &&
-          tcph->srcport == iter->r_ep.sin6_port)))
+    if (iter->r_ep.sin6_port == 0 && conn_local_match(iter, iph, tcph))
       return iter;
   }
   return NULL;
@@ -134,24 +200,48 @@ struct tcp_hdr *find_tcp_hdr(struct ip6_packet *msg) {
   return NULL;
 }
 
-static struct ip6_packet *get_ipmsg(int plen) {
-  int alen = sizeof(struct ip6_packet) + sizeof(struct tcp_hdr) + 
-    sizeof(struct ip_iovec) + plen;
-  char *buf = ip_malloc(alen);
-  struct ip6_packet *msg = (struct ip6_packet *)buf;
-  struct ip_iovec *iov = (struct ip_iovec *)(buf + alen - sizeof(struct ip_iovec));
-
-  if (buf == NULL) return NULL;
-  memset(msg, 0, sizeof(struct ip6_packet) + sizeof(struct tcp_hdr));
-  msg->ip6_hdr.ip6_nxt = IANA_TCP;
-  msg->ip6_hdr.ip6_plen = htons(sizeof(struct tcp_hdr) + plen);
-
-  msg->ip6_data = iov;
-  iov->iov_next = NULL;
-  iov->iov_len = plen + sizeof(struct tcp_hdr);
-  iov->iov_base = (void *)(msg + 1);
+/* segments are built on the stack: the header, followed by the
+   payload where it sits in the transmit buffer, in two pieces if it
+   wraps.  tcplib_send_out must be done with them when it returns. */
+struct tcplib_segment {
+  struct ip6_packet pkt;
+  struct ip_iovec v[3];
+  struct tcp_hdr tcph;
+  uint8_t opt[8];
+};
+
+static struct tcp_hdr *init_segment(struct tcplib_segment *seg,
+                                    uint8_t *data[2], int data_len[2]) {
+  struct ip_iovec *last = &seg->v[0];
+  int i, plen = sizeof(struct tcp_hdr);
+
+  memset(&seg->pkt, 0, sizeof(struct ip6_packet));
+  memset(&seg->tcph, 0, sizeof(struct tcp_hdr));
+  seg->pkt.ip6_hdr.ip6_nxt = IANA_TCP;
+  seg->pkt.ip6_data = &seg->v[0];
+  seg->v[0].iov_base = (uint8_t *)&seg->tcph;
+  seg->v[0].iov_len = sizeof(struct tcp_hdr);
+  seg->v[0].iov_next = NULL;
+
+  for (i = 0; data != NULL && i < 2; i++) {
+    if (data_len[i] == 0) continue;
+    last->iov_next = &seg->v[i + 1];
+    last = last->iov_next;
+    last->iov_base = data[i];
+    last->iov_len = data_len[i];
+    last->iov_next = NULL;
+    plen += data_len[i];
+  }
+  seg->pkt.ip6_hdr.ip6_plen = htons(plen);
+  return &seg->tcph;
+}
 
-  return msg;
+/* options go right after the header, in the same iovec */
+static void segment_add_options(struct tcplib_segment *seg,
+                                const uint8_t *opt, int len) {
+  memcpy(seg->opt + seg->v[0].iov_len - sizeof(struct tcp_hdr), opt, len);
+  seg->v[0].iov_len += len;
+  seg->pkt.ip6_hdr.ip6_plen = htons(ntohs(seg->pkt.ip6_hdr.ip6_plen) + len);
 }
 
 static void __tcplib_send(struct tcplib_sock *sock,
@@ -168,7 +258,7 @@ static void __tcplib_send(struct tcplib_sock *sock,
 
   tcph->srcport = sock->l_ep.sin6_port;
   tcph->dstport = sock->r_ep.sin6_port;
-  tcph->offset = sizeof(struct tcp_hdr) * 4;
+  tcph->offset = msg->ip6_data->iov_len * 4;
   tcph->window = htons(sock->my_wind);
   tcph->chksum = 0;
   tcph->urgent = 0;
@@ -177,95 +267,279 @@ static void __tcplib_send(struct tcplib_sock *sock,
 }
 
 static void tcplib_send_ack(struct tcplib_sock *sock, int fin_seqno, uint8_t flags) {
-  struct ip6_packet *msg = get_ipmsg(0);
-  printf("sending ACK\n");
-      
-  if (msg != NULL) {
-    struct tcp_hdr *tcp_rep = (struct tcp_hdr *)(msg + 1);
-    tcp_rep->flags = flags;
+  struct tcplib_segment seg;
+  struct tcp_hdr *tcp_rep = init_segment(&seg, NULL, NULL);
+
+  tcp_rep->flags = flags;
+  /* SYNs and FINs come after everything in the buffer; a bare ACK
+     must not claim data that hasn't been sent */
+  tcp_rep->seqno = htonl((flags & (TCP_FLAG_SYN | TCP_FLAG_FIN)) ?
+                         sock->seqno : sock->snd_nxt);
+  tcp_rep->ackno = htonl(sock->ackno +
+                         (fin_seqno ? 1 : 0));
+  if (flags & TCP_FLAG_SYN) {
+    /* a SYN-ACK only permits SACK if the SYN did */
+    uint8_t opt[8] = {TCPOPT_MSS, 4, sock->mss >> 8, sock->mss & 0xff,
+                      TCPOPT_NOP, TCPOPT_NOP, TCPOPT_SACK_PERMITTED, 2};
+    segment_add_options(&seg, opt, (!(flags & TCP_FLAG_ACK) ||
+                                    (sock->opts & TCP_OPT_SACK)) ? 8 : 4);
+  }
+  printf("sending ACK seqno: %u ackno: %u\n", ntohl(tcp_rep->seqno), ntohl(tcp_rep->ackno));
+  __tcplib_send(sock, &seg.pkt);
+}
+
+static void tcplib_send_rst(struct ip6_hdr *iph, struct tcp_hdr *tcph) {
+  struct tcplib_segment seg;
+  struct tcp_hdr *tcp_rep = init_segment(&seg, NULL, NULL);
+
+  memcpy(&seg.pkt.ip6_hdr.ip6_dst, &iph->ip6_src, 16);
+
+  tcp_rep->flags = TCP_FLAG_RST | TCP_FLAG_ACK;
+
+  tcp_rep->ackno = htonl(ntohl(tcph->seqno) + 1);
+  tcp_rep->seqno = tcph->ackno;
+
+  tcp_rep->srcport = tcph->dstport;
+  tcp_rep->dstport = tcph->srcport;
+  tcp_rep->offset = sizeof(struct tcp_hdr) * 4;
+
+  tcplib_send_out(&seg.pkt, tcp_rep);
+}
+
+/* Walk the options of a received segment.  On a SYN, learn the MSS
+   and whether the peer permits SACK; otherwise, add any SACK blocks
+   to the scoreboard. */
+static void sack_update(struct tcplib_sock *sock, uint32_t start, uint32_t end);
+
+static void tcplib_options(struct tcplib_sock *sock, struct tcp_hdr *tcph,
+                           int len) {
+  uint8_t *opt = (uint8_t *)(tcph + 1);
+  uint8_t *end = ((uint8_t *)tcph) + (tcph->offset / 4);
+  int i;
+
+  if (tcph->offset / 4 > len) return;
+  if (tcph->flags & TCP_FLAG_SYN)
+    sock->opts &= ~TCP_OPT_SACK;
+
+  while (opt < end && *opt != TCPOPT_EOL) {
+    if (*opt == TCPOPT_NOP) {
+      opt++;
+      continue;
+    }
+    if (opt + 2 > end || opt[1] < 2 || opt + opt[1] > end)
+      break;
+    if (tcph->flags & TCP_FLAG_SYN) {
+      if (opt[0] == TCPOPT_MSS && opt[1] == 4) {
+        uint16_t mss = (opt[2] << 8) | opt[3];
+        if (mss > 0 && mss < sock->mss)
+          sock->mss = mss;
+      } else if (opt[0] == TCPOPT_SACK_PERMITTED) {
+        sock->opts |= TCP_OPT_SACK;
+      }
+    } else if (opt[0] == TCPOPT_SACK && (sock->opts & TCP_OPT_SACK)) {
+      for (i = 2; i + 8 <= opt[1]; i += 8) {
+        uint32_t l, r;
+        memcpy(&l, opt + i, 4);
+        memcpy(&r, opt + i + 4, 4);
+        sack_update(sock, ntohl(l), ntohl(r));
+      }
+    }
+    opt += opt[1];
+  }
+}
+
+/* Effects: add [start, end) to the scoreboard, merging it with the
+     ranges it touches.  With no room left, the range ending lowest is
+     forgotten. */
+static void sack_update(struct tcplib_sock *sock, uint32_t start, uint32_t end) {
+  uint32_t una = circ_get_seqno(sock->tx_buf);
+  int i, slot = -1;
+
+  if (SEQ_LEQ(end, start) || SEQ_LEQ(end, una) || SEQ_LT(sock->snd_max, end))
+    return;
+  if (SEQ_LT(start, una))
+    start = una;
+
+  for (i = 0; i < TCPLIB_SACK_BLOCKS; i++) {
+    if (sock->sack[i].start == sock->sack[i].end) {
+      if (slot < 0) slot = i;
+    } else if (SEQ_LEQ(sock->sack[i].start, end) &&
+               SEQ_LEQ(start, sock->sack[i].end)) {
+      if (SEQ_LT(sock->sack[i].start, start)) start = sock->sack[i].start;
+      if (SEQ_LT(end, sock->sack[i].end)) end = sock->sack[i].end;
+      sock->sack[i].start = sock->sack[i].end = 0;
+      if (slot < 0) slot = i;
+    }
+  }
+  if (slot < 0) {
+    slot = 0;
+    for (i = 1; i < TCPLIB_SACK_BLOCKS; i++)
+      if (SEQ_LT(sock->sack[i].end, sock->sack[slot].end))
+        slot = i;
+    if (SEQ_LT(end, sock->sack[slot].end))
+      return;
+  }
+  sock->sack[slot].start = start;
+  sock->sack[slot].end = end;
+}
+
+/* Effects: drops everything at or below the head from the scoreboard */
+static void sack_prune(struct tcplib_sock *sock, uint32_t una) {
+  int i;
+  for (i = 0; i < TCPLIB_SACK_BLOCKS; i++) {
+    if (SEQ_LEQ(sock->sack[i].end, una))
+      sock->sack[i].start = sock->sack[i].end = 0;
+    else if (SEQ_LT(sock->sack[i].start, una))
+      sock->sack[i].start = una;
+  }
+}
+
+/* Returns: the length of the next hole below the highest SACKed byte,
+     from rexmit_nxt on, which is stored in *seqno; or 0 if there is
+     none.  Without SACK, the head is the only hole. */
+static int sack_next_hole(struct tcplib_sock *sock, uint32_t *seqno) {
+  uint32_t una = circ_get_seqno(sock->tx_buf);
+  uint32_t hole = sock->rexmit_nxt, high = una, end;
+  int i, moved = 1;
+
+  if (SEQ_LT(hole, una)) hole = una;
+  for (i = 0; i < TCPLIB_SACK_BLOCKS; i++)
+    if (sock->sack[i].start != sock->sack[i].end &&
+        SEQ_LT(high, sock->sack[i].end))
+      high = sock->sack[i].end;
+  if (high == una) {
+    *seqno = una;
+    return hole == una ? min(sock->snd_max - una, sock->mss) : 0;
+  }
+
+  while (moved) {
+    moved = 0;
+    for (i = 0; i < TCPLIB_SACK_BLOCKS; i++) {
+      if (sock->sack[i].start != sock->sack[i].end &&
+          SEQ_LEQ(sock->sack[i].start, hole) &&
+          SEQ_LT(hole, sock->sack[i].end)) {
+        hole = sock->sack[i].end;
+        moved = 1;
+      }
+    }
+  }
+  if (!SEQ_LT(hole, high))
+    return 0;
+  end = high;
+  for (i = 0; i < TCPLIB_SACK_BLOCKS; i++)
+    if (sock->sack[i].start != sock->sack[i].end &&
+        SEQ_LT(hole, sock->sack[i].start) && SEQ_LT(sock->sack[i].start, end))
+      end = sock->sack[i].start;
+  *seqno = hole;
+  return min(end - hole, sock->mss);
+}
 
+static int8_t rto_ticks(struct tcplib_sock *sock) {
+  return (sock->rto + TCPLIB_TICK_MS - 1) / TCPLIB_TICK_MS;
+}
 
-    tcp_rep->seqno = htonl(sock->seqno);
-    tcp_rep->ackno = htonl(sock->ackno +
-                           (fin_seqno ? 1 : 0));
-    printf("sending ACK seqno: %u ackno: %u\n", ntohl(tcp_rep->seqno), ntohl(tcp_rep->ackno));
-    __tcplib_send(sock, msg);
-    ip_free(msg);
+/* Effects: folds a round trip time sample into srtt and rttvar, and
+     sets the retransmission timeout from them (RFC 6298) */
+static void rtt_sample(struct tcplib_sock *sock, uint32_t m) {
+  int32_t delta;
+  uint32_t rto;
+
+  /* srtt has to fit in 16 bits scaled by 8 */
+  if (m > 8000) m = 8000;
+  if (sock->srtt == 0) {
+    sock->srtt = m << 3;
+    sock->rttvar = m << 1;
   } else {
-    printf("Could not send ack-- no memory!\n");
+    delta = m - (sock->srtt >> 3);
+    sock->srtt += delta;
+    if (delta < 0) delta = -delta;
+    sock->rttvar += delta - (sock->rttvar >> 2);
   }
+  rto = (sock->srtt >> 3) +
+    (sock->rttvar > TCPLIB_TICK_MS ? sock->rttvar : TCPLIB_TICK_MS);
+  if (rto < TCPLIB_RTO_MIN) rto = TCPLIB_RTO_MIN;
+  if (rto > TCPLIB_RTO_MAX) rto = TCPLIB_RTO_MAX;
+  sock->rto = rto;
 }
 
-static void tcplib_send_rst(struct ip6_hdr *iph, struct tcp_hdr *tcph) {
-  struct ip6_packet *msg = get_ipmsg(0);
-      
-  if (msg != NULL) {
-    struct tcp_hdr *tcp_rep = (struct tcp_hdr *)(msg + 1);
-
-    memcpy(&msg->ip6_hdr.ip6_dst, &iph->ip6_src, 16);
-
-    tcp_rep->flags = TCP_FLAG_RST | TCP_FLAG_ACK;
-
-    tcp_rep->ackno = htonl(ntohl(tcph->seqno) + 1);
-    tcp_rep->seqno = tcph->ackno;;
-
-    tcp_rep->srcport = tcph->dstport;
-    tcp_rep->dstport = tcph->srcport;
-    tcp_rep->offset = sizeof(struct tcp_hdr) * 4;
-    tcp_rep->window = 0;
-    tcp_rep->chksum = 0;
-    tcp_rep->urgent = 0;
-
-    tcplib_send_out(msg, tcp_rep);
-
-    ip_free(msg);
-    
-  }  
-}
-
-/* send all the data in the tx buffer, starting at sseqno */
-static int tcplib_output(struct tcplib_sock *sock, uint32_t sseqno) {
-  // the output size is the minimum of the advertised window and the
-  // conjestion window.  of course, if we have less data we send even
-  // less.
-  int seg_size = min(sock->seqno - sseqno, sock->r_wind);
-  printf("r_wind: %i\n", sock->r_wind);
-  seg_size = min(seg_size, sock->cwnd);
-  while (seg_size > 0 && sock->seqno > sseqno) {
-    // printf("sending seg_size: %i\n", seg_size);
-    struct ip6_packet *msg = get_ipmsg(seg_size);
-    struct tcp_hdr *tcph;
-    uint8_t *data;
-    if (msg == NULL) return -1;
-    tcph = (struct tcp_hdr *)(msg + 1);
-    data = (uint8_t *)(tcph + 1);
-
-    tcph->flags = TCP_FLAG_ACK;
-    tcph->seqno = htonl(sseqno);
-    tcph->ackno = htonl(sock->ackno);
-
-    printf("tcplib_output: seqno: %u ackno: %u len: %i headno: %u\n",
-           ntohl(tcph->seqno), ntohl(tcph->ackno), seg_size,
-           circ_get_seqno(sock->tx_buf));
-
-    if (seg_size != circ_buf_read(sock->tx_buf, sseqno, data, seg_size)) {
-      printf("WARN: circ could not read!\n");
+/* send [sseqno, sseqno + len) from the tx buffer as one segment */
+static void tcplib_send_data(struct tcplib_sock *sock, uint32_t sseqno, int len) {
+  struct tcplib_segment seg;
+  struct tcp_hdr *tcph;
+  uint8_t *data[2];
+  int data_len[2];
+
+  if (len != circ_buf_map(sock->tx_buf, sseqno, len, data, data_len)) {
+    printf("WARN: circ could not read!\n");
+  }
+  tcph = init_segment(&seg, data, data_len);
+  tcph->flags = TCP_FLAG_ACK;
+  tcph->seqno = htonl(sseqno);
+  tcph->ackno = htonl(sock->ackno);
+
+  printf("tcplib_output: seqno: %u ackno: %u len: %i headno: %u\n",
+         ntohl(tcph->seqno), ntohl(tcph->ackno), len,
+         circ_get_seqno(sock->tx_buf));
+
+  __tcplib_send(sock, &seg.pkt);
+}
+
+/* resend one segment; by Karn's rule, nothing in flight is timed */
+static void tcplib_retransmit(struct tcplib_sock *sock, uint32_t sseqno, int len) {
+  sock->opts &= ~TCP_OPT_TIMING;
+  tcplib_send_data(sock, sseqno, len);
+  sock->rexmit_nxt = sseqno + len;
+}
+
+/* send as much new data as the congestion and advertised windows
+   allow, starting at snd_nxt */
+static int tcplib_output(struct tcplib_sock *sock) {
+  uint32_t una = circ_get_seqno(sock->tx_buf);
+  uint32_t wind = min(sock->cwnd, sock->r_wind);
+
+  sock->opts &= ~TCP_OPT_OUTPUT;
+  while (SEQ_LT(sock->snd_nxt, sock->seqno)) {
+    uint32_t in_flight = sock->snd_nxt - una;
+    int seg_size = min(sock->seqno - sock->snd_nxt, sock->mss);
+
+    if (in_flight + seg_size > wind) {
+      /* never stall with nothing in flight */
+      if (in_flight > 0 || wind == 0) break;
+      seg_size = wind;
     }
-    __tcplib_send(sock, msg);
-    ip_free(msg);
+    tcplib_send_data(sock, sock->snd_nxt, seg_size);
 
-    sseqno += seg_size;
-    seg_size = min(sock->seqno - sseqno, sock->mss);
+    /* time the first new segment sent while nothing is timed */
+    if (!(sock->opts & TCP_OPT_TIMING) && sock->snd_nxt == sock->snd_max) {
+      sock->opts |= TCP_OPT_TIMING;
+      sock->rtt_seq = sock->snd_nxt + seg_size;
+      sock->rtt_start = tcplib_extern_now();
+    }
+    sock->snd_nxt += seg_size;
+    if (SEQ_LT(sock->snd_max, sock->snd_nxt))
+      sock->snd_max = sock->snd_nxt;
+    if (sock->timer.retx == 0)
+      sock->timer.retx = rto_ticks(sock);
   }
   return 0;
 }
 
+/* Effects: sets up the sender once the SYN has used up a sequence
+     number */
+static void tcplib_start_sender(struct tcplib_sock *sock) {
+  sock->snd_nxt = sock->snd_max = sock->recover = sock->seqno;
+  sock->opts &= TCP_OPT_SACK;
+  memset(sock->sack, 0, sizeof(sock->sack));
+}
+
 int tcplib_init_sock(struct tcplib_sock *sock) {
+  conn_hash_del(sock);
   memset(sock, 0, sizeof(struct tcplib_sock) - sizeof(struct tcplib_sock *));
   sock->mss = 200;
   sock->my_wind = 200;
   sock->cwnd = ONE_SEGMENT(sock);
   sock->ssthresh = 0xffff;
+  sock->rto = TCPLIB_RTO_INIT;
   conn_add_once(sock);
   return 0;
 }
@@ -288,13 +562,93 @@ static int receive_data(struct tcplib_sock *sock, struct tcp_hdr *tcph, int len)
   return payload_len;
 }
 
+/* half of what is in flight, but at least two segments */
 static void reset_ssthresh(struct tcplib_sock *conn) {
-  uint16_t new_ssthresh = min(conn->cwnd, conn->r_wind) / 2;
+  uint32_t in_flight = conn->snd_max - circ_get_seqno(conn->tx_buf);
+  uint16_t new_ssthresh = min(in_flight, 0xffff) / 2;
   if (new_ssthresh < 2 * ONE_SEGMENT(conn))
     new_ssthresh = 2 * ONE_SEGMENT(conn);
   conn->ssthresh = new_ssthresh;
 }
 
+/* new data was ACKed */
+static void tcplib_ack_new(struct tcplib_sock *conn, uint32_t hdr_ackno) {
+  uint32_t acked = hdr_ackno - circ_get_seqno(conn->tx_buf);
+  uint32_t seqno;
+  int len;
+
+  if ((conn->opts & TCP_OPT_TIMING) && SEQ_LEQ(conn->rtt_seq, hdr_ackno)) {
+    conn->opts &= ~TCP_OPT_TIMING;
+    rtt_sample(conn, tcplib_extern_now() - conn->rtt_start);
+  }
+  conn->retxcnt = 0;
+  UNSET_ACK_COUNT(conn->flags);
+  // truncates the ack buffer
+  circ_shorten_head(conn->tx_buf, hdr_ackno);
+  sack_prune(conn, hdr_ackno);
+  if (SEQ_LT(conn->snd_nxt, hdr_ackno))
+    conn->snd_nxt = hdr_ackno;
+
+  if (conn->opts & TCP_OPT_RECOVERY) {
+    if (SEQ_LEQ(conn->recover, hdr_ackno)) {
+      // a full ACK ends recovery (RFC 6582): deflate the window
+      conn->opts &= ~TCP_OPT_RECOVERY;
+      conn->cwnd = min(conn->ssthresh,
+                       conn->snd_max - hdr_ackno + ONE_SEGMENT(conn));
+    } else {
+      // a partial ACK: the next hole was lost too
+      if ((len = sack_next_hole(conn, &seqno)) > 0)
+        tcplib_retransmit(conn, seqno, len);
+      conn->cwnd = (conn->cwnd > acked ? conn->cwnd - acked : 0) +
+        ONE_SEGMENT(conn);
+    }
+  } else if (conn->cwnd <= conn->ssthresh) {
+    // in slow start; increase the cwnd by one segment
+    conn->cwnd += ONE_SEGMENT(conn);
+  } else {
+    // in congestion avoidance
+    conn->cwnd += (ONE_SEGMENT(conn) * ONE_SEGMENT(conn)) / conn->cwnd;
+  }
+
+  if (conn->state == TCP_ESTABLISHED)
+    conn->timer.retx = hdr_ackno == conn->snd_max ? 0 : rto_ticks(conn);
+}
+
+/* the head is still missing */
+static void tcplib_ack_dup(struct tcplib_sock *conn, uint32_t hdr_ackno) {
+  uint32_t seqno;
+  int len;
+
+  if (GET_ACK_COUNT(conn->flags) < (TCP_DUPACKS >> TCP_DUPACKS_OFF))
+    INCR_ACK_COUNT(conn->flags);
+
+  if (!(conn->opts & TCP_OPT_RECOVERY)) {
+    // on the third duplicate, retransmit the head and go into fast
+    // recovery -- unless the ACK doesn't cover the data sent before
+    // the last recovery or timeout (RFC 6582)
+    if (GET_ACK_COUNT(conn->flags) == TCPLIB_DUPACK_THRESH &&
+        SEQ_LT(conn->recover, hdr_ackno + 1)) {
+      printf("fast retransmit [%u, %u]\n", hdr_ackno, conn->snd_max);
+      reset_ssthresh(conn);
+      conn->recover = conn->snd_max;
+      conn->rexmit_nxt = hdr_ackno;
+      conn->opts |= TCP_OPT_RECOVERY;
+      if ((len = sack_next_hole(conn, &seqno)) > 0)
+        tcplib_retransmit(conn, seqno, len);
+      conn->cwnd = conn->ssthresh + TCPLIB_DUPACK_THRESH * ONE_SEGMENT(conn);
+      if (conn->state == TCP_ESTABLISHED)
+        conn->timer.retx = rto_ticks(conn);
+    }
+  } else {
+    // each duplicate means a segment has left the network
+    if (conn->cwnd < 0xffff - ONE_SEGMENT(conn))
+      conn->cwnd += ONE_SEGMENT(conn);
+    if ((conn->opts & TCP_OPT_SACK) &&
+        (len = sack_next_hole(conn, &seqno)) > 0)
+      tcplib_retransmit(conn, seqno, len);
+  }
+}
+
 int tcplib_process(struct ip6_hdr *iph, void *payload) {
   int rc = 0;
   struct tcp_hdr *tcph;
@@ -371,6 +725,7 @@ int tcplib_process(struct ip6_hdr *iph, void *payload) {
       if (tcph->flags & (TCP_FLAG_SYN | TCP_FLAG_ACK)) {
         // got a syn-ack
         // send the ACK this_conn
+        tcplib_options(this_conn, tcph, len - sizeof(struct ip6_hdr));
         this_conn->state = TCP_ESTABLISHED;
         this_conn->ackno = hdr_seqno + 1;
         connect_done = 1;
@@ -394,16 +749,13 @@ int tcplib_process(struct ip6_hdr *iph, void *payload) {
         struct tcplib_sock *new_sock;
 
         if (this_conn->state == TCP_LISTEN) {
-          memcpy(&this_conn->r_ep.sin6_addr, &iph->ip6_src, 16);
-          this_conn->r_ep.sin6_port = tcph->srcport;
+          conn_set_remote(this_conn, &iph->ip6_src, tcph->srcport);
           new_sock = tcplib_accept(this_conn, &this_conn->r_ep);
           if (new_sock != this_conn) {
-            memset(this_conn->r_ep.sin6_addr.s6_addr, 0, 16);
-            this_conn->r_ep.sin6_port = 0;
+            conn_set_remote(this_conn, NULL, 0);
             if (new_sock != NULL) {
-              memcpy(&new_sock->r_ep.sin6_addr, &iph->ip6_src, 16);
-              new_sock->r_ep.sin6_port = tcph->srcport;
               conn_add_once(new_sock);
+              conn_set_remote(new_sock, &iph->ip6_src, tcph->srcport);
             }
           }
           if (new_sock == NULL) {
@@ -422,12 +774,14 @@ int tcplib_process(struct ip6_hdr *iph, void *payload) {
         }
 
         if (new_sock != NULL) {
+          tcplib_options(new_sock, tcph, len - sizeof(struct ip6_hdr));
           new_sock->seqno = 0xcafebabe + 1;
           new_sock->state = TCP_SYN_RCVD;
           tcplib_send_ack(new_sock, 0, TCP_FLAG_ACK | TCP_FLAG_SYN);
           new_sock->seqno++;
+          tcplib_start_sender(new_sock);
         } else {
-          memset(&this_conn->r_ep, 0, sizeof(struct sockaddr_in6));
+          conn_set_remote(this_conn, NULL, 0);
         }
       } else if (this_conn->state == TCP_LISTEN) {
         tcplib_send_rst(iph, tcph);
@@ -454,58 +808,23 @@ int tcplib_process(struct ip6_hdr *iph, void *payload) {
         }
 
 
-        // receive side sequence check and add data
-        printf("seqno: %u ackno: %u\n", hdr_seqno, hdr_ackno);
-        printf("conn seqno: %u ackno: %u\n", this_conn->seqno, this_conn->ackno);
-
-
-        // send side recieve sequence check and congestion window updates.
-        if (hdr_ackno > circ_get_seqno(this_conn->tx_buf)) {
-          // new data is being ACKed
-          // or we haven't sent anything new
-          if (this_conn->cwnd <= this_conn->ssthresh) {
-            // in slow start; increase the cwnd by one segment
-            this_conn->cwnd += ONE_SEGMENT(this_conn);
-            // printf("in slow start\n");
-          } else {
-            // in congestion avoidance
-            this_conn->cwnd += (ONE_SEGMENT(this_conn) * ONE_SEGMENT(this_conn)) / this_conn->cwnd;
-            // printf("in congestion avoidence\n");
-          }
-          // printf("ACK new data: cwnd: %i ssthresh: %i\n", this_conn->cwnd, this_conn->ssthresh);
-          // reset the duplicate ack counter
-          UNSET_ACK_COUNT(this_conn->flags);
-          // truncates the ack buffer 
-          circ_shorten_head(this_conn->tx_buf, hdr_ackno);
-          // printf("ack_count: %i\n", GET_ACK_COUNT(this_conn->flags));
-
+        // send side: the SACK blocks and the cumulative ACK
+        if (!(tcph->flags & TCP_FLAG_SYN))
+          tcplib_options(this_conn, tcph, len - sizeof(struct ip6_hdr));
+        if (SEQ_LT(circ_get_seqno(this_conn->tx_buf), hdr_ackno) &&
+            SEQ_LEQ(hdr_ackno, this_conn->snd_max)) {
+          tcplib_ack_new(this_conn, hdr_ackno);
           if (this_conn->seqno == hdr_ackno) {
             tcplib_extern_acked(this_conn);
           }
-        } else if (this_conn->seqno > circ_get_seqno(this_conn->tx_buf)) {
-          // this is a duplicate ACK
-          //  - increase the counter of the number of duplicate ACKs
-          //  - if we get to three duplicate ACK's, start resending at
-          //    the ACK number because this probably means we lost a segment
-
-          INCR_ACK_COUNT(this_conn->flags);
-          // printf("ack_count: %i\n", GET_ACK_COUNT(this_conn->flags));
-          // printf("dup ack count: %i\n", GET_ACK_COUNT(this_conn->flags));
-          // a "dup ack count" of 2 is really 3 total acks because we start with zero
-          if (GET_ACK_COUNT(this_conn->flags) == 2) {
-            UNSET_ACK_COUNT(this_conn->flags);
-            printf("detected multiple duplicate ACKs-- doing fast retransmit [%u, %u]\n",
-                   circ_get_seqno(this_conn->tx_buf),
-                   this_conn->seqno);
-
-            // this is our detection of a "duplicate ack" event.
-            // we are going to reset ssthresh and retransmit the data.
-            reset_ssthresh(this_conn);
-            tcplib_output(this_conn, circ_get_seqno(this_conn->tx_buf));
-            this_conn->timer.retx = 6;
-            
-          }
+        } else if (hdr_ackno == circ_get_seqno(this_conn->tx_buf) &&
+                   SEQ_LT(hdr_ackno, this_conn->snd_max) &&
+                   payload_len == 0 &&
+                   !(tcph->flags & (TCP_FLAG_SYN | TCP_FLAG_FIN))) {
+          tcplib_ack_dup(this_conn, hdr_ackno);
         }
+        if (this_conn->state == TCP_ESTABLISHED)
+          tcplib_output(this_conn);
 
         if (hdr_seqno != this_conn->ackno) {
           printf("==> received forward segment\n");
@@ -526,10 +845,6 @@ int tcplib_process(struct ip6_hdr *iph, void *payload) {
             tcplib_send_ack(this_conn, 0, TCP_FLAG_ACK);
           }
         }
-
-        // reset the retransmission timer
-        if (this_conn->timer.retx == 0)
-          this_conn->timer.retx = 6;
       }
 
       if (connect_done && !(this_conn->flags & TCP_CONNECTDONE)) {
@@ -604,11 +919,14 @@ int tcplib_connect(struct tcplib_sock *sock,
 
   sock->ackno = 0;
   sock->seqno = 0xcafebabe;
+  conn_hash_del(sock);
   memcpy(&sock->r_ep, serv_addr, sizeof(struct sockaddr_in6));
+  conn_hash_add(sock);
   tcplib_send_ack(sock, 0, TCP_FLAG_SYN);
   sock->state = TCP_SYN_SENT;
   sock->seqno++;
-  sock->timer.retx = 6;
+  tcplib_start_sender(sock);
+  sock->timer.retx = rto_ticks(sock);
 
   return 0;
 }
@@ -618,7 +936,7 @@ int tcplib_send(struct tcplib_sock *sock, void *data, int len) {
   /* have enough tx buffer left? */
   if (sock->state != TCP_ESTABLISHED)
     return -1;
-  if (sock->seqno - circ_get_seqno(sock->tx_buf) + len > sock->tx_buf_len) // circ_get_window(sock->tx_buf))
+  if (sock->seqno - circ_get_seqno(sock->tx_buf) + len > circ_get_window(sock->tx_buf))
     return -1;
   if (circ_buf_write(sock->tx_buf, sock->seqno, data, len) < 0)
     return -1;
@@ -628,12 +946,9 @@ int tcplib_send(struct tcplib_sock *sock, void *data, int len) {
   // tcplib_output(sock, sock->seqno - len);
 
   // this will let multiple calls to send() get combined into a single packet
-  // the data will be sent out next time the timer fires
-  sock->timer.retx = 1;
-  
-  // 3 seconds
-  //if (sock->timer.retx == 0)
-  //sock->timer.retx = 6;
+  // the data will be sent out next time the timer fires, or when an
+  // ACK opens the window
+  sock->opts |= TCP_OPT_OUTPUT;
 
   return 0;
 }
@@ -643,22 +958,32 @@ void tcplib_retx_expire(struct tcplib_sock *sock) {
   sock->retxcnt++;
   switch (sock->state) {
   case TCP_ESTABLISHED:
-    if (circ_get_seqno(sock->tx_buf) != sock->seqno) {
+    if (SEQ_LT(circ_get_seqno(sock->tx_buf), sock->snd_max)) {
       printf("retransmitting [%u, %u]\n", circ_get_seqno(sock->tx_buf),
-             sock->seqno);
+             sock->snd_max);
       reset_ssthresh(sock);
-      // restart slow start
+      // restart slow start from the head.  the peer may renege on what
+      // it SACKed, so the scoreboard goes too (RFC 2018).
       sock->cwnd = ONE_SEGMENT(sock);
-      // printf("tcplib_output from timer\n");
-      tcplib_output(sock, circ_get_seqno(sock->tx_buf));
-      sock->timer.retx = 6;
+      sock->snd_nxt = circ_get_seqno(sock->tx_buf);
+      sock->recover = sock->snd_max;
+      sock->opts &= ~(TCP_OPT_TIMING | TCP_OPT_RECOVERY);
+      memset(sock->sack, 0, sizeof(sock->sack));
+      UNSET_ACK_COUNT(sock->flags);
+      // back off until an ACK of new data gives a fresh sample
+      sock->rto = min(2 * (uint32_t)sock->rto, TCPLIB_RTO_MAX);
+      tcplib_output(sock);
     } else {
       sock->retxcnt--;
     }
     break;
   case TCP_SYN_SENT:
+    // the SYN already took its sequence number
+    sock->seqno--;
     tcplib_send_ack(sock, 0, TCP_FLAG_SYN);
-    sock->timer.retx = 6;
+    sock->seqno++;
+    sock->rto = min(2 * (uint32_t)sock->rto, TCPLIB_RTO_MAX);
+    sock->timer.retx = rto_ticks(sock);
     break;
   case TCP_LAST_ACK:
   case TCP_FIN_WAIT_1:
@@ -698,6 +1023,7 @@ int tcplib_abort(struct tcplib_sock *sock) {
     break;
   default:
     tcplib_send_ack(sock, 0, TCP_FLAG_RST);
+    conn_hash_del(sock);
     memset(&sock->l_ep, 0, sizeof(struct sockaddr_in6));
     memset(&sock->r_ep, 0, sizeof(struct sockaddr_in6));
     sock->state = TCP_CLOSED;
@@ -712,7 +1038,7 @@ int tcplib_close(struct tcplib_sock *sock) {
     /* passive close */
   case TCP_CLOSE_WAIT:
     tcplib_send_ack(sock, 1, TCP_FLAG_ACK | TCP_FLAG_FIN);
-    sock->timer.retx = 6;
+    sock->timer.retx = rto_ticks(sock);
     sock->state = TCP_LAST_ACK;
     break;
     /* active close */
@@ -740,6 +1066,8 @@ int tcplib_timer_process() {
     if ((iter->flags & TCP_ACKPENDING) >= 2) {
       tcplib_send_ack(iter, 0, TCP_FLAG_ACK);
     }
+    if ((iter->opts & TCP_OPT_OUTPUT) && iter->state == TCP_ESTABLISHED)
+      tcplib_output(iter);
   }
   return 0;
 }
@@ -60,7 +60,35 @@ enum {
   TCP_ACKSENT     = 0x80,
 };
 
+/* options negotiated and sender state, in tcplib_sock.opts */
 enum {
+  TCP_OPT_SACK     = 0x1,   /* the peer sends SACK blocks */
+  TCP_OPT_TIMING   = 0x2,   /* a segment is being timed */
+  TCP_OPT_RECOVERY = 0x4,   /* in fast recovery */
+  TCP_OPT_OUTPUT   = 0x8,   /* new data to send on the next tick */
+};
+
+/* tcplib_timer_process should be called every TCPLIB_TICK_MS */
+#ifndef TCPLIB_TICK_MS
+#define TCPLIB_TICK_MS 512
+#endif
+
+/* bounds on the retransmission timeout, in ms; the first timeout is
+   TCPLIB_RTO_INIT, before there is a round trip time sample */
+#ifndef TCPLIB_RTO_INIT
+#define TCPLIB_RTO_INIT 3000
+#endif
+#define TCPLIB_RTO_MIN  1000
+#define TCPLIB_RTO_MAX  60000
+
+/* how many ranges of SACKed data the sender remembers */
+#ifndef TCPLIB_SACK_BLOCKS
+#define TCPLIB_SACK_BLOCKS 3
+#endif
+
+enum {
+  /* duplicate ACKs that start a fast retransmit */
+  TCPLIB_DUPACK_THRESH = 3,
   /* how many timer tics to stay in TIME_WAIT */
   TCPLIB_TIMEWAIT_LEN = 1,
   TCPLIB_2MSL = 4,
@@ -68,10 +96,19 @@ enum {
   TCPLIB_GIVEUP = 6,
 };
 
+/* buckets in the connection demux; a power of two */
+#ifndef TCPLIB_HASH_SZ
+#define TCPLIB_HASH_SZ 8
+#endif
+
 #define GET_ACK_COUNT(X)    (((X) & TCP_DUPACKS) >> TCP_DUPACKS_OFF)
 #define UNSET_ACK_COUNT(X)  ((X) &= ~TCP_DUPACKS)
 #define INCR_ACK_COUNT(X)   ((X) += 1 << TCP_DUPACKS_OFF)
 
+/* sequence number comparisons, modulo 2^32 */
+#define SEQ_LT(X,Y)  ((int32_t)((X) - (Y)) < 0)
+#define SEQ_LEQ(X,Y) ((int32_t)((X) - (Y)) <= 0)
+
 struct tcplib_sock {
   uint8_t flags;
   
@@ -102,6 +139,30 @@ struct tcplib_sock {
   // and the index of the last byte we've ACKed
   uint32_t ackno;
 
+  /* the oldest unacknowledged byte is the head of tx_buf; snd_nxt is
+     the next one to send, and snd_max the highest sent so far */
+  uint32_t snd_nxt;
+  uint32_t snd_max;
+  /* snd_max when fast recovery started, and the next hole to fill */
+  uint32_t recover;
+  uint32_t rexmit_nxt;
+
+  /* Jacobson/Karels round trip time estimate, in ms: srtt is scaled
+     by 8 and rttvar by 4.  one segment at a time is timed. */
+  uint32_t rtt_seq;
+  uint32_t rtt_start;
+  uint16_t srtt;
+  uint16_t rttvar;
+  uint16_t rto;
+
+  uint8_t opts;
+
+  /* SACK scoreboard: ranges above the head the peer has received */
+  struct {
+    uint32_t start;
+    uint32_t end;
+  } sack[TCPLIB_SACK_BLOCKS];
+
   struct {
     int8_t retx;
   } timer;
@@ -109,6 +170,9 @@ struct tcplib_sock {
   /* retransmission counter */
   uint16_t retxcnt;
 
+  /* connected sockets are also chained by their 4-tuple */
+  struct tcplib_sock *hash_next;
+
   /* this needs to be at the end so
      we can call init() on a socket
      without blowing away the linked
@@ -134,6 +198,9 @@ struct tcplib_sock {
 struct tcplib_sock *tcplib_accept(struct tcplib_sock *conn,
                                   struct sockaddr_in6 *from);
 
+/* a millisecond clock, for round trip time estimation */
+uint32_t tcplib_extern_now(void);
+
 /* a call-out point for tcplib to send a message */
 void tcplib_send_out(struct ip6_packet *pkt, struct tcp_hdr *tcph);
 
@@ -46,6 +46,21 @@ void do_read(void *buf, uint32_t sseqno) {
 
 }
 
+/* circ_buf_map must see the same bytes as circ_buf_read */
+void do_map(void *buf, uint32_t sseqno) {
+  char data[20];
+  uint8_t *map[2];
+  int map_len[2], data_len;
+  data_len = circ_buf_read(buf, sseqno, data, 20);
+
+  if (circ_buf_map(buf, sseqno, 20, map, map_len) != data_len ||
+      memcmp(data, map[0], map_len[0]) != 0 ||
+      memcmp(data + map_len[0], map[1], map_len[1]) != 0)
+    printf("buf_map: mismatch\n");
+  else
+    printf("buf_map: %i + %i\n", map_len[0], map_len[1]);
+}
+
 int main(int argc, char **argv) {
   char buf[200];
   char data[20], readbuf[30];
@@ -101,6 +116,7 @@ int main(int argc, char **argv) {
   for (i = 0; i < 25; i++) {
     circ_buf_write(buf, i * 20, data, 20);
     do_read(buf, i * 20);
+    do_map(buf, i * 20);
     circ_shorten_head(buf, (i > 0) ? (i - 1) * 20 : 0 * 10);
     circ_buf_dump(buf);
   }
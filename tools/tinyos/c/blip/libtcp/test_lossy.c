@@ -0,0 +1,403 @@
+/* Goodput of a tcplib bulk transfer over a lossy link.
+ *
+ * test_lossy [loss %] [bytes] [seed]
+ *
+ * A tcplib socket sends bytes of a known pattern to a peer over a
+ * simulated link: a fixed rate and delay in each direction, a short
+ * drop-tail queue, and random loss of frames both ways.  Time is
+ * virtual, and tcplib_timer_process runs every TCPLIB_TICK_MS.  The
+ * peer is either a host that reassembles out-of-order data and sends
+ * SACK blocks, the same host without SACK, or another tcplib socket,
+ * which only takes data in order.  Every transfer must complete with
+ * the data intact.  Reports goodput, how many bytes were sent for each
+ * one delivered, and retransmission timeouts.  Without a loss rate,
+ * sweeps a few.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "lib6lowpan/ip.h"
+#include "libtcp/tcplib.h"
+
+#define LINK_RATE   4000          /* bytes per second each way */
+#define LINK_DELAY  40            /* ms */
+#define LINK_QUEUE  8             /* frames waiting to go out, each way */
+#define MAX_FRAMES  64
+#define FRAME_LEN   (sizeof(struct ip6_hdr) + sizeof(struct tcp_hdr) + 40 + 400)
+
+#define TX_BUF_LEN  1024
+#define RCV_WIND    800
+#define SERVER_PORT 80
+#define APP_CHUNK   64
+#define TIME_LIMIT  (900 * 1000)
+
+enum { PEER_SACK, PEER_NOSACK, PEER_TCPLIB, N_PEERS };
+static const char *peer_names[N_PEERS] = {"host+sack", "host", "tcplib"};
+
+struct frame {
+  uint32_t at;
+  int dir;
+  int len;
+  uint8_t data[FRAME_LEN];
+};
+
+static struct frame frames[MAX_FRAMES];
+static int n_frames;
+static uint32_t link_free[2];
+static int loss;
+
+static struct tcplib_sock client, server;
+static uint8_t client_buf[TX_BUF_LEN], server_buf[TX_BUF_LEN];
+static struct sockaddr_in6 client_addr, server_addr;
+static int peer;
+
+static uint32_t now_ms;
+static int total, success;
+
+static struct {
+  int app_sent, delivered, corrupt;
+  int bytes_sent, drops, timeouts;
+} stats;
+
+/* the host peer: it only receives */
+static struct {
+  int sack;
+  uint16_t rport;
+  uint32_t irs, rcv_nxt, iss;
+  uint32_t last;           /* start of the latest out-of-order segment */
+  uint8_t have[RCV_WIND];  /* out-of-order bytes, by seqno % RCV_WIND */
+} host;
+
+static uint8_t pattern(uint32_t i) {
+  return i * 13 + (i >> 9);
+}
+
+static void deliver(const uint8_t *data, int len) {
+  int i;
+  for (i = 0; i < len; i++)
+    if (data[i] != pattern(stats.delivered + i))
+      stats.corrupt++;
+  stats.delivered += len;
+}
+
+void tcplib_extern_connectdone(struct tcplib_sock *sock, int error) {}
+
+void tcplib_extern_recv(struct tcplib_sock *sock, void *data, int len) {
+  if (sock == &server)
+    deliver(data, len);
+}
+
+void tcplib_extern_closed(struct tcplib_sock *sock) {}
+
+void tcplib_extern_closedone(struct tcplib_sock *sock) {
+  tcplib_init_sock(sock);
+}
+
+void tcplib_extern_acked(struct tcplib_sock *sock) {}
+
+uint32_t tcplib_extern_now(void) {
+  return now_ms;
+}
+
+#include "libtcp/circ.c"
+#include "libtcp/tcplib.c"
+/* tcplib.c compiles its tracing out by redefining printf */
+#undef printf
+
+struct tcplib_sock *tcplib_accept(struct tcplib_sock *conn,
+                                  struct sockaddr_in6 *from) {
+  conn->tx_buf = server_buf;
+  conn->tx_buf_len = sizeof(server_buf);
+  /* tcplib hands data to the app as it arrives, so it can take a
+     window of data at once */
+  conn->my_wind = RCV_WIND;
+  return conn;
+}
+
+/* dir 0 is towards the peer, 1 back to the client */
+static void link_send(int dir, const uint8_t *data, int len) {
+  struct frame *f;
+  uint32_t start;
+  int i, queued = 0;
+
+  if (rand() % 100 < loss) {
+    stats.drops++;
+    return;
+  }
+  /* frames still waiting for the link */
+  for (i = 0; i < n_frames; i++)
+    queued += frames[i].dir == dir && frames[i].at - LINK_DELAY > now_ms;
+  if (queued >= LINK_QUEUE || n_frames == MAX_FRAMES) {
+    stats.drops++;
+    return;
+  }
+  start = link_free[dir] > now_ms ? link_free[dir] : now_ms;
+  link_free[dir] = start + (len * 1000 + LINK_RATE - 1) / LINK_RATE;
+  f = &frames[n_frames++];
+  f->at = link_free[dir] + LINK_DELAY;
+  f->dir = dir;
+  f->len = len;
+  memcpy(f->data, data, len);
+}
+
+void tcplib_send_out(struct ip6_packet *pkt, struct tcp_hdr *tcph) {
+  uint8_t buf[FRAME_LEN];
+  struct ip6_hdr *iph = (struct ip6_hdr *)buf;
+  struct ip_iovec *v;
+  int from_client = tcph->srcport != htons(SERVER_PORT);
+  int len = sizeof(struct ip6_hdr);
+
+  memcpy(iph, &pkt->ip6_hdr, sizeof(struct ip6_hdr));
+  memcpy(&iph->ip6_src, from_client ? &client_addr.sin6_addr :
+         &server_addr.sin6_addr, 16);
+  for (v = pkt->ip6_data; v != NULL; v = v->iov_next) {
+    memcpy(buf + len, v->iov_base, v->iov_len);
+    len += v->iov_len;
+  }
+  if (from_client)
+    stats.bytes_sent += len - sizeof(struct ip6_hdr) - tcph->offset / 4;
+  link_send(!from_client, buf, len);
+}
+
+static void host_send(uint8_t flags, const uint8_t *opt, int opt_len) {
+  uint8_t buf[FRAME_LEN];
+  struct ip6_hdr *iph = (struct ip6_hdr *)buf;
+  struct tcp_hdr *tcph = (struct tcp_hdr *)(iph + 1);
+  int len = sizeof(struct tcp_hdr) + opt_len;
+
+  memset(buf, 0, sizeof(struct ip6_hdr) + len);
+  iph->ip6_vfc = IPV6_VERSION;
+  iph->ip6_nxt = IANA_TCP;
+  iph->ip6_plen = htons(len);
+  memcpy(&iph->ip6_src, &server_addr.sin6_addr, 16);
+  memcpy(&iph->ip6_dst, &client_addr.sin6_addr, 16);
+  tcph->srcport = htons(SERVER_PORT);
+  tcph->dstport = host.rport;
+  tcph->seqno = htonl(host.iss + !(flags & TCP_FLAG_SYN));
+  tcph->ackno = htonl(host.rcv_nxt);
+  tcph->offset = len * 4;
+  tcph->flags = flags;
+  tcph->window = htons(RCV_WIND);
+  memcpy(tcph + 1, opt, opt_len);
+  link_send(1, buf, sizeof(struct ip6_hdr) + len);
+}
+
+/* a run of out-of-order bytes at or around seqno */
+static void host_run(uint32_t seqno, uint32_t *start, uint32_t *end) {
+  *start = *end = seqno;
+  while (*start != host.rcv_nxt && host.have[(*start - 1) % RCV_WIND])
+    (*start)--;
+  while (*end != host.rcv_nxt + RCV_WIND && host.have[*end % RCV_WIND])
+    (*end)++;
+}
+
+/* ACK everything, with the block holding the latest segment first
+   and then the lowest others (RFC 2018) */
+static void host_ack(void) {
+  uint8_t opt[4 + 8 * 3] = {TCPOPT_NOP, TCPOPT_NOP, TCPOPT_SACK, 2};
+  uint32_t seqno, start, end, blocks[3][2];
+  int n = 0, i;
+
+  if (host.sack && SEQ_LT(host.rcv_nxt, host.last) &&
+      host.have[host.last % RCV_WIND]) {
+    host_run(host.last, &blocks[0][0], &blocks[0][1]);
+    n = 1;
+  }
+  for (seqno = host.rcv_nxt; host.sack && n < 3 &&
+         SEQ_LT(seqno, host.rcv_nxt + RCV_WIND); seqno++) {
+    if (!host.have[seqno % RCV_WIND])
+      continue;
+    host_run(seqno, &start, &end);
+    if (n == 0 || start != blocks[0][0]) {
+      blocks[n][0] = start;
+      blocks[n][1] = end;
+      n++;
+    }
+    seqno = end;
+  }
+  for (i = 0; i < n; i++) {
+    uint32_t l = htonl(blocks[i][0]), r = htonl(blocks[i][1]);
+    memcpy(opt + 4 + 8 * i, &l, 4);
+    memcpy(opt + 8 + 8 * i, &r, 4);
+  }
+  opt[3] += 8 * n;
+  host_send(TCP_FLAG_ACK, opt, n ? 4 + 8 * n : 0);
+}
+
+static void host_input(struct ip6_hdr *iph, struct tcp_hdr *tcph) {
+  uint8_t *data = (uint8_t *)tcph + tcph->offset / 4;
+  int len = ntohs(iph->ip6_plen) - tcph->offset / 4;
+  uint32_t seqno = ntohl(tcph->seqno);
+  int i;
+
+  if (tcph->flags & TCP_FLAG_SYN) {
+    /* a SYN-ACK, permitting SACK if the SYN did */
+    uint8_t opt[8] = {TCPOPT_MSS, 4, 0, 200,
+                      TCPOPT_NOP, TCPOPT_NOP, TCPOPT_SACK_PERMITTED, 2};
+    uint8_t *p = (uint8_t *)(tcph + 1);
+    int permitted = 0;
+    while (p < data && *p != TCPOPT_EOL) {
+      if (*p == TCPOPT_NOP) {
+        p++;
+        continue;
+      }
+      permitted |= *p == TCPOPT_SACK_PERMITTED;
+      p += p[1] ? p[1] : 1;
+    }
+    host.sack = peer == PEER_SACK && permitted;
+    host.rport = tcph->srcport;
+    host.irs = seqno;
+    host.rcv_nxt = seqno + 1;
+    host.last = host.rcv_nxt;
+    memset(host.have, 0, sizeof(host.have));
+    host_send(TCP_FLAG_SYN | TCP_FLAG_ACK, opt, host.sack ? 8 : 4);
+    return;
+  }
+  if (len <= 0)
+    return;
+
+  /* keep what fits in the window; without SACK, only data in order */
+  for (i = 0; i < len; i++) {
+    uint32_t s = seqno + i;
+    if (SEQ_LT(s, host.rcv_nxt) || !SEQ_LT(s, host.rcv_nxt + RCV_WIND) ||
+        (!host.sack && s != host.rcv_nxt))
+      continue;
+    if (s == host.rcv_nxt) {
+      deliver(data + i, 1);
+      host.rcv_nxt++;
+      while (host.have[host.rcv_nxt % RCV_WIND]) {
+        host.have[host.rcv_nxt % RCV_WIND] = 0;
+        host.rcv_nxt++;
+        stats.delivered++;
+      }
+    } else {
+      /* out-of-order bytes are checked when they arrive */
+      if (data[i] != pattern(s - host.irs - 1))
+        stats.corrupt++;
+      host.have[s % RCV_WIND] = 1;
+    }
+  }
+  if (SEQ_LT(host.rcv_nxt, seqno))
+    host.last = seqno;
+  host_ack();
+}
+
+static void deliver_frame(struct frame *f) {
+  struct ip6_hdr *iph = (struct ip6_hdr *)f->data;
+  struct tcp_hdr *tcph = (struct tcp_hdr *)(iph + 1);
+
+  if (tcph->dstport == htons(SERVER_PORT) && peer != PEER_TCPLIB)
+    host_input(iph, tcph);
+  else
+    tcplib_process(iph, tcph);
+}
+
+/* keep the transmit buffer full */
+static void app_send(int bytes) {
+  uint8_t chunk[APP_CHUNK];
+  int i, len;
+
+  while (client.state == TCP_ESTABLISHED && stats.app_sent < bytes) {
+    len = min(bytes - stats.app_sent, APP_CHUNK);
+    for (i = 0; i < len; i++)
+      chunk[i] = pattern(stats.app_sent + i);
+    if (tcplib_send(&client, chunk, len) < 0)
+      break;
+    stats.app_sent += len;
+  }
+}
+
+/* Returns: the transfer time in ms, or -1 if it did not complete */
+static int transfer(int bytes) {
+  uint32_t next_tick = TCPLIB_TICK_MS;
+  struct frame f;
+  int i, next, retxcnt;
+
+  memset(&stats, 0, sizeof(stats));
+  memset(&host, 0, sizeof(host));
+  host.iss = 0x10000000;
+  n_frames = 0;
+  link_free[0] = link_free[1] = now_ms = 0;
+
+  tcplib_init_sock(&client);
+  tcplib_init_sock(&server);
+  client.tx_buf = client_buf;
+  client.tx_buf_len = sizeof(client_buf);
+  if (peer == PEER_TCPLIB)
+    tcplib_bind(&server, &server_addr);
+  tcplib_connect(&client, &server_addr);
+
+  while (stats.delivered < bytes && now_ms < TIME_LIMIT) {
+    next = -1;
+    for (i = 0; i < n_frames; i++)
+      if (next < 0 || SEQ_LT(frames[i].at, frames[next].at))
+        next = i;
+    if (next >= 0 && SEQ_LEQ(frames[next].at, next_tick)) {
+      now_ms = frames[next].at;
+      memcpy(&f, &frames[next], sizeof(struct frame));
+      frames[next] = frames[--n_frames];
+      deliver_frame(&f);
+    } else {
+      now_ms = next_tick;
+      next_tick += TCPLIB_TICK_MS;
+      retxcnt = client.retxcnt;
+      tcplib_timer_process();
+      stats.timeouts += client.retxcnt > retxcnt;
+    }
+    app_send(bytes);
+  }
+  return stats.delivered == bytes && !stats.corrupt ? now_ms : -1;
+}
+
+static void run(int loss_pct, int bytes) {
+  int ms;
+
+  loss = loss_pct;
+  for (peer = 0; peer < N_PEERS; peer++) {
+    ms = transfer(bytes);
+    total++;
+    if (ms < 0) {
+      printf("%-9s %3i%%: failed: %i/%i bytes, %i corrupt\n",
+             peer_names[peer], loss, stats.delivered, bytes, stats.corrupt);
+      continue;
+    }
+    /* without loss, nothing is sent twice */
+    if (loss == 0 && (stats.bytes_sent != bytes || stats.timeouts)) {
+      printf("%-9s %3i%%: failed: %i bytes sent, %i timeouts\n",
+             peer_names[peer], loss, stats.bytes_sent, stats.timeouts);
+      continue;
+    }
+    success++;
+    printf("%-9s %3i%%: %6.0f bit/s  %4.2f sent/delivered  %3i drops  "
+           "%3i timeouts  srtt %i ms\n", peer_names[peer], loss,
+           bytes * 8000.0 / ms, (double)stats.bytes_sent / bytes,
+           stats.drops, stats.timeouts, client.srtt >> 3);
+  }
+}
+
+int main(int argc, char **argv) {
+  static const int sweep[] = {0, 1, 2, 5, 10, 20};
+  int bytes = argc > 2 ? atoi(argv[2]) : 16384;
+  int i;
+
+  srand(argc > 3 ? atoi(argv[3]) : 1);
+  memset(&client_addr, 0, sizeof(client_addr));
+  memset(&server_addr, 0, sizeof(server_addr));
+  client_addr.sin6_addr.s6_addr[0] = server_addr.sin6_addr.s6_addr[0] = 0x20;
+  client_addr.sin6_addr.s6_addr[1] = server_addr.sin6_addr.s6_addr[1] = 0x01;
+  client_addr.sin6_addr.s6_addr[15] = 1;
+  server_addr.sin6_addr.s6_addr[15] = 2;
+  server_addr.sin6_port = htons(SERVER_PORT);
+
+  printf("%i bytes, %i byte/s, %i ms each way\n", bytes, LINK_RATE, LINK_DELAY);
+  if (argc > 1) {
+    run(atoi(argv[1]), bytes);
+  } else {
+    for (i = 0; i < sizeof(sweep) / sizeof(sweep[0]); i++)
+      run(sweep[i], bytes);
+  }
+  printf("%s: %i/%i tests succeeded\n", __FILE__, success, total);
+  return success != total;
+}
@@ -8,6 +8,10 @@
 
 #include "config.h"
 
+#if !defined(WITH_CONTIKI) && !defined(WITH_TINYOS) && !defined(_GNU_SOURCE)
+#define _GNU_SOURCE		/* for pread() and fsync() */
+#endif
+
 #if defined(HAVE_ASSERT_H) && !defined(assert)
 # include <assert.h>
 #endif
@@ -17,7 +21,22 @@
 #  define assert(x)
 #endif
 
+#ifndef WITH_CONTIKI
+#ifndef WITH_TINYOS
+#include <stdio.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#ifdef HAVE_MMAP
+#include <sys/mman.h>
+#endif /* HAVE_MMAP */
+#endif /* WITH_TINYOS */
+#endif /* WITH_CONTIKI */
+
 #include "debug.h"
+#include "mem.h"
+#include "hashkey.h"
 #include "block.h"
 
 #define min(a,b) ((a) < (b) ? (a) : (b))
@@ -117,4 +136,294 @@ coap_add_block(coap_pdu_t *pdu, unsigned int len, const unsigned char *data,
 		       min(len - start, (unsigned int)(1 << (block_szx + 4))),
 		       data + start);
 }
+
+void
+coap_block_source_buffer(coap_block_source_t *source,
+			 const unsigned char *data, size_t length) {
+  coap_key_t h;
+
+  assert(source);
+  memset(source, 0, sizeof(coap_block_source_t));
+  source->length = length;
+  source->data = data;
+
+  memset(h, 0, sizeof(coap_key_t));
+  coap_hash(data, length, h);
+  memcpy(source->etag, h, sizeof(coap_key_t));
+  source->etag_length = sizeof(coap_key_t);
+}
+
+int
+coap_block_source_read(coap_block_source_t *source, size_t offset,
+		       unsigned char *buf, size_t len) {
+  if (offset >= source->length)
+    return 0;
+  len = min(len, source->length - offset);
+
+  if (source->data) {
+    memcpy(buf, source->data + offset, len);
+    return len;
+  }
+  return source->read ? source->read(source, offset, buf, len) : -1;
+}
+
+int
+coap_add_block_source(coap_pdu_t *pdu, coap_block_source_t *source,
+		      unsigned int block_num, unsigned char block_szx) {
+  size_t start, len;
+  int n;
+
+  assert(pdu);
+  assert(pdu->data == NULL);
+
+  start = (size_t)block_num << (block_szx + 4);
+  if (source->length <= start)
+    return 0;
+  len = min(source->length - start, (size_t)1 << (block_szx + 4));
+
+  if (pdu->length + len + 1 > pdu->max_size) {
+    warn("coap_add_block_source: cannot add: block too large for PDU\n");
+    return 0;
+  }
+
+  /* read the block straight into the payload */
+  pdu->data = (unsigned char *)pdu->hdr + pdu->length;
+  *pdu->data = COAP_PAYLOAD_START;
+  n = coap_block_source_read(source, start, pdu->data + 1, len);
+  if (n <= 0) {
+    debug("coap_add_block_source: cannot read block %u\n", block_num);
+    pdu->data = NULL;
+    return 0;
+  }
+
+  pdu->data++;
+  pdu->length += n + 1;
+  return 1;
+}
+
+unsigned char
+coap_block_sink_store(coap_block_sink_t *sink, coap_pdu_t *request,
+		      coap_block_t *block) {
+  size_t offset, len;
+  unsigned char *data;
+
+  assert(sink);
+
+  coap_get_block(request, COAP_OPTION_BLOCK1, block);
+  coap_get_data(request, &len, &data);
+
+  offset = (size_t)block->num << (block->szx + 4);
+  if (block->m && len != (size_t)1 << (block->szx + 4))
+    return COAP_RESPONSE_CODE(400);
+
+  if (offset == 0) {
+    sink->length = 0;		/* a new upload */
+  } else if (offset != sink->length) {
+    if (offset < sink->length && offset + len == sink->length)
+      return block->m ? COAP_RESPONSE_CODE(231) : COAP_RESPONSE_CODE(204);
+    debug("coap_block_sink_store: expected offset %u, got %u\n",
+	  (unsigned int)sink->length, (unsigned int)offset);
+    return COAP_RESPONSE_CODE(408);
+  }
+
+  if (len && !sink->write(sink, offset, data, len))
+    return COAP_RESPONSE_CODE(500);
+  sink->length = offset + len;
+
+  if (block->m)
+    return COAP_RESPONSE_CODE(231);
+  if (sink->done && !sink->done(sink))
+    return COAP_RESPONSE_CODE(500);
+  return COAP_RESPONSE_CODE(204);
+}
+
+#ifndef WITH_CONTIKI
+#ifndef WITH_TINYOS
+typedef struct {
+  int fd;
+  void *map;			/**< the mapped file, or @c NULL */
+  struct stat st;		/**< the file's status when it was opened */
+  char path[];
+} block_file_t;
+
+static int
+file_read(coap_block_source_t *source, size_t offset,
+	  unsigned char *buf, size_t len) {
+  block_file_t *f = (block_file_t *)source->arg;
+
+  return pread(f->fd, buf, len, offset);
+}
+
+static void
+file_release(block_file_t *f) {
+#ifdef HAVE_MMAP
+  if (f->map)
+    munmap(f->map, f->st.st_size);
+#endif /* HAVE_MMAP */
+  f->map = NULL;
+  if (f->fd >= 0)
+    close(f->fd);
+  f->fd = -1;
+}
+
+static int
+file_open(coap_block_source_t *source, block_file_t *f) {
+  unsigned long long tag;
+  int i;
+
+  f->fd = open(f->path, O_RDONLY);
+  if (f->fd < 0 || fstat(f->fd, &f->st) < 0) {
+    file_release(f);
+    return 0;
+  }
+
+  source->length = f->st.st_size;
+  source->data = NULL;
+  source->read = file_read;
+#ifdef HAVE_MMAP
+  if (f->st.st_size > 0) {
+    f->map = mmap(NULL, f->st.st_size, PROT_READ, MAP_SHARED, f->fd, 0);
+    if (f->map == MAP_FAILED)
+      f->map = NULL;
+    else
+      source->data = f->map;
+  }
+#endif /* HAVE_MMAP */
+
+  tag = (unsigned long long)f->st.st_ino * 0x9e3779b97f4a7c15ULL
+    ^ (unsigned long long)f->st.st_size << 32
+    ^ (unsigned long long)f->st.st_mtime;
+  for (i = 0; i < COAP_BLOCK_ETAG_LENGTH; i++, tag >>= 8)
+    source->etag[i] = tag & 0xff;
+  source->etag_length = COAP_BLOCK_ETAG_LENGTH;
+  return 1;
+}
+
+int
+coap_block_source_file(coap_block_source_t *source, const char *path) {
+  block_file_t *f;
+
+  assert(source);
+  memset(source, 0, sizeof(coap_block_source_t));
+
+  f = (block_file_t *)coap_malloc(sizeof(block_file_t) + strlen(path) + 1);
+  if (!f)
+    return 0;
+  strcpy(f->path, path);
+  f->map = NULL;
+  source->arg = f;
+
+  if (!file_open(source, f)) {
+    debug("coap_block_source_file: cannot open %s\n", path);
+    coap_free(f);
+    source->arg = NULL;
+    return 0;
+  }
+  return 1;
+}
+
+int
+coap_block_source_refresh(coap_block_source_t *source) {
+  block_file_t *f = (block_file_t *)source->arg;
+  struct stat st;
+
+  if (source->read != file_read || stat(f->path, &st) < 0
+      || (st.st_ino == f->st.st_ino && st.st_size == f->st.st_size
+	  && st.st_mtime == f->st.st_mtime))
+    return 0;
+
+  /* Blocks of the old file may still be in flight, but a client that
+   * finds a new ETag starts over. */
+  file_release(f);
+  if (!file_open(source, f)) {
+    source->length = 0;
+    source->data = NULL;
+  }
+  return 1;
+}
+
+void
+coap_block_source_close(coap_block_source_t *source) {
+  if (source && source->read == file_read) {
+    file_release((block_file_t *)source->arg);
+    coap_free(source->arg);
+    memset(source, 0, sizeof(coap_block_source_t));
+  }
+}
+
+typedef struct {
+  int fd;
+  char *part;			/**< where the blocks go */
+  char path[];
+} block_upload_t;
+
+static int
+upload_write(coap_block_sink_t *sink, size_t offset,
+	     const unsigned char *data, size_t len) {
+  block_upload_t *u = (block_upload_t *)sink->arg;
+
+  if (offset == 0) {
+    if (u->fd >= 0)
+      close(u->fd);
+    u->fd = open(u->part, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+  }
+
+  return u->fd >= 0 && pwrite(u->fd, data, len, offset) == (ssize_t)len;
+}
+
+static int
+upload_done(coap_block_sink_t *sink) {
+  block_upload_t *u = (block_upload_t *)sink->arg;
+  int ok;
+
+  if (u->fd < 0 && sink->length == 0) /* an empty upload */
+    u->fd = open(u->part, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+  if (u->fd < 0)
+    return 0;
+
+  /* readers of path keep the old file until they open it again */
+  ok = fsync(u->fd) == 0;
+  close(u->fd);
+  u->fd = -1;
+  return ok && rename(u->part, u->path) == 0;
+}
+
+int
+coap_block_sink_file(coap_block_sink_t *sink, const char *path) {
+  block_upload_t *u;
+  size_t len = strlen(path);
+
+  assert(sink);
+  memset(sink, 0, sizeof(coap_block_sink_t));
+
+  /* path, and path with ".part" appended */
+  u = (block_upload_t *)coap_malloc(sizeof(block_upload_t) + 2 * len + 7);
+  if (!u)
+    return 0;
+  u->fd = -1;
+  strcpy(u->path, path);
+  u->part = u->path + len + 1;
+  strcpy(u->part, path);
+  strcpy(u->part + len, ".part");
+
+  sink->write = upload_write;
+  sink->done = upload_done;
+  sink->arg = u;
+  return 1;
+}
+
+void
+coap_block_sink_close(coap_block_sink_t *sink) {
+  block_upload_t *u;
+
+  if (sink && sink->write == upload_write) {
+    u = (block_upload_t *)sink->arg;
+    if (u->fd >= 0)
+      close(u->fd);
+    coap_free(u);
+    memset(sink, 0, sizeof(coap_block_sink_t));
+  }
+}
+#endif /* WITH_TINYOS */
+#endif /* WITH_CONTIKI */
 #endif /* WITHOUT_BLOCK  */
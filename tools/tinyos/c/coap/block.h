@@ -127,6 +127,142 @@ int coap_write_block_opt(coap_block_t *block, unsigned short type,
  */
 int coap_add_block(coap_pdu_t *pdu, unsigned int len, const unsigned char *data,
 		   unsigned int block_num, unsigned char block_szx);
+
+/** Maximum length of the ETag of a block source. */
+#define COAP_BLOCK_ETAG_LENGTH 8
+
+typedef struct coap_block_source_t coap_block_source_t;
+
+/**
+ * Reads @p len bytes at @p offset of the representation of @p source
+ * into @p buf. Returns the number of bytes read, or a negative value
+ * on error.
+ */
+typedef int (*coap_block_read_t)(coap_block_source_t *source, size_t offset,
+				 unsigned char *buf, size_t len);
+
+/**
+ * A representation that is served block by block. Instead of passing
+ * the whole representation to coap_add_block() for every Block2
+ * request, a resource describes where its bytes are: each request
+ * then produces only the block it asks for. If @c data is set, the
+ * representation is in memory, or mapped from a file, and blocks are
+ * sent from there without copying them into the response. Otherwise,
+ * @c read is called for each block.
+ *
+ * The length and ETag are kept with the source rather than recomputed
+ * per block. A file source checks whether its file has changed when
+ * block 0 is requested, i.e. once per transfer.
+ */
+struct coap_block_source_t {
+  size_t length;		/**< length of the representation */
+  const unsigned char *data;	/**< the representation, if in memory */
+  coap_block_read_t read;	/**< reads the representation otherwise */
+  void *arg;			/**< user data for @c read */
+
+  /** identifies this version of the representation */
+  unsigned char etag[COAP_BLOCK_ETAG_LENGTH];
+  unsigned char etag_length;	/**< length of @c etag, @c 0 for none */
+};
+
+typedef struct coap_block_sink_t coap_block_sink_t;
+
+/**
+ * Stores @p len bytes from @p data at @p offset of the representation
+ * received by @p sink. Returns @c 1 on success, @c 0 otherwise.
+ */
+typedef int (*coap_block_write_t)(coap_block_sink_t *sink, size_t offset,
+				  const unsigned char *data, size_t len);
+
+/**
+ * Where the blocks of a Block1 upload go, in order. @c write is called
+ * for each block as it arrives, and @c done after the last one. An
+ * upload that starts again with block 0 replaces the previous one.
+ */
+struct coap_block_sink_t {
+  coap_block_write_t write;	/**< stores a block */
+  /** called after the last block, returns @c 1 on success */
+  int (*done)(coap_block_sink_t *sink);
+  void *arg;			/**< user data for @c write and @c done */
+  size_t length;		/**< bytes received so far */
+};
+
+/**
+ * Initializes @p source to serve the @p length bytes at @p data. The
+ * ETag is a hash of @p data, computed once here.
+ */
+void coap_block_source_buffer(coap_block_source_t *source,
+			      const unsigned char *data, size_t length);
+
+/**
+ * Reads @p len bytes at @p offset of @p source into @p buf, from @c
+ * data or with @c read. Returns the number of bytes read, or a
+ * negative value on error.
+ */
+int coap_block_source_read(coap_block_source_t *source, size_t offset,
+			   unsigned char *buf, size_t len);
+
+/**
+ * Adds block @p block_num of size 1 << (@p block_szx + 4) of @p source
+ * to @p pdu, reading it directly into the payload. Unlike
+ * coap_add_block(), the caller does not need the whole representation.
+ *
+ * @return @c 1 on success, @c 0 otherwise.
+ */
+int coap_add_block_source(coap_pdu_t *pdu, coap_block_source_t *source,
+			  unsigned int block_num, unsigned char block_szx);
+
+/**
+ * Stores the payload of @p request in @p sink. A request without a
+ * Block1 option is an upload of one block. Blocks must arrive in
+ * order; a retransmission of the last block is accepted again.
+ *
+ * @param sink    The sink to write to.
+ * @param request A PUT or POST request.
+ * @param block   Set to the Block1 option of @p request.
+ * @return The response code: 2.31 when more blocks are expected, 2.04
+ *         when the upload is complete, 4.08 for a block out of order,
+ *         4.00 for a block of the wrong size, or 5.00 if @p sink failed.
+ */
+unsigned char coap_block_sink_store(coap_block_sink_t *sink,
+				    coap_pdu_t *request, coap_block_t *block);
+
+#ifndef WITH_CONTIKI
+#ifndef WITH_TINYOS
+/**
+ * Initializes @p source to serve the file at @p path. The file is
+ * mapped into memory if possible, and read block by block otherwise.
+ * The ETag is derived from the file's inode, size and modification
+ * time.
+ *
+ * @return @c 1 on success, @c 0 if @p path cannot be opened.
+ */
+int coap_block_source_file(coap_block_source_t *source, const char *path);
+
+/**
+ * Checks if the file of @p source has changed since it was opened, and
+ * if so, opens it again. Does nothing for other sources.
+ *
+ * @return @c 1 if the representation has changed, @c 0 otherwise.
+ */
+int coap_block_source_refresh(coap_block_source_t *source);
+
+/** Releases the file of a source from coap_block_source_file(). */
+void coap_block_source_close(coap_block_source_t *source);
+
+/**
+ * Initializes @p sink to write an upload to the file at @p path. The
+ * blocks are written to @p path with ".part" appended, which replaces
+ * @p path when the last block has arrived.
+ *
+ * @return @c 1 on success, @c 0 if memory is low.
+ */
+int coap_block_sink_file(coap_block_sink_t *sink, const char *path);
+
+/** Releases a sink from coap_block_sink_file(). */
+void coap_block_sink_close(coap_block_sink_t *sink);
+#endif /* WITH_TINYOS */
+#endif /* WITH_CONTIKI */
 /**@}*/
 
 #endif /* _COAP_BLOCK_H_ */
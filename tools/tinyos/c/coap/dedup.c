@@ -0,0 +1,167 @@
+/* dedup.c -- answering retransmitted requests from a response cache
+ *
+ * This file is part of the CoAP library libcoap. Please see
+ * README for terms of use.
+ */
+
+#include "config.h"
+
+#include "mem.h"
+#include "debug.h"
+#include "net.h"
+#include "dedup.h"
+
+#ifndef WITHOUT_DEDUP
+
+static inline size_t
+entry_size(coap_dedup_entry_t *e) {
+  return sizeof(coap_dedup_entry_t)
+    + (e->response ? sizeof(coap_pdu_t) + e->response->max_size : 0);
+}
+
+static inline unsigned int
+bucket_of(const coap_address_t *peer, coap_pdu_t *pdu) {
+  coap_tid_t id;
+
+  coap_transaction_id(peer, pdu, &id);
+  return (unsigned short)id % COAP_DEDUP_BUCKETS;
+}
+
+static coap_dedup_entry_t *
+find(coap_dedup_entry_t *e, const coap_address_t *peer, unsigned short id) {
+  for (; e; e = e->next)
+    if (e->id == id && coap_address_equals(&e->peer, peer))
+      return e;
+  return NULL;
+}
+
+/* removes e from its hash bucket */
+static void
+unlink_entry(coap_dedup_t *cache, coap_dedup_entry_t *e) {
+  coap_dedup_entry_t **p;
+
+  p = &cache->bucket[e->bucket];
+  while (*p != e)
+    p = &(*p)->next;
+  *p = e->next;
+  e->bucket = COAP_DEDUP_BUCKETS;
+}
+
+/* removes and frees the oldest entry */
+static void
+remove_oldest(coap_dedup_t *cache) {
+  coap_dedup_entry_t *e = cache->oldest;
+
+  if (e->bucket < COAP_DEDUP_BUCKETS)
+    unlink_entry(cache, e);
+
+  cache->oldest = e->newer;
+  if (!cache->oldest)
+    cache->newest = NULL;
+
+  cache->size -= entry_size(e);
+  coap_delete_pdu(e->response);
+  coap_free(e);
+}
+
+/* evicts the oldest entries, but not keep, until the cache is in budget */
+static void
+shrink(coap_dedup_t *cache, coap_dedup_entry_t *keep) {
+  while (cache->size > COAP_DEDUP_MAX_SIZE && cache->oldest != keep) {
+    remove_oldest(cache);
+    cache->evicted++;
+  }
+}
+
+int
+coap_dedup_request(coap_dedup_t *cache, const coap_address_t *peer,
+		   coap_pdu_t *request, coap_pdu_t **response) {
+  coap_dedup_entry_t *e;
+  unsigned int b;
+  coap_tick_t now;
+
+  coap_ticks(&now);
+  while (cache->oldest &&
+	 now - cache->oldest->created >= COAP_DEDUP_LIFETIME * COAP_TICKS_PER_SECOND)
+    remove_oldest(cache);
+
+  b = bucket_of(peer, request);
+  e = find(cache->bucket[b], peer, request->hdr->id);
+  if (e) {
+    *response = e->response;
+    if (e->response)
+      cache->hits++;
+    else
+      cache->pending++;
+    return 1;
+  }
+
+  cache->misses++;
+  e = (coap_dedup_entry_t *)coap_malloc(sizeof(coap_dedup_entry_t));
+  if (!e) {
+    debug("coap_dedup_request: cannot remember request\n");
+    return 0;
+  }
+
+  memset(e, 0, sizeof(coap_dedup_entry_t));
+  e->created = now;
+  memcpy(&e->peer, peer, sizeof(coap_address_t));
+  e->id = request->hdr->id;
+  e->bucket = b;
+
+  e->next = cache->bucket[b];
+  cache->bucket[b] = e;
+  if (cache->newest)
+    cache->newest->newer = e;
+  else
+    cache->oldest = e;
+  cache->newest = e;
+
+  cache->size += entry_size(e);
+  shrink(cache, e);
+  return 0;
+}
+
+void
+coap_dedup_response(coap_dedup_t *cache, const coap_address_t *peer,
+		    coap_pdu_t *response) {
+  coap_dedup_entry_t *e;
+  coap_pdu_t *copy;
+
+  e = find(cache->bucket[bucket_of(peer, response)], peer, response->hdr->id);
+  if (!e)
+    return;
+
+  copy = coap_pdu_init(0, 0, 0, response->length);
+  if (!copy) {
+    debug("coap_dedup_response: cannot keep response\n");
+    return;
+  }
+  memcpy(copy->hdr, response->hdr, response->length);
+  copy->length = response->length;
+
+  cache->size -= entry_size(e);
+  coap_delete_pdu(e->response);
+  e->response = copy;
+  cache->size += entry_size(e);
+  shrink(cache, e);
+}
+
+void
+coap_dedup_forget(coap_dedup_t *cache, const coap_address_t *peer,
+		  coap_pdu_t *response) {
+  coap_dedup_entry_t *e;
+
+  e = find(cache->bucket[bucket_of(peer, response)], peer, response->hdr->id);
+  /* the entry stays in the list until it expires, but is not found */
+  if (e)
+    unlink_entry(cache, e);
+}
+
+void
+coap_dedup_clear(coap_dedup_t *cache) {
+  while (cache->oldest)
+    remove_oldest(cache);
+}
+
+#endif /* WITHOUT_DEDUP */
@@ -0,0 +1,133 @@
+/* dedup.h -- answering retransmitted requests from a response cache
+ *
+ * This file is part of the CoAP library libcoap. Please see
+ * README for terms of use.
+ */
+
+/**
+ * @file dedup.h
+ * @brief answering retransmitted requests from a response cache
+ */
+
+#ifndef _COAP_DEDUP_H_
+#define _COAP_DEDUP_H_
+
+#include "config.h"
+#include "address.h"
+#include "pdu.h"
+#include "coap_time.h"
+
+/* Contiki has no heap for the cached responses. */
+#if defined(WITH_CONTIKI) && !defined(WITHOUT_DEDUP)
+#define WITHOUT_DEDUP
+#endif /* WITH_CONTIKI */
+
+#ifndef WITHOUT_DEDUP
+
+/**
+ * @defgroup dedup Duplicate Detection
+ * @{
+ * A client retransmits a confirmable request when our ACK or response
+ * is lost. Rather than calling the resource handler again, the context
+ * remembers each confirmable request by peer and message id for
+ * #COAP_DEDUP_LIFETIME seconds, together with the ACK that answered
+ * it, and sends that ACK again. A retransmission that arrives before
+ * the request has been answered is dropped: the answer is still to
+ * come.
+ *
+ * All entries live equally long, so they expire in the order they were
+ * made: the cache keeps them in a list from oldest to newest, and
+ * expiring or evicting takes the head. A hash table by transaction id
+ * finds them. When the entries and their responses would take more
+ * than #COAP_DEDUP_MAX_SIZE bytes, the oldest are evicted early.
+ */
+
+#ifndef COAP_DEDUP_LIFETIME
+/**
+ * Seconds a request is remembered: EXCHANGE_LIFETIME, the time from
+ * the first transmission of a confirmable message until its sender
+ * gives up on it, with the default transmission parameters.
+ */
+#define COAP_DEDUP_LIFETIME 247
+#endif /* COAP_DEDUP_LIFETIME */
+
+#ifndef COAP_DEDUP_MAX_SIZE
+/** Memory budget of the cache in bytes, including its entries. */
+#ifdef WITH_TINYOS
+#define COAP_DEDUP_MAX_SIZE 512
+#else /* WITH_TINYOS */
+#define COAP_DEDUP_MAX_SIZE 65536
+#endif /* WITH_TINYOS */
+#endif /* COAP_DEDUP_MAX_SIZE */
+
+#ifndef COAP_DEDUP_BUCKETS
+/** Number of hash buckets. */
+#ifdef WITH_TINYOS
+#define COAP_DEDUP_BUCKETS 8
+#else /* WITH_TINYOS */
+#define COAP_DEDUP_BUCKETS 256
+#endif /* WITH_TINYOS */
+#endif /* COAP_DEDUP_BUCKETS */
+
+typedef struct coap_dedup_entry_t {
+  struct coap_dedup_entry_t *next;  /**< next in the same hash bucket */
+  struct coap_dedup_entry_t *newer; /**< next younger entry */
+  coap_tick_t created;		/**< when the request was first seen */
+  coap_address_t peer;		/**< the client */
+  unsigned short id;		/**< message id, in network byte order */
+  unsigned short bucket;	/**< hash bucket, #COAP_DEDUP_BUCKETS if none */
+  coap_pdu_t *response;		/**< the ACK sent, or @c NULL if none yet */
+} coap_dedup_entry_t;
+
+typedef struct {
+  coap_dedup_entry_t *bucket[COAP_DEDUP_BUCKETS];
+  coap_dedup_entry_t *oldest, *newest;
+  size_t size;			/**< bytes in use */
+
+  unsigned long hits;		/**< retransmissions answered from the cache */
+  unsigned long pending;	/**< retransmissions dropped, no answer yet */
+  unsigned long misses;		/**< new requests recorded */
+  unsigned long evicted;	/**< entries removed early to stay in budget */
+} coap_dedup_t;
+
+/**
+ * Looks up the confirmable @p request from @p peer. If it was seen
+ * before, @p *response is set to the ACK that was sent in reply, or to
+ * @c NULL if there was none yet, and @c 1 is returned: the caller should
+ * send @p *response, if any, and drop @p request. Otherwise, the
+ * request is remembered and @c 0 is returned. Expired entries are
+ * removed on the way.
+ *
+ * @param cache    The cache to use.
+ * @param peer     The sender of @p request.
+ * @param request  A confirmable request.
+ * @param response Set to the cached response, owned by the cache.
+ * @return @c 1 if @p request is a retransmission, @c 0 otherwise.
+ */
+int coap_dedup_request(coap_dedup_t *cache, const coap_address_t *peer,
+		       coap_pdu_t *request, coap_pdu_t **response);
+
+/**
+ * Keeps a copy of the ACK @p response sent to @p peer with the request
+ * it answers, if that is in the cache. A later ACK for the same
+ * request replaces an earlier one.
+ */
+void coap_dedup_response(coap_dedup_t *cache, const coap_address_t *peer,
+			 coap_pdu_t *response);
+
+/**
+ * Forgets the request answered by @p response to @p peer, so that a
+ * retransmission is handled as a new request. This is for responses
+ * that are cheaper to produce again than to keep.
+ */
+void coap_dedup_forget(coap_dedup_t *cache, const coap_address_t *peer,
+		       coap_pdu_t *response);
+
+/** Removes all entries from @p cache. The counters are kept. */
+void coap_dedup_clear(coap_dedup_t *cache);
+
+/** @} */
+
+#endif /* WITHOUT_DEDUP */
+
+#endif /* _COAP_DEDUP_H_ */
@@ -27,6 +27,10 @@
 #include "resource.h"
 #include "coap.h"
 
+#ifdef HAVE_PTHREAD_H
+#include <pthread.h>
+#endif
+
 #define COAP_RESOURCE_CHECK_TIME 2
 
 #ifndef min
@@ -41,8 +45,12 @@ static time_t my_clock_base = 0;
 
 #ifndef WITHOUT_ASYNC
 /* This variable is used to mimic long-running tasks that require
- * asynchronous responses. */
+ * asynchronous responses. Each worker thread has its own. */
+#ifdef HAVE_PTHREAD_H
+static __thread coap_async_state_t *async = NULL;
+#else /* HAVE_PTHREAD_H */
 static coap_async_state_t *async = NULL;
+#endif /* HAVE_PTHREAD_H */
 #endif /* WITHOUT_ASYNC */
 
 /* SIGINT handler: set quit to 1 for graceful termination */
@@ -296,15 +304,17 @@ usage( const char *program, const char *version) {
 
   fprintf( stderr, "%s v%s -- a small CoAP implementation\n"
 	   "(c) 2010,2011 Olaf Bergmann <bergmann@tzi.org>\n\n"
-	   "usage: %s [-A address] [-p port]\n\n"
+	   "usage: %s [-A address] [-p port] [-t threads]\n\n"
 	   "\t-A address\tinterface address to bind to\n"
 	   "\t-p port\t\tlisten on specified port\n"
+	   "\t-t threads\tserve from this many threads, each with its own\n"
+	   "\t\t\tcontext and resources (default: 1)\n"
 	   "\t-v num\t\tverbosity level (default: 3)\n",
 	   program, version, program );
 }
 
 coap_context_t *
-get_context(const char *node, const char *port) {
+get_context(const char *node, const char *port, int shared) {
   coap_context_t *ctx = NULL;  
   int s;
   struct addrinfo hints;
@@ -330,7 +340,11 @@ get_context(const char *node, const char *port) {
       addr.size = rp->ai_addrlen;
       memcpy(&addr.addr, rp->ai_addr, rp->ai_addrlen);
 
+#ifdef HAVE_PTHREAD_H
+      ctx = shared ? coap_new_context_reuseport(&addr) : coap_new_context(&addr);
+#else /* HAVE_PTHREAD_H */
       ctx = coap_new_context(&addr);
+#endif /* HAVE_PTHREAD_H */
       if (ctx) {
 	/* TODO: output address:port for successful binding */
 	goto finish;
@@ -345,47 +359,16 @@ get_context(const char *node, const char *port) {
   return ctx;
 }
 
-int
-main(int argc, char **argv) {
-  coap_context_t  *ctx;
+/* Serves requests on ctx until SIGINT. With several threads, each runs
+ * this loop on its own context. */
+void *
+serve(void *arg) {
+  coap_context_t  *ctx = (coap_context_t *)arg;
   fd_set readfds;
   struct timeval tv, *timeout;
   int result;
   coap_tick_t now;
   coap_queue_t *nextpdu;
-  char addr_str[NI_MAXHOST] = "::";
-  char port_str[NI_MAXSERV] = "5683";
-  int opt;
-  coap_log_t log_level = LOG_WARN;
-
-  while ((opt = getopt(argc, argv, "A:p:v:")) != -1) {
-    switch (opt) {
-    case 'A' :
-      strncpy(addr_str, optarg, NI_MAXHOST-1);
-      addr_str[NI_MAXHOST - 1] = '\0';
-      break;
-    case 'p' :
-      strncpy(port_str, optarg, NI_MAXSERV-1);
-      port_str[NI_MAXSERV - 1] = '\0';
-      break;
-    case 'v' :
-      log_level = strtol(optarg, NULL, 10);
-      break;
-    default:
-      usage( argv[0], PACKAGE_VERSION );
-      exit( 1 );
-    }
-  }
-
-  coap_set_log_level(log_level);
-
-  ctx = get_context(addr_str, port_str);
-  if (!ctx)
-    return -1;
-
-  init_resources(ctx);
-
-  signal(SIGINT, handle_sigint);
 
   while ( !quit ) {
     FD_ZERO(&readfds);
@@ -416,7 +399,7 @@ main(int argc, char **argv) {
 	perror("select");
     } else if ( result > 0 ) {	/* read from socket */
       if ( FD_ISSET( ctx->sockfd, &readfds ) ) {
-	coap_read( ctx );	/* read received data */
+	coap_read_batch( ctx );	/* read received data */
 	coap_dispatch( ctx );	/* and dispatch PDUs from receivequeue */
       }
     } else {			/* timeout */
@@ -435,6 +418,83 @@ main(int argc, char **argv) {
   }
 
   coap_free_context( ctx );
+  return NULL;
+}
+
+int
+main(int argc, char **argv) {
+  coap_context_t  *ctx;
+  char addr_str[NI_MAXHOST] = "::";
+  char port_str[NI_MAXSERV] = "5683";
+  int opt;
+  coap_log_t log_level = LOG_WARN;
+  int threads = 1;
+#ifdef HAVE_PTHREAD_H
+  pthread_t *workers;
+  int i;
+#endif /* HAVE_PTHREAD_H */
+
+  while ((opt = getopt(argc, argv, "A:p:t:v:")) != -1) {
+    switch (opt) {
+    case 'A' :
+      strncpy(addr_str, optarg, NI_MAXHOST-1);
+      addr_str[NI_MAXHOST - 1] = '\0';
+      break;
+    case 'p' :
+      strncpy(port_str, optarg, NI_MAXSERV-1);
+      port_str[NI_MAXSERV - 1] = '\0';
+      break;
+    case 't' :
+      threads = strtol(optarg, NULL, 10);
+      break;
+    case 'v' :
+      log_level = strtol(optarg, NULL, 10);
+      break;
+    default:
+      usage( argv[0], PACKAGE_VERSION );
+      exit( 1 );
+    }
+  }
+
+  coap_set_log_level(log_level);
+  signal(SIGINT, handle_sigint);
+
+#ifdef HAVE_PTHREAD_H
+  if (threads > 1) {
+    /* one context per thread on the same port: the kernel hands each
+     * peer's datagrams to one of them */
+    workers = malloc(threads * sizeof(pthread_t));
+    if (!workers)
+      return -1;
+
+    for (i = 0; i < threads; i++) {
+      ctx = get_context(addr_str, port_str, 1);
+      if (!ctx)
+	return -1;
+
+      init_resources(ctx);
+      if (pthread_create(&workers[i], NULL, serve, ctx) != 0) {
+	perror("pthread_create");
+	return -1;
+      }
+    }
+
+    for (i = 0; i < threads; i++)
+      pthread_join(workers[i], NULL);
+    free(workers);
+    return 0;
+  }
+#else /* HAVE_PTHREAD_H */
+  if (threads > 1)
+    fprintf(stderr, "no thread support, serving from one thread\n");
+#endif /* HAVE_PTHREAD_H */
+
+  ctx = get_context(addr_str, port_str, 0);
+  if (!ctx)
+    return -1;
+
+  init_resources(ctx);
+  serve(ctx);
 
   return 0;
 }
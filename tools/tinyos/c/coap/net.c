@@ -8,7 +8,15 @@
 
 #include "config.h"
 
+#if defined(HAVE_RECVMMSG) && !defined(WITH_CONTIKI) && !defined(WITH_TINYOS)
+#define COAP_RECVMMSG
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE		/* for recvmmsg() */
+#endif
+#endif /* HAVE_RECVMMSG */
+
 #include <ctype.h>
+#include <errno.h>
 #include <stdio.h>
 #ifdef HAVE_UNISTD_H
 #include <unistd.h>
@@ -25,6 +33,9 @@
 #ifdef HAVE_ARPA_INET_H
 #include <arpa/inet.h>
 #endif
+#if !defined(WITH_CONTIKI) && !defined(WITH_TINYOS)
+#include <sys/uio.h>
+#endif
 
 #include "debug.h"
 #include "mem.h"
@@ -175,6 +186,159 @@ coap_new_node() {
   return node;
 }
 
+/* The sendqueue is a pairing heap ordered by t, so that adding a
+ * message or removing any of them does not walk the queue. The
+ * transaction index finds a message by id in the same way. */
+
+/* melds the heaps a and b, whose roots have no siblings */
+static coap_queue_t *
+heap_meld(coap_queue_t *a, coap_queue_t *b) {
+  coap_queue_t *tmp;
+
+  if ( !a )
+    return b;
+  if ( !b )
+    return a;
+
+  /* on a tie, the node that was queued first stays on top */
+  if ( b->t < a->t ) {
+    tmp = a;
+    a = b;
+    b = tmp;
+  }
+
+  b->next = a->child;
+  if ( a->child )
+    a->child->prev = b;
+  b->prev = a;
+  a->child = b;
+  return a;
+}
+
+/* melds the list of heaps starting at first in two passes: pairs from
+ * the left, then the pairs from the right */
+static coap_queue_t *
+heap_merge_pairs(coap_queue_t *first) {
+  coap_queue_t *a, *b, *pairs = NULL, *root = NULL;
+
+  while ( first ) {
+    a = first;
+    b = a->next;
+    first = b ? b->next : NULL;
+    a->next = a->prev = NULL;
+    if ( b )
+      b->next = b->prev = NULL;
+    a = heap_meld(a, b);
+    a->next = pairs;
+    pairs = a;
+  }
+
+  while ( pairs ) {
+    a = pairs;
+    pairs = a->next;
+    a->next = NULL;
+    root = heap_meld(root, a);
+  }
+  return root;
+}
+
+static void
+heap_remove(coap_queue_t **heap, coap_queue_t *node) {
+  coap_queue_t *sub;
+
+  sub = heap_merge_pairs(node->child);
+  if ( node == *heap ) {
+    *heap = sub;
+  } else {
+    /* unlink node from its parent's children */
+    if ( node->prev->child == node )
+      node->prev->child = node->next;
+    else
+      node->prev->next = node->next;
+    if ( node->next )
+      node->next->prev = node->prev;
+    *heap = heap_meld(*heap, sub);
+  }
+  node->next = node->prev = node->child = NULL;
+}
+
+static void
+heap_delete_all(coap_queue_t *node) {
+  coap_queue_t *next, *last;
+
+  while ( node ) {
+    /* a heap can be as deep as it is large, so rather than recurse,
+     * move node's children in front of its siblings */
+    if ( node->child ) {
+      for (last = node->child; last->next; last = last->next)
+	;
+      last->next = node->next;
+      node->next = node->child;
+    }
+    next = node->next;
+    coap_delete_node(node);
+    node = next;
+  }
+}
+
+#ifdef WITH_CONTIKI
+/* Contiki has no transaction index; its few nodes are searched */
+static coap_queue_t *
+heap_find(coap_queue_t *node, coap_tid_t id) {
+  coap_queue_t *found;
+
+  for (; node; node = node->next) {
+    if ( node->id == id )
+      return node;
+    if ( (found = heap_find(node->child, id)) )
+      return found;
+  }
+  return NULL;
+}
+#endif /* WITH_CONTIKI */
+
+/* adds node to the sendqueue of context and its transaction index */
+static void
+coap_insert_sent(coap_context_t *context, coap_queue_t *node) {
+  node->next = node->prev = node->child = NULL;
+  context->sendqueue = heap_meld(context->sendqueue, node);
+#ifndef WITH_CONTIKI
+  HASH_ADD_INT(context->sendindex, id, node);
+#endif /* WITH_CONTIKI */
+}
+
+coap_queue_t *
+coap_find_sent(coap_context_t *context, coap_tid_t id) {
+  coap_queue_t *node;
+
+  if ( !context )
+    return NULL;
+
+#ifndef WITH_CONTIKI
+  HASH_FIND_INT(context->sendindex, &id, node);
+#else /* WITH_CONTIKI */
+  node = heap_find(context->sendqueue, id);
+#endif /* WITH_CONTIKI */
+  return node;
+}
+
+int
+coap_remove_sent(coap_context_t *context, coap_tid_t id, coap_queue_t **node) {
+  coap_queue_t *q;
+
+  q = coap_find_sent(context, id);
+  if ( !q )
+    return 0;
+
+  heap_remove(&context->sendqueue, q);
+#ifndef WITH_CONTIKI
+  HASH_DEL(context->sendindex, q);
+#endif /* WITH_CONTIKI */
+  *node = q;
+  debug("*** removed transaction %u\n", id);
+  return 1;
+}
+
 coap_queue_t *
 coap_peek_next( coap_context_t *context ) {
   if ( !context || !context->sendqueue )
@@ -191,8 +355,10 @@ coap_pop_next( coap_context_t *context ) {
     return NULL;
 
   next = context->sendqueue;
-  context->sendqueue = context->sendqueue->next;
-  next->next = NULL;
+  heap_remove(&context->sendqueue, next);
+#ifndef WITH_CONTIKI
+  HASH_DEL(context->sendindex, next);
+#endif /* WITH_CONTIKI */
   return next;
 }
 
@@ -222,8 +388,8 @@ is_wkc(coap_key_t k) {
 }
 #endif /* WITHOUT_WELLKNOWN */
 
-coap_context_t *
-coap_new_context(const coap_address_t *listen_addr) {
+static coap_context_t *
+new_context(const coap_address_t *listen_addr, int reuseport) {
 #ifndef WITH_CONTIKI
   coap_context_t *c = coap_malloc( sizeof( coap_context_t ) );
 #ifndef WITH_TINYOS
@@ -304,6 +470,22 @@ coap_new_context(const coap_address_t *listen_addr) {
 #endif
   }
 
+  if ( reuseport ) {
+#ifdef SO_REUSEPORT
+    if ( setsockopt( c->sockfd, SOL_SOCKET, SO_REUSEPORT, &reuse, sizeof(reuse) ) < 0 ) {
+#ifndef NDEBUG
+      coap_log(LOG_EMERG, "setsockopt SO_REUSEPORT");
+#endif
+      goto onerror;
+    }
+#else /* SO_REUSEPORT */
+#ifndef NDEBUG
+    coap_log(LOG_EMERG, "coap_new_context: SO_REUSEPORT not supported\n");
+#endif
+    goto onerror;
+#endif /* SO_REUSEPORT */
+  }
+
   if (bind(c->sockfd, &listen_addr->addr.sa, listen_addr->size) < 0) {
 #ifndef NDEBUG
     coap_log(LOG_EMERG, "coap_new_context: bind");
@@ -344,6 +526,18 @@ coap_new_context(const coap_address_t *listen_addr) {
 #endif /* WITH_TINYOS */
 }
 
+coap_context_t *
+coap_new_context(const coap_address_t *listen_addr) {
+  return new_context(listen_addr, 0);
+}
+
+#if !defined(WITH_CONTIKI) && !defined(WITH_TINYOS)
+coap_context_t *
+coap_new_context_reuseport(const coap_address_t *listen_addr) {
+  return new_context(listen_addr, 1);
+}
+#endif /* !WITH_CONTIKI && !WITH_TINYOS */
+
 void
 coap_free_context( coap_context_t *context ) {
 #ifndef WITH_CONTIKI
@@ -355,7 +549,13 @@ coap_free_context( coap_context_t *context ) {
     return;
 
   coap_delete_all(context->recvqueue);
-  coap_delete_all(context->sendqueue);
+#ifndef WITHOUT_DEDUP
+  coap_dedup_clear(&context->dedup);
+#endif /* WITHOUT_DEDUP */
+#ifndef WITH_CONTIKI
+  HASH_CLEAR(hh, context->sendindex);
+#endif /* WITH_CONTIKI */
+  heap_delete_all(context->sendqueue);
 
 #ifndef WITH_CONTIKI
   HASH_ITER(hh, context->resources, res, rtmp) {
@@ -365,6 +565,7 @@ coap_free_context( coap_context_t *context ) {
   /* coap_delete_list(context->subscriptions); */
 #ifndef WITH_TINYOS
   close( context->sockfd );
+  coap_free( context->recv_arena );
 #endif /* WITH_TINYOS */
   //TODO: TinyOS: delete resources???
   coap_free( context );
@@ -539,6 +740,11 @@ coap_tid_t
 coap_send(coap_context_t *context, 
 	  const coap_address_t *dst, 
 	  coap_pdu_t *pdu) {
+#ifndef WITHOUT_DEDUP
+  /* keep the answer to a confirmable request for its retransmissions */
+  if (context && dst && pdu && pdu->hdr->type == COAP_MESSAGE_ACK)
+    coap_dedup_response(&context->dedup, dst, pdu);
+#endif /* WITHOUT_DEDUP */
   return coap_send_impl(context, dst, pdu);
 }
 
@@ -620,8 +826,7 @@ coap_send_confirmed(coap_context_t *context,
   memcpy(&node->remote, dst, sizeof(coap_address_t));
   node->pdu = pdu;
 
-  assert(&context->sendqueue);
-  coap_insert_node(&context->sendqueue, node, _order_timestamp);
+  coap_insert_sent(context, node);
 
 #ifdef WITH_CONTIKI
   {			    /* (re-)initialize retransmission timer */
@@ -664,7 +869,7 @@ coap_retransmit( coap_context_t *context, coap_queue_t *node ) {
   if ( node->retransmit_cnt < COAP_DEFAULT_MAX_RETRANSMIT ) {
     node->retransmit_cnt++;
     node->t += ( node->timeout << node->retransmit_cnt );
-    coap_insert_node( &context->sendqueue, node, _order_timestamp );
+    coap_insert_sent( context, node );
 
 #ifndef WITH_CONTIKI
     debug("** retransmission #%d of transaction %d\n",
@@ -674,8 +879,9 @@ coap_retransmit( coap_context_t *context, coap_queue_t *node ) {
 	  node->retransmit_cnt, uip_ntohs(node->pdu->hdr->id));
 #endif /* WITH_CONTIKI */
 
-    node->id = coap_send_impl(context, &node->remote, node->pdu);
-    return node->id;
+    /* node->id is its index key, which a failed send must not
+     * overwrite; the id is the same for every copy sent */
+    return coap_send_impl(context, &node->remote, node->pdu);
   }
 
   /* no more retransmissions, remove node from system */
@@ -722,56 +928,17 @@ check_opt_size(coap_opt_t *opt, unsigned char *maxpos) {
   return 0;
 }
 
-int
-coap_read( coap_context_t *ctx ) {
-#ifndef WITH_CONTIKI
-  static char buf[COAP_MAX_PDU_SIZE];
+/**
+ * Checks the datagram of @p bytes_read bytes in @p buf received from
+ * @p src and adds it to @p ctx's receive queue if it is a CoAP PDU.
+ * Returns @c 0 on success, @c -1 otherwise.
+ */
+static int
+coap_handle_datagram(coap_context_t *ctx, char *buf, ssize_t bytes_read,
+		     coap_address_t *src, coap_address_t *dst) {
   coap_hdr_t *pdu = (coap_hdr_t *)buf;
-#else /* WITH_CONTIKI */
-  char *buf;
-  coap_hdr_t *pdu;
-#endif /* WITH_CONTIKI */
-  ssize_t bytes_read = -1;
-  coap_address_t src, dst;
   coap_queue_t *node;
 
-#ifdef WITH_CONTIKI
-  buf = uip_appdata;
-  pdu = (coap_hdr_t *)buf;
-#endif /* WITH_CONTIKI */
-
-  coap_address_init(&src);
-
-#ifndef WITH_CONTIKI
-#ifndef WITH_TINYOS
-  bytes_read = recvfrom(ctx->sockfd, buf, sizeof(buf), 0,
-			&src.addr.sa, &src.size);
-#endif /* WITH_CONTIKI */
-#endif /* WITH_TINYOS */
-
-#ifdef WITH_CONTIKI
-  if(uip_newdata()) {
-    uip_ipaddr_copy(&src.addr, &UIP_IP_BUF->srcipaddr);
-    src.port = UIP_UDP_BUF->srcport;
-    uip_ipaddr_copy(&dst.addr, &UIP_IP_BUF->destipaddr);
-    dst.port = UIP_UDP_BUF->destport;
-
-    bytes_read = uip_datalen();
-    ((char *)uip_appdata)[bytes_read] = 0;
-    PRINTF("Server received %d bytes from [", (int)bytes_read);
-    PRINT6ADDR(&src.addr);
-    PRINTF("]:%d\n", uip_ntohs(src.port));
-  } 
-#endif /* WITH_CONTIKI */
-
-#ifdef WITH_TINYOS
-  bytes_read = ctx->bytes_read;
-  memcpy(buf, ctx->buf, bytes_read);
-
-  memcpy(&src, &(ctx->src), sizeof (coap_address_t));
-  // port included?
-#endif /* WITH_TINYOS */
-
   if ( bytes_read < 0 ) {
     warn("coap_read: recvfrom");
     return -1;
@@ -796,8 +963,8 @@ coap_read( coap_context_t *ctx ) {
     goto error;
 
   coap_ticks( &node->t );
-  memcpy(&node->local, &dst, sizeof(coap_address_t));
-  memcpy(&node->remote, &src, sizeof(coap_address_t));
+  memcpy(&node->local, dst, sizeof(coap_address_t));
+  memcpy(&node->remote, src, sizeof(coap_address_t));
 
 if (!coap_pdu_parse((unsigned char *)buf, bytes_read, node->pdu)) {
     warn("discard malformed PDU");
@@ -806,7 +973,11 @@ if (!coap_pdu_parse((unsigned char *)buf, bytes_read, node->pdu)) {
 
   /* and add new node to receive queue */
   coap_transaction_id(&node->remote, node->pdu, &node->id);
-  coap_insert_node(&ctx->recvqueue, node, _order_timestamp);
+  if ( ctx->recvqueue )
+    ctx->recvqueue_last->next = node;
+  else
+    ctx->recvqueue = node;
+  ctx->recvqueue_last = node;
 
 #ifndef NDEBUG
   if (LOG_DEBUG <= coap_get_log_level()) {
@@ -815,7 +986,7 @@ if (!coap_pdu_parse((unsigned char *)buf, bytes_read, node->pdu)) {
 #endif
     unsigned char addr[INET6_ADDRSTRLEN+8];
 
-    if (coap_print_addr(&src, addr, INET6_ADDRSTRLEN+8))
+    if (coap_print_addr(src, addr, INET6_ADDRSTRLEN+8))
       debug("** received %d bytes from %s:\n", (int)bytes_read, addr);
 
     coap_show_pdu( node->pdu );
@@ -829,6 +1000,125 @@ if (!coap_pdu_parse((unsigned char *)buf, bytes_read, node->pdu)) {
   return -1;
 }
 
+int
+coap_read( coap_context_t *ctx ) {
+#ifdef WITH_TINYOS
+  static char buf[COAP_MAX_PDU_SIZE];
+#elif !defined(WITH_CONTIKI)
+  /* on the stack, so that contexts can be used from several threads */
+  char buf[COAP_MAX_PDU_SIZE];
+#else /* WITH_CONTIKI */
+  char *buf;
+#endif /* WITH_CONTIKI */
+  ssize_t bytes_read = -1;
+  coap_address_t src, dst;
+
+#ifdef WITH_CONTIKI
+  buf = uip_appdata;
+#endif /* WITH_CONTIKI */
+
+  coap_address_init(&src);
+  coap_address_init(&dst);
+
+#ifndef WITH_CONTIKI
+#ifndef WITH_TINYOS
+  bytes_read = recvfrom(ctx->sockfd, buf, sizeof(buf), 0,
+			&src.addr.sa, &src.size);
+#endif /* WITH_CONTIKI */
+#endif /* WITH_TINYOS */
+
+#ifdef WITH_CONTIKI
+  if(uip_newdata()) {
+    uip_ipaddr_copy(&src.addr, &UIP_IP_BUF->srcipaddr);
+    src.port = UIP_UDP_BUF->srcport;
+    uip_ipaddr_copy(&dst.addr, &UIP_IP_BUF->destipaddr);
+    dst.port = UIP_UDP_BUF->destport;
+
+    bytes_read = uip_datalen();
+    ((char *)uip_appdata)[bytes_read] = 0;
+    PRINTF("Server received %d bytes from [", (int)bytes_read);
+    PRINT6ADDR(&src.addr);
+    PRINTF("]:%d\n", uip_ntohs(src.port));
+  } 
+#endif /* WITH_CONTIKI */
+
+#ifdef WITH_TINYOS
+  bytes_read = ctx->bytes_read;
+  memcpy(buf, ctx->buf, bytes_read);
+
+  memcpy(&src, &(ctx->src), sizeof (coap_address_t));
+  // port included?
+#endif /* WITH_TINYOS */
+
+  return coap_handle_datagram(ctx, buf, bytes_read, &src, &dst);
+}
+
+#ifdef COAP_RECVMMSG
+/** Receive buffers for coap_read_batch(), allocated on first use. */
+struct coap_recv_arena_t {
+  struct mmsghdr msg[COAP_RECV_BATCH];
+  struct iovec iov[COAP_RECV_BATCH];
+  coap_address_t src[COAP_RECV_BATCH];
+  char buf[COAP_RECV_BATCH][COAP_MAX_PDU_SIZE];
+};
+
+/* at most this many batches per call, so that a busy socket does not
+ * hold up retransmissions and notifications */
+#define COAP_RECV_MAX_BATCHES 4
+
+int
+coap_read_batch( coap_context_t *ctx ) {
+  struct coap_recv_arena_t *arena = ctx->recv_arena;
+  coap_address_t dst;
+  int i, n, batches = 0, received = 0, queued = 0;
+
+  if ( !arena ) {
+    arena = coap_malloc(sizeof(struct coap_recv_arena_t));
+    if ( !arena )
+      return coap_read(ctx) < 0 ? -1 : 1;
+
+    memset(arena, 0, sizeof(struct coap_recv_arena_t));
+    for (i = 0; i < COAP_RECV_BATCH; i++) {
+      arena->iov[i].iov_base = arena->buf[i];
+      arena->iov[i].iov_len = COAP_MAX_PDU_SIZE;
+      arena->msg[i].msg_hdr.msg_iov = &arena->iov[i];
+      arena->msg[i].msg_hdr.msg_iovlen = 1;
+      arena->msg[i].msg_hdr.msg_name = &arena->src[i].addr;
+    }
+    ctx->recv_arena = arena;
+  }
+
+  coap_address_init(&dst);
+  do {
+    for (i = 0; i < COAP_RECV_BATCH; i++)
+      arena->msg[i].msg_hdr.msg_namelen = sizeof(arena->src[i].addr);
+
+    n = recvmmsg(ctx->sockfd, arena->msg, COAP_RECV_BATCH, MSG_DONTWAIT, 
+		 NULL);
+    if ( n < 0 ) {
+      if ( errno != EAGAIN && errno != EWOULDBLOCK )
+	warn("coap_read_batch: recvmmsg");
+      break;
+    }
+
+    for (i = 0; i < n; i++) {
+      arena->src[i].size = arena->msg[i].msg_hdr.msg_namelen;
+      if (coap_handle_datagram(ctx, arena->buf[i], arena->msg[i].msg_len,
+			       &arena->src[i], &dst) == 0)
+	queued++;
+    }
+    received += n;
+  } while ( n == COAP_RECV_BATCH && ++batches < COAP_RECV_MAX_BATCHES );
+
+  return received ? queued : -1;
+}
+#else /* COAP_RECVMMSG */
+int
+coap_read_batch( coap_context_t *ctx ) {
+  return coap_read(ctx) < 0 ? -1 : 1;
+}
+#endif /* COAP_RECVMMSG */
+
 int
 coap_remove_from_queue(coap_queue_t **queue, coap_tid_t id, coap_queue_t **node) {
   coap_queue_t *p, *q;
@@ -1017,6 +1307,184 @@ void led2On();
 */
 #endif /* WITH_TINYOS */
 
+#ifndef WITHOUT_BLOCK
+/** Block size for a source when the client does not ask for one, 1024 bytes. */
+#define COAP_BLOCK_SZX_DEFAULT 6
+
+static inline coap_pdu_t *
+new_response(coap_queue_t *node, unsigned char code) {
+  coap_pdu_t *response;
+
+  response = coap_pdu_init(node->pdu->hdr->type == COAP_MESSAGE_CON
+			   ? COAP_MESSAGE_ACK
+			   : COAP_MESSAGE_NON,
+			   code, node->pdu->hdr->id, COAP_MAX_PDU_SIZE);
+  if (response && !coap_add_token(response, node->pdu->hdr->token_length,
+				  node->pdu->hdr->token)) {
+    coap_delete_pdu(response);
+    response = NULL;
+  }
+  return response;
+}
+
+#ifndef WITH_CONTIKI
+#ifndef WITH_TINYOS
+/* Sends response, which has no payload yet, with len bytes at data as
+ * payload. The data is sent from where it is rather than copied into
+ * response. */
+static coap_tid_t
+send_gather(coap_context_t *context, const coap_address_t *dst,
+	    coap_pdu_t *response, const unsigned char *data, size_t len) {
+  struct iovec iov[2];
+  struct msghdr msg;
+  coap_tid_t id = COAP_INVALID_TID;
+
+  *((unsigned char *)response->hdr + response->length) = COAP_PAYLOAD_START;
+  iov[0].iov_base = response->hdr;
+  iov[0].iov_len = response->length + 1;
+  iov[1].iov_base = (void *)data;
+  iov[1].iov_len = len;
+
+  memset(&msg, 0, sizeof(msg));
+  msg.msg_name = (void *)&dst->addr.sa;
+  msg.msg_namelen = dst->size;
+  msg.msg_iov = iov;
+  msg.msg_iovlen = 2;
+
+  if (sendmsg(context->sockfd, &msg, 0) >= 0)
+    coap_transaction_id(dst, response, &id);
+  else
+    coap_log(LOG_CRIT, "send_gather: sendmsg");
+
+#ifndef WITHOUT_DEDUP
+  /* The block is not in response, so a retransmission is served again
+   * from the source rather than from the cache. */
+  coap_dedup_forget(&context->dedup, dst, response);
+#endif /* WITHOUT_DEDUP */
+  return id;
+}
+#endif /* WITH_TINYOS */
+#endif /* WITH_CONTIKI */
+
+/* Answers a GET request with the block of source that it asks for, or
+ * with the whole representation if that fits in one block and no
+ * block was asked for. */
+static void
+serve_block(coap_context_t *context, coap_queue_t *node,
+	    coap_block_source_t *source) {
+  coap_pdu_t *response;
+  coap_block_t block;
+  coap_opt_iterator_t opt_iter;
+  coap_opt_t *etag;
+  coap_opt_filter_t opt_filter;
+  size_t start = 0, len = 0;
+  int want_block, res;
+
+  want_block = coap_get_block(node->pdu, COAP_OPTION_BLOCK2, &block);
+  if (!want_block)
+    block.szx = COAP_BLOCK_SZX_DEFAULT;
+
+#ifndef WITH_CONTIKI
+#ifndef WITH_TINYOS
+  /* a new transfer: check if the representation has changed */
+  if (block.num == 0)
+    coap_block_source_refresh(source);
+#endif /* WITH_TINYOS */
+#endif /* WITH_CONTIKI */
+
+  response = new_response(node, COAP_RESPONSE_CODE(205));
+  if (!response) {
+    warn("cannot generate response\r\n");
+    return;
+  }
+
+  /* the client has this version already */
+  etag = coap_check_option(node->pdu, COAP_OPTION_ETAG, &opt_iter);
+  if (etag && source->etag_length
+      && COAP_OPT_LENGTH(etag) == source->etag_length
+      && memcmp(COAP_OPT_VALUE(etag), source->etag, source->etag_length) == 0)
+    response->hdr->code = COAP_RESPONSE_CODE(203);
+
+  if (source->etag_length)
+    coap_add_option(response, COAP_OPTION_ETAG, source->etag_length,
+		    source->etag);
+
+  if (response->hdr->code == COAP_RESPONSE_CODE(205) && source->length) {
+    if (want_block || source->length > (size_t)1 << (block.szx + 4)) {
+      res = coap_write_block_opt(&block, COAP_OPTION_BLOCK2, response,
+				 source->length);
+      if (res < 0) {
+	coap_delete_pdu(response);
+	coap_option_filter_clear(opt_filter);
+	response = coap_new_error_response(node->pdu, res == -2
+					   ? COAP_RESPONSE_CODE(402)
+					   : COAP_RESPONSE_CODE(500),
+					   opt_filter);
+	if (response)
+	  coap_send(context, &node->remote, response);
+	coap_delete_pdu(response);
+	return;
+      }
+    }
+
+    start = (size_t)block.num << (block.szx + 4);
+    len = source->length - start;
+    if (len > (size_t)1 << (block.szx + 4))
+      len = (size_t)1 << (block.szx + 4);
+  }
+
+#ifndef WITH_CONTIKI
+#ifndef WITH_TINYOS
+  if (len && source->data) {
+    if (send_gather(context, &node->remote, response,
+		    source->data + start, len) == COAP_INVALID_TID)
+      debug("cannot send block %u\n", block.num);
+    coap_delete_pdu(response);
+    return;
+  }
+#endif /* WITH_TINYOS */
+#endif /* WITH_CONTIKI */
+
+  if (len && !coap_add_block_source(response, source, block.num, block.szx))
+    response->hdr->code = COAP_RESPONSE_CODE(500);
+
+  if (coap_send(context, &node->remote, response) == COAP_INVALID_TID)
+    debug("cannot send block %u\n", block.num);
+  coap_delete_pdu(response);
+}
+
+/* Stores the payload of a PUT or POST request in sink and acknowledges
+ * its block. */
+static void
+store_block(coap_context_t *context, coap_queue_t *node,
+	    coap_block_sink_t *sink) {
+  coap_pdu_t *response;
+  coap_block_t block;
+  coap_opt_iterator_t opt_iter;
+  unsigned char code, buf[3];
+
+  code = coap_block_sink_store(sink, node->pdu, &block);
+
+  response = new_response(node, code);
+  if (!response) {
+    warn("cannot generate response\r\n");
+    return;
+  }
+
+  /* echo the block that was stored */
+  if ((code == COAP_RESPONSE_CODE(231) || code == COAP_RESPONSE_CODE(204))
+      && coap_check_option(node->pdu, COAP_OPTION_BLOCK1, &opt_iter))
+    coap_add_option(response, COAP_OPTION_BLOCK1,
+		    coap_encode_var_bytes(buf, (block.num << 4)
+					  | (block.m << 3) | block.szx),
+		    buf);
+
+  if (coap_send(context, &node->remote, response) == COAP_INVALID_TID)
+    debug("cannot send response for block %u\n", block.num);
+  coap_delete_pdu(response);
+}
+#endif /* WITHOUT_BLOCK */
+
 void
 handle_request(coap_context_t *context, coap_queue_t *node) {      
   coap_method_handler_t h = NULL;
@@ -1125,6 +1593,18 @@ handle_request(coap_context_t *context, coap_queue_t *node) {
       warn("cannot generate response\r\n");
     }
   } else {
+#ifndef WITHOUT_BLOCK
+    if (resource->source && node->pdu->hdr->code == COAP_REQUEST_GET) {
+      serve_block(context, node, resource->source);
+      return;
+    }
+    if (resource->sink && (node->pdu->hdr->code == COAP_REQUEST_PUT
+			   || node->pdu->hdr->code == COAP_REQUEST_POST)) {
+      store_block(context, node, resource->sink);
+      return;
+    }
+#endif /* WITHOUT_BLOCK */
+
     if (WANT_WKC(node->pdu, key)) {
       debug("create default response for %s\n", COAP_DEFAULT_URI_WELLKNOWN);
       response = wellknown_response(context, node->pdu);
@@ -1180,6 +1660,7 @@ coap_dispatch( coap_context_t *context ) {
 
   while ( context->recvqueue ) {
     rcvd = context->recvqueue;
+    sent = NULL;
 
     /* remove node from recvqueue */
     context->recvqueue = context->recvqueue->next;
@@ -1193,7 +1674,7 @@ coap_dispatch( coap_context_t *context ) {
     switch ( rcvd->pdu->hdr->type ) {
     case COAP_MESSAGE_ACK:
       /* find transaction in sendqueue to stop retransmission */
-      coap_remove_from_queue(&context->sendqueue, rcvd->id, &sent);
+      coap_remove_sent(context, rcvd->id, &sent);
 
       if (rcvd->pdu->hdr->code == 0)
 	goto cleanup;
@@ -1217,7 +1698,7 @@ coap_dispatch( coap_context_t *context ) {
 #endif /* WITH_CONTIKI */
 
       /* find transaction in sendqueue to stop retransmission */
-      coap_remove_from_queue(&context->sendqueue, rcvd->id, &sent);
+      coap_remove_sent(context, rcvd->id, &sent);
 
       /* @todo remove observer for this resource, if any 
        * get token from sent and try to find a matching resource. Uh!
@@ -1249,6 +1730,19 @@ coap_dispatch( coap_context_t *context ) {
 	
 	goto cleanup;
       }
+
+#ifndef WITHOUT_DEDUP
+      if (COAP_MESSAGE_IS_REQUEST(rcvd->pdu->hdr) &&
+	  coap_dedup_request(&context->dedup, &rcvd->remote, rcvd->pdu, 
+			     &response)) {
+	/* a retransmission: answer as before, if we have answered yet,
+	 * without calling the handler again */
+	if (response &&
+	    coap_send_impl(context, &rcvd->remote, response) == COAP_INVALID_TID)
+	  warn("coap_dispatch: error sending cached response\n");
+	goto cleanup;
+      }
+#endif /* WITHOUT_DEDUP */
       break;
     }
    
@@ -46,11 +46,19 @@ typedef uint16_t in_port_t; //TODO: mab: move to TinyOS part
 #include "prng.h"
 #include "pdu.h"
 #include "coap_time.h"
+#include "dedup.h"
+#ifndef WITH_CONTIKI
+#include "uthash.h"
+#endif /* WITH_CONTIKI */
 
 struct coap_queue_t;
 
 typedef struct coap_queue_t {
   struct coap_queue_t *next;
+  /* the sendqueue is a pairing heap: next links siblings, child is the
+   * first child and prev the left sibling, or the parent of a first
+   * child */
+  struct coap_queue_t *child, *prev;
 
   coap_tick_t t;	        /* when to send PDU for the next time */
   unsigned char retransmit_cnt;	/* retransmission counter, will be removed when zero */
@@ -61,6 +69,9 @@ typedef struct coap_queue_t {
   coap_tid_t id;		/**< unique transaction id */
 
   coap_pdu_t *pdu;		/**< the CoAP PDU to send */
+#ifndef WITH_CONTIKI
+  UT_hash_handle hh;		/**< sendqueue index by transaction id */
+#endif /* WITH_CONTIKI */
 } coap_queue_t;
 
 /* adds node to given queue, ordered by specified order function */
@@ -105,7 +116,21 @@ typedef struct coap_context_t {
   /** list of asynchronous transactions */
   struct coap_async_state_t *async_state;
 #endif /* WITHOUT_ASYNC */
-  coap_queue_t *sendqueue, *recvqueue;
+  /**
+   * Confirmable messages awaiting an ACK, as a heap ordered by
+   * retransmission time: the head is the next one due, but the rest is
+   * not a list.  Use coap_peek_next(), coap_pop_next(),
+   * coap_find_sent() and coap_remove_sent() rather than the list
+   * functions.
+   */
+  coap_queue_t *sendqueue;
+#ifndef WITH_CONTIKI
+  coap_queue_t *sendindex;	/**< hash of sendqueue by transaction id */
+#endif /* WITH_CONTIKI */
+  coap_queue_t *recvqueue, *recvqueue_last; /**< received, in order */
+#ifndef WITHOUT_DEDUP
+  coap_dedup_t dedup;		/**< answers to recent confirmable requests */
+#endif /* WITHOUT_DEDUP */
 #ifdef WITH_CONTIKI
   struct uip_udp_conn *conn;	/**< uIP connection object */
 
@@ -124,6 +149,7 @@ typedef struct coap_context_t {
 #ifndef WITH_CONTIKI
 #ifndef WITH_TINYOS
   int sockfd;			/**< send/receive socket */
+  struct coap_recv_arena_t *recv_arena; /**< buffers for coap_read_batch() */
 #endif /* WITH_CONTIKI */
 #endif /* WITH_TINYOS */
 
@@ -182,6 +208,22 @@ coap_queue_t *coap_pop_next( coap_context_t *context );
 /* Creates a new coap_context_t object that will hold the CoAP stack status.  */
 coap_context_t *coap_new_context(const coap_address_t *listen_addr);
 
+#if !defined(WITH_CONTIKI) && !defined(WITH_TINYOS)
+/**
+ * Creates a new context like coap_new_context(), with @c SO_REUSEPORT
+ * set on its socket so that several contexts, usually one per thread,
+ * can listen on the same address. The kernel spreads incoming
+ * datagrams over them by source address, so all messages from one
+ * peer go to the same context. A context must only be used by one
+ * thread at a time.
+ *
+ * @param listen_addr The address to bind to.
+ * @return A new context or @c NULL on error, or if @c SO_REUSEPORT is
+ *         not supported.
+ */
+coap_context_t *coap_new_context_reuseport(const coap_address_t *listen_addr);
+#endif /* !WITH_CONTIKI && !WITH_TINYOS */
+
 /** 
  * Returns a new message id and updates @p context->message_id
  * accordingly. The message id is returned in network byte order
@@ -343,6 +385,25 @@ coap_tid_t coap_retransmit( coap_context_t *context, coap_queue_t *node );
  */
 int coap_read( coap_context_t *context );
 
+#ifndef COAP_RECV_BATCH
+/** The number of datagrams coap_read_batch() reads with one call. */
+#define COAP_RECV_BATCH 32
+#endif /* COAP_RECV_BATCH */
+
+/**
+ * Reads the datagrams waiting on @p context's socket without blocking
+ * and adds those that parse as CoAP PDUs to the receive queue, to be
+ * handled with one call to coap_dispatch(). Where @c recvmmsg() is
+ * available, up to #COAP_RECV_BATCH datagrams are read at a time into
+ * buffers kept with the context, for at most four batches per call.
+ * Elsewhere, this reads one datagram with coap_read().
+ *
+ * @param context The context to read from.
+ * @return The number of PDUs added to the receive queue, or @c -1 if
+ *         nothing was read.
+ */
+int coap_read_batch( coap_context_t *context );
+
 /** 
  * Calculates a unique transaction id from given arguments @p peer and
  * @p pdu. The id is returned in @p id.
@@ -403,6 +464,28 @@ coap_remove_transaction(coap_queue_t **queue, coap_tid_t id) {
  */
 coap_queue_t *coap_find_transaction(coap_queue_t *queue, coap_tid_t id);
 
+/** 
+ * Removes the confirmable message with transaction id @p id from the
+ * sendqueue of @p context, which stops its retransmission. Like
+ * coap_remove_from_queue(), the storage of @p node is @b not
+ * released.
+ * 
+ * @param context The context whose sendqueue to search.
+ * @param id      The transaction id.
+ * @param node    If found, @p node is updated to point to the 
+ *   removed node.
+ * 
+ * @return @c 1 if @p id was found, @c 0 otherwise.
+ */
+int coap_remove_sent(coap_context_t *context, coap_tid_t id,
+		     coap_queue_t **node);
+
+/**
+ * Retrieves a confirmable message from the sendqueue of @p context.
+ * @return The message with transaction id @p id, or NULL if not found
+ */
+coap_queue_t *coap_find_sent(coap_context_t *context, coap_tid_t id);
+
 /** Dispatches the PDUs from the receive queue in given context. */
 void coap_dispatch( coap_context_t *context );
 
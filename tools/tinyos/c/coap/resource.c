@@ -7,11 +7,20 @@
  */
 
 #include "config.h"
+
+#if defined(HAVE_SENDMMSG) && !defined(_GNU_SOURCE)
+#define _GNU_SOURCE		/* for sendmmsg() */
+#endif
 #include "net.h"
 #include "debug.h"
 #include "resource.h"
 #include "subscribe.h"
 
+#if defined(HAVE_SENDMMSG) && !defined(WITH_CONTIKI) && !defined(WITH_TINYOS)
+#include <sys/socket.h>
+#include <sys/uio.h>
+#endif /* HAVE_SENDMMSG */
+
 #ifndef WITH_CONTIKI
 #include "utlist.h"
 #include "mem.h"
@@ -549,10 +558,259 @@ coap_delete_observer(coap_resource_t *resource, coap_address_t *observer,
 }
 
 
+#if defined(HAVE_SENDMMSG) && !defined(WITH_CONTIKI) && !defined(WITH_TINYOS)
+#define COAP_NOTIFY_SENDMMSG
+
+/** Non-confirmable notifications waiting to be sent together. */
+typedef struct {
+  unsigned int count;
+  unsigned char hdr[COAP_NOTIFY_BATCH][sizeof(coap_hdr_t)];
+  struct iovec iov[COAP_NOTIFY_BATCH][3];
+  struct mmsghdr msg[COAP_NOTIFY_BATCH];
+} notify_batch_t;
+
+static void
+notify_flush(coap_context_t *context, coap_resource_t *r,
+	     notify_batch_t *batch) {
+  unsigned int done = 0;
+  int n;
+
+  while (done < batch->count) {
+    n = sendmmsg(context->sockfd, batch->msg + done, batch->count - done, 0);
+    if (n <= 0) {
+      coap_log(LOG_CRIT, "coap_check_notify: sendmmsg");
+      r->notify_stats.failed += batch->count - done;
+      break;
+    }
+    done += n;
+    r->notify_stats.sent += n;
+  }
+  batch->count = 0;
+}
+
+/* queues a notification to obs made of its own header and token and
+ * the options and payload of tmpl */
+static void
+notify_batch_add(coap_context_t *context, coap_resource_t *r,
+		 notify_batch_t *batch, coap_pdu_t *tmpl,
+		 coap_subscription_t *obs, unsigned short id) {
+  unsigned int i = batch->count++;
+  size_t skip = sizeof(coap_hdr_t) + tmpl->hdr->token_length;
+  coap_hdr_t *hdr = (coap_hdr_t *)batch->hdr[i];
+
+  memcpy(hdr, tmpl->hdr, sizeof(coap_hdr_t));
+  hdr->type = COAP_MESSAGE_NON;
+  hdr->token_length = obs->token_length;
+  hdr->id = id;
+
+  batch->iov[i][0].iov_base = hdr;
+  batch->iov[i][0].iov_len = sizeof(coap_hdr_t);
+  batch->iov[i][1].iov_base = obs->token;
+  batch->iov[i][1].iov_len = obs->token_length;
+  batch->iov[i][2].iov_base = (unsigned char *)tmpl->hdr + skip;
+  batch->iov[i][2].iov_len = tmpl->length - skip;
+
+  memset(&batch->msg[i], 0, sizeof(struct mmsghdr));
+  batch->msg[i].msg_hdr.msg_name = &obs->subscriber.addr.sa;
+  batch->msg[i].msg_hdr.msg_namelen = obs->subscriber.size;
+  batch->msg[i].msg_hdr.msg_iov = batch->iov[i];
+  batch->msg[i].msg_hdr.msg_iovlen = 3;
+
+  if (batch->count == COAP_NOTIFY_BATCH)
+    notify_flush(context, r, batch);
+}
+#endif /* HAVE_SENDMMSG */
+
+/** 
+ * Copies the notification rendered in @p tmpl into @p pdu, or into a
+ * new PDU of just the right size if @p pdu is @c NULL, with the token
+ * of @p obs and the given @p type and message @p id.
+ */
+static coap_pdu_t *
+notify_clone(coap_pdu_t *pdu, coap_pdu_t *tmpl, coap_subscription_t *obs,
+	     unsigned char type, unsigned short id) {
+  size_t skip = sizeof(coap_hdr_t) + tmpl->hdr->token_length;
+  size_t body = tmpl->length - skip;
+  coap_pdu_t *fresh = NULL;
+
+  if (!pdu) {
+    pdu = fresh = coap_pdu_init(type, tmpl->hdr->code, id,
+				sizeof(coap_hdr_t) + obs->token_length + body);
+    if (!pdu)
+      return NULL;
+  } else {
+    coap_pdu_clear(pdu, pdu->max_size);
+    pdu->hdr->type = type;
+    pdu->hdr->code = tmpl->hdr->code;
+    pdu->hdr->id = id;
+  }
+
+  if (!coap_add_token(pdu, obs->token_length, obs->token)
+      || pdu->length + body > pdu->max_size) {
+    debug("coap_check_notify: notification does not fit\n");
+    if (fresh)
+      coap_delete_pdu(fresh);
+    return NULL;
+  }
+
+  memcpy((unsigned char *)pdu->hdr + pdu->length,
+	 (unsigned char *)tmpl->hdr + skip, body);
+  pdu->length += body;
+  pdu->max_delta = tmpl->max_delta;
+  if (tmpl->data)
+    pdu->data = (unsigned char *)pdu->hdr + pdu->length
+      - ((unsigned char *)tmpl->hdr + tmpl->length - tmpl->data);
+  return pdu;
+}
+
+/* sends a notification, keeping confirmable ones for retransmission */
+static void
+notify_send(coap_context_t *context, coap_resource_t *r,
+	    coap_subscription_t *obs, coap_pdu_t *pdu, int keep) {
+  coap_tid_t tid;
+
+  if (pdu->hdr->type == COAP_MESSAGE_CON) {
+    tid = coap_send_confirmed(context, &obs->subscriber, pdu);
+    obs->non_cnt = 0;
+  } else {
+    tid = coap_send(context, &obs->subscriber, pdu);
+    obs->non_cnt++;
+  }
+
+  if (COAP_INVALID_TID == tid)
+    r->notify_stats.failed++;
+  else
+    r->notify_stats.sent++;
+
+  if (!keep && (COAP_INVALID_TID == tid || 
+		pdu->hdr->type != COAP_MESSAGE_CON))
+    coap_delete_pdu(pdu);
+}
+
+static inline unsigned char
+notify_type(coap_subscription_t *obs) {
+  return obs->non && obs->non_cnt < COAP_OBS_MAX_NON
+    ? COAP_MESSAGE_NON : COAP_MESSAGE_CON;
+}
+
+/* calls the GET handler h for each observer of r */
+static void
+notify_each(coap_context_t *context, coap_resource_t *r,
+	    coap_method_handler_t h, coap_subscription_t *obs) {
+  coap_pdu_t *response;
+  str token;
+
+#ifndef WITH_CONTIKI
+  for (; obs; obs = obs->next) {
+#else /* WITH_CONTIKI */
+  for (; obs; obs = list_item_next(obs)) {
+#endif /* WITH_CONTIKI */
+    /* initialize response */
+    response = coap_pdu_init(COAP_MESSAGE_CON, 0, 0, COAP_MAX_PDU_SIZE);
+    if (!response) {
+      debug("coap_check_notify: pdu init failed\n");
+      r->notify_stats.failed++;
+      continue;
+    }
+    if (!coap_add_token(response, obs->token_length, obs->token)) {
+      debug("coap_check_notify: cannot add token\n");
+      coap_delete_pdu(response);
+      r->notify_stats.failed++;
+      continue;
+    }
+
+    token.length = obs->token_length;
+    token.s = obs->token;
+
+    response->hdr->id = coap_new_message_id(context);
+    response->hdr->type = notify_type(obs);
+
+    /* fill with observer-specific data */
+    h(context, r, &obs->subscriber, NULL, &token, response);
+    notify_send(context, r, obs, response, 0);
+  }
+}
+
+/* calls the GET handler h once, for the first observer of r, and sends
+ * copies of its response to the others */
+static void
+notify_all(coap_context_t *context, coap_resource_t *r,
+	   coap_method_handler_t h, coap_subscription_t *obs) {
+  coap_pdu_t *tmpl, *pdu, *scratch = NULL;
+  str token;
+#ifdef COAP_NOTIFY_SENDMMSG
+  notify_batch_t *batch;
+
+  batch = coap_malloc(sizeof(notify_batch_t));
+  if (batch)
+    batch->count = 0;
+#endif /* COAP_NOTIFY_SENDMMSG */
+
+  tmpl = coap_pdu_init(COAP_MESSAGE_CON, 0, 0, COAP_MAX_PDU_SIZE);
+  if (!tmpl || !coap_add_token(tmpl, obs->token_length, obs->token)) {
+    debug("coap_check_notify: pdu init failed\n");
+    if (tmpl)
+      coap_delete_pdu(tmpl);
+    notify_each(context, r, h, obs);
+    return;
+  }
+  token.length = obs->token_length;
+  token.s = obs->token;
+
+  /* The Observe option is the same for all observers of this change,
+   * so only the header and token differ. */
+  h(context, r, &obs->subscriber, NULL, &token, tmpl);
+
+#ifndef WITH_CONTIKI
+  for (; obs; obs = obs->next) {
+#else /* WITH_CONTIKI */
+  for (; obs; obs = list_item_next(obs)) {
+#endif /* WITH_CONTIKI */
+    unsigned char type = notify_type(obs);
+    unsigned short id = coap_new_message_id(context);
+
+#ifdef COAP_NOTIFY_SENDMMSG
+    if (batch && type == COAP_MESSAGE_NON) {
+      notify_batch_add(context, r, batch, tmpl, obs, id);
+      obs->non_cnt++;
+      continue;
+    }
+#endif /* COAP_NOTIFY_SENDMMSG */
+
+    if (type == COAP_MESSAGE_CON) {
+      /* kept until acknowledged, so it gets its own copy */
+      pdu = notify_clone(NULL, tmpl, obs, type, id);
+    } else {
+      /* sent at once: reuse one PDU for all of them */
+      if (!scratch)
+	scratch = coap_pdu_init(type, 0, 0, COAP_MAX_PDU_SIZE);
+      pdu = scratch ? notify_clone(scratch, tmpl, obs, type, id) : NULL;
+    }
+
+    if (!pdu) {
+      r->notify_stats.failed++;
+      if (type == COAP_MESSAGE_CON)
+	obs->non_cnt = 0;
+      continue;
+    }
+    notify_send(context, r, obs, pdu, pdu == scratch);
+  }
+
+#ifdef COAP_NOTIFY_SENDMMSG
+  if (batch) {
+    notify_flush(context, r, batch);
+    coap_free(batch);
+  }
+#endif /* COAP_NOTIFY_SENDMMSG */
+  if (scratch)
+    coap_delete_pdu(scratch);
+  coap_delete_pdu(tmpl);
+}
+
 void
 coap_check_notify(coap_context_t *context) {
   coap_resource_t *r;
-  coap_pdu_t *response;
+  coap_tick_t start, end;
 #ifndef WITH_CONTIKI
   coap_resource_t *tmp;
 
@@ -570,7 +828,6 @@ coap_check_notify(coap_context_t *context) {
 #endif /* WITH_CONTIKI */
       coap_method_handler_t h;
       coap_subscription_t *obs;
-      str token;
 
       /* retrieve GET handler, prepare response */
       h = r->handler[COAP_REQUEST_GET - 1];
@@ -578,47 +835,23 @@ coap_check_notify(coap_context_t *context) {
 				 * GET handler is defined */
 
 #ifndef WITH_CONTIKI
-      /* FIXME: */
-      LL_FOREACH(r->subscribers, obs) {
+      obs = r->subscribers;
 #else /* WITH_CONTIKI */
-      for (obs = list_head(r->subscribers); obs; obs = list_item_next(obs)) {
+      obs = list_head(r->subscribers);
 #endif /* WITH_CONTIKI */
-        coap_tid_t tid = COAP_INVALID_TID;
-	/* initialize response */
-        response = coap_pdu_init(COAP_MESSAGE_CON, 0, 0, COAP_MAX_PDU_SIZE);
-        if (!response) {
-          debug("coap_check_notify: pdu init failed\n");
-          continue;
-        }
-	if (!coap_add_token(response, obs->token_length, obs->token)) {
-	  debug("coap_check_notify: cannot add token\n");
-	  coap_delete_pdu(response);
-	  continue;
-	}
-
-	token.length = obs->token_length;
-	token.s = obs->token;
-
-	response->hdr->id = coap_new_message_id(context);
-	if (obs->non && obs->non_cnt < COAP_OBS_MAX_NON)
-	  response->hdr->type = COAP_MESSAGE_NON;
-	else
-	  response->hdr->type = COAP_MESSAGE_CON;
 
-	/* fill with observer-specific data */
-	h(context, r, &obs->subscriber, NULL, &token, response);
-
-	if (response->hdr->type == COAP_MESSAGE_CON) {
-	  tid = coap_send_confirmed(context, &obs->subscriber, response);
-	  obs->non_cnt = 0;
-	} else {
-	  tid = coap_send(context, &obs->subscriber, response);
-	  obs->non_cnt++;
-	}
-
-        if (COAP_INVALID_TID == tid || response->hdr->type != COAP_MESSAGE_CON)
-          coap_delete_pdu(response);
-      }
+      coap_ticks(&start);
+      if (r->flags & COAP_RESOURCE_FLAGS_NOTIFY_PER_OBSERVER)
+	notify_each(context, r, h, obs);
+      else
+	notify_all(context, r, h, obs);
+      coap_ticks(&end);
+
+      r->notify_stats.changes++;
+      r->notify_stats.last = end - start;
+      r->notify_stats.total += end - start;
+      if (r->notify_stats.last > r->notify_stats.max)
+	r->notify_stats.max = r->notify_stats.last;
 
       /* Increment value for next Observe use. */
       context->observe++;
@@ -25,6 +25,14 @@
 #define COAP_RESOURCE_CHECK_TIME 2
 #endif /* COAP_RESOURCE_CHECK_TIME */
 
+#ifndef COAP_NOTIFY_BATCH
+/**
+ * The number of non-confirmable notifications that coap_check_notify()
+ * sends with one call to sendmmsg(), where available.
+ */
+#define COAP_NOTIFY_BATCH 32
+#endif /* COAP_NOTIFY_BATCH */
+
 #ifndef WITH_CONTIKI
 #include "uthash.h"
 #else /* WITH_CONTIKI */
@@ -36,6 +44,7 @@
 #include "pdu.h"
 #include "net.h"
 #include "subscribe.h"
+#include "block.h"
 
 #ifdef WITH_TINYOS
 extern void hnd_coap_default_tinyos(coap_context_t  *ctx,
@@ -63,6 +72,27 @@ typedef struct coap_attr_t {
 
 #define COAP_RESOURCE_FLAGS_RELEASE_URI 0x1
 
+/**
+ * Notifications of a change are normally rendered once, by calling the
+ * GET handler for the first observer, and copied for the others with
+ * their own token and message id. Set this flag for resources whose
+ * representation depends on the observer, to call the GET handler for
+ * each of them.
+ */
+#define COAP_RESOURCE_FLAGS_NOTIFY_PER_OBSERVER 0x2
+
+#ifndef WITHOUT_OBSERVE
+/** Statistics of the notifications sent for a resource. */
+typedef struct {
+  unsigned int changes;		/**< changes notified */
+  unsigned long sent;		/**< notifications sent */
+  unsigned long failed;		/**< notifications that could not be sent */
+  coap_tick_t last;		/**< time to notify all observers of the last change */
+  coap_tick_t max;		/**< longest time to notify all observers */
+  coap_tick_t total;		/**< total time, for the mean over changes */
+} coap_notify_stats_t;
+#endif /* WITHOUT_OBSERVE */
+
 typedef struct coap_resource_t {
   unsigned int dirty:1;	      /**< set to 1 if resource has changed */
   unsigned int observable:1; /**< can be observed */
@@ -94,6 +124,21 @@ typedef struct coap_resource_t {
   str uri;
   int flags;
 
+#ifndef WITHOUT_OBSERVE
+  coap_notify_stats_t notify_stats;
+#endif /* WITHOUT_OBSERVE */
+
+#ifndef WITHOUT_BLOCK
+  /**
+   * If set, a GET request without a handler is answered block by
+   * block from @c source, and a PUT or POST request without a handler
+   * is stored in @c sink. Both are owned by the caller, who also
+   * registers the Block2 and Block1 options with coap_register_option().
+   */
+  coap_block_source_t *source;
+  coap_block_sink_t *sink;
+#endif /* WITHOUT_BLOCK */
+
 #ifdef WITH_TINYOS
   uint8_t max_age;
   uint8_t etag;
@@ -288,7 +333,10 @@ void coap_delete_observer(coap_resource_t *resource,
 
 /** 
  * Checks for all known resources, if they are dirty and notifies
- * subscribed observers.
+ * subscribed observers. The representation is rendered once per
+ * change unless the resource has
+ * COAP_RESOURCE_FLAGS_NOTIFY_PER_OBSERVER set, and the time taken is
+ * recorded in the resource's notify_stats.
  */
 void coap_check_notify(coap_context_t *context);
 
@@ -0,0 +1,49 @@
+/* bench.c -- helpers shared by the benchmarks
+ *
+ * This file is part of the CoAP library libcoap. Please see
+ * README for terms of use.
+ */
+
+#include <stdio.h>
+#include <sys/time.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+
+#include "bench.h"
+
+static int total, success;
+
+double
+bench_now(void) {
+  struct timeval tv;
+  gettimeofday(&tv, NULL);
+  return tv.tv_sec + tv.tv_usec / 1e6;
+}
+
+void
+bench_check(const char *what, int ok) {
+  total++;
+  if (ok) {
+    success++;
+    printf("test: success\n");
+  } else {
+    printf("%s: failed\n", what);
+  }
+}
+
+void
+bench_loopback(coap_address_t *addr, int fd) {
+  coap_address_init(addr);
+  addr->addr.sin.sin_family = AF_INET;
+  addr->addr.sin.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  addr->size = sizeof(struct sockaddr_in);
+  if (fd >= 0)
+    getsockname(fd, &addr->addr.sa, &addr->size);
+}
+
+int
+bench_result(const char *file) {
+  printf("%s: %i/%i tests succeeded\n", file, success, total);
+  return success != total;
+}
@@ -0,0 +1,34 @@
+/* bench.h -- helpers shared by the benchmarks
+ *
+ * This file is part of the CoAP library libcoap. Please see
+ * README for terms of use.
+ */
+
+#ifndef _BENCH_H_
+#define _BENCH_H_
+
+#include "coap.h"
+
+/** Returns the current wall clock time in seconds. */
+double bench_now(void);
+
+/**
+ * Counts a check and prints its outcome. @p what names the check in
+ * the message printed when @p ok is zero.
+ */
+void bench_check(const char *what, int ok);
+
+/**
+ * Initializes @p addr with the IPv4 loopback address. If @p fd is a
+ * valid socket, the port it is bound to is filled in as well.
+ */
+void bench_loopback(coap_address_t *addr, int fd);
+
+/**
+ * Prints how many of the checks made by @p file succeeded and returns
+ * the benchmark's exit status: @c 0 if all checks passed, @c 1
+ * otherwise.
+ */
+int bench_result(const char *file);
+
+#endif /* _BENCH_H_ */
@@ -0,0 +1,305 @@
+/* bench_block.c -- block-wise transfer from sources and to sinks
+ *
+ * This file is part of the CoAP library libcoap. Please see
+ * README for terms of use.
+ *
+ * bench_block [kbytes] [transfers]
+ *
+ * Serves a file of 100 (or kbytes) KB over Block2 in blocks of 1024
+ * bytes from a client socket on the loopback interface, in three
+ * ways: from a GET handler that reads the whole file for every block
+ * and passes it to coap_add_block(), from a source that reads each
+ * block with a callback, and from a source that maps the file and
+ * sends each block from the mapping.  Checks that all three deliver
+ * the file with the same ETag on every block, that a matching ETag
+ * gets 2.03, and that a retransmitted request is answered.  Then
+ * uploads a new version of the file over Block1 to a file sink,
+ * checks that a block out of order gets 4.08, and that the mapped
+ * source serves the new version with a new ETag.  Reports the time
+ * per transfer for each.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+
+#include "coap.h"
+#include "bench.h"
+
+#define SZX 6
+#define BLOCK_SIZE (1 << (SZX + 4))
+
+static char path[] = "/tmp/bench_block.XXXXXX";
+static unsigned char *image;
+static size_t image_length;
+
+/* the old way: render the whole representation for each block */
+static void
+hnd_get_whole(coap_context_t *ctx, coap_resource_t *resource,
+	      coap_address_t *peer, coap_pdu_t *request, str *token,
+	      coap_pdu_t *response) {
+  static unsigned char buf[1 << 20];
+  coap_block_t block;
+  ssize_t len;
+  int fd;
+
+  fd = open(path, O_RDONLY);
+  len = read(fd, buf, sizeof(buf));
+  close(fd);
+
+  response->hdr->code = COAP_RESPONSE_CODE(205);
+  if (!coap_get_block(request, COAP_OPTION_BLOCK2, &block))
+    block.szx = SZX;
+  coap_write_block_opt(&block, COAP_OPTION_BLOCK2, response, len);
+  coap_add_block(response, len, buf, block.num, block.szx);
+}
+
+static int reads;
+
+static int
+read_file(coap_block_source_t *source, size_t offset,
+	  unsigned char *buf, size_t len) {
+  reads++;
+  return pread(*(int *)source->arg, buf, len, offset);
+}
+
+static coap_context_t *ctx;
+static coap_address_t server_addr;
+static int client;
+static unsigned short mid;
+
+/* Sends a request and returns the answer, or NULL. Options are added
+ * if given, in the order of their numbers. */
+static coap_pdu_t *
+exchange(unsigned char code, const char *uri, const coap_block_source_t *etag,
+	 unsigned short block_type, unsigned int block,
+	 const unsigned char *data, size_t len, int again) {
+  static coap_pdu_t *answer;
+  coap_pdu_t *pdu;
+  unsigned char buf[COAP_MAX_PDU_SIZE], opt[3];
+  struct pollfd pfd;
+  ssize_t n;
+
+  if (!again)
+    mid++;
+  pdu = coap_pdu_init(COAP_MESSAGE_CON, code, htons(mid), COAP_MAX_PDU_SIZE);
+  if (etag)
+    coap_add_option(pdu, COAP_OPTION_ETAG, etag->etag_length, etag->etag);
+  coap_add_option(pdu, COAP_OPTION_URI_PATH, strlen(uri),
+		  (unsigned char *)uri);
+  if (block_type)
+    coap_add_option(pdu, block_type, coap_encode_var_bytes(opt, block), opt);
+  if (len)
+    coap_add_data(pdu, len, data);
+  sendto(client, pdu->hdr, pdu->length, 0,
+	 &server_addr.addr.sa, server_addr.size);
+  coap_delete_pdu(pdu);
+
+  coap_read(ctx);
+  coap_dispatch(ctx);
+
+  pfd.fd = client;
+  pfd.events = POLLIN;
+  if (poll(&pfd, 1, 0) <= 0 || (n = recv(client, buf, sizeof(buf), 0)) <= 0)
+    return NULL;
+
+  coap_delete_pdu(answer);
+  answer = coap_pdu_init(0, 0, 0, COAP_MAX_PDU_SIZE);
+  if (!coap_pdu_parse(buf, n, answer))
+    return NULL;
+  return answer;
+}
+
+/* Fetches uri block by block and checks it against image. Sets etag to
+ * the ETag of the first block, and returns 1 if every block had it. */
+static int
+fetch(const char *uri, coap_block_source_t *etag) {
+  coap_pdu_t *answer;
+  coap_opt_iterator_t opt_iter;
+  coap_opt_t *opt;
+  coap_block_t block;
+  unsigned char *data;
+  size_t offset = 0, len;
+  unsigned int num = 0;
+  int ok = 1;
+
+  memset(etag, 0, sizeof(coap_block_source_t));
+  do {
+    answer = exchange(COAP_REQUEST_GET, uri, NULL, COAP_OPTION_BLOCK2,
+		      num << 4 | SZX, NULL, 0, 0);
+    if (!answer || answer->hdr->code != COAP_RESPONSE_CODE(205)
+	|| !coap_get_block(answer, COAP_OPTION_BLOCK2, &block)
+	|| block.num != num || !coap_get_data(answer, &len, &data)
+	|| offset + len > image_length
+	|| memcmp(image + offset, data, len))
+      return 0;
+
+    opt = coap_check_option(answer, COAP_OPTION_ETAG, &opt_iter);
+    if (num == 0 && opt) {
+      etag->etag_length = COAP_OPT_LENGTH(opt);
+      memcpy(etag->etag, COAP_OPT_VALUE(opt), etag->etag_length);
+    }
+    ok &= !etag->etag_length || (opt && COAP_OPT_LENGTH(opt) == etag->etag_length
+				 && !memcmp(COAP_OPT_VALUE(opt), etag->etag,
+					    etag->etag_length));
+    offset += len;
+    num++;
+  } while (block.m);
+
+  return ok && offset == image_length;
+}
+
+static void
+new_image(size_t length) {
+  size_t i;
+
+  image_length = length;
+  for (i = 0; i < length; i++)
+    image[i] = rand();
+}
+
+/* uploads image to uri; returns the code of the last answer */
+static unsigned char
+upload(const char *uri) {
+  coap_pdu_t *answer = NULL;
+  size_t offset, len;
+  unsigned int num = 0;
+  int more;
+
+  for (offset = 0; offset < image_length; offset += len, num++) {
+    len = image_length - offset;
+    more = len > BLOCK_SIZE;
+    if (more)
+      len = BLOCK_SIZE;
+    answer = exchange(COAP_REQUEST_PUT, uri, NULL, COAP_OPTION_BLOCK1,
+		      num << 4 | more << 3 | SZX, image + offset, len, 0);
+    if (!answer || answer->hdr->code != (more ? COAP_RESPONSE_CODE(231)
+					 : COAP_RESPONSE_CODE(204)))
+      break;
+  }
+  return answer ? answer->hdr->code : 0;
+}
+
+int
+main(int argc, char **argv) {
+  int kbytes = argc > 1 ? atoi(argv[1]) : 100;
+  int transfers = argc > 2 ? atoi(argv[2]) : 20;
+  static const char *name[] = { "whole", "callback", "mapped" };
+  coap_block_source_t file_cb, file_map, etag, etag2;
+  coap_block_sink_t sink;
+  coap_resource_t *r;
+  coap_address_t addr;
+  coap_pdu_t *answer;
+  double t0, t[3];
+  int fd, i, j, ok;
+  unsigned char code;
+
+  if (kbytes < 2 || kbytes > 1000 || transfers < 1) {
+    fprintf(stderr, "usage: %s [kbytes 2 to 1000] [transfers]\n", argv[0]);
+    return 2;
+  }
+
+  coap_set_log_level(LOG_CRIT);
+  image = malloc(kbytes * 1024 + 7);
+  if (!image)
+    return 1;
+  new_image(kbytes * 1024 + 7);	/* the last block is short */
+  fd = mkstemp(path);
+  if (fd < 0 || write(fd, image, image_length) != (ssize_t)image_length) {
+    bench_check("file", 0);
+    return 1;
+  }
+
+  bench_loopback(&addr, -1);
+  ctx = coap_new_context(&addr);
+  client = socket(AF_INET, SOCK_DGRAM, 0);
+  if (!ctx || client < 0 || bind(client, &addr.addr.sa, addr.size) < 0) {
+    bench_check("context", 0);
+    return 1;
+  }
+  bench_loopback(&server_addr, ctx->sockfd);
+  coap_register_option(ctx, COAP_OPTION_BLOCK2);
+  coap_register_option(ctx, COAP_OPTION_BLOCK1);
+
+  r = coap_resource_init((unsigned char *)"whole", 5, 0);
+  coap_register_handler(r, COAP_REQUEST_GET, hnd_get_whole);
+  coap_add_resource(ctx, r);
+
+  coap_block_source_file(&file_map, path);
+  r = coap_resource_init((unsigned char *)"mapped", 6, 0);
+  r->source = &file_map;
+  coap_add_resource(ctx, r);
+
+  /* the same file, read block by block */
+  memcpy(&file_cb, &file_map, sizeof(coap_block_source_t));
+  file_cb.data = NULL;
+  file_cb.read = read_file;
+  file_cb.arg = &fd;
+  r = coap_resource_init((unsigned char *)"callback", 8, 0);
+  r->source = &file_cb;
+  coap_add_resource(ctx, r);
+
+  coap_block_sink_file(&sink, path);
+  r = coap_resource_init((unsigned char *)"upload", 6, 0);
+  r->sink = &sink;
+  coap_add_resource(ctx, r);
+
+  /* every way delivers the file, the sources with a stable ETag */
+  for (i = 0; i < 3; i++) {
+    ok = 1;
+    t0 = bench_now();
+    for (j = 0; j < transfers; j++)
+      ok &= fetch(name[i], &etag);
+    t[i] = (bench_now() - t0) / transfers;
+    bench_check(name[i], ok && (i == 0 || etag.etag_length));
+  }
+  bench_check("reads", reads == transfers
+	      * (int)((image_length + BLOCK_SIZE - 1) / BLOCK_SIZE));
+
+  /* the client has it already */
+  answer = exchange(COAP_REQUEST_GET, "mapped", &etag, 0, 0, NULL, 0, 0);
+  bench_check("etag", answer && answer->hdr->code == COAP_RESPONSE_CODE(203)
+	&& !answer->data);
+
+  /* a retransmission of a block sent from the mapping is answered */
+  answer = exchange(COAP_REQUEST_GET, "mapped", NULL, COAP_OPTION_BLOCK2,
+		    1 << 4 | SZX, NULL, 0, 0);
+  i = answer && answer->hdr->code == COAP_RESPONSE_CODE(205);
+  answer = exchange(COAP_REQUEST_GET, "mapped", NULL, COAP_OPTION_BLOCK2,
+		    1 << 4 | SZX, NULL, 0, 1);
+  bench_check("retransmit", i && answer
+	&& answer->hdr->code == COAP_RESPONSE_CODE(205));
+
+  /* a new version over Block1; a block out of order is refused */
+  new_image(kbytes * 1024 / 2);
+  answer = exchange(COAP_REQUEST_PUT, "upload", NULL, COAP_OPTION_BLOCK1,
+		    2 << 4 | 1 << 3 | SZX, image, BLOCK_SIZE, 0);
+  bench_check("order", answer && answer->hdr->code == COAP_RESPONSE_CODE(408));
+  code = upload("upload");
+  bench_check("upload", code == COAP_RESPONSE_CODE(204));
+
+  /* the next transfer finds it */
+  bench_check("refresh", fetch("mapped", &etag2)
+	&& (etag2.etag_length != etag.etag_length
+	    || memcmp(etag2.etag, etag.etag, etag.etag_length)));
+
+  printf("%i KB in %i byte blocks:\n", kbytes, BLOCK_SIZE);
+  for (i = 0; i < 3; i++)
+    printf("%-9s %8.2f ms per transfer\n", name[i], t[i] * 1e3);
+
+  close(fd);
+  close(client);
+  coap_free_context(ctx);
+  coap_block_source_close(&file_map);
+  coap_block_sink_close(&sink);
+  unlink(path);
+  free(image);
+
+  return bench_result(__FILE__);
+}
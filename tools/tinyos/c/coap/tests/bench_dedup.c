@@ -0,0 +1,181 @@
+/* bench_dedup.c -- duplicate request detection test and benchmark
+ *
+ * This file is part of the CoAP library libcoap. Please see
+ * README for terms of use.
+ *
+ * bench_dedup [requests]
+ *
+ * Sends 1000 (or requests) confirmable GET requests from a client
+ * socket on the loopback interface to a server context and retransmits
+ * each of them three times, as a client does when the ACK is lost.
+ * Checks that the handler runs once per request, that every
+ * retransmission gets the same bytes as the first answer, that the
+ * same message id from another peer is a new request, that a request
+ * not yet answered is dropped, and that entries expire and are evicted
+ * to stay within COAP_DEDUP_MAX_SIZE.  Reports the time to answer a
+ * request and a retransmission.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+
+#include "coap.h"
+#include "bench.h"
+
+#define RETRANSMIT 3
+
+static int handler_calls;
+
+/* answers with the number of calls so far, so that a second call for
+   the same request would be noticed */
+static void
+hnd_get(coap_context_t *ctx, coap_resource_t *resource,
+	coap_address_t *peer, coap_pdu_t *request, str *token,
+	coap_pdu_t *response) {
+  char buf[16];
+
+  response->hdr->code = COAP_RESPONSE_CODE(205);
+  coap_add_data(response, snprintf(buf, sizeof(buf), "%d", ++handler_calls),
+		(unsigned char *)buf);
+}
+
+/* answers later, if at all */
+static void
+hnd_get_later(coap_context_t *ctx, coap_resource_t *resource,
+	      coap_address_t *peer, coap_pdu_t *request, str *token,
+	      coap_pdu_t *response) {
+  handler_calls++;
+  response->hdr->type = COAP_MESSAGE_NON;
+}
+
+static coap_context_t *ctx;
+static coap_address_t server_addr;
+
+/* sends a GET for path with message id mid from fd and returns the
+   answer's length, or 0 if there is none */
+static ssize_t
+request(int fd, const char *path, unsigned short mid, unsigned char *answer) {
+  coap_pdu_t *pdu;
+  struct pollfd pfd;
+
+  pdu = coap_pdu_init(COAP_MESSAGE_CON, COAP_REQUEST_GET, htons(mid), 32);
+  coap_add_token(pdu, 2, (unsigned char *)&mid);
+  coap_add_option(pdu, COAP_OPTION_URI_PATH, strlen(path),
+		  (unsigned char *)path);
+  sendto(fd, pdu->hdr, pdu->length, 0, &server_addr.addr.sa, server_addr.size);
+  coap_delete_pdu(pdu);
+
+  coap_read(ctx);
+  coap_dispatch(ctx);
+
+  pfd.fd = fd;
+  pfd.events = POLLIN;
+  if (poll(&pfd, 1, 0) <= 0)
+    return 0;
+  return recv(fd, answer, COAP_MAX_PDU_SIZE, 0);
+}
+
+int
+main(int argc, char **argv) {
+  int n = argc > 1 ? atoi(argv[1]) : 1000;
+  coap_resource_t *r;
+  coap_address_t addr;
+  unsigned char first[COAP_MAX_PDU_SIZE], again[COAP_MAX_PDU_SIZE];
+  ssize_t len, len2;
+  int fd, fd2, i, j, ok, calls;
+  unsigned long hits, misses;
+  double t0, t_new = 0, t_dup = 0;
+  coap_dedup_entry_t *e;
+
+  if (n < 1 || n > 65535) {
+    fprintf(stderr, "usage: %s [requests up to 65535]\n", argv[0]);
+    return 2;
+  }
+
+  coap_set_log_level(LOG_CRIT);
+  bench_loopback(&addr, -1);
+  ctx = coap_new_context(&addr);
+  fd = socket(AF_INET, SOCK_DGRAM, 0);
+  fd2 = socket(AF_INET, SOCK_DGRAM, 0);
+  if (!ctx || fd < 0 || fd2 < 0 || bind(fd, &addr.addr.sa, addr.size) < 0
+      || bind(fd2, &addr.addr.sa, addr.size) < 0) {
+    bench_check("context", 0);
+    return 1;
+  }
+  bench_loopback(&server_addr, ctx->sockfd);
+
+  r = coap_resource_init((unsigned char *)"x", 1, 0);
+  coap_register_handler(r, COAP_REQUEST_GET, hnd_get);
+  coap_add_resource(ctx, r);
+  r = coap_resource_init((unsigned char *)"later", 5, 0);
+  coap_register_handler(r, COAP_REQUEST_GET, hnd_get_later);
+  coap_add_resource(ctx, r);
+
+  /* each request is handled once, and its retransmissions get the
+     same answer */
+  ok = 1;
+  for (i = 0; i < n; i++) {
+    t0 = bench_now();
+    len = request(fd, "x", i, first);
+    t_new += bench_now() - t0;
+    ok &= len > 4;
+    for (j = 0; j < RETRANSMIT; j++) {
+      t0 = bench_now();
+      len2 = request(fd, "x", i, again);
+      t_dup += bench_now() - t0;
+      ok &= len2 == len && !memcmp(first, again, len);
+    }
+  }
+  bench_check("retransmit", ok && handler_calls == n && ctx->dedup.misses == n
+	&& ctx->dedup.hits == n * RETRANSMIT);
+
+  /* the same message id from another peer is another request */
+  calls = handler_calls;
+  len = request(fd2, "x", 0, first);
+  len2 = request(fd2, "x", 0, again);
+  bench_check("peer", handler_calls == calls + 1 && len > 4 && len2 == len);
+
+  /* a retransmission before the answer is dropped */
+  calls = handler_calls;
+  len = request(fd, "later", 60000, first);
+  len2 = request(fd, "later", 60000, again);
+  bench_check("pending", handler_calls == calls + 1 && len == 0 && len2 == 0
+	&& ctx->dedup.pending == 1);
+
+  /* the cache stays in budget, and what fell out is handled again */
+  bench_check("budget", ctx->dedup.size <= COAP_DEDUP_MAX_SIZE
+	&& (ctx->dedup.evicted > 0
+	    || n * sizeof(coap_dedup_entry_t) < COAP_DEDUP_MAX_SIZE));
+  calls = handler_calls;
+  misses = ctx->dedup.misses;
+  request(fd, "x", 0, first);
+  bench_check("evicted", ctx->dedup.evicted == 0
+	|| (handler_calls == calls + 1 && ctx->dedup.misses == misses + 1));
+
+  /* after EXCHANGE_LIFETIME, everything is forgotten */
+  for (e = ctx->dedup.oldest; e; e = e->newer)
+    e->created -= COAP_DEDUP_LIFETIME * COAP_TICKS_PER_SECOND;
+  calls = handler_calls;
+  hits = ctx->dedup.hits;
+  request(fd, "x", 1, first);
+  bench_check("expire", handler_calls == calls + 1 && ctx->dedup.hits == hits
+	&& ctx->dedup.oldest == ctx->dedup.newest);
+
+  printf("%i requests, %lu hits, %lu misses, %lu evicted, %lu bytes\n",
+	 n, ctx->dedup.hits, ctx->dedup.misses, ctx->dedup.evicted,
+	 (unsigned long)ctx->dedup.size);
+  printf("request:        %.2f us\n", t_new * 1e6 / n);
+  printf("retransmission: %.2f us\n", t_dup * 1e6 / (n * RETRANSMIT));
+
+  close(fd);
+  close(fd2);
+  coap_free_context(ctx);
+
+  return bench_result(__FILE__);
+}
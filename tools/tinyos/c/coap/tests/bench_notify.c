@@ -0,0 +1,176 @@
+/* bench_notify.c -- observe notification fan-out benchmark
+ *
+ * This file is part of the CoAP library libcoap. Please see
+ * README for terms of use.
+ *
+ * bench_notify [observers]
+ *
+ * Registers 500 (or observers) observers of one resource, each with its
+ * own socket on the loopback interface and its own token, some of them
+ * asking for non-confirmable notifications.  Marks the resource dirty a
+ * number of times and runs coap_check_notify(), then checks that every
+ * observer got one notification per change with its token, the current
+ * Observe value and the payload, and that the GET handler was called
+ * once per change.  Reports the time per notification with the
+ * response rendered once, and with it rendered for each observer
+ * (COAP_RESOURCE_FLAGS_NOTIFY_PER_OBSERVER).
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+
+#include "coap.h"
+#include "bench.h"
+
+#define CHANGES 20
+
+static int handler_calls;
+static char payload[COAP_MAX_PDU_SIZE];
+
+/* a GET handler that does some work to render the current value */
+static void
+hnd_get(coap_context_t *ctx, coap_resource_t *resource,
+	coap_address_t *peer, coap_pdu_t *request, str *token,
+	coap_pdu_t *response) {
+  unsigned char buf[3];
+  int i, len;
+
+  handler_calls++;
+  len = snprintf(payload, 32, "%u:", ctx->observe);
+  for (i = len; i < 200; i++)
+    payload[i] = 'a' + (i * ctx->observe) % 26;
+  payload[i] = '\0';
+
+  response->hdr->code = COAP_RESPONSE_CODE(205);
+  coap_add_option(response, COAP_OPTION_OBSERVE,
+		  coap_encode_var_bytes(buf, ctx->observe), buf);
+  coap_add_option(response, COAP_OPTION_CONTENT_TYPE,
+		  coap_encode_var_bytes(buf, COAP_MEDIATYPE_TEXT_PLAIN), buf);
+  coap_add_data(response, 200, (unsigned char *)payload);
+}
+
+/* Returns 1 if the datagram in buf is a notification for the observer
+   with the given token that carries the current value. */
+static int
+notification_ok(coap_context_t *ctx, unsigned char *buf, ssize_t len,
+		unsigned char *token, unsigned char token_length) {
+  coap_pdu_t *pdu;
+  coap_opt_iterator_t oi;
+  coap_opt_t *opt;
+  unsigned char *data;
+  size_t data_len;
+  int ok;
+
+  pdu = coap_pdu_init(0, 0, 0, len);
+  if (!pdu)
+    return 0;
+  ok = coap_pdu_parse(buf, len, pdu)
+    && pdu->hdr->code == COAP_RESPONSE_CODE(205)
+    && pdu->hdr->token_length == token_length
+    && !memcmp(pdu->hdr->token, token, token_length)
+    && (opt = coap_check_option(pdu, COAP_OPTION_OBSERVE, &oi))
+    && coap_decode_var_bytes(COAP_OPT_VALUE(opt), COAP_OPT_LENGTH(opt))
+       == ctx->observe
+    && coap_get_data(pdu, &data_len, &data)
+    && data_len == 200 && !memcmp(data, payload, 200);
+  coap_delete_pdu(pdu);
+  return ok;
+}
+
+static void
+run(int n, int flags) {
+  coap_context_t *ctx;
+  coap_resource_t *r;
+  coap_address_t local, peer;
+  unsigned char token[8], buf[COAP_MAX_PDU_SIZE];
+  int *fds, i, c, ok = 1, non = 0;
+  double t0, t = 0;
+
+  bench_loopback(&local, -1);
+  ctx = coap_new_context(&local);
+  r = coap_resource_init((unsigned char *)"value", 5, flags);
+  if (!ctx || !r) {
+    bench_check("context", 0);
+    return;
+  }
+  coap_register_handler(r, COAP_REQUEST_GET, hnd_get);
+  r->observable = 1;
+  coap_add_resource(ctx, r);
+
+  fds = malloc(n * sizeof(*fds));
+  for (i = 0; i < n; i++) {
+    str tok = { 4, token };
+    coap_subscription_t *s;
+
+    fds[i] = socket(AF_INET, SOCK_DGRAM, 0);
+    bench_loopback(&peer, -1);
+    if (fds[i] < 0 || bind(fds[i], &peer.addr.sa, peer.size) < 0) {
+      bench_check("socket", 0);
+      return;
+    }
+    bench_loopback(&peer, fds[i]);
+    memcpy(token, &i, 4);
+    s = coap_add_observer(r, &peer, &tok);
+    s->non = i % 4 != 0;
+    non += s->non;
+  }
+
+  handler_calls = 0;
+  for (c = 0; c < CHANGES; c++) {
+    r->dirty = 1;
+    t0 = bench_now();
+    coap_check_notify(ctx);
+    t += bench_now() - t0;
+
+    /* every observer got this change; the Observe value was bumped
+       after the notifications went out */
+    ctx->observe--;
+    for (i = 0; i < n; i++) {
+      ssize_t len = recv(fds[i], buf, sizeof(buf), MSG_DONTWAIT);
+      memcpy(token, &i, 4);
+      ok &= len > 0 && notification_ok(ctx, buf, len, token, 4);
+    }
+    ctx->observe++;
+  }
+
+  if (flags & COAP_RESOURCE_FLAGS_NOTIFY_PER_OBSERVER) {
+    bench_check("per observer", ok && handler_calls == CHANGES * n);
+    printf("per observer: %.2f us/notification\n", t * 1e6 / (CHANGES * n));
+  } else {
+    bench_check("render once", ok && handler_calls == CHANGES);
+    printf("render once:  %.2f us/notification\n", t * 1e6 / (CHANGES * n));
+  }
+  bench_check("stats", r->notify_stats.changes == CHANGES
+	&& r->notify_stats.sent == CHANGES * n && !r->notify_stats.failed
+	&& r->notify_stats.max >= r->notify_stats.last
+	&& r->notify_stats.total >= r->notify_stats.max);
+  printf("%u changes, %i observers (%i non-confirmable), "
+	 "max fan-out %u ticks\n", r->notify_stats.changes, n, non,
+	 (unsigned int)r->notify_stats.max);
+
+  for (i = 0; i < n; i++)
+    close(fds[i]);
+  free(fds);
+  coap_free_context(ctx);
+}
+
+int
+main(int argc, char **argv) {
+  int n = argc > 1 ? atoi(argv[1]) : 500;
+
+  if (n < 1) {
+    fprintf(stderr, "usage: %s [observers]\n", argv[0]);
+    return 2;
+  }
+
+  coap_set_log_level(LOG_CRIT);
+  run(n, 0);
+  run(n, COAP_RESOURCE_FLAGS_NOTIFY_PER_OBSERVER);
+
+  return bench_result(__FILE__);
+}
@@ -0,0 +1,232 @@
+/* bench_recv.c -- server receive path benchmark
+ *
+ * This file is part of the CoAP library libcoap. Please see
+ * README for terms of use.
+ *
+ * bench_recv [requests] [threads]
+ *
+ * Sends 100000 (or requests) confirmable GET requests from 64 client
+ * sockets on the loopback interface to a server context, in rounds of
+ * 2 per socket, and counts the piggy-backed responses.  The server
+ * reads the requests one datagram per wakeup with coap_read(), as the
+ * example server used to, and then all at once with coap_read_batch().
+ * Then runs the same load against 4 (or threads) worker threads, each
+ * with its own context on the same port (coap_new_context_reuseport()),
+ * and checks that every request is answered and that every worker got
+ * some of them.  Reports requests per second for each.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <poll.h>
+#include <pthread.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+
+#include "coap.h"
+#include "bench.h"
+
+#define CLIENTS   64
+#define PER_ROUND 2
+#define MAX_THREADS 64
+
+typedef struct {
+  pthread_t thread;
+  coap_context_t *ctx;
+  int handled;
+} worker_t;
+
+static worker_t workers[MAX_THREADS];
+static int n_workers;
+static volatile int stop;
+
+static void
+hnd_get(coap_context_t *ctx, coap_resource_t *resource,
+	coap_address_t *peer, coap_pdu_t *request, str *token,
+	coap_pdu_t *response) {
+  int i;
+
+  for (i = 0; i < n_workers; i++)
+    if (workers[i].ctx == ctx)
+      workers[i].handled++;
+
+  response->hdr->code = COAP_RESPONSE_CODE(205);
+  coap_add_data(response, 2, (unsigned char *)"ok");
+}
+
+static coap_context_t *
+server(coap_address_t *addr, int reuseport) {
+  coap_context_t *ctx;
+  coap_resource_t *r;
+
+  ctx = reuseport ? coap_new_context_reuseport(addr) : coap_new_context(addr);
+  if (!ctx)
+    return NULL;
+  r = coap_resource_init((unsigned char *)"x", 1, 0);
+  coap_register_handler(r, COAP_REQUEST_GET, hnd_get);
+  coap_add_resource(ctx, r);
+  return ctx;
+}
+
+/* the example server's loop: wait, read, dispatch */
+static void
+serve_once(coap_context_t *ctx, int batch, int timeout) {
+  struct pollfd pfd;
+
+  pfd.fd = ctx->sockfd;
+  pfd.events = POLLIN;
+  if (poll(&pfd, 1, timeout) > 0) {
+    if (batch)
+      coap_read_batch(ctx);
+    else
+      coap_read(ctx);
+    coap_dispatch(ctx);
+  }
+}
+
+static void *
+serve(void *arg) {
+  worker_t *w = (worker_t *)arg;
+
+  while (!stop)
+    serve_once(w->ctx, 1, 10);
+  return NULL;
+}
+
+static int clients[CLIENTS];
+
+/* Sends n requests to addr, in rounds, and returns how many were
+   answered.  Without workers, runs ctx between sending and receiving. */
+static int
+load(coap_address_t *addr, int n, coap_context_t *ctx, int batch) {
+  coap_pdu_t *pdu;
+  unsigned char buf[64];
+  unsigned short mid = 0;
+  int i, j, sent = 0, answered = 0, expected;
+  double deadline;
+
+  pdu = coap_pdu_init(COAP_MESSAGE_CON, COAP_REQUEST_GET, 0, 16);
+  coap_add_option(pdu, COAP_OPTION_URI_PATH, 1, (unsigned char *)"x");
+
+  while (sent < n) {
+    expected = 0;
+    for (i = 0; i < CLIENTS && sent < n; i++)
+      for (j = 0; j < PER_ROUND && sent < n; j++, sent++, expected++) {
+	pdu->hdr->id = htons(mid++);
+	sendto(clients[i], pdu->hdr, pdu->length, 0,
+	       &addr->addr.sa, addr->size);
+      }
+
+    /* collect this round's responses */
+    deadline = bench_now() + 1;
+    while (expected && bench_now() < deadline) {
+      if (ctx)
+	serve_once(ctx, batch, 0);
+      for (i = 0; i < CLIENTS; i++)
+	while (recv(clients[i], buf, sizeof(buf), MSG_DONTWAIT) > 0) {
+	  answered++;
+	  expected--;
+	}
+    }
+  }
+
+  coap_delete_pdu(pdu);
+  return answered;
+}
+
+static void
+run_single(int n) {
+  coap_context_t *ctx;
+  coap_address_t addr;
+  double t0, t;
+  int answered, batch;
+
+  for (batch = 0; batch < 2; batch++) {
+    bench_loopback(&addr, -1);
+    ctx = server(&addr, 0);
+    if (!ctx) {
+      bench_check("context", 0);
+      return;
+    }
+    bench_loopback(&addr, ctx->sockfd);
+
+    t0 = bench_now();
+    answered = load(&addr, n, ctx, batch);
+    t = bench_now() - t0;
+    bench_check(batch ? "coap_read_batch" : "coap_read", answered == n);
+    printf("%-16s %.0f requests/s\n",
+	   batch ? "coap_read_batch:" : "coap_read:", n / t);
+    coap_free_context(ctx);
+  }
+}
+
+static void
+run_threads(int n, int threads) {
+  coap_address_t addr;
+  double t0, t;
+  int i, answered, ok = 1;
+
+  bench_loopback(&addr, -1);
+  n_workers = 0;
+  for (i = 0; i < threads; i++) {
+    workers[i].ctx = server(&addr, 1);
+    if (!workers[i].ctx) {
+      bench_check("reuseport", 0);
+      return;
+    }
+    /* the others bind to the port the first one got */
+    bench_loopback(&addr, workers[i].ctx->sockfd);
+    workers[i].handled = 0;
+    n_workers++;
+  }
+
+  stop = 0;
+  for (i = 0; i < threads; i++)
+    pthread_create(&workers[i].thread, NULL, serve, &workers[i]);
+
+  t0 = bench_now();
+  answered = load(&addr, n, NULL, 1);
+  t = bench_now() - t0;
+
+  stop = 1;
+  for (i = 0; i < threads; i++) {
+    pthread_join(workers[i].thread, NULL);
+    ok &= workers[i].handled > 0;
+    printf("worker %i: %i requests\n", i, workers[i].handled);
+    coap_free_context(workers[i].ctx);
+  }
+  bench_check("threads", ok && answered == n);
+  printf("%i threads:       %.0f requests/s\n", threads, n / t);
+}
+
+int
+main(int argc, char **argv) {
+  int n = argc > 1 ? atoi(argv[1]) : 100000;
+  int threads = argc > 2 ? atoi(argv[2]) : 4;
+  coap_address_t addr;
+  int i;
+
+  if (n < 1 || threads < 1 || threads > MAX_THREADS) {
+    fprintf(stderr, "usage: %s [requests] [threads up to %i]\n",
+	    argv[0], MAX_THREADS);
+    return 2;
+  }
+
+  coap_set_log_level(LOG_CRIT);
+  for (i = 0; i < CLIENTS; i++) {
+    clients[i] = socket(AF_INET, SOCK_DGRAM, 0);
+    bench_loopback(&addr, -1);
+    bind(clients[i], &addr.addr.sa, addr.size);
+  }
+
+  run_single(n);
+  run_threads(n, threads);
+
+  for (i = 0; i < CLIENTS; i++)
+    close(clients[i]);
+
+  return bench_result(__FILE__);
+}
@@ -0,0 +1,231 @@
+/* bench_sendqueue.c -- confirmable message queue benchmark
+ *
+ * This file is part of the CoAP library libcoap. Please see
+ * README for terms of use.
+ *
+ * bench_sendqueue [exchanges]
+ *
+ * Sends 10000 (or exchanges) confirmable requests from a context to a
+ * peer socket on the loopback interface, has the peer acknowledge 90%
+ * of them in random order, and runs the rest through coap_pop_next()
+ * and coap_retransmit() until they give up.  Checks that the ACKs
+ * remove exactly the acknowledged transactions and that messages come
+ * out of the sendqueue in time order, and reports the time per message
+ * for each phase.  For comparison, runs the same inserts, removals by
+ * id and pops through the list functions the sendqueue used to be
+ * built on.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+
+#include "coap.h"
+#include "bench.h"
+
+#define ACK_PERCENT 90
+#define ACK_BATCH   64
+
+static void
+shuffle(unsigned short *a, int n) {
+  int i, j;
+  unsigned short tmp;
+
+  for (i = n - 1; i > 0; i--) {
+    j = rand() % (i + 1);
+    tmp = a[i];
+    a[i] = a[j];
+    a[j] = tmp;
+  }
+}
+
+static int
+cmp_tid(const void *a, const void *b) {
+  return *(const coap_tid_t *)a - *(const coap_tid_t *)b;
+}
+
+static int
+order_timestamp(coap_queue_t *lhs, coap_queue_t *rhs) {
+  return lhs->t < rhs->t ? -1 : 1;
+}
+
+/* the sendqueue with the ids acknowledged, as coap_read and
+   coap_dispatch see them */
+static void
+run_context(int n) {
+  coap_context_t *ctx;
+  coap_address_t local, peer;
+  unsigned short *mids;
+  coap_tid_t *want, *got;
+  coap_queue_t *node;
+  coap_tick_t last;
+  double t0, t_send, t_ack, t_retransmit;
+  int fd, i, j, n_ack = n * ACK_PERCENT / 100, n_left, ok, pops = 0;
+
+  bench_loopback(&local, -1);
+  ctx = coap_new_context(&local);
+  fd = socket(AF_INET, SOCK_DGRAM, 0);
+  bench_loopback(&peer, -1);
+  if (!ctx || fd < 0 || bind(fd, &peer.addr.sa, peer.size) < 0) {
+    bench_check("context", 0);
+    return;
+  }
+  bench_loopback(&peer, fd);
+  bench_loopback(&local, ctx->sockfd);
+
+  mids = malloc(n * sizeof(*mids));
+  want = malloc(n * sizeof(*want));
+  got = malloc(n * sizeof(*got));
+
+  t0 = bench_now();
+  for (i = 0; i < n; i++) {
+    coap_pdu_t *pdu = coap_pdu_init(COAP_MESSAGE_CON, COAP_REQUEST_GET,
+				    coap_new_message_id(ctx),
+				    COAP_MAX_PDU_SIZE);
+    mids[i] = pdu->hdr->id;
+    if (coap_send_confirmed(ctx, &peer, pdu) == COAP_INVALID_TID) {
+      bench_check("send", 0);
+      return;
+    }
+  }
+  t_send = bench_now() - t0;
+
+  /* the peer acknowledges most of them, in a random order, a batch at
+     a time so the context's socket does not overflow */
+  shuffle(mids, n);
+  t0 = bench_now();
+  for (i = 0; i < n_ack; i += ACK_BATCH) {
+    for (j = i; j < n_ack && j < i + ACK_BATCH; j++) {
+      coap_pdu_t *ack = coap_pdu_init(COAP_MESSAGE_ACK, 0, mids[j], 4);
+      sendto(fd, ack->hdr, ack->length, 0, &local.addr.sa, local.size);
+      coap_delete_pdu(ack);
+    }
+    for (j = i; j < n_ack && j < i + ACK_BATCH; j++)
+      coap_read(ctx);
+    coap_dispatch(ctx);
+  }
+  t_ack = bench_now() - t0;
+
+  /* transaction ids are 16 bits, so some collide: all that can be
+     checked is that the ids left are those not acknowledged */
+  n_left = n - n_ack;
+  for (i = n_ack; i < n; i++) {
+    coap_pdu_t *pdu = coap_pdu_init(COAP_MESSAGE_CON, 0, mids[i], 4);
+    coap_transaction_id(&peer, pdu, &want[i - n_ack]);
+    coap_delete_pdu(pdu);
+  }
+  ok = 1;
+  for (i = 0; i < n_left; i++)
+    ok &= coap_find_sent(ctx, want[i]) != NULL;
+  bench_check("ack", ok);
+
+  /* every message left is retransmitted until it gives up, in time
+     order */
+  ok = 1;
+  last = 0;
+  t0 = bench_now();
+  while ((node = coap_pop_next(ctx))) {
+    ok &= node->t >= last;
+    last = node->t;
+    if (node->retransmit_cnt == 0 && pops < n)
+      got[pops++] = node->id;
+    coap_retransmit(ctx, node);
+  }
+  t_retransmit = bench_now() - t0;
+  qsort(want, n_left, sizeof(*want), cmp_tid);
+  qsort(got, pops, sizeof(*got), cmp_tid);
+  bench_check("retransmit", ok && pops == n_left && coap_can_exit(ctx) &&
+	!memcmp(want, got, n_left * sizeof(*want)));
+
+  printf("%i exchanges, %i acknowledged\n", n, n_ack);
+  printf("send:       %.2f us/message\n", t_send * 1e6 / n);
+  printf("ack:        %.2f us/message\n", t_ack * 1e6 / n_ack);
+  printf("retransmit: %.2f us/message\n",
+	 t_retransmit * 1e6 / (n_left * (COAP_DEFAULT_MAX_RETRANSMIT + 1)));
+
+  free(mids);
+  free(want);
+  free(got);
+  close(fd);
+  coap_free_context(ctx);
+}
+
+/* the same deadlines, removals and pops through the list functions */
+static void
+run_list(int n) {
+  coap_queue_t *queue = NULL, *node, *nodes;
+  coap_tid_t *ids;
+  double t0, t_insert, t_remove, t_retransmit;
+  int i, n_ack = n * ACK_PERCENT / 100, ok = 1, left = 0;
+
+  nodes = calloc(n, sizeof(*nodes));
+  ids = malloc(n * sizeof(*ids));
+  for (i = 0; i < n; i++) {
+    nodes[i].id = ids[i] = i;
+    nodes[i].timeout = COAP_DEFAULT_RESPONSE_TIMEOUT * COAP_TICKS_PER_SECOND
+      + rand() % (COAP_TICKS_PER_SECOND * COAP_DEFAULT_RESPONSE_TIMEOUT / 2);
+    nodes[i].t = i / 8 + nodes[i].timeout;
+  }
+
+  t0 = bench_now();
+  for (i = 0; i < n; i++)
+    coap_insert_node(&queue, &nodes[i], order_timestamp);
+  t_insert = bench_now() - t0;
+
+  for (i = n - 1; i > 0; i--) {
+    int j = rand() % (i + 1);
+    coap_tid_t tmp = ids[i];
+    ids[i] = ids[j];
+    ids[j] = tmp;
+  }
+  t0 = bench_now();
+  for (i = 0; i < n_ack; i++)
+    ok &= coap_remove_from_queue(&queue, ids[i], &node);
+  t_remove = bench_now() - t0;
+
+  /* what coap_retransmit did to the list, less the sending */
+  t0 = bench_now();
+  while (queue) {
+    node = queue;
+    queue = node->next;
+    node->next = NULL;
+    if (node->retransmit_cnt < COAP_DEFAULT_MAX_RETRANSMIT) {
+      node->retransmit_cnt++;
+      node->t += node->timeout << node->retransmit_cnt;
+      coap_insert_node(&queue, node, order_timestamp);
+    } else {
+      left++;
+    }
+  }
+  t_retransmit = bench_now() - t0;
+  bench_check("list", ok && left == n - n_ack);
+
+  printf("list insert:     %.2f us/message\n", t_insert * 1e6 / n);
+  printf("list remove:     %.2f us/message\n", t_remove * 1e6 / n_ack);
+  printf("list retransmit: %.2f us/message\n",
+	 t_retransmit * 1e6 / ((n - n_ack) * (COAP_DEFAULT_MAX_RETRANSMIT + 1)));
+
+  free(nodes);
+  free(ids);
+}
+
+int
+main(int argc, char **argv) {
+  int n = argc > 1 ? atoi(argv[1]) : 10000;
+
+  if (n < 1 || n > 65535) {
+    fprintf(stderr, "usage: %s [exchanges up to 65535]\n", argv[0]);
+    return 2;
+  }
+
+  srand(1);
+  coap_set_log_level(LOG_CRIT);
+  run_context(n);
+  run_list(n);
+
+  return bench_result(__FILE__);
+}
@@ -29,29 +29,55 @@
  * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  */
 
-#include <string.h>
+#include <errno.h>
+#include <signal.h>
+#include <stdarg.h>
 #include <stdio.h>
 #include <stdlib.h>
-#include <unistd.h>
 #include <string.h>
-#include <sys/types.h>
+#include <unistd.h>
+#include <sys/epoll.h>
 #include <sys/time.h>
-#include <sys/socket.h>
-#include <netinet/in_systm.h>
-#include <netinet/in.h>
-#include <netinet/ip.h>
-#include <arpa/inet.h>
-#include <netdb.h>
-
-#include <stdarg.h>
 
 #include "tun_dev.h"
 #include "serialsource.h"
-#include "serialpacket.h"
-#include "6lowpan.h"
+#include "lib6lowpan/lib6lowpan.h"
+#include "lib6lowpan/ieee154_header.h"
+#include "lib6lowpan/ip_malloc.h"
+
+/*
+ * A tunnel between a tun interface and a mote which bridges raw
+ * 802.15.4 frames to its serial port.  Packets from the tun interface
+ * are compressed with IPHC and fragmented by lib6lowpan; frames from
+ * the mote are reassembled in a lowpan_recon_table.  Both descriptors
+ * are drained in batches from one epoll loop.
+ *
+ * SIGUSR1 prints the tunnel counters, as does exiting.
+ */
+
+/* the serial dispatch of a raw 802.15.4 frame, as in Serial.h */
+enum {
+    TOS_SERIAL_802_15_4_ID = 2,
+};
+
+/* the frames lowpan_frag_get builds: the length byte and the MPDU
+   without its FCS */
+#define FRAME_LEN (IEEE154_LINK_MTU - 1)
+
+#define TUN_PANID 0x22
+#define TUN_SADDR 0x12
 
-#define min(a,b) ( (a>b) ? b : a )
-#define max(a,b) ( (a>b) ? a : b )
+/* the prefix on the tun interface, which is also IPHC context 0 */
+static const uint8_t tun_prefix[8] = {0x20, 0x01, 0x06, 0x38,
+				      0x07, 0x09, 0x12, 0x34};
+
+/* packets handled per descriptor each time round the loop, so a busy
+   side cannot starve the other */
+#define TUN_BATCH 16
+#define SERIAL_BATCH 32
+
+#define N_RECON 8
+#define STATS_INTERVAL 60 /* seconds */
 
 static char *msgs[] = {
   "unknown_packet_type",
@@ -67,54 +93,41 @@ static char *msgs[] = {
 };
 
 /* global variables */
-lowpan_pkt_t *fragments = NULL; /* fragment reassembly of received frames */
-//lowpan_pkt_t *send_queue = NULL;
-int g_send_pending = 0;
-
-hw_addr_t hw_addr;
-
 serial_source ser_src;
 int tun_fd = 0; /* tunnel device */
-//int ser_fd = 0; /* serial device */
-
-uint16_t g_dgram_tag = 0; /* datagram_tag for sending fragmented packets */
-
-/* ------------------------------------------------------------------------- */
-/* function pre-declarations */
-int serial_output_am_payload(uint8_t *buf, int len,
-			     const hw_addr_t *hw_src_addr,
-			     const hw_addr_t *hw_dst_addr);
 
-int serial_input_layer3(uint8_t *buf, int len,
-			const hw_addr_t *hw_src_addr,
-			const hw_addr_t *hw_dst_addr);
-
-int serial_input_ipv6_uncompressed(uint8_t *buf, int len,
-				   const hw_addr_t *hw_src_addr,
-				   const hw_addr_t *hw_dst_addr);
+static struct ieee154_frame_addr tx_frame;
+static uint16_t g_dgram_tag = 0; /* datagram_tag for sending fragmented packets */
+static uint8_t g_dsn = 0;
+
+static struct lowpan_reconstruct recon_slots[N_RECON];
+static struct lowpan_recon_table recon_table;
+/* when the first fragment of the datagram in each slot arrived */
+static struct {
+    uint16_t tag;
+    uint16_t source_key;
+    struct timeval start;
+} recon_start[N_RECON];
+
+static int verbose = 0;
+static volatile sig_atomic_t g_report = 0, g_quit = 0;
+
+struct latency {
+    uint32_t count;
+    uint64_t total_us;
+    uint32_t max_us;
+};
 
-int serial_input_ipv6_compressed(uint8_t *buf, int len,
-				 const hw_addr_t *hw_src_addr,
-				 const hw_addr_t *hw_dst_addr);
+/* tunnel counters; "tx" is tun to serial, "rx" serial to tun */
+static struct {
+    uint32_t tx_pkts, tx_bytes, tx_frames, tx_frame_bytes, tx_drops;
+    uint32_t rx_frames, rx_frame_bytes, rx_pkts, rx_bytes, rx_drops;
+    struct latency tx_lat, rx_lat;
+} stats, last_stats;
+static struct timeval last_report;
 
 /* ------------------------------------------------------------------------- */
 /* utility functions */
-int get_ser_fd()
-{
-    return serial_source_fd(ser_src);
-}
-
-void increment_g_dgram_tag()
-{
-    uint16_t tmp = ntohs(g_dgram_tag);
-    if (tmp == 0xFFFF) {
-	tmp = 0;
-    } else {
-	tmp++;
-    }
-    g_dgram_tag = htons(tmp);
-}
-
 void stderr_msg(serial_source_msg problem)
 {
   fprintf(stderr, "Note: %s\n", msgs[problem]);
@@ -125,6 +138,8 @@ debug(const char *fmt, ...)
 {
     int result;
     va_list ap;
+    if (!verbose)
+	return 0;
     va_start(ap, fmt);
     result = vfprintf(stderr, fmt, ap);
     va_end(ap);
@@ -145,1063 +160,438 @@ ssystem(const char *fmt, ...)
   return system(cmd);
 }
 
-/* print char* in hex format */
-void dump_serial_packet(const unsigned char *packet, const int len) {
-    int i;
-    printf("len: %d\n", len);
-    if (!packet)
-	return;
-    for (i = 0; i < len; i++) {
-	printf("%02x ", packet[i]);
-	//printf("%02x(%c) ", packet[i], packet[i]);
-	//printf("%c", packet[i]);
-    }
-    putchar('\n');
-/*     printf("---\n"); */
-/*     for (i = 0; i < len; i++) { */
-/* 	printf("%c", packet[i]); */
-/*     } */
-/*     putchar('\n'); */
-/*     printf("---\n"); */
-}
-
-/* ------------------------------------------------------------------------- */
-/* ip6_addr_t and hw_addr_t utility functions */
-int ipv6_addr_is_zero(const ip6_addr_t *addr)
+static long elapsed_us(const struct timeval *from, const struct timeval *to)
 {
-    int i;
-    for (i=0;i<16;i++) {
-	if (addr->addr[i]) {
-	    return 0;
-	}
-    }
-    return 1;
+    return (to->tv_sec - from->tv_sec) * 1000000L
+	+ (to->tv_usec - from->tv_usec);
 }
 
-int ipv6_addr_is_linklocal_unicast(const ip6_addr_t *addr)
+static void latency_add(struct latency *l, const struct timeval *from,
+			const struct timeval *to)
 {
-    if (   addr->addr[0] == 0xFE
-	   && addr->addr[1] == 0x80
-	   && addr->addr[2] == 0
-	   && addr->addr[3] == 0
-	   && addr->addr[4] == 0
-	   && addr->addr[5] == 0
-	   && addr->addr[6] == 0
-	   && addr->addr[7] == 0
-	   )
-	return 1;
-    else
-	return 0;
+    long us = elapsed_us(from, to);
+    if (us < 0) us = 0;
+    l->count++;
+    l->total_us += us;
+    if (us > l->max_us)
+	l->max_us = us;
 }
 
-int cmp_ipv6_addr(const ip6_addr_t *addr1, const ip6_addr_t *addr2)
+void print_stats()
 {
-    return memcmp(addr1, addr2, sizeof(ip6_addr_t));
+    struct timeval now;
+    double secs;
+
+    gettimeofday(&now, NULL);
+    secs = elapsed_us(&last_report, &now) / 1e6;
+    if (secs <= 0) secs = 1;
+
+    printf("tun -> serial: %u pkts %u bytes, %u frames %u bytes, "
+	   "%u dropped, %.1f kbit/s, latency %.2f ms avg %.2f ms max\n",
+	   stats.tx_pkts, stats.tx_bytes, stats.tx_frames,
+	   stats.tx_frame_bytes, stats.tx_drops,
+	   (stats.tx_bytes - last_stats.tx_bytes) * 8 / secs / 1000,
+	   stats.tx_lat.count ?
+	   stats.tx_lat.total_us / 1000.0 / stats.tx_lat.count : 0,
+	   stats.tx_lat.max_us / 1000.0);
+    printf("serial -> tun: %u frames %u bytes, %u pkts %u bytes, "
+	   "%u dropped, %.1f kbit/s, reassembly %.2f ms avg %.2f ms max\n",
+	   stats.rx_frames, stats.rx_frame_bytes, stats.rx_pkts,
+	   stats.rx_bytes, stats.rx_drops,
+	   (stats.rx_bytes - last_stats.rx_bytes) * 8 / secs / 1000,
+	   stats.rx_lat.count ?
+	   stats.rx_lat.total_us / 1000.0 / stats.rx_lat.count : 0,
+	   stats.rx_lat.max_us / 1000.0);
+    fflush(stdout);
+    last_stats = stats;
+    last_report = now;
 }
 
-int cmp_hw_addr(const hw_addr_t *addr1, const hw_addr_t *addr2)
+static void on_signal(int sig)
 {
-    // for short addresses compare only the first two bytes
-    if (addr1->type == HW_ADDR_SHORT && addr2->type == HW_ADDR_SHORT) {
-	return memcmp(addr1->addr_short, addr2->addr_short,
-		      sizeof(addr1->addr_short));
-    } else {
-	return memcmp(addr1, addr2, sizeof(hw_addr_t));
-    }
-}
-
-int hw_addr_is_broadcat(const hw_addr_t *hw_addr)
-{
-    if (hw_addr->type == HW_ADDR_SHORT
-	&& hw_addr->addr_short[0] == 0xFF  && hw_addr->addr_short[1] == 0xFF)
-	return 1;
-    // TODO: long address
-    else return 0;
+    if (sig == SIGUSR1)
+	g_report = 1;
+    else
+	g_quit = 1;
 }
 
 /* ------------------------------------------------------------------------- */
-/* more utility functions */
-void clear_pkt(lowpan_pkt_t *pkt)
-{
-    memset(pkt, 0, sizeof(*pkt));
-    pkt->buf_begin = pkt->buf + LOWPAN_OVERHEAD;
-}
-
-void free_frag_list(frag_info_t *p)
-{
-    frag_info_t *q;
-    while (p) {
-	q = p->next;
-	free(p);
-	p = q;
-    }
-}
-
-void free_lowpan_pkt(lowpan_pkt_t *pkt)
-{
-    lowpan_pkt_t *p;
-    lowpan_pkt_t **q;
-
-    if (!fragments) return;
-    for(q=&fragments; *q; q=&(*q)->next) {
-	if (*q == pkt) {
-	    p = *q;
-	    *q = p->next;
-	    free_frag_list(p->frag_list);
-	    free(p);
-	    return;
-	}
-    }
-}
-
-lowpan_pkt_t * find_fragment(hw_addr_t *hw_src_addr, hw_addr_t *hw_dst_addr,
-			     uint16_t dgram_size, uint16_t dgram_tag)
+/* IPHC contexts: context 0 is the prefix of the tun interface */
+int lowpan_extern_match_context(struct in6_addr *addr, uint8_t *ctx_id)
 {
-    lowpan_pkt_t *p;
-    for(p=fragments; p; p=p->next) {
-	if ((p->dgram_tag == dgram_tag)
-	    && (p->dgram_size == dgram_size)
-	    && cmp_hw_addr(&p->hw_src_addr, hw_src_addr) == 0
-	    && cmp_hw_addr(&p->hw_dst_addr, hw_dst_addr) == 0
-	    ) {
-	    return p;
-	}
+    if (memcmp(addr->s6_addr, tun_prefix, sizeof(tun_prefix)) == 0) {
+	*ctx_id = 0;
+	return 64;
     }
-    return NULL;
+    return 0;
 }
-/* ------------------------------------------------------------------------- */
-/* HC1 and HC2 compression and decompresstion functions */
 
-/* the caller has to free() new_buf */
-int lowpan_decompress(uint8_t *buf, int len,
-		       const hw_addr_t *hw_src_addr,
-		       const hw_addr_t *hw_dst_addr,
-		       uint8_t **new_buf, int *new_len)
+int lowpan_extern_read_context(struct in6_addr *addr, int context)
 {
-    uint8_t hc1_enc;
-    uint8_t hc2_enc;
-    struct ip6_hdr *ip_hdr = NULL;
-    struct udp_hdr *udp_hdr = NULL;
-    
-    *new_buf = malloc(len + sizeof(*ip_hdr) + sizeof(*udp_hdr));
-    if (!*new_buf) {
-	fprintf(stderr, "%s: out of memory\n", __func__);
-	*new_len = 0;
-	return 1;
-    }
-    hc1_enc = *buf;
-    buf += sizeof(hc1_enc);
-    len -= sizeof(hc1_enc);
-
-    /* HC2 encoding follows HC1 encoding */
-    if ((hc1_enc & HC1_HC2_MASK) == HC1_HC2_PRESENT) {
-	hc2_enc = *buf;
-	buf += sizeof(hc2_enc);
-	len -= sizeof(hc2_enc);
-    }
-
-    /* IP header fields */
-    ip_hdr = (struct ip6_hdr *) *new_buf;
-    memset(ip_hdr, 0, sizeof(struct ip6_hdr));
-
-    ip_hdr->vtc |= IPV6_VERSION;
-
-    ip_hdr->hlim = *buf;
-    buf += sizeof(ip_hdr->hlim);
-    len -= sizeof(ip_hdr->hlim);
-
-    /* source IP address */
-    if ((hc1_enc & HC1_SRC_PREFIX_MASK) == HC1_SRC_PREFIX_INLINE) {
-	memcpy(&ip_hdr->src_addr, buf, sizeof(ip_hdr->src_addr)/2);
-	buf += sizeof(ip_hdr->src_addr)/2;
-	len -= sizeof(ip_hdr->src_addr)/2;
-    } else {
-	ip_hdr->src_addr.addr[0] = 0xFE;
-	ip_hdr->src_addr.addr[1] = 0x80;
-    }
-     
-    if ((hc1_enc & HC1_SRC_IFACEID_MASK) == HC1_SRC_IFACEID_INLINE) {
-	memcpy(((void*)&ip_hdr->src_addr) + sizeof(ip_hdr->src_addr)/2,
-	       buf, sizeof(ip_hdr->src_addr)/2);
-	buf += sizeof(ip_hdr->src_addr)/2;
-	len -= sizeof(ip_hdr->src_addr)/2;
-    }
-
-    /* destination IP address */
-    if ((hc1_enc & HC1_DST_PREFIX_MASK) == HC1_DST_PREFIX_INLINE) {
-	memcpy(&ip_hdr->dst_addr, buf, sizeof(ip_hdr->dst_addr)/2);
-	buf += sizeof(ip_hdr->dst_addr)/2;
-	len -= sizeof(ip_hdr->dst_addr)/2;
-    } else {
-	ip_hdr->dst_addr.addr[0] = 0xFE;
-	ip_hdr->dst_addr.addr[1] = 0x80;
-    }
-     
-    if ((hc1_enc & HC1_DST_IFACEID_MASK) == HC1_DST_IFACEID_INLINE) {
-	memcpy(((void*)&ip_hdr->dst_addr) + sizeof(ip_hdr->dst_addr)/2,
-	       buf, sizeof(ip_hdr->dst_addr)/2);
-	buf += sizeof(ip_hdr->dst_addr)/2;
-	len -= sizeof(ip_hdr->dst_addr)/2;
-    }
-
-    /* Traffic Class and Flow Label */
-    if ((hc1_enc & HC1_TCFL_MASK) == HC1_TCFL_INLINE) {
-	//TODO
-    }
-
-    /* Next Header */
-    switch (hc1_enc & HC1_NEXTHDR_MASK) {
-    case HC1_NEXTHDR_INLINE:
-	ip_hdr->nxt_hdr = *buf;
-	buf += sizeof(ip_hdr->nxt_hdr);
-	len -= sizeof(ip_hdr->nxt_hdr);
-	break;
-    case HC1_NEXTHDR_UDP:
-	ip_hdr->nxt_hdr = NEXT_HEADER_UDP;
-	break;
-    case HC1_NEXTHDR_ICMP:
-	ip_hdr->nxt_hdr = NEXT_HEADER_ICMP6;
-	break;
-    case HC1_NEXTHDR_TCP:
-	ip_hdr->nxt_hdr = NEXT_HEADER_TCP;
-	break;
-    default:
-	fprintf(stderr, "unknown next header HC1 encoding\n");
-	break;
+    if (context == 0) {
+	memcpy(addr->s6_addr, tun_prefix, sizeof(tun_prefix));
+	return 64;
     }
-    
-    /* HC_UDP compression */
-    if ((hc1_enc & HC1_HC2_MASK) == HC1_HC2_PRESENT
-	&& (hc1_enc & HC1_NEXTHDR_MASK) == HC1_NEXTHDR_UDP) {
-	
-	udp_hdr = (struct udp_hdr *) ((*new_buf) + sizeof(struct ip6_hdr));
-	//udp_hdr = (struct udp_hdr *) (ip_hdr + 1);
-	memset(udp_hdr, 0, sizeof(struct udp_hdr));
-
-	/* UDP Source Port */
-	if ((hc2_enc & HC2_UDP_SRC_PORT_MASK) == HC2_UDP_SRC_PORT_INLINE) {
-	    memcpy(&udp_hdr->src_port, buf, sizeof(udp_hdr->src_port));
-	    buf += sizeof(udp_hdr->src_port);
-	    len -= sizeof(udp_hdr->src_port);
-	} else {
-	    //TODO
-	}
-
-	/* UDP Destination Port */
-	if ((hc2_enc & HC2_UDP_DST_PORT_MASK) == HC2_UDP_DST_PORT_INLINE) {
-	    memcpy(&udp_hdr->dst_port, buf, sizeof(udp_hdr->dst_port));
-	    buf += sizeof(udp_hdr->dst_port);
-	    len -= sizeof(udp_hdr->dst_port);
-	} else {
-	    //TODO
-	}
-
-	/* UDP Length */
-	if ((hc2_enc & HC2_UDP_LEN_MASK) == HC2_UDP_LEN_INLINE) {
-	    memcpy(&udp_hdr->len, buf, sizeof(udp_hdr->len));
-	    buf += sizeof(udp_hdr->len);
-	    len -= sizeof(udp_hdr->len);
-	} else {
-	    udp_hdr->len = len - sizeof(udp_hdr->chksum)
-		+ sizeof(struct udp_hdr);
-	}
-	
-	/* Checksum */
-	memcpy(&udp_hdr->chksum, buf, sizeof(udp_hdr->chksum));
-	buf += sizeof(udp_hdr->chksum);
-	len -= sizeof(udp_hdr->chksum);
-	
-	/* IPv6 Payload Length */
-	ip_hdr->plen = htons(len + sizeof(struct udp_hdr));
-	
-	memcpy((*new_buf) + sizeof(struct ip6_hdr) + sizeof(struct udp_hdr),
-	       buf, len);
-	*new_len = len + sizeof(struct ip6_hdr) + sizeof(struct udp_hdr);
-    } else {
-    /* IPv6 Payload Length */
-    ip_hdr->plen = htons(len);
-
-    memcpy((*new_buf) + sizeof(struct ip6_hdr), buf, len);
-    *new_len = len + sizeof(struct ip6_hdr);
-    }
-    
     return 0;
 }
 
-/* assuming there is space available in from of buf_begin */
-int lowpan_compress(uint8_t **buf_begin, int *len,
-		     const hw_addr_t *hw_src_addr,
-		     const hw_addr_t *hw_dst_addr)
+/*
+ * the link address for an IPv6 destination: motes' addresses end in
+ * ff:fe00 and their short address, as in IPNeighborDiscoveryP, and
+ * everything else is broadcast to the mote
+ */
+static void resolve_link_addr(struct in6_addr *addr, ieee154_addr_t *link)
 {
-    uint8_t *hc1_enc;
-    uint8_t *hc2_enc;
-    struct ip6_hdr *ip_hdr = NULL;
-    struct udp_hdr *udp_hdr = NULL;
-    
-    uint8_t new_buf[sizeof(struct ip6_hdr) + sizeof(struct udp_hdr) + 5];
-    uint8_t *new_buf_p = new_buf;
-    int new_len = 0;
-
-    debug("%s\n", __func__);
-
-    ip_hdr = (struct ip6_hdr *) *buf_begin;
-    udp_hdr = (struct udp_hdr *) ((*buf_begin) + sizeof(struct ip6_hdr));
-
-    /* check if this is an IPv6 packet */
-    if ((ip_hdr->vtc & IPV6_VERSION_MASK) != IPV6_VERSION) {
-	debug("IP version check failed - not an IPv6 packet\n");
-	return 0;
-    }
-    
-    /* set 6lowpan dispatch value */
-    *new_buf_p = DISPATCH_COMPRESSED_IPV6;
-    new_buf_p += sizeof(uint8_t);
-    new_len += sizeof(uint8_t);
-
-    /* HC1 encoding field */
-    hc1_enc = new_buf_p;
-    new_buf_p += sizeof(uint8_t);
-    new_len += sizeof(uint8_t);
-    *hc1_enc = 0;
-
-    /* does HC2 follow after HC1? */
-    if (ip_hdr->nxt_hdr == NEXT_HEADER_UDP) {
-	*hc1_enc |= HC1_HC2_PRESENT;
-
-	/* HC2 encoding field */
-	hc2_enc = new_buf_p;
-	new_buf_p += sizeof(uint8_t);
-	new_len += sizeof(uint8_t);
-	*hc2_enc = 0;
-    } else {    
-	*hc1_enc |= HC1_HC2_NONE;
-    }
-
-    /* Hop Limit */
-    *new_buf_p = ip_hdr->hlim;
-    new_buf_p += sizeof(uint8_t);
-    new_len += sizeof(uint8_t);
-
-    /* source address prefix */
-    //TODO: fails checksum on the mote !!!
-    if (ipv6_addr_is_linklocal_unicast(&ip_hdr->src_addr)) {
-	*hc1_enc |= HC1_SRC_PREFIX_LINKLOCAL;
-    } else {
-	*hc1_enc |= HC1_SRC_PREFIX_INLINE;
-
-	memcpy(new_buf_p, &(ip_hdr->src_addr), 8);
-	new_buf_p += 8;
-	new_len += 8;
-    }
-
-    /* source address interface identifier */
-    *hc1_enc |= HC1_SRC_IFACEID_INLINE;
-    
-    memcpy(new_buf_p, ((void*)&(ip_hdr->src_addr)) + 8, 8);
-    new_buf_p += 8;
-    new_len += 8;
-
-    /* destination address prefix */
-    if (ipv6_addr_is_linklocal_unicast(&ip_hdr->dst_addr)) {
-	*hc1_enc |= HC1_DST_PREFIX_LINKLOCAL;
-    } else {
-	*hc1_enc |= HC1_DST_PREFIX_INLINE;
-
-	memcpy(new_buf_p, &(ip_hdr->dst_addr), 8);
-	new_buf_p += 8;
-	new_len += 8;
-    }
-
-    /* destination address interface identifier */
-    *hc1_enc |= HC1_DST_IFACEID_INLINE;
-    
-    memcpy(new_buf_p, ((void*)&(ip_hdr->dst_addr)) + 8, 8);
-    new_buf_p += 8;
-    new_len += 8;
-
-    /* we're always sending packets with TC anf FL zero */
-    *hc1_enc |= HC1_TCFL_ZERO;
-    
-    /* next header */
-    switch (ip_hdr->nxt_hdr) {
-    case NEXT_HEADER_UDP:
-	*hc1_enc |= HC1_NEXTHDR_UDP;
-	break;
-    case NEXT_HEADER_ICMP6:
-	*hc1_enc |= HC1_NEXTHDR_ICMP;
-	break;
-    case NEXT_HEADER_TCP:
-	*hc1_enc |= HC1_NEXTHDR_TCP;
-	break;
-    default:
-	*hc1_enc |= HC1_NEXTHDR_INLINE;
-
-	*new_buf_p = ip_hdr->nxt_hdr;
-	new_buf_p += sizeof(ip_hdr->nxt_hdr);
-	new_len += sizeof(ip_hdr->nxt_hdr);
-	break;
-    }
-    
-    /* HC_UDP encoding */
-    if ((*hc1_enc & HC1_HC2_MASK) == HC1_HC2_PRESENT
-	&& (*hc1_enc & HC1_NEXTHDR_MASK) == HC1_NEXTHDR_UDP) {
-	
-	/* Source Port */
-	*hc2_enc |= HC2_UDP_SRC_PORT_INLINE;
-	memcpy(new_buf_p, &udp_hdr->src_port, sizeof(udp_hdr->src_port));
-	new_buf_p += sizeof(udp_hdr->src_port);
-	new_len += sizeof(udp_hdr->src_port);
-	
-	/* Destination Port */
-	*hc2_enc |= HC2_UDP_DST_PORT_INLINE;
-	memcpy(new_buf_p, &udp_hdr->dst_port, sizeof(udp_hdr->dst_port));
-	new_buf_p += sizeof(udp_hdr->dst_port);
-	new_len += sizeof(udp_hdr->dst_port);
-
-	/* Length */
-	//*hc2_enc |= HC2_UDP_LEN_COMPR;
-	*hc2_enc |= HC2_UDP_LEN_INLINE;
-	memcpy(new_buf_p, &udp_hdr->len, sizeof(udp_hdr->len));
-	new_buf_p += sizeof(udp_hdr->len);
-	new_len += sizeof(udp_hdr->len);
-
-	/* Checksum */
-	memcpy(new_buf_p, &udp_hdr->chksum, sizeof(udp_hdr->chksum));
-	new_buf_p += sizeof(udp_hdr->chksum);
-	new_len += sizeof(udp_hdr->chksum);
-
-	/* replace the IP and UDP headers with the compressed ones */
-	*len += new_len;
-	*len -= sizeof(struct ip6_hdr);
-	*len -= sizeof(struct udp_hdr);
-	*buf_begin += sizeof(struct ip6_hdr);
-	*buf_begin += sizeof(struct udp_hdr);
-	*buf_begin -= new_len;
-	memcpy(*buf_begin, new_buf, new_len);
+    link->ieee_mode = IEEE154_ADDR_SHORT;
+    if (addr->s6_addr[0] != 0xff &&
+	addr->s6_addr16[4] == 0 &&
+	addr->s6_addr16[5] == htons(0x00FF) &&
+	addr->s6_addr16[6] == htons(0xFE00)) {
+	link->i_saddr = htole16(ntohs(addr->s6_addr16[7]));
     } else {
-	/* replace the IP header with the compressed one */
-	*len += new_len;
-	*len -= sizeof(struct ip6_hdr);
-	*buf_begin += sizeof(struct ip6_hdr);
-	*buf_begin -= new_len;
-	memcpy(*buf_begin, new_buf, new_len);
+	link->i_saddr = htole16(IEEE154_BROADCAST_ADDR);
     }
-
-    return 0;
 }
 
 /* ------------------------------------------------------------------------- */
 /* handling of data arriving on the tun interface */
 
 /*
- * encapsulate buf as an Active Message payload
- * fragments packets if needed
- */
-int serial_output_am_payload(uint8_t *buf, int len,
-			     const hw_addr_t *hw_src_addr,
-			     const hw_addr_t *hw_dst_addr)
-{
-    am_packet_t AMpacket;
-    int result;
-    
-    //debug("%s: dumping buf (len: %d)...\n", __func__, len);
-    //dump_serial_packet(buf, len);
-
-    if (len > LINK_DATA_MTU) {
-	fprintf(stderr, "%s: requested to send more than LINK_DATA_MTU"\
-		"(%d bytes)\n", __func__, len);
-	// TODO: maybe we should send the fisr LINK_DATA_MTU bytes
-	//       and only print a warning
-	return -1;
-    }
-    memset(&AMpacket, 0, sizeof(AMpacket));
-    AMpacket.pkt_type = 0;
-    // TODO: make the dst addr handling more general
-    //AMpacket.dst = htons(0x14);
-    AMpacket.dst = htons(0xFFFF);
-    //AMpacket.src = htons(0x12);
-    // TODO: make the src addr handling more general
-    memcpy(&AMpacket.src, hw_addr.addr_short, 2);
-    AMpacket.group = 0;
-    AMpacket.type = 0x41;
-    AMpacket.length = min(len,LINK_DATA_MTU);
-    //AMpacket.data = buf;
-    memcpy(AMpacket.data, buf, AMpacket.length);
-    
-    len = AMpacket.length + 8; // data + header
-
-    debug("sending to serial port...\n");
-    dump_serial_packet((unsigned char *)&AMpacket, len);
-
-    result = write_serial_packet(ser_src, &AMpacket, len);
-    /*
-     * Returns: 0 if packet successfully written, 1 if successfully
-     * written but not acknowledged, -1 otherwise
-     */
-    debug("write_serial_packet returned %d\n", result);
-
-    if (result < 0) {
-	perror ("sendto");
-	return -1;
-    }
-    return len;
-}
-
-/*
- * read data from the tun device and send it to the serial port
- * does also fragmentation
+ * read a packet from the tun device and send it to the serial port,
+ * compressed and fragmented
+ *
+ * Returns: 1 if a packet was read, 0 if there was none
  */
 int tun_input()
 {
-    uint8_t buf[LOWPAN_MTU + LOWPAN_OVERHEAD];
-    uint8_t *buf_begin = buf + LOWPAN_OVERHEAD;
-    int len;
-    int result;
-    
-    struct lowpan_frag_hdr *frag_hdr;
-    uint8_t dgram_offset = 0;
-    uint16_t dgram_size;
-    hw_addr_t hw_dst_addr;
-    uint8_t frag_len; /* length of the fragment just being sent */
-
-    uint8_t *frame_begin; /* begin of the frame payload */
-    uint8_t frame_len; /* length of the frame payload */
-    
-    len = tun_read (tun_fd, (char*) buf_begin, LOWPAN_MTU);
+    uint8_t buf[INET_MTU];
+    uint8_t frame[1 + FRAME_LEN];
+    struct ip6_packet pkt;
+    struct ip_iovec v;
+    struct lowpan_ctx ctx;
+    struct timeval start, end;
+    int len, rv;
+
+    len = tun_read(tun_fd, (char *) buf, sizeof(buf));
     if (len <= 0) {
-	perror ("read");
+	if (len < 0 && errno != EAGAIN)
+	    perror("tun_read");
 	return 0;
     }
-    printf("data on tun interface\n");
+    gettimeofday(&start, NULL);
+    stats.tx_pkts++;
+    stats.tx_bytes += len;
 
-    /* set 802.15.4 destination address */
-    hw_dst_addr.type = HW_ADDR_SHORT;
-    hw_dst_addr.addr_short[0] =0xFF;
-    hw_dst_addr.addr_short[1] =0xFF;
-    
-    /* HC compression */
-    lowpan_compress(&buf_begin, &len,
-		    &hw_addr, &hw_dst_addr);
-
-    /* prepend dispatch */
-/*     buf_begin--; */
-/*     *buf_begin = DISPATCH_UNCOMPRESSED_IPV6;  */
-/*     len++; */
-
-    /* determine if fragmentation is needed */
-    if (len > LINK_DATA_MTU) {
-	/* fragmentation needed */
-	increment_g_dgram_tag();
-	dgram_size = htons(len);
-	
-	/* first fragment */
-	debug("first fragment... (len: %d, offset: %d)\n",
-	      len, dgram_offset);
-	/* fragment heder */
-	frame_begin = buf_begin - sizeof(struct lowpan_frag_hdr);
-	frag_hdr = (struct lowpan_frag_hdr *) frame_begin;
-	frag_hdr->dgram_size = dgram_size;
-	frag_hdr->dispatch |= DISPATCH_FIRST_FRAG;
-	frag_hdr->dgram_tag = g_dgram_tag;
-	/* align fragment length at an 8-byte multiple */
-	frag_len = LINK_DATA_MTU - sizeof(struct lowpan_frag_hdr);
-	frag_len -= frag_len%8;
-	frame_len = frag_len + sizeof(struct lowpan_frag_hdr);
-	result = serial_output_am_payload(frame_begin, frame_len,
-					  &hw_addr, &hw_dst_addr);
-	if (result < 0) {
-	    perror("serial_output_am_payload() failed\n");
-	    return -1;
-	}
-	buf_begin += frag_len;
-	len -= frag_len;
-	dgram_offset += frag_len/8; /* in 8-byte multiples */
-    
-	/* subseq fragment */
-	while (len > 0) {
-	    usleep(10000); /* workaround to prevent loosing fragments */
-	    debug("subsequent fragment... (len: %d, offset: %d)\n",
-		  len, dgram_offset);
-	    /* dgram_offset */
-	    frame_begin = buf_begin - sizeof(uint8_t);
-	    *(frame_begin) = dgram_offset;
-	    /* fragment heder */
-	    frame_begin -= sizeof(struct lowpan_frag_hdr);
-	    frag_hdr = (struct lowpan_frag_hdr *) frame_begin;
-	    frag_hdr->dgram_size = dgram_size;
-	    frag_hdr->dispatch |= DISPATCH_SUBSEQ_FRAG;
-	    frag_hdr->dgram_tag = g_dgram_tag;
-	    if (len <= LINK_DATA_MTU  - sizeof(struct lowpan_frag_hdr)
-		- sizeof(uint8_t)) {
-		/*
-		 * last fragment does not have to be aligned
-		 * at an 8-byte multiple
-		 */
-		frag_len = len;
-	    } else {
-		/* align fragment length at an 8-byte multiple */
-		frag_len = LINK_DATA_MTU - sizeof(struct lowpan_frag_hdr)
-		           - sizeof(uint8_t);
-		frag_len -= frag_len%8;
-	    }
-	    frame_len = frag_len + sizeof(struct lowpan_frag_hdr)
-		                 + sizeof(uint8_t);
-	    result = serial_output_am_payload(frame_begin, frame_len,
-					      &hw_addr, &hw_dst_addr);
-	    if (result < 0) {
-		perror("serial_output_am_payload() failed\n");
-		//return -1;
-	    }
-	    buf_begin += frag_len;
-	    len -= frag_len;
-	    dgram_offset += frag_len/8; /* in 8-byte multiples */
-	}
+    if (len < sizeof(struct ip6_hdr) ||
+	(buf[0] & 0xf0) != IPV6_VERSION ||
+	ntohs(((struct ip6_hdr *) buf)->ip6_plen) !=
+	len - sizeof(struct ip6_hdr)) {
+	debug("%s: not an IPv6 packet\n", __func__);
+	stats.tx_drops++;
 	return 1;
+    }
 
-    } else {
-	/* no need for fragmentation */
-	serial_output_am_payload(buf_begin, len,
-				 &hw_addr, &hw_dst_addr);
+    memcpy(&pkt.ip6_hdr, buf, sizeof(struct ip6_hdr));
+    v.iov_base = buf + sizeof(struct ip6_hdr);
+    v.iov_len = len - sizeof(struct ip6_hdr);
+    v.iov_next = NULL;
+    pkt.ip6_data = &v;
+
+    resolve_link_addr(&pkt.ip6_hdr.ip6_dst, &tx_frame.ieee_dst);
+    ctx.tag = g_dgram_tag++;
+    ctx.offset = 0;
+    frame[0] = TOS_SERIAL_802_15_4_ID;
+
+    while ((rv = lowpan_frag_get(frame + 1, FRAME_LEN, &pkt, &tx_frame,
+				 &ctx)) > 0) {
+	/* the 802.15.4 length counts the FCS but not itself */
+	frame[1] = rv + 1;
+	frame[4] = g_dsn++;
+	if (write_serial_packet(ser_src, frame, rv + 1) < 0) {
+	    fprintf(stderr, "%s: write_serial_packet failed\n", __func__);
+	    stats.tx_drops++;
+	    return 1;
+	}
+	stats.tx_frames++;
+	stats.tx_frame_bytes += rv + 1;
+    }
+    if (rv < 0) {
+	debug("%s: lowpan_frag_get: %d\n", __func__, rv);
+	stats.tx_drops++;
 	return 1;
     }
 
+    gettimeofday(&end, NULL);
+    latency_add(&stats.tx_lat, &start, &end);
+    return 1;
 }
 
 /* ------------------------------------------------------------------------- */
 /* handling of data arriving on the serial port */
 
-/* 
- * read data on serial port and send it to the tun interface
- * does fragment reassembly
- */
-int serial_input()
+static void deliver(struct lowpan_reconstruct *recon)
 {
-    int result = 0;
-
-    void *ser_data; /* data read from serial port */
-    int ser_len;    /* length of data read from serial port */
-    uint8_t *buf;
-    int len;
-
-    am_packet_t *AMpacket;
-    struct hw_addr hw_src_addr;
-    struct hw_addr hw_dst_addr;
-    uint8_t *dispatch;
-    struct lowpan_broadcast_hdr *bc_hdr;
-    struct lowpan_frag_hdr *frag_hdr;
-
-    uint16_t dgram_tag;
-    uint16_t dgram_size;
-    uint8_t dgram_offset;
-    struct timeval tv;
-    frag_info_t *p;
-    frag_info_t **q;
-    int last_frag;
-    lowpan_pkt_t *pkt;
-
-    printf("serial_input()\n");
-    /* read data from serial port */
-    ser_data = read_serial_packet(ser_src, &ser_len);
-
-    /* process the packet we have received */
-    if (ser_len && ser_data) {
-	printf("dumping data on serial port...\n");
-	dump_serial_packet(ser_data, ser_len);
-	AMpacket = ser_data;
-
-	/* copy 802.15.4 addresses */
-	// TODO: check if I got the byte ordering right
-	hw_src_addr.type = HW_ADDR_SHORT;
-	memcpy(hw_src_addr.addr_short, &AMpacket->src,
-	       sizeof(hw_src_addr.addr_short));
-	hw_dst_addr.type = HW_ADDR_SHORT;
-	memcpy(hw_dst_addr.addr_short, &AMpacket->dst,
-	       sizeof(hw_dst_addr.addr_short));
-
-	/* --- 6lowpan optional headers --- */
-	buf = AMpacket->data;
-	len = AMpacket->length;
-	if (len != ser_len - 8) {
-	    fprintf(stderr,
-		    "warning: mismatch between AMpacket->length(%d)"\
-		    " and ser_len - 8(%d)", AMpacket->length, ser_len - 8);
-	}
-	// TODO: check if length has a sensible value
-	dispatch = AMpacket->data;
-	/* Mesh Addressing header */
-	if ( (*dispatch & DISPATCH_MESH_MASK) == DISPATCH_MESH) {
-	    /* move over the dispatch field */
-	    buf += sizeof(*dispatch);
-	    len -= sizeof(*dispatch);
-
-	    /* Hops Left */
-	    if ((*dispatch & 0x0F) == 0) {
-	      goto discard_packet;
-	    }
-	    
-	    /* Final Destination Address */
-	    if (*dispatch & DISPATCH_MESH_F_FLAG) {
-		hw_dst_addr.type = HW_ADDR_LONG;
-		memcpy(&hw_dst_addr.addr_long, buf,
-		       sizeof(hw_dst_addr.addr_long));
-		buf += sizeof(hw_dst_addr.addr_long);
-		len -= sizeof(hw_dst_addr.addr_long);
-	    } else {
-		hw_dst_addr.type = HW_ADDR_SHORT;
-		memcpy(&hw_dst_addr.addr_short, buf,
-		       sizeof(hw_dst_addr.addr_short));
-		buf += sizeof(hw_dst_addr.addr_short);
-		len -= sizeof(hw_dst_addr.addr_short);
-	    }
-	    
-	    /* check if we're the recipient */
-	    if (cmp_hw_addr(&hw_dst_addr, &hw_addr) != 0
-		&& !hw_addr_is_broadcat(&hw_dst_addr)) {
-		// TODO: if mesh forwarding enabled, then forward
-		goto discard_packet;
-	    }
-	    
-	    /* Originator Address */
-	    if (*dispatch & DISPATCH_MESH_O_FLAG) {
-		hw_src_addr.type = HW_ADDR_LONG;
-		memcpy(&hw_src_addr.addr_long, buf,
-		       sizeof(hw_src_addr.addr_long));
-		buf += sizeof(hw_src_addr.addr_long);
-		len -= sizeof(hw_src_addr.addr_long);
-	    } else {
-		hw_src_addr.type = HW_ADDR_SHORT;
-		memcpy(&hw_src_addr.addr_short, buf,
-		       sizeof(hw_src_addr.addr_short));
-		buf += sizeof(hw_src_addr.addr_short);
-		len -= sizeof(hw_src_addr.addr_short);
-	    }
-	    
-	    dispatch = buf;
-	}
-	/* Broadcast header */
-	if (*dispatch == DISPATCH_BC0) {
-	    bc_hdr = (struct lowpan_broadcast_hdr *) buf;
-	    // do something usefull with bc_hdr->seq_no...
-	    
-	    buf += (sizeof(struct lowpan_broadcast_hdr));
-	    len -= (sizeof(struct lowpan_broadcast_hdr));
-	    dispatch = buf;
-	}
-
-	/* fragment header */
-	if ((*dispatch & DISPATCH_FRAG_MASK)
-	    == DISPATCH_FIRST_FRAG
-	    || (*dispatch & DISPATCH_FRAG_MASK)
-	    == DISPATCH_SUBSEQ_FRAG
-	    ) {
-	    frag_hdr = (struct lowpan_frag_hdr *) buf;
-	    buf += sizeof(struct lowpan_frag_hdr);
-	    len -= sizeof(struct lowpan_frag_hdr);
-
-	    /* collect information about the fragment */
-	    dgram_tag = frag_hdr->dgram_tag;
-	    dgram_size = frag_hdr->dgram_size & htons(0x07FF);
-	    //dgram_size = frag_hdr->dgram_size8[1];
-	    //dgram_size += ((uint16_t) (frag_hdr->dgram_size8[0] & 0x07)) << 8;
-	    if ((*dispatch & DISPATCH_FRAG_MASK) == DISPATCH_SUBSEQ_FRAG) {
-		dgram_offset = *buf;
-		buf += 1;
-		len -= 1;
-	    } else {
-		dgram_offset = 0;
-	    }
-	    
-	    debug("fragment reassembly: tag: 0x%04X, size: %d, offset: %d"\
-		  "(*8=%d)\n",
-		  ntohs(dgram_tag), ntohs(dgram_size),
-		  dgram_offset, dgram_offset*8);
-
-	    pkt = find_fragment(&hw_src_addr, &hw_dst_addr,
-				dgram_size, dgram_tag);
-	    if (pkt) {
-		debug("found an existing reassembly buffer\n");
-		/* fragment reassembly buffer found */
-		/* check for overlap */
-		for (p = pkt->frag_list; p; p=p->next) {
-		    if (dgram_offset == p->offset && len == p->len) {
-			/* duplicate - discard it */
-			result = 0;
-			goto discard_packet;
-		    } else if ((dgram_offset == p->offset && len < p->len) ||
-			       (dgram_offset > p->offset
-				&& dgram_offset < p->offset + p->len/8)
-			       ) {
-			goto frag_overlap;
-		    }
-		}
-		/* no overlap found */
-		goto frag_reassemble;
-	    } else {
-		debug("starting a new reassembly buffer\n");
-		/* fragment reassembly buffer not found - set up a new one */
-		pkt = malloc(sizeof(lowpan_pkt_t));
-		if (!pkt) {
-		    // no free slot for reassembling fragments
-		    fprintf(stderr, "out of memory - dropping a fragment\n");
-		    result = -1;
-		    goto discard_packet;
-		}
-		pkt->next = fragments;
-		fragments = pkt;
-		clear_pkt(pkt);
-		memcpy(&pkt->hw_src_addr, &hw_src_addr, sizeof(hw_src_addr));
-		memcpy(&pkt->hw_dst_addr, &hw_dst_addr, sizeof(hw_dst_addr));
-		pkt->dgram_tag = dgram_tag;
-		pkt->dgram_size = dgram_size;
-		gettimeofday(&tv, NULL);
-		pkt->frag_timeout = tv.tv_sec + FRAG_TIMEOUT;
-		goto frag_reassemble;
-	    }
-	    
-	frag_overlap:
-	    /* overlap - discard previous frags
-	     * and restart freagment reassembly
-	     */
-	    free_frag_list(pkt->frag_list);
-	    pkt->frag_list = NULL;
-	    /* not sure if we want to clear the whole buf */
-	    //memset(&pkt->buf, 0, sizeof(pkt->buf));
-	    gettimeofday(&tv, NULL);
-	    pkt->frag_timeout = tv.tv_sec + FRAG_TIMEOUT;
-	    goto frag_reassemble;
-	    
-	frag_reassemble:
-	    /* copy buf data */
-	    debug("dgram_offset: %d\n", dgram_offset);
-	    memcpy(pkt->buf_begin + dgram_offset*8, buf, len);
-	    //TODO: make sure a large len does not cause a buffer overflow
-
-	    /* update frag_info */
-	    p = malloc(sizeof(frag_info_t));
-	    if (!p) {
-		fprintf(stderr, "out of memory - fragment "\
-			"reassembly failing\n");
-	    } else {
-		p->offset = dgram_offset;
-		p->len = len;
-
-		/* insert frag_info into the orderer list */
-		if (pkt->frag_list) {
-		    for(q = &(pkt->frag_list); (*q)->next; q=&((*q)->next)) {
-			if (p->offset > (*q)->offset) {
-			    break;
-			}
-		    }
-		    if ((*q)) {
-			debug("inserting frag_info before offset %d\n",
-			      (*q)->offset);
-		    } else {
-			debug("inserting frag_info at the beginning/end\n");
-		    }
-
-		    p->next = *q;
-		    *q = p;
-		} else {
-		    debug("inserting frag_info to the beginning "
-			  "of the list\n");
-		    p->next = pkt->frag_list;
-		    pkt->frag_list = p;
-		}
-	    }
-
-	    /* check if this is not the last fragment */
-	    if (!dgram_offset) {
-		/* the first fragment cannot be the last one */
-		last_frag = 0;
-	    } else {
-		debug("checking last_frag...\n");
-		last_frag=1;
-		dgram_offset = ntohs(dgram_size)/8;
-		for(p=pkt->frag_list; p && dgram_offset; p=p->next) {
-		    debug("dgram_offset: %d, p->offset: %d, p->len: %d\n",
-			  dgram_offset, p->offset, p->len);
-		    if (p->offset + p->len/8 != dgram_offset) {
-			debug("offset mismatch - not the last fragment\n");
-			last_frag = 0;
-			break;
-		    }
-		    dgram_offset = p->offset;
-		}
-	    }
-
-	    if (last_frag) {
-		debug("last fragment, reassembly done\n");
-		pkt->len = ntohs(dgram_size);
-		
-		debug("dumping reassembled datagram...\n");
-		dump_serial_packet(pkt->buf_begin, pkt->len);
-		
-		/* pass up the complete packet */
-		result = serial_input_layer3(pkt->buf_begin, pkt->len,
-					     &hw_src_addr, &hw_dst_addr);
-		/* deallocate pkt and all fragment info */
-		free_lowpan_pkt(pkt);
-	    } else {
-		result = 0;
-	    }
-	} else { /* no fragment header present */
-	    result =  serial_input_layer3(buf, len,
-					  &hw_src_addr, &hw_dst_addr);
-	}
-	
-    } else {
-	//printf("no data on serial port, but FD trigerred select\n");
-    }
- discard_packet:
-    if (ser_data) {
-	free(ser_data);
-    }
-    if (ser_data && ser_len > 0) {
-	return 1;
-    } else {
-	return 0;
+    struct ip6_hdr *iph = (struct ip6_hdr *) recon->r_buf;
+
+    /* the payload length field is always compressed, have to put it
+       back here */
+    iph->ip6_plen = htons(recon->r_bytes_rcvd - sizeof(struct ip6_hdr));
+    if (tun_write(tun_fd, (char *) recon->r_buf, recon->r_bytes_rcvd) < 0) {
+	perror("tun_write");
+	stats.rx_drops++;
+	return;
     }
-    //return result;
+    stats.rx_pkts++;
+    stats.rx_bytes += recon->r_bytes_rcvd;
 }
 
-int serial_input_layer3(uint8_t *buf, int len,
-			const hw_addr_t *hw_src_addr,
-			const hw_addr_t *hw_dst_addr)
+/* Effects: hands a reassembled datagram to the tun interface and
+     notes how long it took from its first fragment */
+static void recon_done(struct lowpan_reconstruct *recon,
+		       const struct timeval *now)
 {
-    uint8_t *dispatch = buf;
-    //debug("%s()\n", __func__);
-    //dump_serial_packet(buf, len);
+    int slot = recon - recon_slots;
 
-    if (len <= 0) return 1;
+    deliver(recon);
+    latency_add(&stats.rx_lat, &recon_start[slot].start, now);
+    recon_start[slot].start.tv_sec = 0;
+    lowpan_recon_release(&recon_table, recon);
+}
 
-    /* uncompressed IPv6 */
-    if (*dispatch == 0x41) {
-	return serial_input_ipv6_uncompressed(buf+1, len-1,
-					      hw_src_addr, hw_dst_addr);
+/* remember when a datagram's first fragment arrived */
+static void recon_started(struct lowpan_reconstruct *recon,
+			  const struct timeval *now)
+{
+    int slot = recon - recon_slots;
 
-    }
-    /* LOWPAN_HC1 compressed IPv6 */
-    else if (*dispatch == 0x42) {
-	return serial_input_ipv6_compressed(buf+1, len-1,
-					    hw_src_addr, hw_dst_addr);
-    }
-    /* unknown dispatch value if we got here */
-    else {
-	debug("unknown dispatch value: %X\n", *dispatch);
-	return tun_write(tun_fd, (char*) buf+1, len-1);
+    if (recon_start[slot].start.tv_sec == 0 ||
+	recon_start[slot].tag != recon->r_tag ||
+	recon_start[slot].source_key != recon->r_source_key) {
+	recon_start[slot].tag = recon->r_tag;
+	recon_start[slot].source_key = recon->r_source_key;
+	recon_start[slot].start = *now;
     }
 }
 
-int serial_input_ipv6_uncompressed(uint8_t *buf, int len,
-				   const hw_addr_t *hw_src_addr,
-				   const hw_addr_t *hw_dst_addr)
+/*
+ * read a frame from the serial port, and send the packet it carries or
+ * completes to the tun interface
+ *
+ * Returns: 1 if a frame was read, 0 if there was none
+ */
+int serial_input()
 {
-    debug("%s()\n", __func__);
-    //dump_serial_packet(buf, len);
-    // TODO: update neighbor table
-    return tun_write(tun_fd, (char*) buf, len);
-}
+    struct ieee154_frame_addr frame;
+    struct packed_lowmsg lowmsg;
+    struct timeval now;
+    uint8_t *ser_data, *buf;
+    int ser_len, rv;
+    size_t len;
 
-int serial_input_ipv6_compressed(uint8_t *buf, int len,
-				 const hw_addr_t *hw_src_addr,
-				 const hw_addr_t *hw_dst_addr)
-{
-    int ret=0;
-    int new_len;
-    uint8_t *new_buf;
-
-    debug("%s()\n", __func__);
-    if (0 == lowpan_decompress(buf, len,
-			       hw_src_addr, hw_dst_addr,
-			       &new_buf, &new_len)
-	) {
-	// TODO: update neighbor table
-	buf = new_buf;
-	len = new_len;
-	ret =  tun_write(tun_fd, (char*) buf, len);
-	
-	if (new_buf && new_len) {
-	    free(new_buf);
+    ser_data = read_serial_packet(ser_src, &ser_len);
+    if (!ser_data)
+	return 0;
+    gettimeofday(&now, NULL);
+    stats.rx_frames++;
+    stats.rx_frame_bytes += ser_len;
+
+    if (ser_len < 2 || ser_data[0] != TOS_SERIAL_802_15_4_ID) {
+	debug("%s: not an 802.15.4 frame\n", __func__);
+	goto drop;
+    }
+
+    /* unpack the 802.15.4 address fields */
+    buf = ser_data + 1;
+    len = ser_len - 1;
+    if (unpack_ieee154_hdr(&buf, &len, &frame) < 0)
+	goto drop;
+
+    /* unpack any 6lowpan headers */
+    lowmsg.data = buf;
+    lowmsg.len = len;
+    lowmsg.headers = getHeaderBitmap(&lowmsg);
+    if (lowmsg.headers == LOWMSG_NALP)
+	goto drop;
+
+    if (hasFrag1Header(&lowmsg) || hasFragNHeader(&lowmsg)) {
+	struct lowpan_reconstruct *recon;
+
+	rv = lowpan_recon_input(&recon_table, &frame, buf, len, &recon);
+	if (rv < 0) {
+	    debug("%s: fragment dropped: %d\n", __func__, rv);
+	    goto drop;
 	}
+	recon_started(recon, &now);
+	if (rv > 0)
+	    recon_done(recon, &now);
+    } else {
+	/* no fragmentation, just deliver it */
+	struct lowpan_reconstruct recon;
+
+	if (lowpan_recon_start(&frame, &recon, buf, len) < 0)
+	    goto drop;
+	if (recon.r_size == recon.r_bytes_rcvd)
+	    deliver(&recon);
+	ip_free(recon.r_buf);
     }
-    
-    return ret;
+    free(ser_data);
+    return 1;
+
+ drop:
+    stats.rx_drops++;
+    free(ser_data);
+    return 1;
 }
 
 /* ------------------------------------------------------------------------- */
 
-void timer_fired()
+/* Returns: ms from now until t, at least 0 */
+static int ms_until(const struct timeval *t)
 {
-    struct timeval tv;
-    lowpan_pkt_t *p;
-    lowpan_pkt_t **q;
-
-    /* time out old fragments */
-    (void) gettimeofday(&tv, NULL);
-    for(q = &fragments; *q; ) {
-	if ((*q)->frag_timeout > tv.tv_sec) {
-	    p = (*q)->next;
-	    free(*q);
-	    *q = p;
-	} else {
-	    q = &((*q)->next);
-	}
+    struct timeval now;
+    long us;
+
+    gettimeofday(&now, NULL);
+    us = elapsed_us(&now, t);
+    return us > 0 ? (us + 999) / 1000 : 0;
+}
+
+static void add_ms(struct timeval *t, int ms)
+{
+    t->tv_sec += ms / 1000;
+    t->tv_usec += (ms % 1000) * 1000;
+    if (t->tv_usec >= 1000000) {
+	t->tv_sec++;
+	t->tv_usec -= 1000000;
     }
-    // TODO: ND retransmission
-    // TODO: neighbor table timeouts
 }
 
 /* shifts data between the serial port and the tun interface */
 int serial_tunnel(serial_source ser_src, int tun_fd) {
-    //int result;
-    fd_set fs;
-    
-    while (1) {
-	FD_ZERO (&fs);
-	FD_SET (tun_fd, &fs);
-	FD_SET (serial_source_fd(ser_src), &fs);
+    struct epoll_event ev, events[2];
+    struct timeval next_age, next_stats;
+    int ep, ser_fd = serial_source_fd(ser_src);
+    int n, i, timeout, t, tun_ready, ser_ready;
+
+    ep = epoll_create(2);
+    if (ep < 0) {
+	perror("epoll_create");
+	return -1;
+    }
+    memset(&ev, 0, sizeof(ev));
+    ev.events = EPOLLIN;
+    ev.data.fd = tun_fd;
+    if (epoll_ctl(ep, EPOLL_CTL_ADD, tun_fd, &ev) < 0) {
+	perror("epoll_ctl");
+	close(ep);
+	return -1;
+    }
+    ev.data.fd = ser_fd;
+    if (epoll_ctl(ep, EPOLL_CTL_ADD, ser_fd, &ev) < 0) {
+	perror("epoll_ctl");
+	close(ep);
+	return -1;
+    }
 
-	select (tun_fd>serial_source_fd(ser_src)?
-		tun_fd+1 : serial_source_fd(ser_src)+1,
-		&fs, NULL, NULL, NULL);
+    gettimeofday(&next_age, NULL);
+    next_stats = last_report = next_age;
+    add_ms(&next_age, FRAG_EXPIRE_TIME);
+    next_stats.tv_sec += STATS_INTERVAL;
+    tun_ready = ser_ready = 0;
+
+    while (!g_quit) {
+	/* don't wait while either side still has packets from the last
+	   batch. Writing a packet can leave received frames buffered in
+	   the serial source, which epoll won't report: read them now */
+	if (!serial_source_empty(ser_src))
+	    ser_ready = 1;
+	if (tun_ready || ser_ready) {
+	    timeout = 0;
+	} else {
+	    timeout = ms_until(&next_age);
+	    t = ms_until(&next_stats);
+	    if (t < timeout) timeout = t;
+	    t = serial_source_timeout(ser_src);
+	    if (t >= 0 && t < timeout) timeout = t;
+	}
 
-	debug("--- select() fired ---\n");
+	n = epoll_wait(ep, events, 2, timeout);
+	if (n < 0 && errno != EINTR) {
+	    perror("epoll_wait");
+	    break;
+	}
+	for (i = 0; i < n; i++) {
+	    if (events[i].data.fd == tun_fd)
+		tun_ready = 1;
+	    else
+		ser_ready = 1;
+	}
+	if (serial_source_timeout(ser_src) == 0)
+	    ser_ready = 1;
 
 	/* data available on tunnel device */
-	if (FD_ISSET (tun_fd, &fs)) {
-	    //result = tun_input();
-	    while( tun_input() );
+	if (tun_ready) {
+	    for (i = 0; i < TUN_BATCH && tun_input(); i++)
+		;
+	    tun_ready = i == TUN_BATCH;
 	}
-	
-	/* data available on serial port */
-	if (FD_ISSET (serial_source_fd(ser_src), &fs)) {
-	    /* more packets may be queued so process them all */
-	    while (serial_input());
-	    /* using serial_source_empty() seems to make select()
-	     * fire way too often, so the above solution is better */
-	    //while(! serial_source_empty(ser_src)) {
-	    //result = serial_input();
-		//}
+
+	/* data available on serial port; this also services the serial
+	   source's retransmissions */
+	if (ser_ready) {
+	    for (i = 0; i < SERIAL_BATCH && serial_input(); i++)
+		;
+	    ser_ready = i == SERIAL_BATCH;
+	}
+
+	if (ms_until(&next_age) == 0) {
+	    /* time out old fragments */
+	    lowpan_recon_age(&recon_table);
+	    add_ms(&next_age, FRAG_EXPIRE_TIME);
+	}
+	if (ms_until(&next_stats) == 0) {
+	    if (stats.tx_pkts != last_stats.tx_pkts ||
+		stats.rx_frames != last_stats.rx_frames)
+		print_stats();
+	    next_stats.tv_sec += STATS_INTERVAL;
+	}
+	if (g_report) {
+	    g_report = 0;
+	    print_stats();
 	}
-	/* end of data available */
     }
-    /* end of while(1) */
-    
+
+    close(ep);
     return 0;
 }
 
 int main(int argc, char **argv) {
+    struct sigaction sa;
     char dev[16];
-    
-    if (argc != 3)
-	{
-	    fprintf(stderr, "Usage: %s <device> <rate>\n", argv[0]);
-	    exit(2);
+    int c;
+
+    while ((c = getopt(argc, argv, "v")) != -1) {
+	switch (c) {
+	case 'v':
+	    verbose = 1;
+	    break;
+	default:
+	    goto usage;
 	}
-    
-    hw_addr.type = HW_ADDR_SHORT;
-    hw_addr.addr_short[0] = 0x00; // network byte order
-    hw_addr.addr_short[1] = 0x12;
+    }
+    if (argc - optind != 2) {
+    usage:
+	fprintf(stderr, "Usage: %s [-v] <device> <rate>\n", argv[0]);
+	exit(2);
+    }
+
+    memset(&tx_frame, 0, sizeof(tx_frame));
+    tx_frame.ieee_src.ieee_mode = IEEE154_ADDR_SHORT;
+    tx_frame.ieee_src.i_saddr = htole16(TUN_SADDR);
+    tx_frame.ieee_dstpan = htole16(TUN_PANID);
+
+    ip_malloc_init();
+    lowpan_recon_init(&recon_table, recon_slots, N_RECON, 0);
 
     /* create the tunnel device */
     dev[0] = 0;
@@ -1215,35 +605,43 @@ int main(int argc, char **argv) {
     }
     
     /* open the serial port */
-    ser_src = open_serial_source(argv[1], platform_baud_rate(argv[2]),
+    ser_src = open_serial_source(argv[optind], platform_baud_rate(argv[optind + 1]),
 				 1, stderr_msg);
     /* 0 - blocking reads
      * 1 - non-blocking reads
      */
     
     if (!ser_src) {
-	debug("Couldn't open serial port at %s:%s\n",
-		argv[1], argv[2]);
+	fprintf(stderr, "Couldn't open serial port at %s:%s\n",
+		argv[optind], argv[optind + 1]);
 	exit(1);
     }
     
-    /* set up the tun interface */
+    /* set up the tun interface; the addresses end in the link address,
+       so IPHC can elide them */
     printf("\n");
-    ssystem("ifconfig tun0 up");
-    ssystem("ifconfig tun0 mtu 1280");
-    ssystem("ifconfig tun0 inet6 add 2001:0638:0709:1234::fffe:12/64");
-    ssystem("ifconfig tun0 inet6 add fe80::fffe:12/64");
+    ssystem("ifconfig %s up", dev);
+    ssystem("ifconfig %s mtu 1280", dev);
+    ssystem("ifconfig %s inet6 add 2001:0638:0709:1234::ff:fe00:%x/64",
+	    dev, TUN_SADDR);
+    ssystem("ifconfig %s inet6 add fe80::ff:fe00:%x/64", dev, TUN_SADDR);
     printf("\n");
 
-    printf("try:\n\tsudo ping6 -s 0 2001:0638:0709:1234::fffe:14\n"
-	   "\tnc6 -u 2001:0638:0709:1234::fffe:14 1234\n\n");
+    printf("try:\n\tsudo ping6 -s 0 2001:0638:0709:1234::ff:fe00:14\n"
+	   "\tnc6 -u 2001:0638:0709:1234::ff:fe00:14 1234\n\n");
+
+    memset(&sa, 0, sizeof(sa));
+    sa.sa_handler = on_signal;
+    sigaction(SIGUSR1, &sa, NULL);
+    sigaction(SIGINT, &sa, NULL);
+    sigaction(SIGTERM, &sa, NULL);
 
     /* start tunneling */
     serial_tunnel(ser_src, tun_fd);
+    print_stats();
     
     /* clean up */
     close_serial_source(ser_src);
-    //close(ser_fd);
     tun_close(tun_fd, dev);
     return 0;
 }
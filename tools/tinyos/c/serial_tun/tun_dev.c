@@ -36,6 +36,7 @@
 #include <string.h>
 #include <syslog.h>
 #include <errno.h>
+#include <sys/uio.h>
 
 #include <arpa/inet.h>
 #include <sys/ioctl.h>
@@ -92,38 +93,36 @@ int tun_read(int fd, char *buf, int len)
     return read(fd, buf, len);
 }
 */
+/* the packet information header goes in front of each packet; read and
+   write it with the packet rather than copying them together */
 int tun_write(int fd, char *buf, int len)
 {
     int out;
     struct tun_pi pi = {0, htons(ETH_P_IPV6)};
-    char *nbuf = malloc(len+sizeof(struct tun_pi));
-    if (!nbuf) {
-	fprintf(stderr, "tun_write: out of memory!");
+    struct iovec v[2];
+
+    v[0].iov_base = &pi;
+    v[0].iov_len = sizeof(struct tun_pi);
+    v[1].iov_base = buf;
+    v[1].iov_len = len;
+    out = writev(fd, v, 2);
+    if (out < (int)sizeof(struct tun_pi))
 	return -1;
-    }
-    memcpy(nbuf, &pi, sizeof(struct tun_pi));
-    memcpy(nbuf+sizeof(struct tun_pi), buf, len);
-    out = write(fd, nbuf, len+sizeof(struct tun_pi));
-    free(nbuf);
-    return out;
+    return out - sizeof(struct tun_pi);
 }
 
 int tun_read(int fd, char *buf, int len)
 {
     int out;
-    char *nbuf = malloc(len+sizeof(struct tun_pi));
-    if (!nbuf) {
-	fprintf(stderr, "tun_read: out of memory!");
-	return -1;
-    }
-    out=read(fd, nbuf, len+sizeof(struct tun_pi));
-    if (out > 0 && out >= sizeof(struct tun_pi)) {
-	out-=sizeof(struct tun_pi);
-	memcpy(buf, nbuf+sizeof(struct tun_pi), out);
-	free(nbuf);
-	return out;
-    } else {
-	free(nbuf);
+    struct tun_pi pi;
+    struct iovec v[2];
+
+    v[0].iov_base = &pi;
+    v[0].iov_len = sizeof(struct tun_pi);
+    v[1].iov_base = buf;
+    v[1].iov_len = len;
+    out = readv(fd, v, 2);
+    if (out < (int)sizeof(struct tun_pi))
 	return -1;
-    }
+    return out - sizeof(struct tun_pi);
 }
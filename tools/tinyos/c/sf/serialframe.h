@@ -0,0 +1,87 @@
+#ifndef SERIALFRAME_H
+#define SERIALFRAME_H
+
+/* HDLC-like framing of the mote serial protocol (TEP113): flag bytes,
+   byte stuffing and the CRC-16 trailer. Shared by the serial source and
+   the tools built on it; none of these functions allocates memory. */
+
+#include <stdint.h>
+#include <stddef.h>
+#if defined(_WIN32) && !defined(__CYGWIN__)
+struct iovec {
+  void *iov_base;
+  size_t iov_len;
+};
+#else
+#include <sys/uio.h>
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+enum {
+  SERIAL_FRAME_MTU = 256	/* longest frame, crc included */
+};
+
+/* Room needed to encode len bytes: every byte and the crc may need
+   escaping, plus the two flags */
+#define SERIAL_FRAME_ENCODED_MAX(len) (2 * ((len) + 2) + 2)
+
+typedef struct {
+  const uint8_t *data;		/* protocol byte onwards, crc stripped */
+  int len;
+  int64_t stamp;		/* stamp of the chunk holding the first byte */
+} serial_frame;
+
+typedef enum {
+  serial_deframe_more,		/* all data used, no complete frame */
+  serial_deframe_frame,		/* a frame with a good crc */
+  serial_deframe_sync,		/* first flag byte found */
+  serial_deframe_too_long,	/* longer than SERIAL_FRAME_MTU, sync lost */
+  serial_deframe_bad_sync,	/* flag byte after an escape */
+  serial_deframe_bad_crc
+} serial_deframe_result;
+
+typedef struct {
+  uint8_t frame[SERIAL_FRAME_MTU];
+  int count;
+  int in_sync, escaped;
+  int64_t stamp;
+} serial_deframer;
+
+void serial_deframer_init(serial_deframer *d);
+/* Effects: resets d to look for the next flag byte */
+
+serial_deframe_result serial_deframe(serial_deframer *d,
+				     const uint8_t *data, int len,
+				     int64_t stamp, int *used,
+				     serial_frame *frame);
+/* Effects: consumes bytes of data until a frame is complete, something
+     noteworthy happens or all len bytes are used, and sets *used to the
+     number of bytes consumed. Call again with the rest of data until it
+     returns serial_deframe_more. Chunks may be split anywhere. stamp
+     (any unit, e.g. the time data was read) is passed on to the frames
+     starting in data.
+   Returns: what happened. For serial_deframe_frame, *frame points into
+     d and is valid until the next call.
+*/
+
+uint16_t serial_crc(uint16_t crc, const void *data, int len);
+/* Returns: crc updated with len bytes of data (CRC-16-CCITT, start
+     with 0)
+*/
+
+int serial_frame_encode(struct iovec *out, const struct iovec *in, int count);
+/* Effects: escapes the concatenation of the count parts of in, followed
+     by their crc, between two flag bytes into out->iov_base in one
+     pass, and sets out->iov_len to the frame length. out->iov_len must
+     be at least SERIAL_FRAME_ENCODED_MAX(total length of in).
+   Returns: 0, or -1 if out is too small (out is then unchanged)
+*/
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
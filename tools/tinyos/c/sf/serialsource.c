@@ -35,6 +35,7 @@
 
 #include "serialsource.h"
 #include "serialprotocol.h"
+#include "serialframe.h"
 
 typedef int bool;
 
@@ -48,13 +49,22 @@ enum {
   BUFSIZE = 256,
   MTU = 256,
   ACK_TIMEOUT = 100000, /* in us */
-  SYNC_BYTE = SERIAL_HDLC_FLAG_BYTE,
-  ESCAPE_BYTE = SERIAL_HDLC_CTLESC_BYTE,
 
   P_ACK = SERIAL_SERIAL_PROTO_ACK,
   P_PACKET_ACK = SERIAL_SERIAL_PROTO_PACKET_ACK,
   P_PACKET_NO_ACK = SERIAL_SERIAL_PROTO_PACKET_NOACK,
-  P_UNKNOWN = SERIAL_SERIAL_PROTO_PACKET_UNKNOWN
+  P_UNKNOWN = SERIAL_SERIAL_PROTO_PACKET_UNKNOWN,
+  P_WINDOW = SERIAL_SERIAL_PROTO_WINDOW,
+  P_PACKET_SEQ = SERIAL_SERIAL_PROTO_PACKET_SEQ,
+  P_SACK = SERIAL_SERIAL_PROTO_SACK,
+
+  /* Windowed protocol, see tos/lib/serial/README.txt */
+  WINDOW_SIZE = SERIAL_SERIAL_WINDOW_SIZE,
+  SYNC_ATTEMPTS = 3, /* unanswered P_WINDOW frames before stop-and-wait */
+  MAX_RETRIES = 5,
+  W_STOP_AND_WAIT = 0,
+  W_PROBING,
+  W_WINDOWED
 };
 
 struct packet_list
@@ -64,6 +74,16 @@ struct packet_list
   struct packet_list *next;
 };
 
+struct window_slot
+{
+  uint8_t *packet;
+  int len;
+  int64_t deadline; /* next retransmission, 0 if due now */
+  bool sent, acked;
+  int retries;
+  unsigned order; /* transmission order, 0 if never sent */
+};
+
 struct serial_source_t {
 #ifndef LOSE32
   int fd;
@@ -77,16 +97,24 @@ struct serial_source_t {
   struct {
     uint8_t buffer[BUFSIZE];
     int bufpos, bufused;
-    uint8_t packet[MTU];
-    bool in_sync, escaped;
-    int count;
+    serial_deframer deframer;
     struct packet_list *queue[256]; // indexed by protocol
   } recv;
   struct {
     uint8_t seqno;
-    uint8_t *escaped;
-    int escapeptr;
-    uint16_t crc;
+
+    /* Windowed protocol state. Packets base..next-1 are in slots
+       (seqno % WINDOW_SIZE) until acked or dropped */
+    int mode;
+    int window; /* granted by the node */
+    uint8_t base, next;
+    unsigned order;
+    struct window_slot slots[WINDOW_SIZE];
+    bool syncing;
+    int64_t sync_deadline;
+    int sync_attempts;
+    uint8_t sync_base;
+    int dropped;
   } send;
 };
 
@@ -323,10 +351,13 @@ serial_source open_serial_source(const char *device, int baud_rate,
       if (src)
 	{
 	  memset(src, 0, sizeof *src);
+	  serial_deframer_init(&src->recv.deframer);
 	  src->fd = fd;
 	  src->non_blocking = non_blocking;
 	  src->message = message;
 	  src->send.seqno = 37;
+	  src->send.mode = W_PROBING;
+	  src->send.window = 1;
 
 	  return src;
 	}
@@ -367,6 +398,7 @@ serial_source open_serial_source(const char *device, int baud_rate,
 
     if (src) {
 	  memset(src, 0, sizeof *src);
+	  serial_deframer_init(&src->recv.deframer);
 	  src->hComm = hComm;
 	  src->non_blocking = non_blocking;
 	  src->message = message;
@@ -405,12 +437,16 @@ int close_serial_source(serial_source src)
      considered closed anyway)
  */
 {
+  int i;
 #ifndef LOSE32
   int ok = close(src->fd);
 #else
   int ok = CloseHandle(src->hComm);
 #endif
 
+  for (i = 0; i < WINDOW_SIZE; i++)
+    free(src->send.slots[i].packet);
+
   free(src);
 
   return ok;
@@ -581,163 +617,97 @@ int serial_source_empty(serial_source src)
     !packet_available(src, P_PACKET_NO_ACK);
 }
 
-/* Slow implementation of crc function */
-static uint16_t crc_byte(uint16_t crc, uint8_t b)
-{
-  uint8_t i;
-
-  crc = crc ^ b << 8;
-  i = 8;
-  do
-    if (crc & 0x8000)
-      crc = crc << 1 ^ 0x1021;
-    else
-      crc = crc << 1;
-  while (--i);
-
-  return crc;
-}
-
-static uint16_t crc_packet(uint8_t *data, int len)
-{
-  uint16_t crc = 0;
-
-  while (len-- > 0)
-    crc = crc_byte(crc, *data++);
-
-  return crc;
-}
-
-static int read_byte(serial_source src, int non_blocking)
-/* Returns: next byte (>= 0), or -1 if no data available and non-blocking is true.
+static int fill_buffer(serial_source src, int non_blocking)
+/* Effects: reads the next chunk of data into src->recv.buffer
+   Returns: 0, or -1 if no data available and non-blocking is true.
 */
 {
-  if (src->recv.bufpos >= src->recv.bufused)
+  for (;;)
     {
-      for (;;)
-	{
-	  int n = serial_read(src, non_blocking, src->recv.buffer, sizeof src->recv.buffer);
+      int n = serial_read(src, non_blocking, src->recv.buffer, sizeof src->recv.buffer);
 
-	  if (n == 0) /* Can't occur because of serial_read bug workaround */
-	    {
-	      message(src, msg_closed);
-	      return -1;
-	    }
-	  if (n > 0)
-	    {
+      if (n == 0) /* Can't occur because of serial_read bug workaround */
+	{
+	  message(src, msg_closed);
+	  return -1;
+	}
+      if (n > 0)
+	{
 #ifdef DEBUG
-	      dump("raw", src->recv.buffer, n);
+	  dump("raw", src->recv.buffer, n);
 #endif
-	      src->recv.bufpos = 0;
-	      src->recv.bufused = n;
-	      break;
-	    }
+	  src->recv.bufpos = 0;
+	  src->recv.bufused = n;
+	  return 0;
+	}
 #ifndef LOSE32
-	  if (errno == EAGAIN)
-	    return -1;
-	  if (errno != EINTR)
-	    message(src, msg_unix_error);
+      if (errno == EAGAIN)
+	return -1;
+      if (errno != EINTR)
+	message(src, msg_unix_error);
 #endif
     }
-    }
-  //printf("in %02x\n", src->recv.buffer[src->recv.bufpos]);
-  return src->recv.buffer[src->recv.bufpos++];
 }
 
 static void process_packet(serial_source src, uint8_t *packet, int len);
 static int write_framed_packet(serial_source src,
 			       uint8_t packet_type, uint8_t first_byte,
 			       const uint8_t *packet, int count);
+static bool window_ack(serial_source src, uint8_t seqno);
+static void window_sack(serial_source src, uint8_t cumulative, uint8_t mask);
+static void window_reply(serial_source src, uint8_t base, uint8_t size);
+static int window_service(serial_source src);
+static int window_wait(serial_source src);
 
 static void read_and_process(serial_source src, int non_blocking)
 /* Effects: reads and processes up to one packet.
 */
 {
-  uint8_t *packet = src->recv.packet;
-
   for (;;)
     {
-      int byte = read_byte(src, non_blocking);
+      serial_frame frame;
+      uint8_t *received;
+      int used;
 
-      if (byte < 0)
+      if (src->recv.bufpos >= src->recv.bufused &&
+	  fill_buffer(src, non_blocking) < 0)
 	return;
 
-      if (!src->recv.in_sync)
-	{
-	  if (byte == SYNC_BYTE)
-	    {
-	      src->recv.in_sync = TRUE;
-	      message(src, msg_sync);
-	      src->recv.count = 0;
-	      src->recv.escaped = FALSE;
-	    }
-	  continue;
-	}
-      if (src->recv.count >= MTU)
+      switch (serial_deframe(&src->recv.deframer,
+			     src->recv.buffer + src->recv.bufpos,
+			     src->recv.bufused - src->recv.bufpos,
+			     0, &used, &frame))
 	{
+	case serial_deframe_more:
+	  break;
+	case serial_deframe_sync:
+	  message(src, msg_sync);
+	  break;
+	case serial_deframe_too_long:
 	  message(src, msg_too_long);
-	  src->recv.in_sync = FALSE;
-	  continue;
-	}
-      if (src->recv.escaped)
-	{
-	  if (byte == SYNC_BYTE)
-	    {
-	      /* sync byte following escape is an error, resync */
-	      message(src, msg_bad_sync);
-	      src->recv.in_sync = FALSE;
-	      continue;
-	    }
-	  byte ^= 0x20;
-	  src->recv.escaped = FALSE;
-	}
-      else if (byte == ESCAPE_BYTE)
-	{
-	  src->recv.escaped = TRUE;
-	  continue;
-	}
-      else if (byte == SYNC_BYTE)
-	{
-	  int count = src->recv.count;
-	  uint8_t *received;
-	  uint16_t read_crc, computed_crc;
-
-	  src->recv.count = 0; /* ready for next packet */
-
-	  if (count < 4)
-	    /* frames that are too small are ignored */
-	    continue;
-
-	  received = malloc(count - 2);
-	  if (!received)
-	    {
-	      message(src, msg_no_memory);
-	      continue;
-	    }
-	  memcpy(received, packet, count - 2);
-
-	  read_crc = packet[count - 2] | packet[count - 1] << 8;
-	  computed_crc = crc_packet(received, count - 2);
-
+	  break;
+	case serial_deframe_bad_sync:
+	  message(src, msg_bad_sync);
+	  break;
+	case serial_deframe_bad_crc:
+	  message(src, msg_bad_crc);
+	  break;
+	case serial_deframe_frame:
+	  src->recv.bufpos += used;
 #ifdef DEBUG
-	  dump("received", packet, count);
-	  printf("  crc %x comp %x\n", read_crc, computed_crc);
+	  dump("received", (unsigned char *)frame.data, frame.len);
 #endif
-	  if (read_crc == computed_crc)
-	    {
-	      process_packet(src, received, count - 2);
-	      return; /* give rest of world chance to do something */
-	    }
-	  else
+	  received = malloc(frame.len);
+	  if (!received)
 	    {
-	      message(src, msg_bad_crc);
-	      free(received);
-	      /* We don't lose sync here. If we did, garbage on the line
-		 at startup will cause loss of the first packet. */
+	      message(src, msg_no_memory);
 	      continue;
 	    }
+	  memcpy(received, frame.data, frame.len);
+	  process_packet(src, received, frame.len);
+	  return; /* give rest of world chance to do something */
 	}
-      packet[src->recv.count++] = byte;
+      src->recv.bufpos += used;
     }
 }
 
@@ -745,6 +715,27 @@ static void process_packet(serial_source src, uint8_t *packet, int len)
 {
   int packet_type = packet[0], offset = 1;
 
+  switch (packet_type)
+    {
+    case P_ACK:
+      if (len >= 2 && window_ack(src, packet[1]))
+	{
+	  free(packet);
+	  return;
+	}
+      break;
+    case P_SACK:
+      if (len >= 3)
+	window_sack(src, packet[1], packet[2]);
+      free(packet);
+      return;
+    case P_WINDOW:
+      if (len >= 4)
+	window_reply(src, packet[1], packet[3]);
+      free(packet);
+      return;
+    }
+
   if (packet_type == P_PACKET_ACK)
     {
       /* send ack */
@@ -768,6 +759,7 @@ void *read_serial_packet(serial_source src, int *len)
 */
 {
   read_and_process(src, TRUE);
+  window_service(src);
   for (;;)
     {
       struct packet_list *entry;
@@ -784,110 +776,376 @@ void *read_serial_packet(serial_source src, int *len)
 	}
       if (src->non_blocking && serial_source_empty(src))
 	return NULL;
-      source_wait(src, NULL);
-      read_and_process(src, src->non_blocking);
+      if (src->send.base != src->send.next || src->send.syncing)
+	/* keep retransmitting while waiting */
+	window_wait(src);
+      else
+	{
+	  source_wait(src, NULL);
+	  read_and_process(src, src->non_blocking);
+	}
     }
 }
 
-/* The escaper does the sync bytes+escape-like encoding+crc of packets */
-
-static void escape_add(serial_source src, uint8_t b)
+// Write a packet of type 'packetType', first byte 'firstByte'
+// and bytes 2..'count'+1 in 'packet'
+static int write_framed_packet(serial_source src,
+			       uint8_t packet_type, uint8_t first_byte,
+			       const uint8_t *packet, int count)
 {
-  src->send.escaped[src->send.escapeptr++] = b;
-}
+  uint8_t header[2], encoded[SERIAL_FRAME_ENCODED_MAX(MTU)];
+  struct iovec in[2], out;
 
-static int init_escaper(serial_source src, int count)
-{
-  src->send.escaped = malloc(count * 2 + 2);
-  if (!src->send.escaped)
+#ifdef DEBUG
+  printf("writing %02x %02x", packet_type, first_byte);
+  dump("", (unsigned char *)packet, count);
+#endif
+
+  header[0] = packet_type;
+  header[1] = first_byte;
+  in[0].iov_base = header;
+  in[0].iov_len = sizeof header;
+  in[1].iov_base = (void *)packet;
+  in[1].iov_len = count;
+  out.iov_base = encoded;
+  out.iov_len = sizeof encoded;
+  if (serial_frame_encode(&out, in, 2) < 0)
     {
-      message(src, msg_no_memory);
+      message(src, msg_too_long);
       return -1;
     }
-  src->send.escapeptr = 0;
-  src->send.crc = 0;
 
-  escape_add(src, SYNC_BYTE);
+#ifdef DEBUG
+  dump("encoded", encoded, out.iov_len);
+#endif
 
+  if (source_write(src, encoded, out.iov_len) < 0)
+    return -1;
   return 0;
 }
 
-static void terminate_escaper(serial_source src)
+static void add_timeval(struct timeval *tv, long us)
+/* Specialised for this app */
+{
+  tv->tv_sec += us / 1000000;
+  tv->tv_usec += us % 1000000;
+  if (tv->tv_usec > 1000000)
+    {
+      tv->tv_usec -= 1000000;
+      tv->tv_sec++;
+    }
+}
+
+/* The windowed protocol. Packets are kept in their slot until the node
+   acks them with P_SACK (or P_ACK after falling back to stop-and-wait),
+   so that they can be retransmitted. Only unix sources probe for it. */
+
+static int64_t now_us(void)
+{
+#ifndef LOSE32
+  struct timeval tv;
+
+  gettimeofday(&tv, NULL);
+  return (int64_t)tv.tv_sec * 1000000 + tv.tv_usec;
+#else
+  return (int64_t)GetTickCount() * 1000;
+#endif
+}
+
+static struct window_slot *window_slot(serial_source src, uint8_t seqno)
 {
-  escape_add(src, SYNC_BYTE);
+  return &src->send.slots[seqno % WINDOW_SIZE];
 }
 
-static void escape_byte(serial_source src, uint8_t b)
+static int window_outstanding(serial_source src)
 {
-  src->send.crc = crc_byte(src->send.crc, b);
-  if (b == SYNC_BYTE || b == ESCAPE_BYTE)
+  return (uint8_t)(src->send.next - src->send.base);
+}
+
+static int window_limit(serial_source src)
+{
+  return src->send.mode == W_WINDOWED ? src->send.window : 1;
+}
+
+static void window_start_sync(serial_source src)
+/* Effects: sends P_WINDOW frames that restart the node's window at base
+     until it answers, nothing else is sent meanwhile
+*/
+{
+  if (src->send.syncing)
+    return;
+  src->send.syncing = TRUE;
+  src->send.sync_deadline = 0;
+  src->send.sync_attempts = 0;
+  src->send.sync_base = src->send.base;
+}
+
+static void window_resend_all(serial_source src)
+{
+  uint8_t seqno;
+
+  for (seqno = src->send.base; seqno != src->send.next; seqno++)
     {
-      escape_add(src, ESCAPE_BYTE);
-      escape_add(src, b ^ 0x20);
+      struct window_slot *slot = window_slot(src, seqno);
+
+      slot->sent = FALSE;
+      slot->deadline = 0;
     }
-  else
-    escape_add(src, b);
 }
 
-static void free_escaper(serial_source src)
+static void window_advance(serial_source src)
 {
-  free(src->send.escaped);
+  while (src->send.base != src->send.next &&
+	 window_slot(src, src->send.base)->acked)
+    {
+      struct window_slot *slot = window_slot(src, src->send.base);
+
+      free(slot->packet);
+      slot->packet = NULL;
+      src->send.base++;
+    }
 }
 
-// Write a packet of type 'packetType', first byte 'firstByte'
-// and bytes 2..'count'+1 in 'packet'
-static int write_framed_packet(serial_source src,
-			       uint8_t packet_type, uint8_t first_byte,
-			       const uint8_t *packet, int count)
+static unsigned window_ack_slot(serial_source src, uint8_t seqno)
+/* Returns: the transmission order of seqno, 0 if it was acked already */
 {
-  int i, crc;
+  struct window_slot *slot = window_slot(src, seqno);
 
-#ifdef DEBUG
-  printf("writing %02x %02x", packet_type, first_byte);
-  dump("", packet, count);
-#endif
+  if (slot->acked)
+    return 0;
+  slot->acked = TRUE;
+  return slot->order;
+}
 
-  if (init_escaper(src, count + 4) < 0)
-    return -1;
+static bool window_ack(serial_source src, uint8_t seqno)
+/* Effects: handles the P_ACK of a packet sent from the window after
+     falling back to stop-and-wait
+   Returns: FALSE if the window is empty, i.e., the ack is for
+     write_and_wait
+*/
+{
+  struct window_slot *slot = window_slot(src, src->send.base);
 
-  escape_byte(src, packet_type);
-  escape_byte(src, first_byte);
-  for (i = 0; i < count; i++)
-    escape_byte(src, packet[i]);
+  if (src->send.base == src->send.next)
+    return FALSE;
+  if (src->send.mode != W_WINDOWED && slot->sent && seqno == src->send.base)
+    {
+      slot->acked = TRUE;
+      window_advance(src);
+    }
+  return TRUE;
+}
 
-  crc = src->send.crc;
-  escape_byte(src, crc & 0xff);
-  escape_byte(src, crc >> 8);
+static void window_sack(serial_source src, uint8_t cumulative, uint8_t mask)
+/* Effects: handles [next expected seqno] [bit i: next + 1 + i received] */
+{
+  unsigned latest = 0, sent;
+  uint8_t seqno;
+  int i;
 
-  terminate_escaper(src);
+  if (src->send.mode != W_WINDOWED || src->send.syncing)
+    return;
+  if ((uint8_t)(cumulative - src->send.base) > window_outstanding(src))
+    {
+      /* the node lost its state, or waits for a packet we dropped */
+      window_start_sync(src);
+      return;
+    }
+  for (seqno = src->send.base; seqno != cumulative; seqno++)
+    if ((sent = window_ack_slot(src, seqno)) > latest)
+      latest = sent;
+  for (i = 0; i < 8; i++)
+    {
+      seqno = cumulative + 1 + i;
+      if ((mask & 1 << i) &&
+	  (uint8_t)(seqno - src->send.base) < window_outstanding(src) &&
+	  (sent = window_ack_slot(src, seqno)) > latest)
+	latest = sent;
+    }
+  window_advance(src);
 
-#ifdef DEBUG
-  dump("encoded", src->send.escaped, src->send.escapeptr);
-#endif
+  /* The line does not reorder: what was sent before an acked packet
+     and is not acked is lost */
+  for (seqno = src->send.base; seqno != src->send.next; seqno++)
+    {
+      struct window_slot *slot = window_slot(src, seqno);
+
+      if (slot->sent && !slot->acked && slot->order < latest)
+	{
+	  slot->sent = FALSE;
+	  slot->deadline = 0;
+	}
+    }
+}
 
-  if (source_write(src, src->send.escaped, src->send.escapeptr) < 0)
+static void window_reply(serial_source src, uint8_t base, uint8_t size)
+/* Effects: handles [base] [version] [window], window 0 if the node lost
+     its state
+*/
+{
+  if (size == 0)
     {
-      free_escaper(src);
-      return -1;
+      if (src->send.mode == W_WINDOWED)
+	window_start_sync(src);
+      return;
+    }
+  if (!src->send.syncing || base != src->send.sync_base)
+    return; /* late answer to an earlier attempt */
+
+  src->send.syncing = FALSE;
+  src->send.window = size < WINDOW_SIZE ? size : WINDOW_SIZE;
+  src->send.mode = W_WINDOWED;
+  window_resend_all(src);
+}
+
+static int window_poll(serial_source src, int64_t now)
+/* Effects: writes the next frame that is due at now
+   Returns: 1 if a frame was written, 0 if none is due, -1 on error
+*/
+{
+  int i;
+
+  if (src->send.syncing)
+    {
+      if (src->send.sync_deadline > now)
+	return 0;
+      if (src->send.sync_attempts < SYNC_ATTEMPTS)
+	{
+	  uint8_t request[2] = { SERIAL_SERIAL_WINDOW_VERSION, WINDOW_SIZE };
+
+	  src->send.sync_attempts++;
+	  src->send.sync_deadline = now + ACK_TIMEOUT;
+	  if (write_framed_packet(src, P_WINDOW, src->send.sync_base,
+				  request, sizeof request) < 0)
+	    return -1;
+	  return 1;
+	}
+      /* an old image */
+      src->send.syncing = FALSE;
+      src->send.mode = W_STOP_AND_WAIT;
+      window_resend_all(src);
+    }
+
+  for (i = 0; i < window_outstanding(src) && i < window_limit(src); i++)
+    {
+      uint8_t seqno = src->send.base + i;
+      struct window_slot *slot = window_slot(src, seqno);
+
+      if (slot->acked || (slot->sent && slot->deadline > now))
+	continue;
+      if (slot->order)
+	{
+	  /* timed out, or lost according to a sack */
+	  if (slot->retries >= MAX_RETRIES)
+	    {
+	      message(src, msg_ack_timeout);
+	      src->send.dropped++;
+	      slot->acked = TRUE;
+	      window_advance(src);
+	      if (src->send.mode == W_WINDOWED)
+		/* move the node's window past the dropped packet */
+		window_start_sync(src);
+	      return window_poll(src, now);
+	    }
+	  slot->retries++;
+	  if (src->send.mode == W_WINDOWED && slot->sent &&
+	      slot->retries == SYNC_ATTEMPTS)
+	    {
+	      /* the node went silent, it may have been reprogrammed */
+	      window_start_sync(src);
+	      return window_poll(src, now);
+	    }
+	}
+      slot->sent = TRUE;
+      slot->order = ++src->send.order;
+      slot->deadline = now + (int64_t)ACK_TIMEOUT * (slot->retries + 1);
+      if (write_framed_packet(src, src->send.mode == W_WINDOWED ?
+			      P_PACKET_SEQ : P_PACKET_ACK,
+			      seqno, slot->packet, slot->len) < 0)
+	return -1;
+      return 1;
     }
-  free_escaper(src);
   return 0;
 }
 
-static void add_timeval(struct timeval *tv, long us)
-/* Specialised for this app */
+static int64_t window_deadline(serial_source src)
+/* Returns: the time window_poll has something to write, 0 for now,
+     -1 for never
+*/
 {
-  tv->tv_sec += us / 1000000;
-  tv->tv_usec += us % 1000000;
-  if (tv->tv_usec > 1000000)
+  int64_t deadline = -1;
+  int i;
+
+  if (src->send.syncing)
+    return src->send.sync_deadline;
+  for (i = 0; i < window_outstanding(src) && i < window_limit(src); i++)
     {
-      tv->tv_usec -= 1000000;
-      tv->tv_sec++;
+      struct window_slot *slot = window_slot(src, src->send.base + i);
+
+      if (slot->acked)
+	continue;
+      if (!slot->sent)
+	return 0;
+      if (deadline < 0 || slot->deadline < deadline)
+	deadline = slot->deadline;
     }
+  return deadline;
 }
 
-int write_serial_packet(serial_source src, const void *packet, int len)
-/* Effects: writes len byte packet to serial source src
+static int window_service(serial_source src)
+/* Effects: writes all frames that are due
+   Returns: 0, or -1 if a write failed
+*/
+{
+  int64_t now = now_us();
+  int ok;
+
+  while ((ok = window_poll(src, now)) > 0)
+    ;
+  return ok;
+}
+
+static int window_wait(serial_source src)
+/* Effects: writes the frames that are due and, if anything is still
+     pending, waits for data or the next retransmission and processes up
+     to one packet
+   Returns: 0, or -1 if a write failed
+*/
+{
+  int64_t at;
+
+  if (window_service(src) < 0)
+    return -1;
+  at = window_deadline(src);
+  if (at >= 0)
+    {
+      struct timeval deadline;
+
+      deadline.tv_sec = at / 1000000;
+      deadline.tv_usec = at % 1000000;
+      source_wait(src, &deadline);
+      read_and_process(src, TRUE);
+    }
+  /* else the window just emptied (e.g., after falling back) */
+  return 0;
+}
+
+int serial_source_timeout(serial_source src)
+/* Returns: the number of milliseconds until src has a frame to
+     retransmit, or -1 if nothing is pending. Callers which wait for
+     serial_source_fd themselves must call read_serial_packet by then
+*/
+{
+  int64_t at = window_deadline(src), now;
+
+  if (at < 0)
+    return -1;
+  now = now_us();
+  return at <= now ? 0 : (int)((at - now + 999) / 1000);
+}
+
+static int write_and_wait(serial_source src, const void *packet, int len)
+/* Effects: writes len byte packet with the stop-and-wait protocol
    Returns: 0 if packet successfully written, 1 if successfully written
      but not acknowledged, -1 otherwise
 */
@@ -925,6 +1183,56 @@ int write_serial_packet(serial_source src, const void *packet, int len)
     }
 }
 
+int write_serial_packet(serial_source src, const void *packet, int len)
+/* Effects: writes len byte packet to serial source src. If the node
+     speaks the windowed protocol, non-blocking sources only wait for
+     room in the window; packets which are never acknowledged are then
+     reported as msg_ack_timeout
+   Returns: 0 if packet successfully written, 1 if successfully written
+     but not acknowledged, -1 otherwise
+*/
+{
+  struct window_slot *slot;
+  int dropped = src->send.dropped;
+  uint8_t seqno;
+
+  if (src->send.mode == W_PROBING && !src->send.syncing)
+    window_start_sync(src);
+  while (src->send.syncing ||
+	 window_outstanding(src) >= window_limit(src))
+    if (window_wait(src) < 0)
+      return -1;
+  if (src->send.mode == W_STOP_AND_WAIT)
+    return write_and_wait(src, packet, len);
+
+  seqno = src->send.next;
+  slot = window_slot(src, seqno);
+  slot->packet = malloc(len);
+  if (!slot->packet && len > 0)
+    {
+      message(src, msg_no_memory);
+      return -1;
+    }
+  memcpy(slot->packet, packet, len);
+  slot->len = len;
+  slot->deadline = 0;
+  slot->sent = slot->acked = FALSE;
+  slot->retries = 0;
+  slot->order = 0;
+  src->send.next++;
+
+  if (window_service(src) < 0)
+    return -1;
+  if (src->non_blocking)
+    return 0;
+
+  /* blocking sources wait for the ack, as with stop-and-wait */
+  while ((uint8_t)(seqno - src->send.base) < window_outstanding(src))
+    if (window_wait(src) < 0)
+      return -1;
+  return src->send.dropped != dropped;
+}
+
 /* This somewhat convoluted code allows us to use a common baudrate table
    with the Java code. This could be improved if we generated the Java
    code from a common table.
@@ -76,11 +76,20 @@ void *read_serial_packet(serial_source src, int *len);
 */
 
 int write_serial_packet(serial_source src, const void *packet, int len);
-/* Effects: writes len byte packet to serial source src
+/* Effects: writes len byte packet to serial source src. If the node
+     speaks the windowed protocol, non-blocking sources only wait for
+     room in the window; packets which are never acknowledged are then
+     reported as msg_ack_timeout
    Returns: 0 if packet successfully written, 1 if successfully written
      but not acknowledged, -1 otherwise
 */
 
+int serial_source_timeout(serial_source src);
+/* Returns: the number of milliseconds until src has a frame to
+     retransmit, or -1 if nothing is pending. Callers which wait for
+     serial_source_fd themselves must call read_serial_packet by then
+*/
+
 int platform_baud_rate(char *platform_name);
 /* Returns: The baud rate of the specified platform, or -1 for unknown
      platforms. If platform_name starts with a digit, just return 
@@ -265,8 +265,8 @@ int main(int argc, char **argv)
     {
       fd_set rfds;
       int maxfd = -1;
-      struct timeval zero;
-      int serial_empty;
+      struct timeval zero, wait;
+      int serial_empty, timeout;
       int ret;
 
       zero.tv_sec = zero.tv_usec = 0;
@@ -277,8 +277,18 @@ int main(int argc, char **argv)
       wait_clients(&rfds, &maxfd);
 
       serial_empty = serial_source_empty(src);
-      if (serial_empty)
+      timeout = serial_source_timeout(src);
+      if (serial_empty && timeout < 0)
 	ret = select(maxfd + 1, &rfds, NULL, NULL, NULL);
+      else if (serial_empty)
+	{
+	  /* wake up for the next retransmission */
+	  wait.tv_sec = timeout / 1000;
+	  wait.tv_usec = timeout % 1000 * 1000;
+	  ret = select(maxfd + 1, &rfds, NULL, NULL, &wait);
+	  if (ret == 0)
+	    check_serial();
+	}
       else
 	{
 	  ret = select(maxfd + 1, &rfds, NULL, NULL, &zero);
@@ -0,0 +1,367 @@
+/* Fuzz and throughput harness for serialframe.c.
+
+   bench_serialframe [iterations] [megabytes]
+
+   The fuzz part feeds random streams (frames, corrupted frames, stray
+   flags and escapes, garbage) to serial_deframe in random chunks and
+   checks every result against a byte-at-a-time model of the protocol,
+   and checks that everything serial_frame_encode writes decodes to
+   what went in. The throughput part encodes and decodes megabytes of
+   random frames and fails if that is slower than a 3 Mbaud line. */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/time.h>
+
+#include "serialframe.h"
+#include "serialprotocol.h"
+
+enum {
+  SYNC_BYTE = SERIAL_HDLC_FLAG_BYTE,
+  ESCAPE_BYTE = SERIAL_HDLC_CTLESC_BYTE,
+  STREAM_MAX = 1 << 16,
+  LINE_RATE = 3000000 /* baud, 10 bits per byte */
+};
+
+static int failures;
+
+#define CHECK(cond, ...)					\
+  do {								\
+    if (!(cond))						\
+      {								\
+	printf("FAIL %s:%d: ", __FILE__, __LINE__);		\
+	printf(__VA_ARGS__);					\
+	putchar('\n');						\
+	failures++;						\
+	return;							\
+      }								\
+  } while (0)
+
+static double now(void)
+{
+  struct timeval tv;
+
+  gettimeofday(&tv, NULL);
+  return tv.tv_sec + tv.tv_usec / 1e6;
+}
+
+/* The bit-serial crc from tos/system/crc.h */
+static uint16_t crc_byte(uint16_t crc, uint8_t b)
+{
+  int i;
+
+  crc = crc ^ b << 8;
+  for (i = 0; i < 8; i++)
+    crc = crc & 0x8000 ? crc << 1 ^ 0x1021 : crc << 1;
+  return crc;
+}
+
+/* Byte-at-a-time model of serial_deframe: one event per byte at most */
+struct model {
+  uint8_t frame[SERIAL_FRAME_MTU];
+  int count, in_sync, escaped, start, len;
+};
+
+/* Returns: the event for byte at offset pos of the stream, or
+     serial_deframe_more. For frames, *start is the offset of their
+     first byte. */
+static serial_deframe_result model_byte(struct model *m, uint8_t byte,
+					int pos, int *start)
+{
+  if (!m->in_sync)
+    {
+      if (byte != SYNC_BYTE)
+	return serial_deframe_more;
+      m->in_sync = 1;
+      m->count = m->escaped = 0;
+      return serial_deframe_sync;
+    }
+  if (byte == SYNC_BYTE)
+    {
+      int count = m->count, i;
+      uint16_t crc = 0;
+
+      m->count = 0;
+      if (m->escaped)
+	{
+	  m->escaped = 0;
+	  return serial_deframe_bad_sync;
+	}
+      if (count < 4)
+	return serial_deframe_more;
+      for (i = 0; i < count - 2; i++)
+	crc = crc_byte(crc, m->frame[i]);
+      if (crc != (m->frame[count - 2] | m->frame[count - 1] << 8))
+	return serial_deframe_bad_crc;
+      *start = m->start;
+      m->len = count - 2;
+      return serial_deframe_frame;
+    }
+  if (m->count >= SERIAL_FRAME_MTU)
+    {
+      m->in_sync = 0;
+      return serial_deframe_too_long;
+    }
+  if (m->count == 0 && !m->escaped)
+    m->start = pos;
+  if (m->escaped)
+    {
+      byte ^= 0x20;
+      m->escaped = 0;
+    }
+  else if (byte == ESCAPE_BYTE)
+    {
+      m->escaped = 1;
+      return serial_deframe_more;
+    }
+  m->frame[m->count++] = byte;
+  return serial_deframe_more;
+}
+
+static int random_frame(uint8_t *out, int room)
+/* Returns: length of a random encoded frame written to out, maybe
+     damaged */
+{
+  uint8_t payload[300];
+  struct iovec in[3], enc;
+  int len = rand() % 8 ? rand() % 64 + 2 : rand() % 300 + 1, i, cut;
+
+  for (i = 0; i < len; i++)
+    payload[i] = rand() % 4 ? rand() : (rand() % 2 ? SYNC_BYTE : ESCAPE_BYTE);
+  cut = rand() % (len + 1);
+  in[0].iov_base = payload;
+  in[0].iov_len = cut;
+  in[1].iov_base = payload + cut;
+  in[1].iov_len = 0;
+  in[2].iov_base = payload + cut;
+  in[2].iov_len = len - cut;
+  enc.iov_base = out;
+  enc.iov_len = room;
+  if (serial_frame_encode(&enc, in, 3) < 0)
+    return 0;
+  switch (rand() % 16)
+    {
+    case 0: /* bit error */
+      out[rand() % enc.iov_len] ^= 1 << rand() % 8;
+      break;
+    case 1: /* lost closing flag */
+      enc.iov_len--;
+      break;
+    case 2: /* escape before the closing flag */
+      out[enc.iov_len - 1] = ESCAPE_BYTE;
+      out[enc.iov_len++] = SYNC_BYTE;
+      break;
+    }
+  return enc.iov_len;
+}
+
+static int random_stream(uint8_t *stream)
+{
+  int len = 0;
+
+  while (len < STREAM_MAX - 1024)
+    {
+      int i;
+
+      switch (rand() % 8)
+	{
+	case 0: /* garbage */
+	  for (i = rand() % 16; i > 0; i--)
+	    stream[len++] = rand();
+	  break;
+	case 1:
+	  stream[len++] = SYNC_BYTE;
+	  break;
+	default:
+	  len += random_frame(stream + len, 1024);
+	  break;
+	}
+      if (rand() % 64 == 0)
+	break;
+    }
+  return len;
+}
+
+static void fuzz_deframe(void)
+{
+  static uint8_t stream[STREAM_MAX];
+  static int chunk_start[STREAM_MAX];
+  serial_deframer d;
+  struct model m;
+  int len = random_stream(stream), pos = 0, mpos = 0;
+
+  serial_deframer_init(&d);
+  memset(&m, 0, sizeof m);
+  while (pos < len)
+    {
+      int chunk = rand() % 4 ? rand() % 8 + 1 : rand() % 512 + 1, off = 0;
+
+      if (chunk > len - pos)
+	chunk = len - pos;
+      for (off = 0; off < chunk; off++)
+	chunk_start[pos + off] = pos;
+      off = 0;
+      for (;;)
+	{
+	  serial_frame frame;
+	  serial_deframe_result r, expected = serial_deframe_more;
+	  int used, start = -1;
+
+	  r = serial_deframe(&d, stream + pos + off, chunk - off, pos,
+			     &used, &frame);
+	  CHECK(used >= 0 && used <= chunk - off, "used %d of %d", used,
+		chunk - off);
+	  /* the model must agree on every byte consumed */
+	  while (mpos < pos + off + used)
+	    {
+	      serial_deframe_result e = model_byte(&m, stream[mpos], mpos,
+						   &start);
+	      mpos++;
+	      if (e != serial_deframe_more)
+		{
+		  expected = e;
+		  break;
+		}
+	    }
+	  CHECK(r == expected && mpos == pos + off + used,
+		"result %d, expected %d at %d", r, expected, mpos);
+	  if (r == serial_deframe_frame)
+	    {
+	      CHECK(frame.len == m.len &&
+		    !memcmp(frame.data, m.frame, frame.len),
+		    "frame contents at %d", mpos);
+	      CHECK(frame.stamp == chunk_start[start],
+		    "stamp %lld for a frame starting at %d",
+		    (long long)frame.stamp, start);
+	    }
+	  off += used;
+	  if (r == serial_deframe_more)
+	    break;
+	}
+      pos += chunk;
+    }
+}
+
+static void fuzz_roundtrip(void)
+{
+  uint8_t payload[SERIAL_FRAME_MTU], encoded[SERIAL_FRAME_ENCODED_MAX(SERIAL_FRAME_MTU)];
+  struct iovec in[4], out;
+  serial_deframer d;
+  serial_frame frame;
+  int len = rand() % (SERIAL_FRAME_MTU - 3) + 2, i, n, used, off = 0;
+  uint16_t crc = 0;
+
+  for (i = 0; i < len; i++)
+    payload[i] = rand() % 3 ? rand() : (rand() % 2 ? SYNC_BYTE : ESCAPE_BYTE);
+  for (i = 0; i < len; i++)
+    crc = crc_byte(crc, payload[i]);
+  CHECK(serial_crc(0, payload, len) == crc, "crc of %d bytes", len);
+
+  /* split into up to 4 parts */
+  for (n = 0; n < 4 && off < len; n++)
+    {
+      int part = n == 3 ? len - off : rand() % (len - off + 1);
+
+      in[n].iov_base = payload + off;
+      in[n].iov_len = part;
+      off += part;
+    }
+  in[n - 1].iov_len += len - off;
+
+  out.iov_base = encoded;
+  out.iov_len = SERIAL_FRAME_ENCODED_MAX(len) - 1;
+  CHECK(serial_frame_encode(&out, in, n) < 0 &&
+	out.iov_len == SERIAL_FRAME_ENCODED_MAX(len) - 1,
+	"encode into a short buffer");
+  out.iov_len = sizeof encoded;
+  CHECK(serial_frame_encode(&out, in, n) == 0, "encode %d bytes", len);
+  for (i = 1; i < (int)out.iov_len - 1; i++)
+    CHECK(encoded[i] != SYNC_BYTE, "flag inside the frame");
+
+  serial_deframer_init(&d);
+  CHECK(serial_deframe(&d, encoded, out.iov_len, 7, &used, &frame) ==
+	serial_deframe_sync && used == 1, "sync");
+  CHECK(serial_deframe(&d, encoded + 1, out.iov_len - 1, 7, &used, &frame) ==
+	serial_deframe_frame && used == (int)out.iov_len - 1, "decode");
+  CHECK(frame.len == len && !memcmp(frame.data, payload, len) &&
+	frame.stamp == 7, "roundtrip of %d bytes", len);
+}
+
+static void throughput(int megabytes)
+{
+  static uint8_t stream[1 << 20];
+  uint8_t payload[128];
+  struct iovec in, out;
+  serial_deframer d;
+  serial_frame frame;
+  long frames = 0, decoded = 0, bytes = 0;
+  double t0, encode_time, decode_time, rate;
+  int len = 0, i, m, k;
+
+  for (i = 0; i < (int)sizeof payload; i++)
+    payload[i] = rand();
+  in.iov_base = payload;
+
+  t0 = now();
+  for (m = 0; m < megabytes; m++)
+    for (len = 0, k = 0; len < (int)sizeof stream - SERIAL_FRAME_ENCODED_MAX(128); k++)
+      {
+	in.iov_len = 20 + k % 100;
+	out.iov_base = stream + len;
+	out.iov_len = sizeof stream - len;
+	serial_frame_encode(&out, &in, 1);
+	len += out.iov_len;
+	frames++;
+      }
+  encode_time = now() - t0;
+
+  serial_deframer_init(&d);
+  t0 = now();
+  for (m = 0; m < megabytes; m++)
+    for (i = 0; i < len; )
+      {
+	int chunk = len - i < 4096 ? len - i : 4096, off = 0, used;
+
+	while (off < chunk)
+	  {
+	    if (serial_deframe(&d, stream + i + off, chunk - off, 0, &used,
+			       &frame) == serial_deframe_frame)
+	      decoded++;
+	    off += used;
+	  }
+	i += chunk;
+	bytes += chunk;
+      }
+  decode_time = now() - t0;
+
+  printf("encode: %ld frames, %.1f MB/s\n", frames,
+	 bytes / encode_time / 1e6);
+  rate = bytes / decode_time;
+  printf("decode: %ld frames, %.1f MB/s (%.0f Mbaud)\n", decoded,
+	 rate / 1e6, rate * 10 / 1e6);
+  if (decoded != frames || rate * 10 < LINE_RATE ||
+      bytes / encode_time * 10 < LINE_RATE)
+    {
+      printf("FAIL slower than %d baud or frames lost\n", LINE_RATE);
+      failures++;
+    }
+}
+
+int main(int argc, char **argv)
+{
+  int iterations = argc > 1 ? atoi(argv[1]) : 2000;
+  int megabytes = argc > 2 ? atoi(argv[2]) : 16;
+  int i;
+
+  srand(1);
+  for (i = 0; i < iterations && failures < 10; i++)
+    {
+      fuzz_deframe();
+      fuzz_roundtrip();
+    }
+  printf("fuzz: %d iterations, %d failures\n", iterations, failures);
+  throughput(megabytes);
+
+  return failures != 0;
+}
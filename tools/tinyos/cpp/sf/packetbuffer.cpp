@@ -32,136 +32,390 @@
 
 #include "packetbuffer.h"
 
-#include "pthread.h"
-#include <algorithm>
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <stdint.h>
+#ifdef __linux__
+#include <sys/eventfd.h>
+#endif
 
-PacketBuffer::PacketBuffer()
+/*
+ * Lock-free ring lanes. The producer owns tail; head is normally only
+ * advanced by the consumer, but a DROP_OLDEST producer and clear()
+ * advance it too, so every move of head is a compare-and-swap. The
+ * consumer copies packets out *before* it claims them: if its CAS
+ * fails, the slots it copied may have been recycled meanwhile and the
+ * copies are simply thrown away. SFPacket is copied by plain
+ * assignment (fixed size) so such a torn copy is harmless.
+ */
+
+static unsigned roundUpPowerOfTwo(unsigned value)
 {
-    pthread_mutex_init(&buffer.lock, NULL);
-    pthread_cond_init(&buffer.notempty, NULL);
-    pthread_cond_init(&buffer.notfull, NULL);
+    unsigned result = 1;
+    while (result < value)
+    {
+        result <<= 1;
+    }
+    return result;
 }
 
+PacketBuffer::PacketBuffer(unsigned pDepth, overflowPolicy_t pPolicy) : policy(pPolicy), consumerWaiting(0), enqueuedCount(0), dequeuedCount(0), droppedOldestCount(0), droppedNewestCount(0), producerStallCount(0), consumerWakeupCount(0)
+{
+    if (pDepth == 0)
+    {
+        pDepth = 1;
+    }
+    initRing(front, cFrontBufferSize);
+    initRing(back, pDepth);
+    openWakeup(dataFD);
+}
 
 PacketBuffer::~PacketBuffer()
 {
-  pthread_cond_destroy(&buffer.notempty);
-  pthread_cond_destroy(&buffer.notfull);
-  pthread_mutex_destroy(&buffer.lock);
+    destroyRing(front);
+    destroyRing(back);
+    closeWakeup(dataFD);
+}
+
+void PacketBuffer::initRing(ring_t& ring, unsigned depth)
+{
+    unsigned capacity = roundUpPowerOfTwo(depth);
+    ring.slots = new SFPacket[capacity];
+    ring.mask = capacity - 1;
+    ring.limit = depth;
+    ring.head = 0;
+    ring.tail = 0;
+    ring.producerWaiting = 0;
+    openWakeup(ring.spaceFD);
+}
+
+void PacketBuffer::destroyRing(ring_t& ring)
+{
+    delete[] ring.slots;
+    ring.slots = NULL;
+    closeWakeup(ring.spaceFD);
+}
+
+void PacketBuffer::openWakeup(int fds[2])
+{
+#ifdef __linux__
+    fds[0] = fds[1] = eventfd(0, EFD_CLOEXEC);
+    if (fds[0] >= 0)
+    {
+        return;
+    }
+#endif
+    if (pipe(fds) == 0)
+    {
+        // a full pipe already holds a pending wakeup
+        fcntl(fds[1], F_SETFL, O_NONBLOCK);
+        fcntl(fds[0], F_SETFD, FD_CLOEXEC);
+        fcntl(fds[1], F_SETFD, FD_CLOEXEC);
+    }
+    else
+    {
+        fds[0] = fds[1] = -1;
+    }
+}
+
+void PacketBuffer::closeWakeup(int fds[2])
+{
+    if (fds[0] >= 0)
+    {
+        close(fds[0]);
+    }
+    if (fds[1] >= 0 && fds[1] != fds[0])
+    {
+        close(fds[1]);
+    }
+    fds[0] = fds[1] = -1;
+}
+
+void PacketBuffer::signalWakeup(int fds[2])
+{
+    uint64_t one = 1;
+    // eventfd wants exactly 8 bytes, a pipe takes whatever we give it
+    size_t len = (fds[0] == fds[1]) ? sizeof(one) : 1;
+    while (write(fds[1], &one, len) < 0 && errno == EINTR)
+        ;
+}
+
+void PacketBuffer::waitWakeup(int fds[2])
+{
+    char buf[64];
+    if (fds[0] < 0)
+    {
+        // no wakeup channel: poll
+        usleep(1000);
+        pthread_testcancel();
+        return;
+    }
+    // read() is a cancellation point
+    while (read(fds[0], buf, sizeof(buf)) < 0 && errno == EINTR)
+        ;
+}
+
+unsigned PacketBuffer::size(const ring_t& ring)
+{
+    // head never passes tail, so read head first
+    unsigned head = __atomic_load_n(&ring.head, __ATOMIC_SEQ_CST);
+    unsigned tail = __atomic_load_n(&ring.tail, __ATOMIC_SEQ_CST);
+    return tail - head;
+}
+
+bool PacketBuffer::enqueue(ring_t& ring, const SFPacket& pPacket)
+{
+    unsigned tail = ring.tail;
+    bool lossless = true;
+    while (tail - __atomic_load_n(&ring.head, __ATOMIC_ACQUIRE) >= ring.limit)
+    {
+        if (policy == DROP_NEWEST)
+        {
+            __atomic_fetch_add(&droppedNewestCount, 1, __ATOMIC_RELAXED);
+            DEBUG("PacketBuffer::enqueue : full, dropped newest")
+            return false;
+        }
+        else if (policy == DROP_OLDEST)
+        {
+            unsigned head = __atomic_load_n(&ring.head, __ATOMIC_ACQUIRE);
+            if ((tail - head >= ring.limit) &&
+                __atomic_compare_exchange_n(&ring.head, &head, head + 1, false,
+                                            __ATOMIC_SEQ_CST, __ATOMIC_ACQUIRE))
+            {
+                __atomic_fetch_add(&droppedOldestCount, 1, __ATOMIC_RELAXED);
+                DEBUG("PacketBuffer::enqueue : full, dropped oldest")
+                lossless = false;
+            }
+        }
+        else
+        {
+            // announce that we sleep, then re-check to not miss the wakeup
+            __atomic_store_n(&ring.producerWaiting, 1, __ATOMIC_SEQ_CST);
+            if (tail - __atomic_load_n(&ring.head, __ATOMIC_SEQ_CST) >= ring.limit)
+            {
+                DEBUG("PacketBuffer::enqueue : waiting until buffer is <notfull>")
+                __atomic_fetch_add(&producerStallCount, 1, __ATOMIC_RELAXED);
+                waitWakeup(ring.spaceFD);
+            }
+            __atomic_store_n(&ring.producerWaiting, 0, __ATOMIC_RELAXED);
+        }
+    }
+    ring.slots[tail & ring.mask] = pPacket;
+    __atomic_store_n(&ring.tail, tail + 1, __ATOMIC_SEQ_CST);
+    __atomic_fetch_add(&enqueuedCount, 1, __ATOMIC_RELAXED);
+    // the consumer only sleeps on an empty buffer: this is the
+    // empty -> non-empty transition
+    if (__atomic_load_n(&consumerWaiting, __ATOMIC_SEQ_CST))
+    {
+        signalWakeup(dataFD);
+    }
+    return lossless;
+}
+
+unsigned PacketBuffer::tryDequeue(ring_t& ring, SFPacket* pPackets, unsigned pMax)
+{
+    while (true)
+    {
+        unsigned head = __atomic_load_n(&ring.head, __ATOMIC_ACQUIRE);
+        unsigned tail = __atomic_load_n(&ring.tail, __ATOMIC_ACQUIRE);
+        unsigned count = tail - head;
+        if (count == 0)
+        {
+            return 0;
+        }
+        if (count > pMax)
+        {
+            count = pMax;
+        }
+        for (unsigned i = 0; i < count; i++)
+        {
+            pPackets[i] = ring.slots[(head + i) & ring.mask];
+        }
+        if (__atomic_compare_exchange_n(&ring.head, &head, head + count, false,
+                                        __ATOMIC_SEQ_CST, __ATOMIC_RELAXED))
+        {
+            // the producer only sleeps on a full lane: this is the
+            // full -> non-full transition
+            if (__atomic_load_n(&ring.producerWaiting, __ATOMIC_SEQ_CST))
+            {
+                signalWakeup(ring.spaceFD);
+            }
+            return count;
+        }
+        // packets were dropped or cleared while we copied, retry
+    }
+}
+
+void PacketBuffer::clearRing(ring_t& ring)
+{
+    unsigned head = __atomic_load_n(&ring.head, __ATOMIC_ACQUIRE);
+    while (true)
+    {
+        unsigned tail = __atomic_load_n(&ring.tail, __ATOMIC_ACQUIRE);
+        if ((head == tail) ||
+            __atomic_compare_exchange_n(&ring.head, &head, tail, false,
+                                        __ATOMIC_SEQ_CST, __ATOMIC_ACQUIRE))
+        {
+            break;
+        }
+    }
+    if (__atomic_load_n(&ring.producerWaiting, __ATOMIC_SEQ_CST))
+    {
+        signalWakeup(ring.spaceFD);
+    }
 }
 
 // clears the buffer
-void PacketBuffer::clear() {
+void PacketBuffer::clear()
+{
+    clearRing(front);
+    clearRing(back);
+    DEBUG("PacketBuffer::clear : cleared buffer")
+}
+
+// gets packets from the buffer, blocks while the buffer is empty
+unsigned PacketBuffer::dequeue(SFPacket* pPackets, unsigned pMax)
+{
     pthread_testcancel();
-    pthread_mutex_lock(&buffer.lock);
-    // clear
-    buffer.container.clear();
-    DEBUG("PacketBuffer::clear : cleared buffer and signal <notfull>")
-    pthread_cond_signal(&buffer.notfull);
-    pthread_mutex_unlock(&buffer.lock);
+    while (true)
+    {
+        unsigned count = tryDequeue(pPackets, pMax);
+        if (count > 0)
+        {
+            return count;
+        }
+        // announce that we sleep, then re-check to not miss the wakeup
+        __atomic_store_n(&consumerWaiting, 1, __ATOMIC_SEQ_CST);
+        if ((size(front) == 0) && (size(back) == 0))
+        {
+            DEBUG("PacketBuffer::dequeue : waiting until buffer is <notempty>")
+            waitWakeup(dataFD);
+            __atomic_fetch_add(&consumerWakeupCount, 1, __ATOMIC_RELAXED);
+        }
+        __atomic_store_n(&consumerWaiting, 0, __ATOMIC_RELAXED);
+    }
+}
+
+// gets packets from the buffer, never blocks
+unsigned PacketBuffer::tryDequeue(SFPacket* pPackets, unsigned pMax)
+{
+    unsigned count = tryDequeue(front, pPackets, pMax);
+    if (count < pMax)
+    {
+        count += tryDequeue(back, pPackets + count, pMax - count);
+    }
+    if (count > 0)
+    {
+        __atomic_fetch_add(&dequeuedCount, count, __ATOMIC_RELAXED);
+    }
+    return count;
+}
+
+bool PacketBuffer::armWakeup()
+{
+    // same protocol as the blocking dequeue
+    __atomic_store_n(&consumerWaiting, 1, __ATOMIC_SEQ_CST);
+    if ((size(front) == 0) && (size(back) == 0))
+    {
+        return true;
+    }
+    __atomic_store_n(&consumerWaiting, 0, __ATOMIC_RELAXED);
+    return false;
 }
 
-// gets a packet from the buffer (NULL = buffer empty)
+void PacketBuffer::disarmWakeup(bool pSignalled)
+{
+    if (pSignalled && (dataFD[0] >= 0))
+    {
+        // the fd is readable, so this does not block
+        char buf[64];
+        while (read(dataFD[0], buf, sizeof(buf)) < 0 && errno == EINTR)
+            ;
+        __atomic_fetch_add(&consumerWakeupCount, 1, __ATOMIC_RELAXED);
+    }
+    __atomic_store_n(&consumerWaiting, 0, __ATOMIC_RELAXED);
+}
+
+int PacketBuffer::getWakeupFD() const
+{
+    return dataFD[0];
+}
+
+// gets a packet from the buffer, blocks while the buffer is empty
 SFPacket PacketBuffer::dequeue()
 {
     SFPacket packet;
-    pthread_testcancel();
-    pthread_cleanup_push((void(*)(void*)) pthread_mutex_unlock, (void *) &buffer.lock);
-    pthread_mutex_lock(&buffer.lock);
-    // wait until buffer is _not_ empty
-    while(buffer.container.size() == 0)
-    {
-        DEBUG("PacketBuffer::dequeue : waiting until buffer is <notempty>")
-        pthread_cond_wait(&buffer.notempty, &buffer.lock);
-    }
-    // dequeue
-    packet = buffer.container.front();
-    buffer.container.pop_front();
-    DEBUG("PacketBuffer::dequeue : get from buffer and signal <notfull>")
-    pthread_cond_signal(&buffer.notfull);
-    pthread_cleanup_pop(1); 
+    dequeue(&packet, 1);
     return packet;
 }
 
-// puts a packet into buffer... (SUCCESS = true)
-bool PacketBuffer::enqueueFront(SFPacket &pPacket)
+// puts a packet into the priority lane
+bool PacketBuffer::enqueueFront(const SFPacket &pPacket)
 {
     pthread_testcancel();
-    pthread_cleanup_push((void(*)(void*)) pthread_mutex_unlock, (void *) &buffer.lock);
-    pthread_mutex_lock(&buffer.lock);
-    // wait until buffer is _not_ full
-    while(buffer.container.size() >= cMaxBufferSize)
-    {
-        DEBUG("PacketBuffer::enqueueFront : waiting until buffer is <notfull>")
-        pthread_cond_wait(&buffer.notfull, &buffer.lock);
-    }
-    // enqueue
-    buffer.container.push_front(pPacket);
-    DEBUG("PacketBuffer::enqueueFront : put in buffer and signal <notempty>")
-    // signal that buffer is now not empty
-    pthread_cond_signal(&buffer.notempty);
-    pthread_cleanup_pop(1); 
-    return true;
+    return enqueue(front, pPacket);
 }
 
-// puts a packet into buffer... (SUCCESS = true)
-bool PacketBuffer::enqueueBack(SFPacket &pPacket)
+// puts a packet into the normal lane
+bool PacketBuffer::enqueueBack(const SFPacket &pPacket)
 {
     pthread_testcancel();
-    pthread_cleanup_push((void(*)(void*)) pthread_mutex_unlock, (void *) &buffer.lock);
-    pthread_mutex_lock(&buffer.lock);
-    // wait until buffer is _not_ full
-    while(buffer.container.size() >= cMaxBufferSize)
-    {
-        DEBUG("PacketBuffer::enqueueBack : waiting until buffer is <notfull>")
-        pthread_cond_wait(&buffer.notfull, &buffer.lock);
-    }
-    // enqueue
-    buffer.container.push_back(pPacket);
-    DEBUG("PacketBuffer::enqueueBack : put in buffer and signal <notempty>")
-    // signal that buffer is now not empty
-    pthread_cond_signal(&buffer.notempty);
-    pthread_cleanup_pop(1); 
-    return true;
-}
-
-/* checks if packet buffer is full */
-bool PacketBuffer::isFull() {
-  bool isFull = true;
-  pthread_testcancel();
-  pthread_mutex_lock(&buffer.lock);
-  if (buffer.container.size() < cMaxBufferSize) {
-      isFull = false;
-  }
-  pthread_mutex_unlock(&buffer.lock);
-  return isFull;
+    return enqueue(back, pPacket);
+}
+
+/* checks if the normal lane is full */
+bool PacketBuffer::isFull()
+{
+    return size(back) >= back.limit;
 }
 
 /* checks if packet buffer is empty */
-bool PacketBuffer::isEmpty() {
-  bool isEmpty = true;
-  pthread_testcancel();
-  pthread_mutex_lock(&buffer.lock);
-  if (buffer.container.size() > 0) {
-      isEmpty = false;
-  }
-  pthread_mutex_unlock(&buffer.lock);
-  return isEmpty;
-}
-
-/* checks if pPacket is in queue */
-bool PacketBuffer::isInQueue(SFPacket &pPacket)
-{
-    bool result = false;
-    DEBUG("PacketBuffer::isInQueue : lock")
-    pthread_testcancel();
-    pthread_mutex_lock(&buffer.lock);
-    container_t::const_iterator it = find(buffer.container.begin(), buffer.container.end(), pPacket);
-    if( it != buffer.container.end() )
+bool PacketBuffer::isEmpty()
+{
+    return (size(front) == 0) && (size(back) == 0);
+}
+
+unsigned PacketBuffer::getDepth() const
+{
+    return back.limit;
+}
+
+PacketBuffer::overflowPolicy_t PacketBuffer::getPolicy() const
+{
+    return policy;
+}
+
+/* prints out status */
+void PacketBuffer::reportStatus(std::ostream& os)
+{
+    const char* policyName = "block";
+    if (policy == DROP_OLDEST)
     {
-        result = true;
+        policyName = "drop-oldest";
     }
-    pthread_mutex_unlock(&buffer.lock);
-    DEBUG("PacketBuffer::isInQueue : unlock")
-    return result;
+    else if (policy == DROP_NEWEST)
+    {
+        policyName = "drop-newest";
+    }
+    os << "depth = " << back.limit
+       << " ( " << policyName << " )"
+       << " , queued = " << (size(front) + size(back))
+       << " , enqueued = " << __atomic_load_n(&enqueuedCount, __ATOMIC_RELAXED)
+       << " , dequeued = " << __atomic_load_n(&dequeuedCount, __ATOMIC_RELAXED)
+       << " , dropped oldest = " << __atomic_load_n(&droppedOldestCount, __ATOMIC_RELAXED)
+       << " , dropped newest = " << __atomic_load_n(&droppedNewestCount, __ATOMIC_RELAXED)
+       << " , producer stalls = " << __atomic_load_n(&producerStallCount, __ATOMIC_RELAXED)
+       << " , consumer wakeups = " << __atomic_load_n(&consumerWakeupCount, __ATOMIC_RELAXED)
+       << std::endl;
+}
+
+void PacketBuffer::reportMetrics(Metrics& pMetrics, const std::string& pLabels)
+{
+    pMetrics.gauge("sf_buffer_depth_packets", "Capacity of the packet buffer between the serial and the TCP side.", pLabels, back.limit);
+    pMetrics.gauge("sf_buffer_queued_packets", "Packets waiting in the buffer.", pLabels, size(front) + size(back));
+    pMetrics.counter("sf_buffer_enqueued_total", "Packets put into the buffer.", pLabels, __atomic_load_n(&enqueuedCount, __ATOMIC_RELAXED));
+    pMetrics.counter("sf_buffer_dropped_total", "Packets dropped because the buffer was full.", pLabels,
+                     __atomic_load_n(&droppedOldestCount, __ATOMIC_RELAXED) + __atomic_load_n(&droppedNewestCount, __ATOMIC_RELAXED));
+    pMetrics.counter("sf_buffer_producer_stalls_total", "Times a producer waited for room in the buffer.", pLabels, __atomic_load_n(&producerStallCount, __ATOMIC_RELAXED));
 }
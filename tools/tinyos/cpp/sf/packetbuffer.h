@@ -34,8 +34,10 @@
 #define PACKETBUFFER_H
 
 #include <pthread.h>
-#include <list>
+#include <ostream>
+#include <string>
 #include "sfpacket.h"
+#include "sfmetrics.h"
 
 // #define DEBUG_PACKETBUFFER
 
@@ -47,48 +49,151 @@
 #define DEBUG(message) 
 #endif
 
+/*
+ * Bounded packet queue between one producer thread and one consumer
+ * thread, built from preallocated lock-free ring buffers. A buffer
+ * has two lanes: enqueueFront() puts packets into a small priority
+ * lane (used for acks) that is always drained first, enqueueBack()
+ * into the normal lane. Each lane must have at most one producer
+ * thread; dequeue() must only be called from one consumer thread.
+ * clear() may be called from any thread.
+ *
+ * A thread only sleeps when it cannot make progress (consumer on an
+ * empty buffer, producer on a full lane with the block policy), and
+ * it is only woken on the empty -> non-empty (resp. full -> non-full)
+ * transition it waits for, via an eventfd (a pipe where eventfd is not
+ * available). The blocking read is a cancellation point, so threads
+ * can still be cancelled while waiting.
+ */
 class PacketBuffer
 {
+public:
+    /* what enqueue does when the lane is full */
+    typedef enum
+    {
+        /* wait until the consumer made room */
+        BLOCK,
+        /* discard the oldest queued packet to make room */
+        DROP_OLDEST,
+        /* discard the packet being enqueued */
+        DROP_NEWEST
+    } overflowPolicy_t;
+
+    static const unsigned cDefaultBufferSize = 32;
+
+    static const unsigned cFrontBufferSize = 8;
+
 protected:
 
-  static const unsigned cMaxBufferSize = 25;
+    typedef struct
+    {
+        /* preallocated packet slots, size is a power of two */
+        SFPacket* slots;
+        unsigned mask;
+        /* configured depth, at most mask + 1 */
+        unsigned limit;
+        /* next slot to read, advanced by the consumer (and on overflow
+           or clear by other threads, hence compare-and-swap) */
+        unsigned head;
+        /* next slot to write, only advanced by the producer */
+        unsigned tail;
+        /* set while the producer sleeps on a full lane */
+        int producerWaiting;
+        /* signalled when the lane stops being full */
+        int spaceFD[2];
+    } ring_t;
+
+    ring_t front;
+    ring_t back;
+
+    overflowPolicy_t policy;
+
+    /* set while the consumer sleeps on an empty buffer */
+    int consumerWaiting;
+
+    /* signalled when the buffer stops being empty */
+    int dataFD[2];
+
+    /* statistics, updated atomically */
+    unsigned long enqueuedCount;
+    unsigned long dequeuedCount;
+    unsigned long droppedOldestCount;
+    unsigned long droppedNewestCount;
+    unsigned long producerStallCount;
+    unsigned long consumerWakeupCount;
+
+    void initRing(ring_t& ring, unsigned depth);
+
+    void destroyRing(ring_t& ring);
 
-  typedef std::list<SFPacket> container_t;
+    void clearRing(ring_t& ring);
 
-  // thread safe buffer
-  typedef struct
-  {
-    // mutex lock for any of this vars
-    pthread_mutex_t lock;
-    // notempty cond
-    pthread_cond_t notempty;
-    // not full cond
-    pthread_cond_t notfull;
-    // actual buffer 
-    container_t container;
-  } sharedBuffer_t;
+    bool enqueue(ring_t& ring, const SFPacket& pPacket);
 
-  sharedBuffer_t buffer;
+    unsigned tryDequeue(ring_t& ring, SFPacket* pPackets, unsigned pMax);
+
+    static unsigned size(const ring_t& ring);
+
+    static void openWakeup(int fds[2]);
+
+    static void closeWakeup(int fds[2]);
+
+    static void signalWakeup(int fds[2]);
+
+    static void waitWakeup(int fds[2]);
+
+private:
+    /* not copyable */
+    PacketBuffer(const PacketBuffer&);
+    PacketBuffer& operator=(const PacketBuffer&);
 
 public:
-  PacketBuffer();
+    PacketBuffer(unsigned pDepth = cDefaultBufferSize, overflowPolicy_t pPolicy = BLOCK);
+
+    ~PacketBuffer();
+
+    void clear();
+
+    /* blocks until a packet is available */
+    SFPacket dequeue();
+
+    /* blocks until at least one packet is available, then returns up
+       to pMax packets (priority lane first) */
+    unsigned dequeue(SFPacket* pPackets, unsigned pMax);
+
+    /* returns up to pMax packets without blocking, 0 if empty */
+    unsigned tryDequeue(SFPacket* pPackets, unsigned pMax);
+
+    /* for consumers that multiplex the buffer with other fds: call
+       armWakeup(), and if it returns true, wait until getWakeupFD() is
+       readable (or something else happens), then call
+       disarmWakeup(readable). getWakeupFD() is -1 if there is no
+       wakeup channel, then poll. */
+    bool armWakeup();
+
+    void disarmWakeup(bool pSignalled);
+
+    int getWakeupFD() const;
 
-  ~PacketBuffer();
+    /* returns false if a packet (this or an older one) was dropped */
+    bool enqueueFront(const SFPacket &pPacket);
 
-  void clear();
+    bool enqueueBack(const SFPacket &pPacket);
 
-  SFPacket dequeue();
+    /* snapshots, exact only when called from producer or consumer */
+    bool isFull();
 
-  bool enqueueFront(SFPacket &pPacket);
+    bool isEmpty();
 
-  bool enqueueBack(SFPacket &pPacket);
+    unsigned getDepth() const;
 
-  bool isFull();
+    overflowPolicy_t getPolicy() const;
 
-  bool isEmpty();
+    /* prints out depth, policy and counters */
+    void reportStatus(std::ostream& os);
 
-  bool isInQueue(SFPacket &pPacket);
-  
+    /* adds depth, fill level and counters labeled pLabels */
+    void reportMetrics(Metrics& pMetrics, const std::string& pLabels);
 };
 
 #endif
@@ -0,0 +1,302 @@
+/*
+ * Copyright (c) 2007, Technische Universitaet Berlin
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without 
+ * modification, are permitted provided that the following conditions 
+ * are met:
+ * - Redistributions of source code must retain the above copyright notice,
+ *   this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright 
+ *   notice, this list of conditions and the following disclaimer in the 
+ *   documentation and/or other materials provided with the distribution.
+ * - Neither the name of the Technische Universitaet Berlin nor the names 
+ *   of its contributors may be used to endorse or promote products derived
+ *   from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS 
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT 
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT 
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, 
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED 
+ * TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, 
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY 
+ * OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT 
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE 
+ * USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+/**
+ * @author Philipp Huppertz <huppertz@tkn.tu-berlin.de>
+ */
+
+#include "reactor.h"
+#include "sfpacket.h"
+
+#include <iostream>
+#include <cstring>
+#include <cstdlib>
+#include <errno.h>
+#include <unistd.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+
+using namespace std;
+
+static const int cMaxEvents = 64;
+
+/* epoll data of a registration: its generation in the upper 32 bits,
+   the fd in the lower */
+static uint64_t eventData(int fd, uint32_t generation)
+{
+    return ((uint64_t)generation << 32) | (uint32_t)fd;
+}
+
+void* reactorThread(void* ob)
+{
+    static_cast<Reactor*>(ob)->run();
+    return NULL;
+}
+
+Reactor::Reactor() : threadRunning(false), nextGeneration(1), loopCount(0), eventCount(0), timerCount(0)
+{
+    pthread_mutex_init(&lock, NULL);
+    pthread_cond_init(&called, NULL);
+    epollFD = epoll_create1(EPOLL_CLOEXEC);
+    wakeupFD = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if ((epollFD < 0) || (wakeupFD < 0))
+    {
+        cerr << "FATAL : Reactor : epoll/eventfd : " << strerror(errno) << endl;
+        exit(1);
+    }
+    struct epoll_event ev;
+    memset(&ev, 0, sizeof(ev));
+    ev.events = EPOLLIN;
+    ev.data.u64 = eventData(wakeupFD, 0);
+    epoll_ctl(epollFD, EPOLL_CTL_ADD, wakeupFD, &ev);
+    if (pthread_create(&thread, NULL, reactorThread, this) == 0)
+    {
+        threadRunning = true;
+    }
+    else
+    {
+        cerr << "FATAL : Reactor : pthread_create : " << strerror(errno) << endl;
+        exit(1);
+    }
+}
+
+Reactor::~Reactor()
+{
+    if (threadRunning)
+    {
+        pthread_cancel(thread);
+        pthread_join(thread, NULL);
+        threadRunning = false;
+    }
+    close(wakeupFD);
+    close(epollFD);
+    pthread_cond_destroy(&called);
+    pthread_mutex_destroy(&lock);
+}
+
+int64_t Reactor::now()
+{
+    return SFPacket::getCurrentTime();
+}
+
+bool Reactor::inReactorThread()
+{
+    return threadRunning && pthread_equal(pthread_self(), thread);
+}
+
+bool Reactor::add(int fd, uint32_t events, ReactorHandler* handler)
+{
+    struct epoll_event ev;
+    memset(&ev, 0, sizeof(ev));
+    registration_t reg;
+    reg.handler = handler;
+    reg.generation = nextGeneration++;
+    if (nextGeneration == 0)
+    {
+        nextGeneration = 1;
+    }
+    ev.events = events;
+    ev.data.u64 = eventData(fd, reg.generation);
+    if (epoll_ctl(epollFD, EPOLL_CTL_ADD, fd, &ev) < 0)
+    {
+        return false;
+    }
+    handlers[fd] = reg;
+    return true;
+}
+
+bool Reactor::modify(int fd, uint32_t events)
+{
+    map<int, registration_t>::iterator it = handlers.find(fd);
+    if (it == handlers.end())
+    {
+        return false;
+    }
+    struct epoll_event ev;
+    memset(&ev, 0, sizeof(ev));
+    ev.events = events;
+    ev.data.u64 = eventData(fd, it->second.generation);
+    return epoll_ctl(epollFD, EPOLL_CTL_MOD, fd, &ev) == 0;
+}
+
+void Reactor::remove(int fd)
+{
+    struct epoll_event ev;
+    // pre 2.6.9 kernels want a non-NULL event
+    epoll_ctl(epollFD, EPOLL_CTL_DEL, fd, &ev);
+    handlers.erase(fd);
+}
+
+void Reactor::setTimer(ReactorHandler* handler, int64_t delay)
+{
+    cancelTimer(handler);
+    armed[handler] = timers.insert(make_pair(now() + delay, handler));
+}
+
+void Reactor::cancelTimer(ReactorHandler* handler)
+{
+    map<ReactorHandler*, timers_t::iterator>::iterator it = armed.find(handler);
+    if (it != armed.end())
+    {
+        timers.erase(it->second);
+        armed.erase(it);
+    }
+}
+
+void Reactor::call(callback_t fn, void* arg)
+{
+    if (!threadRunning || inReactorThread())
+    {
+        fn(arg);
+        return;
+    }
+    bool done = false;
+    call_t c;
+    c.fn = fn;
+    c.arg = arg;
+    c.done = &done;
+    uint64_t one = 1;
+    pthread_mutex_lock(&lock);
+    calls.push_back(c);
+    if (write(wakeupFD, &one, sizeof(one)) < 0)
+    {
+        // counter overflow is impossible in practice, the loop is awake anyway
+    }
+    while (!done)
+    {
+        pthread_cond_wait(&called, &lock);
+    }
+    pthread_mutex_unlock(&lock);
+}
+
+void Reactor::runCalls()
+{
+    uint64_t count;
+    if (read(wakeupFD, &count, sizeof(count)) < 0)
+    {
+        // spurious wakeup
+    }
+    pthread_mutex_lock(&lock);
+    while (!calls.empty())
+    {
+        call_t c = calls.front();
+        calls.pop_front();
+        pthread_mutex_unlock(&lock);
+        c.fn(c.arg);
+        pthread_mutex_lock(&lock);
+        *c.done = true;
+    }
+    pthread_cond_broadcast(&called);
+    pthread_mutex_unlock(&lock);
+}
+
+int Reactor::nextTimeout()
+{
+    if (timers.empty())
+    {
+        return -1;
+    }
+    int64_t delay = timers.begin()->first - now();
+    if (delay <= 0)
+    {
+        return 0;
+    }
+    // round up, so we do not wake up just before the deadline
+    return (int)((delay + 999999) / 1000000);
+}
+
+void Reactor::runTimers()
+{
+    int64_t current = now();
+    while (!timers.empty() && (timers.begin()->first <= current))
+    {
+        ReactorHandler* handler = timers.begin()->second;
+        armed.erase(handler);
+        timers.erase(timers.begin());
+        ++timerCount;
+        // may re-arm itself
+        handler->handleTimer();
+    }
+}
+
+void Reactor::run()
+{
+    struct epoll_event events[cMaxEvents];
+    while (true)
+    {
+        // epoll_wait is a cancellation point
+        int n = epoll_wait(epollFD, events, cMaxEvents, nextTimeout());
+        ++loopCount;
+        if (n < 0)
+        {
+            if (errno != EINTR)
+            {
+                cerr << "error : Reactor : epoll_wait : " << strerror(errno) << endl;
+            }
+            continue;
+        }
+        // handlers are not written to be cancelled half way
+        int oldState;
+        pthread_setcancelstate(PTHREAD_CANCEL_DISABLE, &oldState);
+        for (int i = 0; i < n; i++)
+        {
+            int fd = (int)(uint32_t)events[i].data.u64;
+            uint32_t generation = (uint32_t)(events[i].data.u64 >> 32);
+            if ((fd == wakeupFD) && (generation == 0))
+            {
+                runCalls();
+                continue;
+            }
+            // the handler may have been removed by an earlier event, and
+            // its fd number reused by a new registration that must not
+            // see the old one's events
+            map<int, registration_t>::iterator it = handlers.find(fd);
+            if ((it != handlers.end()) && (it->second.generation == generation))
+            {
+                ++eventCount;
+                it->second.handler->handleEvent(fd, events[i].events);
+            }
+        }
+        runTimers();
+        pthread_setcancelstate(oldState, &oldState);
+    }
+}
+
+unsigned Reactor::getFDCount()
+{
+    return handlers.size();
+}
+
+void Reactor::reportStatus(ostream& os)
+{
+    os << "Reactor : fds = " << handlers.size()
+       << " , timers = " << timers.size()
+       << " , loops = " << loopCount
+       << " , events = " << eventCount
+       << " , timer expiries = " << timerCount << endl;
+}
@@ -0,0 +1,160 @@
+/*
+ * Copyright (c) 2007, Technische Universitaet Berlin
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without 
+ * modification, are permitted provided that the following conditions 
+ * are met:
+ * - Redistributions of source code must retain the above copyright notice,
+ *   this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright 
+ *   notice, this list of conditions and the following disclaimer in the 
+ *   documentation and/or other materials provided with the distribution.
+ * - Neither the name of the Technische Universitaet Berlin nor the names 
+ *   of its contributors may be used to endorse or promote products derived
+ *   from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS 
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT 
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT 
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, 
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED 
+ * TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, 
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY 
+ * OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT 
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE 
+ * USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+/**
+ * @author Philipp Huppertz <huppertz@tkn.tu-berlin.de>
+ */
+
+#ifndef REACTOR_H
+#define REACTOR_H
+
+#include <pthread.h>
+#include <stdint.h>
+#include <map>
+#include <deque>
+#include <ostream>
+
+/* something that owns fds and/or a timer on a Reactor */
+class ReactorHandler
+{
+public:
+    virtual ~ReactorHandler() {}
+
+    /* fd is ready: events is a mask of EPOLLIN, EPOLLOUT, EPOLLERR ... */
+    virtual void handleEvent(int fd, uint32_t events) = 0;
+
+    /* the timer armed with Reactor::setTimer expired */
+    virtual void handleTimer() {}
+};
+
+/*
+ * One thread running an epoll loop. Handlers register fds and one
+ * timer each; all their callbacks run on the reactor thread, so a
+ * handler needs no locking as long as other threads only touch it
+ * through call(). add/modify/remove/setTimer/cancelTimer must only be
+ * used from the reactor thread (e.g. inside call()).
+ */
+class Reactor
+{
+protected:
+    typedef void (*callback_t)(void*);
+
+    typedef struct
+    {
+        callback_t fn;
+        void* arg;
+        bool* done;
+    } call_t;
+
+    /* deadline (ns on the monotonic clock) -> handler */
+    typedef std::multimap<int64_t, ReactorHandler*> timers_t;
+
+    /* a registered fd: generation tells its events apart from those of
+       an earlier registration of the same fd number */
+    typedef struct
+    {
+        ReactorHandler* handler;
+        uint32_t generation;
+    } registration_t;
+
+    int epollFD;
+
+    /* eventfd to interrupt epoll_wait for calls from other threads */
+    int wakeupFD;
+
+    pthread_t thread;
+
+    bool threadRunning;
+
+    std::map<int, registration_t> handlers;
+
+    /* generation of the next add(), 0 is the wakeup fd */
+    uint32_t nextGeneration;
+
+    timers_t timers;
+
+    std::map<ReactorHandler*, timers_t::iterator> armed;
+
+    /* calls from other threads, protected by lock */
+    pthread_mutex_t lock;
+    pthread_cond_t called;
+    std::deque<call_t> calls;
+
+    /* statistics */
+    unsigned long loopCount;
+    unsigned long eventCount;
+    unsigned long timerCount;
+
+    friend void* reactorThread(void* ob);
+
+    /* the event loop */
+    void run();
+
+    void runCalls();
+
+    void runTimers();
+
+    /* epoll_wait timeout in ms until the next timer, -1 for none */
+    int nextTimeout();
+
+private:
+    /* not copyable */
+    Reactor(const Reactor&);
+    Reactor& operator=(const Reactor&);
+
+public:
+    Reactor();
+
+    ~Reactor();
+
+    /* monotonic clock in ns */
+    static int64_t now();
+
+    bool add(int fd, uint32_t events, ReactorHandler* handler);
+
+    bool modify(int fd, uint32_t events);
+
+    void remove(int fd);
+
+    /* (re)arms the handler's timer to fire after delay ns */
+    void setTimer(ReactorHandler* handler, int64_t delay);
+
+    void cancelTimer(ReactorHandler* handler);
+
+    /* runs fn(arg) on the reactor thread and waits for it to finish */
+    void call(callback_t fn, void* arg);
+
+    bool inReactorThread();
+
+    /* number of registered fds */
+    unsigned getFDCount();
+
+    void reportStatus(std::ostream& os);
+};
+
+#endif
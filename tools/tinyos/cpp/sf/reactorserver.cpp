@@ -0,0 +1,774 @@
+/*
+ * Copyright (c) 2007, Technische Universitaet Berlin
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without 
+ * modification, are permitted provided that the following conditions 
+ * are met:
+ * - Redistributions of source code must retain the above copyright notice,
+ *   this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright 
+ *   notice, this list of conditions and the following disclaimer in the 
+ *   documentation and/or other materials provided with the distribution.
+ * - Neither the name of the Technische Universitaet Berlin nor the names 
+ *   of its contributors may be used to endorse or promote products derived
+ *   from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS 
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT 
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT 
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, 
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED 
+ * TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, 
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY 
+ * OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT 
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE 
+ * USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+/**
+ * @author Philipp Huppertz <huppertz@tkn.tu-berlin.de>
+ */
+
+#include "serialcomm.h"
+#include "reactorserver.h"
+
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <vector>
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <sys/epoll.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <termios.h>
+#include <unistd.h>
+
+using namespace std;
+
+/* helpers to run member functions on the reactor thread */
+void attachServer(void* ob)
+{
+    static_cast<ReactorServer*>(ob)->attach();
+}
+
+void detachServer(void* ob)
+{
+    static_cast<ReactorServer*>(ob)->detach();
+}
+
+void reportServerStatus(void* ob)
+{
+    ReactorServer* server = static_cast<ReactorServer*>(ob);
+    server->printStatus(*(server->statusStream));
+}
+
+void reportServerMetrics(void* ob)
+{
+    ReactorServer* server = static_cast<ReactorServer*>(ob);
+    server->addMetrics(*(server->statusMetrics), server->metricsLabels);
+}
+
+ReactorServer::ReactorServer(Reactor &pReactor, int pPort, const char* pDevice, int pBaudrate, unsigned pBufferDepth, sharedControlInfo_t& pControl, int pWindow) : reactor(pReactor), port(pPort), device(pDevice), baudrate(pBaudrate), bufferDepth(pBufferDepth), serverFD(-1), serialFD(-1), clientsPaused(false), window(pWindow, SerialComm::ackTimeout, SerialComm::maxRetries), tcpReadPacketCount(0), tcpWrittenPacketCount(0), slowClientCount(0), readPacketCount(0), droppedReadPacketCount(0), writtenPacketCount(0), tcpReadByteCount(0), tcpWrittenByteCount(0), serialReadByteCount(0), serialWrittenByteCount(0), latencyHistogram(Histogram::cLatencyBounds, Histogram::cLatencyBoundCount), errorReported(false), errorMsg(""), control(pControl), statusStream(NULL), statusMetrics(NULL)
+{
+    reactor.call(attachServer, this);
+}
+
+ReactorServer::~ReactorServer()
+{
+    cancel();
+}
+
+void ReactorServer::attach()
+{
+    if (openServer() && openSerial())
+    {
+        DEBUG("ReactorServer::attach : port " << port << " , device " << device)
+        // negotiates the window with the node
+        sendNext();
+    }
+}
+
+void ReactorServer::detach()
+{
+    reactor.cancelTimer(this);
+    for (clients_t::iterator it = clients.begin(); it != clients.end(); it++)
+    {
+        reactor.remove(it->first);
+        close(it->first);
+    }
+    clients.clear();
+    if (serverFD >= 0)
+    {
+        reactor.remove(serverFD);
+        close(serverFD);
+        serverFD = -1;
+    }
+    if (serialFD >= 0)
+    {
+        reactor.remove(serialFD);
+        close(serialFD);
+        serialFD = -1;
+    }
+    serialQueue.clear();
+    serialOut.clear();
+}
+
+bool ReactorServer::openServer()
+{
+    struct sockaddr_in me;
+    int opt = 1;
+    int rxBuf = 1024;
+
+    serverFD = reportError("ReactorServer::openServer : socket(AF_INET, SOCK_STREAM, 0)",
+                           socket(AF_INET, SOCK_STREAM, 0));
+    if (!errorReported) {
+        reportError("ReactorServer::openServer : fcntl(serverFD, F_SETFL, O_NONBLOCK)",
+                    fcntl(serverFD, F_SETFL, O_NONBLOCK));
+    }
+    memset(&me, 0, sizeof me);
+    me.sin_family = AF_INET;
+    me.sin_port = htons(port);
+    if (!errorReported) {
+        reportError("ReactorServer::openServer : setsockopt(serverFD, SOL_SOCKET, SO_REUSEADDR, (char *)&opt, sizeof(opt))",
+                    setsockopt(serverFD, SOL_SOCKET, SO_REUSEADDR, (char *)&opt, sizeof(opt)));
+    }
+    if (!errorReported) {
+        reportError("ReactorServer::openServer : setsockopt(serverFD, SOL_SOCKET, SO_RCVBUF, (char *)&rxBuf, sizeof(rxBuf))",
+                    setsockopt(serverFD, SOL_SOCKET, SO_RCVBUF, (char *)&rxBuf, sizeof(rxBuf)));
+    }
+    if (!errorReported) {
+        reportError("ReactorServer::openServer : bind(serverFD, (struct sockaddr *)&me, sizeof me)",
+                    bind(serverFD, (struct sockaddr *)&me, sizeof me));
+    }
+    if (!errorReported) {
+        reportError("ReactorServer::openServer : listen(serverFD, 5)",
+                    listen(serverFD, 5));
+    }
+    if (!errorReported && !reactor.add(serverFD, EPOLLIN, this)) {
+        reportError("ReactorServer::openServer : reactor.add(serverFD)", -1);
+    }
+    return !errorReported;
+}
+
+bool ReactorServer::openSerial()
+{
+    tcflag_t baudflag = SerialComm::parseBaudrate(baudrate);
+
+    serialFD = open(device.c_str(), O_RDWR | O_NOCTTY | O_NONBLOCK);
+    if ((serialFD < 0) || (!baudflag))
+    {
+        ostringstream msg;
+        msg << "could not open device = " << device << " with baudrate = " << baudrate;
+        reportError(msg.str().c_str(), -1);
+        return false;
+    }
+
+    /* Serial port setting, same as SerialComm */
+    struct termios newtio;
+    memset(&newtio, 0, sizeof(newtio));
+    newtio.c_cflag = CS8 | CLOCAL | CREAD;
+    newtio.c_iflag = IGNPAR | IGNBRK;
+    cfsetispeed(&newtio, baudflag);
+    cfsetospeed(&newtio, baudflag);
+
+    /* Raw output_file */
+    newtio.c_oflag = 0;
+
+    if ((tcflush(serialFD, TCIFLUSH) < 0) || (tcsetattr(serialFD, TCSANOW, &newtio) < 0))
+    {
+        ostringstream msg;
+        msg << "could not set ioflags for opened device = " << device;
+        reportError(msg.str().c_str(), -1);
+        return false;
+    }
+    if (!reactor.add(serialFD, EPOLLIN, this))
+    {
+        reportError("ReactorServer::openSerial : reactor.add(serialFD)", -1);
+        return false;
+    }
+    return true;
+}
+
+void ReactorServer::handleEvent(int fd, uint32_t events)
+{
+    if (fd == serverFD)
+    {
+        acceptClients();
+    }
+    else if (fd == serialFD)
+    {
+        if (events & (EPOLLERR | EPOLLHUP))
+        {
+            errno = EIO;
+            reportError("ReactorServer::handleEvent : serial device hung up", -1);
+            return;
+        }
+        if (events & EPOLLIN)
+        {
+            readSerial();
+        }
+        if ((events & EPOLLOUT) && (serialFD >= 0))
+        {
+            flushSerial();
+        }
+    }
+    else
+    {
+        if (events & (EPOLLERR | EPOLLHUP))
+        {
+            removeClient(fd);
+            return;
+        }
+        if (events & EPOLLIN)
+        {
+            readClient(fd);
+        }
+        if ((events & EPOLLOUT) && (clients.find(fd) != clients.end()))
+        {
+            writeClient(fd);
+        }
+    }
+}
+
+void ReactorServer::acceptClients()
+{
+    while (true)
+    {
+        struct sockaddr_in peer;
+        socklen_t peerLen = sizeof(peer);
+        int clientFD = accept(serverFD, (struct sockaddr*)&peer, &peerLen);
+        if (clientFD < 0)
+        {
+            if ((errno != EAGAIN) && (errno != EWOULDBLOCK) && (errno != EINTR)
+                && (errno != ECONNABORTED))
+            {
+                reportError("ReactorServer::acceptClients : accept(serverFD, NULL, NULL)", -1);
+            }
+            return;
+        }
+        fcntl(clientFD, F_SETFL, O_NONBLOCK);
+        if (!reactor.add(clientFD, clientsPaused ? 0 : EPOLLIN, this))
+        {
+            close(clientFD);
+            continue;
+        }
+        client_t &client = clients[clientFD];
+        ostringstream address;
+        address << inet_ntoa(peer.sin_addr) << ":" << ntohs(peer.sin_port);
+        client.peer = address.str();
+        client.written = 0;
+        client.writtenBytes = 0;
+        client.versionChecked = false;
+        client.version = 0;
+        client.options = 0;
+        /* Indicate version and check if a TinyOS 2.0 serial forwarder on the other end */
+        char us[2] = { 'U', SFProtocol::cVersion };
+        sendToClient(clientFD, client, us, 2);
+    }
+}
+
+void ReactorServer::readClient(int fd)
+{
+    clients_t::iterator it = clients.find(fd);
+    if (it == clients.end())
+    {
+        return;
+    }
+    char buffer[cReadChunk];
+    int n = read(fd, buffer, sizeof(buffer));
+    if (n < 0)
+    {
+        if ((errno != EAGAIN) && (errno != EWOULDBLOCK) && (errno != EINTR))
+        {
+            removeClient(fd);
+        }
+        return;
+    }
+    if (n == 0)
+    {
+        DEBUG("ReactorServer::readClient : removeClient")
+        removeClient(fd);
+        return;
+    }
+    tcpReadByteCount += n;
+    client_t &client = it->second;
+    client.in.append(buffer, n);
+    if (!client.versionChecked)
+    {
+        if (client.in.size() < 2)
+        {
+            return;
+        }
+        client.version = SFProtocol::negotiate(client.in[1]);
+        if ((client.in[0] != 'U') || (client.version == 0))
+        {
+            removeClient(fd);
+            return;
+        }
+        if (client.version == SFProtocol::cVersion2)
+        {
+            // followed by the options
+            if (client.in.size() < 3)
+            {
+                return;
+            }
+            client.options = client.in[2];
+            client.in.erase(0, 1);
+        }
+        client.in.erase(0, 2);
+        client.versionChecked = true;
+    }
+    if (!parseClientInput(client))
+    {
+        DEBUG("ReactorServer::readClient : malformed input, removeClient")
+        removeClient(fd);
+        return;
+    }
+    // the client may have sent garbage
+    if ((clients.find(fd) != clients.end())
+        && (client.in.size() > (unsigned)cReadChunk + SFProtocol::cBatchHeaderLength + SFProtocol::cMaxBatchLength))
+    {
+        removeClient(fd);
+    }
+}
+
+bool ReactorServer::parseClientInput(client_t &client)
+{
+    std::vector<SFPacket> packets;
+    unsigned room = (serialQueue.size() < bufferDepth) ? bufferDepth - serialQueue.size() : 0;
+    int used = SFProtocol::decode(client.version, client.in.data(), client.in.size(), packets, room);
+    if (used < 0)
+    {
+        return false;
+    }
+    client.in.erase(0, used);
+    // a v2 batch may overshoot bufferDepth
+    serialQueue.insert(serialQueue.end(), packets.begin(), packets.end());
+    tcpReadPacketCount += packets.size();
+    if (serialQueue.size() >= bufferDepth)
+    {
+        // flow control, like the BLOCK policy of the threaded sf. sendNext
+        // resumes the clients (and parses what is left) once there is room
+        pauseClients(true);
+    }
+    sendNext();
+    return true;
+}
+
+void ReactorServer::pauseClients(bool pause)
+{
+    if (clientsPaused == pause)
+    {
+        return;
+    }
+    clientsPaused = pause;
+    for (clients_t::iterator it = clients.begin(); it != clients.end(); it++)
+    {
+        updateEvents(it->first, !it->second.out.empty());
+    }
+    if (!pause)
+    {
+        // input read before the pause is still waiting to be parsed
+        std::vector<int> failed;
+        for (clients_t::iterator it = clients.begin(); (it != clients.end()) && !clientsPaused; it++)
+        {
+            if (it->second.versionChecked && !parseClientInput(it->second))
+            {
+                failed.push_back(it->first);
+            }
+        }
+        for (unsigned i = 0; i < failed.size(); i++)
+        {
+            removeClient(failed[i]);
+        }
+    }
+}
+
+void ReactorServer::updateEvents(int fd, bool wantWrite)
+{
+    uint32_t events = clientsPaused ? 0 : EPOLLIN;
+    if (wantWrite)
+    {
+        events |= EPOLLOUT;
+    }
+    reactor.modify(fd, events);
+}
+
+bool ReactorServer::sendToClient(int fd, client_t &client, const char* buffer, int count)
+{
+    if (client.out.empty())
+    {
+#ifdef __APPLE__
+        int n = send(fd, buffer, count, 0);
+#else
+        int n = send(fd, buffer, count, MSG_NOSIGNAL);
+#endif
+        if (n < 0)
+        {
+            if ((errno != EAGAIN) && (errno != EWOULDBLOCK) && (errno != EINTR))
+            {
+                return false;
+            }
+            n = 0;
+        }
+        client.writtenBytes += n;
+        tcpWrittenByteCount += n;
+        if (n == count)
+        {
+            return true;
+        }
+        buffer += n;
+        count -= n;
+        updateEvents(fd, true);
+    }
+    if (client.out.size() + count > cMaxClientBacklog)
+    {
+        ++slowClientCount;
+        return false;
+    }
+    client.out.append(buffer, count);
+    return true;
+}
+
+void ReactorServer::writeClient(int fd)
+{
+    client_t &client = clients[fd];
+#ifdef __APPLE__
+    int n = send(fd, client.out.data(), client.out.size(), 0);
+#else
+    int n = send(fd, client.out.data(), client.out.size(), MSG_NOSIGNAL);
+#endif
+    if (n < 0)
+    {
+        if ((errno != EAGAIN) && (errno != EWOULDBLOCK) && (errno != EINTR))
+        {
+            removeClient(fd);
+        }
+        return;
+    }
+    client.writtenBytes += n;
+    tcpWrittenByteCount += n;
+    client.out.erase(0, n);
+    if (client.out.empty())
+    {
+        updateEvents(fd, false);
+    }
+}
+
+void ReactorServer::removeClient(int fd)
+{
+    reactor.remove(fd);
+    close(fd);
+    clients.erase(fd);
+}
+
+void ReactorServer::deliver(SFPacket &pPacket, int64_t pClockOffset)
+{
+    int count = 0;
+    bool full = false;
+    for (clients_t::iterator it = clients.begin(); it != clients.end(); it++)
+    {
+        client_t &client = it->second;
+        if (!client.versionChecked)
+        {
+            continue;
+        }
+        SFProtocol::appendRecord(client.batch, client.version, client.options, pPacket, port, pClockOffset);
+        ++client.written;
+        full = full || (client.batch.size() >= (unsigned)cReadChunk);
+        ++count;
+    }
+    tcpWrittenPacketCount += count;
+    if (count == 0)
+    {
+        ++droppedReadPacketCount;
+    }
+    if (full)
+    {
+        flushBatches();
+    }
+}
+
+void ReactorServer::flushBatches()
+{
+    clients_t::iterator it = clients.begin();
+    while (it != clients.end())
+    {
+        int fd = it->first;
+        client_t &client = it->second;
+        ++it;
+        if (client.batch.empty())
+        {
+            continue;
+        }
+        if (client.version == SFProtocol::cVersion2)
+        {
+            char header[SFProtocol::cBatchHeaderLength];
+            SFProtocol::encodeBatchHeader(client.batch.size(), header);
+            client.batch.insert(0, header, sizeof(header));
+        }
+        bool sent = sendToClient(fd, client, client.batch.data(), client.batch.size());
+        client.batch.clear();
+        if (!sent)
+        {
+            DEBUG("ReactorServer::flushBatches : removeClient")
+            removeClient(fd);
+        }
+    }
+}
+
+void ReactorServer::readSerial()
+{
+    uint8_t buffer[cReadChunk];
+    int n = read(serialFD, buffer, sizeof(buffer));
+    if (n < 0)
+    {
+        if ((errno != EAGAIN) && (errno != EWOULDBLOCK) && (errno != EINTR))
+        {
+            reportError("ReactorServer::readSerial : read(serialFD, buffer, sizeof(buffer))", -1);
+        }
+        return;
+    }
+    /* buggy usb serial drivers return 0 when no data is available */
+    serialReadByteCount += n;
+    int64_t now = SFPacket::getCurrentTime();
+    int delivered = tcpWrittenPacketCount;
+    const uint8_t* pos = buffer;
+    SFPacket packet;
+    bool acked = false;
+    int64_t clockOffset = SFProtocol::getClockOffset();
+    while (framer.decode(pos, buffer + n, packet))
+    {
+        packet.setTimestamp(now);
+        switch (packet.getType())
+        {
+        case SF_ACK:
+        case SF_SACK:
+        case SF_WINDOW:
+            window.receive(packet);
+            acked = true;
+            break;
+        case SF_PACKET_ACK:
+        {
+            // queued behind the frames already waiting for the device;
+            // serialOut may start with a partly written frame, so the
+            // ack cannot jump ahead of them
+            SFPacket ack(SF_ACK, packet.getSeqno());
+            queueSerial(ack);
+        }
+        case SF_PACKET_NO_ACK:
+            // do nothing - fall through
+        default:
+            ++readPacketCount;
+            deliver(packet, clockOffset);
+        }
+        if (serialFD < 0)
+        {
+            // failed while writing the ack
+            flushBatches();
+            return;
+        }
+    }
+    // one send per client for all packets of this read
+    flushBatches();
+    if (tcpWrittenPacketCount != delivered)
+    {
+        latencyHistogram.observe(SFPacket::getCurrentTime() - now, tcpWrittenPacketCount - delivered);
+    }
+    if (acked)
+    {
+        // one round for all acks of this read
+        sendNext();
+    }
+}
+
+bool ReactorServer::queueSerial(SFPacket &pPacket)
+{
+    char buffer[SerialFramer::maxFrameLength(pPacket)];
+    int length = SerialFramer::encode(pPacket, buffer);
+    if (length < 0)
+    {
+        return false;
+    }
+    bool idle = serialOut.empty();
+    serialOut.append(buffer, length);
+    if (idle)
+    {
+        flushSerial();
+    }
+    return true;
+}
+
+void ReactorServer::flushSerial()
+{
+    int n = write(serialFD, serialOut.data(), serialOut.size());
+    if (n < 0)
+    {
+        if ((errno != EAGAIN) && (errno != EWOULDBLOCK) && (errno != EINTR))
+        {
+            reportError("ReactorServer::flushSerial : write(serialFD)", -1);
+            return;
+        }
+        n = 0;
+    }
+    serialWrittenByteCount += n;
+    serialOut.erase(0, n);
+    reactor.modify(serialFD, serialOut.empty() ? EPOLLIN : (EPOLLIN | EPOLLOUT));
+}
+
+void ReactorServer::sendNext()
+{
+    if (serialFD < 0)
+    {
+        return;
+    }
+    int64_t now = SFPacket::getCurrentTime();
+    SFPacket frame;
+    do
+    {
+        while (window.isOpen() && !serialQueue.empty())
+        {
+            window.send(serialQueue.front());
+            serialQueue.pop_front();
+            ++writtenPacketCount;
+        }
+        while (window.poll(frame, now))
+        {
+            if (!queueSerial(frame))
+            {
+                DEBUG("ReactorServer::sendNext : queueSerial failed (SF_PACKET)")
+            }
+            if (serialFD < 0)
+            {
+                return;
+            }
+        }
+        // polling may have ended a negotiation and opened the window
+    } while (window.isOpen() && !serialQueue.empty());
+    int64_t deadline = window.getDeadline();
+    if (deadline >= 0)
+    {
+        reactor.setTimer(this, (deadline > now) ? (deadline - now) : 0);
+    }
+    else
+    {
+        reactor.cancelTimer(this);
+    }
+    if (clientsPaused && (serialQueue.size() < bufferDepth))
+    {
+        pauseClients(false);
+    }
+}
+
+void ReactorServer::handleTimer()
+{
+    sendNext();
+}
+
+void ReactorServer::cancel()
+{
+    reactor.call(detachServer, this);
+}
+
+int ReactorServer::getPort() const
+{
+    return port;
+}
+
+string ReactorServer::getDevice() const
+{
+    return device;
+}
+
+int ReactorServer::getBaudRate() const
+{
+    return baudrate;
+}
+
+/* reports error */
+int ReactorServer::reportError(const char *msg, int result)
+{
+    if ((result < 0) && (!errorReported))
+    {
+        errorMsg << "error : SF-Server ( ReactorServer on port = " << port
+                 << " , device = " << device << " ) : "
+                 << msg << " ( result = " << result << " )" << endl
+                 << "error-description : " << strerror(errno) << endl;
+
+        cerr << errorMsg.str();
+        __atomic_store_n(&errorReported, true, __ATOMIC_RELEASE);
+        detach();
+        pthread_cond_signal(&control.cancel);
+    }
+    return result;
+}
+
+void ReactorServer::reportStatus(ostream& os)
+{
+    statusStream = &os;
+    reactor.call(reportServerStatus, this);
+    statusStream = NULL;
+}
+
+/* prints out status, same format as TCPComm and SerialComm */
+void ReactorServer::printStatus(ostream& os)
+{
+    os << "SF-Server ( TCPComm on port " << port << " )"
+       << " : clients = " << clients.size()
+       << " , packets read = " << tcpReadPacketCount
+       << " , packets written = " << tcpWrittenPacketCount
+       << " ( slow clients dropped = " << slowClientCount << " )" << endl;
+    os << ">> SF-Server ( SerialComm on device " << device << " ) : "
+       << "baudrate = " << baudrate
+       << " , packets read = " << readPacketCount
+       << " ( dropped = " << droppedReadPacketCount
+       << ", bad = " << framer.getBadPacketCount() << " )"
+       << " , packets written = " << writtenPacketCount
+       << " ( dropped = " << window.getDroppedCount()
+       << ", total retries: " << window.getRetryCount() << " ) , ";
+    window.reportStatus(os);
+    os << endl;
+    os << ">> serial queue : " << serialQueue.size() << " / " << bufferDepth
+       << " packets" << (clientsPaused ? " ( clients paused )" : "") << endl;
+}
+
+void ReactorServer::reportMetrics(Metrics& pMetrics, const string& pLabels)
+{
+    statusMetrics = &pMetrics;
+    metricsLabels = pLabels;
+    reactor.call(reportServerMetrics, this);
+    statusMetrics = NULL;
+}
+
+void ReactorServer::addMetrics(Metrics& pMetrics, const string& pLabels)
+{
+    pMetrics.gauge("sf_tcp_clients", "Connected TCP clients.", pLabels, clients.size());
+    pMetrics.counter("sf_tcp_packets_received_total", "Packets received from TCP clients.", pLabels, tcpReadPacketCount);
+    pMetrics.counter("sf_tcp_bytes_received_total", "Bytes received from TCP clients.", pLabels, tcpReadByteCount);
+    pMetrics.counter("sf_tcp_packets_sent_total", "Packets sent to TCP clients (once per client).", pLabels, tcpWrittenPacketCount);
+    pMetrics.counter("sf_tcp_bytes_sent_total", "Bytes sent to TCP clients.", pLabels, tcpWrittenByteCount);
+    pMetrics.counter("sf_tcp_clients_disconnected_total", "Clients disconnected for not keeping up.", pLabels, slowClientCount);
+    pMetrics.histogram("sf_serial_to_tcp_latency_seconds", "Time from the arrival of a frame on the serial line until it was sent to a client.", pLabels, latencyHistogram, 1e-9);
+    for (clients_t::iterator it = clients.begin(); it != clients.end(); it++)
+    {
+        const client_t &client = it->second;
+        string labels = pLabels + "," + Metrics::label("client", client.peer);
+        pMetrics.gauge("sf_client_queued_bytes", "Bytes waiting for a client socket to become writable.", labels, client.out.size());
+        pMetrics.counter("sf_client_packets_sent_total", "Packets sent to a client.", labels, client.written);
+        pMetrics.counter("sf_client_bytes_sent_total", "Bytes sent to a client.", labels, client.writtenBytes);
+    }
+    pMetrics.counter("sf_serial_packets_received_total", "Packets received from the node.", pLabels, readPacketCount);
+    pMetrics.counter("sf_serial_packets_unforwarded_total", "Packets from the node that no TCP client got.", pLabels, droppedReadPacketCount);
+    pMetrics.counter("sf_serial_bad_frames_total", "Frames from the node with a bad crc or length.", pLabels, framer.getBadPacketCount());
+    pMetrics.counter("sf_serial_bytes_received_total", "Bytes read from the serial device.", pLabels, serialReadByteCount);
+    pMetrics.counter("sf_serial_packets_sent_total", "Packets written to the node.", pLabels, writtenPacketCount);
+    pMetrics.counter("sf_serial_bytes_sent_total", "Bytes written to the serial device, acks and retransmissions included.", pLabels, serialWrittenByteCount);
+    window.reportMetrics(pMetrics, pLabels);
+    string queueLabels = pLabels + "," + Metrics::label("buffer", "tcp2serial");
+    pMetrics.gauge("sf_buffer_depth_packets", "Capacity of the packet buffer between the serial and the TCP side.", queueLabels, bufferDepth);
+    pMetrics.gauge("sf_buffer_queued_packets", "Packets waiting in the buffer.", queueLabels, serialQueue.size());
+}
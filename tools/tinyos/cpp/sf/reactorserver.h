@@ -0,0 +1,257 @@
+/*
+ * Copyright (c) 2007, Technische Universitaet Berlin
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without 
+ * modification, are permitted provided that the following conditions 
+ * are met:
+ * - Redistributions of source code must retain the above copyright notice,
+ *   this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright 
+ *   notice, this list of conditions and the following disclaimer in the 
+ *   documentation and/or other materials provided with the distribution.
+ * - Neither the name of the Technische Universitaet Berlin nor the names 
+ *   of its contributors may be used to endorse or promote products derived
+ *   from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS 
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT 
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT 
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, 
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED 
+ * TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, 
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY 
+ * OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT 
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE 
+ * USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+/**
+ * @author Philipp Huppertz <huppertz@tkn.tu-berlin.de>
+ */
+
+#ifndef REACTORSERVER_H
+#define REACTORSERVER_H
+
+#include "reactor.h"
+#include "sfpacket.h"
+#include "sfprotocol.h"
+#include "sfmetrics.h"
+#include "serialframer.h"
+#include "serialwindow.h"
+#include "sharedinfo.h"
+
+#include <map>
+#include <deque>
+#include <string>
+#include <sstream>
+
+// #define DEBUG_REACTORSERVER
+
+#undef DEBUG
+#ifdef DEBUG_REACTORSERVER
+#include <iostream>
+#define DEBUG(message) std::cout << message << std::endl;
+#else
+#define DEBUG(message)
+#endif
+
+/*
+ * A complete sf-server (TCP side and serial side, see TCPComm and
+ * SerialComm) driven by a Reactor instead of five threads of its own.
+ * All sockets and the serial device are non-blocking; the retransmission
+ * timer of the serial window is the reactor timer of this server. Everything
+ * except the constructor, the destructor and the methods marked public
+ * runs on the reactor thread.
+ */
+class ReactorServer : public ReactorHandler
+{
+protected:
+    /* per TCP client state */
+    typedef struct
+    {
+        /* peer address, for reportMetrics */
+        std::string peer;
+        /* "U" and version received and accepted (and the options of a
+           v2 client) */
+        bool versionChecked;
+        /* negotiated protocol version and v2 options */
+        char version;
+        uint8_t options;
+        /* bytes read but not yet parsed into packets */
+        std::string in;
+        /* records delivered during this serial read, sent as one batch */
+        std::string batch;
+        unsigned long written;
+        uint64_t writtenBytes;
+        /* bytes waiting for the socket to become writable */
+        std::string out;
+    } client_t;
+
+    typedef std::map<int, client_t> clients_t;
+
+    /* a client that does not keep up is dropped after this many bytes */
+    static const unsigned cMaxClientBacklog = 64 * 1024;
+
+    /* bytes read from a socket or the device in one go */
+    static const int cReadChunk = 4096;
+
+    Reactor &reactor;
+
+    /* port of this sf */
+    int port;
+
+    /* device of this sf */
+    std::string device;
+
+    /* baudrate of connected device */
+    int baudrate;
+
+    /* max. packets queued for the serial line */
+    unsigned bufferDepth;
+
+    int serverFD;
+
+    int serialFD;
+
+    clients_t clients;
+
+    /* TCP clients are not read while the serial queue is full */
+    bool clientsPaused;
+
+    SerialFramer framer;
+
+    /* packets from TCP clients waiting for the serial line */
+    std::deque<SFPacket> serialQueue;
+
+    /* framed bytes waiting for the device to become writable */
+    std::string serialOut;
+
+    /* packets sent to the node, waiting for their acks */
+    SerialWindow window;
+
+    /* statistics, see TCPComm and SerialComm */
+    int tcpReadPacketCount;
+    int tcpWrittenPacketCount;
+    int slowClientCount;
+    int readPacketCount;
+    int droppedReadPacketCount;
+    int writtenPacketCount;
+    uint64_t tcpReadByteCount;
+    uint64_t tcpWrittenByteCount;
+    uint64_t serialReadByteCount;
+    uint64_t serialWrittenByteCount;
+
+    /* time from reading a frame from the device until it was handed to
+       the client sockets */
+    Histogram latencyHistogram;
+
+    /* indicates that an error occured, set on the reactor thread and
+       read by the control thread, so accessed atomically */
+    bool errorReported;
+
+    /* error message of reportError call */
+    std::ostringstream errorMsg;
+
+    /* for noticing the parent thread of cancelation */
+    sharedControlInfo_t &control;
+
+    /* stream handed to reportStatus() */
+    std::ostream* statusStream;
+
+    /* arguments of reportMetrics() */
+    Metrics* statusMetrics;
+    std::string metricsLabels;
+
+    friend void attachServer(void* ob);
+    friend void detachServer(void* ob);
+    friend void reportServerStatus(void* ob);
+    friend void reportServerMetrics(void* ob);
+
+private:
+    /* do not allow standard constructor */
+    ReactorServer();
+
+protected:
+    /* opens the listening socket and the device, registers with the reactor */
+    void attach();
+
+    /* unregisters from the reactor and closes all fds */
+    void detach();
+
+    bool openSerial();
+
+    bool openServer();
+
+    void acceptClients();
+
+    void readClient(int fd);
+
+    void writeClient(int fd);
+
+    void removeClient(int fd);
+
+    /* parses complete records (v1) or batches (v2) out of client.in,
+       returns false if the client sent garbage */
+    bool parseClientInput(client_t &client);
+
+    /* appends bytes to the client's output, sending right away if possible */
+    bool sendToClient(int fd, client_t &client, const char* buffer, int count);
+
+    /* adds a packet from the node to the batch of all clients */
+    void deliver(SFPacket &pPacket, int64_t pClockOffset);
+
+    /* sends the batches collected by deliver */
+    void flushBatches();
+
+    void readSerial();
+
+    void flushSerial();
+
+    /* frames a packet into serialOut */
+    bool queueSerial(SFPacket &pPacket);
+
+    /* moves queued packets into the window, writes what is due and
+       arms the timer for the next retransmission */
+    void sendNext();
+
+    void pauseClients(bool pause);
+
+    void updateEvents(int fd, bool wantWrite);
+
+    int reportError(const char *msg, int result);
+
+    void printStatus(std::ostream& os);
+
+    void addMetrics(Metrics& pMetrics, const std::string& pLabels);
+
+public:
+    ReactorServer(Reactor &pReactor, int pPort, const char* pDevice, int pBaudrate, unsigned pBufferDepth, sharedControlInfo_t& pControl, int pWindow = SerialWindow::cMaxWindow);
+
+    ~ReactorServer();
+
+    /* ReactorHandler */
+    void handleEvent(int fd, uint32_t events);
+
+    void handleTimer();
+
+    /* closes all connections, the server stays registered as failed */
+    void cancel();
+
+    int getPort() const;
+
+    std::string getDevice() const;
+
+    int getBaudRate() const;
+
+    void reportStatus(std::ostream& os);
+
+    /* adds the metrics of both sides labeled pLabels, same names as
+       TCPComm and SerialComm */
+    void reportMetrics(Metrics& pMetrics, const std::string& pLabels);
+
+    /* returns if error occurred */
+    bool isErrorReported() { return __atomic_load_n(&errorReported, __ATOMIC_ACQUIRE); }
+};
+
+#endif
@@ -42,9 +42,13 @@
 #include <pthread.h>
 #include <sstream>
 #include <sys/time.h>
+#include <sys/ioctl.h>
 #include <errno.h>
 #include <stdint.h>
 #include <unistd.h>
+#ifdef __linux__
+#include <linux/serial.h>
+#endif
 
 using namespace std;
 
@@ -244,7 +248,7 @@ tcflag_t SerialComm::parseBaudrate(int requested)
     return baudrate;
 }
 
-SerialComm::SerialComm(const char* pDevice, int pBaudrate, PacketBuffer &pReadBuffer, PacketBuffer &pWriteBuffer, sharedControlInfo_t& pControl) : readBuffer(pReadBuffer), writeBuffer(pWriteBuffer), droppedReadPacketCount(0), droppedWritePacketCount(0), readPacketCount(0), writtenPacketCount(0), badPacketCount(0), sumRetries(0), device(pDevice), baudrate(pBaudrate), serialReadFD(-1), serialWriteFD(-1), errorReported(false), errorMsg(""), control(pControl)
+SerialComm::SerialComm(const char* pDevice, int pBaudrate, PacketBuffer &pReadBuffer, PacketBuffer &pWriteBuffer, sharedControlInfo_t& pControl, bool pLowLatency, int pWindow) : window(pWindow, ackTimeout, maxRetries), readBuffer(pReadBuffer), writeBuffer(pWriteBuffer), droppedReadPacketCount(0), readPacketCount(0), writtenPacketCount(0), readByteCount(0), writtenByteCount(0), device(pDevice), baudrate(pBaudrate), lowLatency(pLowLatency), serialReadFD(-1), serialWriteFD(-1), errorReported(false), errorMsg(""), control(pControl)
 {
     writerThreadRunning = false;
     readerThreadRunning = false;
@@ -282,6 +286,19 @@ SerialComm::SerialComm(const char* pDevice, int pBaudrate, PacketBuffer &pReadBu
         && !errorReported)
     {
         DEBUG("SerialComm::SerialComm : opened device "<< pDevice << " with baudrate = " << pBaudrate)
+#if defined(__linux__) && defined(ASYNC_LOW_LATENCY)
+        if (lowLatency)
+        {
+            // e.g. FTDI adapters otherwise hold back bytes for up to 16 ms.
+            // not every device supports it, that is fine
+            struct serial_struct serial;
+            if (ioctl(serialReadFD, TIOCGSERIAL, &serial) == 0)
+            {
+                serial.flags |= ASYNC_LOW_LATENCY;
+                ioctl(serialReadFD, TIOCSSERIAL, &serial);
+            }
+        }
+#endif
             }
     else
     {
@@ -296,7 +313,16 @@ SerialComm::SerialComm(const char* pDevice, int pBaudrate, PacketBuffer &pReadBu
     }
 
     pthread_mutex_init(&ack.lock, NULL);
-    pthread_cond_init(&ack.received, NULL);
+    ack.wakeupFD[0] = ack.wakeupFD[1] = -1;
+    if (!errorReported)
+    {
+        reportError("SerialComm::SerialComm : pipe(ack.wakeupFD)", pipe(ack.wakeupFD));
+    }
+    if (!errorReported)
+    {
+        fcntl(ack.wakeupFD[0], F_SETFL, O_NONBLOCK);
+        fcntl(ack.wakeupFD[1], F_SETFL, O_NONBLOCK);
+    }
 
     if (!errorReported)
     {
@@ -315,27 +341,13 @@ SerialComm::~SerialComm()
     cancel();
 
     pthread_mutex_destroy(&ack.lock);
-    pthread_cond_destroy(&ack.received);
+    if (ack.wakeupFD[0] >= 0) close(ack.wakeupFD[0]);
+    if (ack.wakeupFD[1] >= 0) close(ack.wakeupFD[1]);
 
     if(serialReadFD > 2) close(serialReadFD);
     if(serialWriteFD > 2) close(serialWriteFD);
 }
 
-int SerialComm::hdlcEncode(int count, const char* from, char *to) {
-    int offset = 0;
-    for(int i = 0; i < count; i++) {
-        if (from[i] == SYNC_BYTE || from[i] == ESCAPE_BYTE)
-        {
-            to[offset++] = ESCAPE_BYTE;
-            to[offset++] = from[i] ^ 0x20;
-        }
-        else {
-            to[offset++] = from[i];
-        }
-    }
-    return offset;
-}
-
 int SerialComm::writeFD(int fd, const char *buffer, int count, int *err)
 {
     int cnt = 0;
@@ -353,6 +365,7 @@ int SerialComm::writeFD(int fd, const char *buffer, int count, int *err)
     }
     else {
         cnt += tmpCnt;
+        __atomic_fetch_add(&writtenByteCount, tmpCnt, __ATOMIC_RELAXED);
     }
     return cnt;
 }
@@ -368,6 +381,9 @@ int SerialComm::readFD(int fd, char *buffer, int count, int maxCount, int *err)
     unsigned to = (10000000 / baudrate) * count; // time out in usec
     tvold.tv_sec = to / 1000000;
     tvold.tv_usec = to % 1000000;
+    // the low-latency mode only waits after the driver reported
+    // readiness without having data
+    bool wait = !lowLatency;
     while (cnt == 0)
     {
         // no FD_ZERO here because of performance issues. It is done in constructor...
@@ -376,15 +392,25 @@ int SerialComm::readFD(int fd, char *buffer, int count, int maxCount, int *err)
             return -1;
         }
         FD_CLR(serialReadFD, &rfds);
-        tv = tvold;
-        select(0, NULL, NULL, NULL, &tv);
+        if (wait) {
+            tv = tvold;
+            select(0, NULL, NULL, NULL, &tv);
+        }
         int tmpCnt = read(fd, buffer, maxCount);
         if (tmpCnt < 0) {
+            if ((errno == EAGAIN) || (errno == EINTR)) {
+                wait = true;
+                continue;
+            }
             *err = errno;
             return tmpCnt;
         }
+        else if (tmpCnt == 0) {
+            wait = true;
+        }
         else {
             cnt += tmpCnt;
+            __atomic_fetch_add(&readByteCount, tmpCnt, __ATOMIC_RELAXED);
         }
     }
     return cnt;
@@ -417,137 +443,24 @@ char SerialComm::nextRaw() {
 /* reads packet */
 bool SerialComm::readPacket(SFPacket &pPacket)
 {
-    uint8_t buffer[maxMTU + 10];
-    int count = 0;
-    rx_states_t state = WAIT_FOR_SYNC;
-    for(;;) {
-        uint8_t nextByte = nextRaw();
-        if(state == WAIT_FOR_SYNC) {
-            if(nextByte == SYNC_BYTE) {
-                count = 0;
-                state = IN_SYNC;
-            }
-        }
-        else if(state == IN_SYNC) {
-            if(nextByte == SYNC_BYTE) {
-                if(count < minMTU) {
-                    DEBUG("SerialComm::readPacket : frame too short - size = " << count << " : resynchronising ");
-                    badPacketCount++; 
-                    count = 0;
-                }
-                else {
-                    bool dobreak = true;
-                    DEBUG("SerialComm::readPacket : frame size = " << count);
-                    if(checkCrc(buffer, count)) {
-                        pPacket.setType(buffer[typeOffset]);
-                        pPacket.setSeqno(buffer[seqnoOffset]);
-                        switch (buffer[typeOffset]) {
-                        case SF_ACK:
-                            break;
-                        case SF_PACKET_NO_ACK:
-                            pPacket.setPayload((char *)(&buffer[payloadOffset]-1), count+1+1 - serialHeaderBytes);
-                            break;
-                        case SF_PACKET_ACK:
-                            pPacket.setPayload((char *)(&buffer[payloadOffset]), count+1 - serialHeaderBytes);
-                            break;
-                        default:
-                            dobreak = false;
-                            DEBUG("SerialComm::readPacket : unknown packet type = " \
-                                  << static_cast<uint16_t>(buffer[typeOffset] & 0xff));
-                            break;
-                        }
-                        if(dobreak) break; // leave loop
-                    }
-                    else {
-                        DEBUG("SerialComm::readPacket : bad crc");
-                        count = 0;
-                        badPacketCount++;
-                    }
-                }
-            }
-            else if(nextByte == ESCAPE_BYTE) {
-                state = ESCAPED;
-            }
-            else {
-                buffer[count++] = nextByte;
-                if(count >= maxMTU) {
-                    DEBUG("SerialComm::readPacket : packet too long, resynchronizing");
-                    count = 0;
-                    badPacketCount++;
-                    state = WAIT_FOR_SYNC;
-                }
-            }
-        }
-        else if(state == ESCAPED) {
-            if(nextByte == SYNC_BYTE) {
-                DEBUG("SerialComm::readPacket : state ESCAPED, packet got sync byte, resynchronizing");
-                count = 0;
-                badPacketCount++;
-                state = IN_SYNC;
-            }
-            else {
-                buffer[count++] = nextByte ^ 0x20;
-                if(count >= maxMTU) {
-                    DEBUG("SerialComm::readPacket : state ESCAPED, packet too long, resynchronizing");
-                    count = 0;
-                    badPacketCount++;
-                    state = WAIT_FOR_SYNC;
-                }
-                else {
-                    state = IN_SYNC;
-                }
-            }
-        }
-    }
+    while (!framer.decode(nextRaw(), pPacket))
+        ;
+    pPacket.setTimestamp(SFPacket::getCurrentTime());
     return true;
 }
 
 /* writes packet */
 bool SerialComm::writePacket(SFPacket &pPacket)
 {
-    char type, byte = 0;
-    uint16_t crc = 0;
-    char buffer[2*pPacket.getLength() + 20];
-    int offset = 0;
+    char buffer[SerialFramer::maxFrameLength(pPacket)];
     int err = 0;
     int written = 0;
-    
-    // put SFD into buffer 
-    buffer[offset++] = SYNC_BYTE;
-
-    // packet type
-    byte = type = pPacket.getType();
-    crc = byteCRC(byte, crc);
-    offset += hdlcEncode(1, &byte, buffer + offset);
-
-    // seqno
-    byte = pPacket.getSeqno();
-    crc = byteCRC(byte, crc);
-    offset += hdlcEncode(1, &byte, buffer + offset);
-    switch (type)
+    int offset = SerialFramer::encode(pPacket, buffer);
+
+    if (offset < 0)
     {
-    case SF_ACK:
-        break;
-    case SF_PACKET_NO_ACK:
-    case SF_PACKET_ACK:
-        // compute crc
-        for(int i = 0; i < pPacket.getLength(); i++) {
-            crc = byteCRC(pPacket.getPayload()[i], crc);
-        }
-        offset += hdlcEncode(pPacket.getLength(), pPacket.getPayload(), buffer + offset);
-        break;
-    default:
         return false;
     }
-
-    // crc two bytes
-    byte = crc & 0xff;
-    offset += hdlcEncode(1, &byte, buffer + offset);
-    byte = (crc >> 8) & 0xff;
-    offset += hdlcEncode(1, &byte, buffer + offset);
-    
-    // put SFD into buffer
-    buffer[offset++] = SYNC_BYTE;
     written = writeFD(serialWriteFD, buffer, offset, &err);
     if(written < 0) {
         if(err != EINTR) {
@@ -587,42 +500,88 @@ void* readSerialThread(void* ob)
 /* reads from connected clients */
 void SerialComm::readSerial()
 {
+    if (lowLatency)
+    {
+        readSerialLowLatency();
+    }
     while (true)
     {
         SFPacket packet;
         readPacket(packet);
-        switch (packet.getType())
-	{
-	case SF_ACK:
-            // successful delivery
-            // FIXME: seqnos are not implemented on the node !
-            pthread_cond_signal(&ack.received);
-            break;
-	case SF_PACKET_ACK:
+        handlePacket(packet);
+    }
+}
+
+/* reads without delay and deframes the whole read in one pass */
+void SerialComm::readSerialLowLatency()
+{
+    uint8_t raw[cLowLatencyReadBytes];
+    while (true)
+    {
+        int err = 0;
+        int count = readFD(serialReadFD, (char*)raw, 1, sizeof(raw), &err);
+        if (count < 0)
         {
-	    // put ack in front of queue
-	    SFPacket ack(SF_ACK, packet.getSeqno());
-	    writeBuffer.enqueueFront(ack);
+            close(serialReadFD);
+            close(serialWriteFD);
+            serialReadFD = -1;
+            serialWriteFD = -1;
+            errno = err;
+            reportError("SerialComm::readSerialLowLatency : readFD(serialReadFD, raw, 1, sizeof(raw))", count);
+        }
+        // all frames completed by this read arrived now
+        int64_t now = SFPacket::getCurrentTime();
+        const uint8_t* pos = raw;
+        SFPacket packet;
+        while (framer.decode(pos, raw + count, packet))
+        {
+            packet.setTimestamp(now);
+            handlePacket(packet);
+        }
+    }
+}
+
+void SerialComm::handlePacket(SFPacket &packet)
+{
+    switch (packet.getType())
+    {
+    case SF_ACK:
+    case SF_SACK:
+    case SF_WINDOW:
+    {
+        // the writer owns the window
+        pthread_mutex_lock(&ack.lock);
+        if (ack.frames.size() >= cMaxAckFrames)
+        {
+            ack.frames.pop_front();
+        }
+        ack.frames.push_back(packet);
+        bool wakeup = (ack.frames.size() == 1);
+        pthread_mutex_unlock(&ack.lock);
+        if (wakeup)
+        {
+            char byte = 0;
+            while ((write(ack.wakeupFD[1], &byte, 1) < 0) && (errno == EINTR))
+                ;
+        }
+        break;
+    }
+    case SF_PACKET_ACK:
+    {
+        // put ack in front of queue
+        SFPacket ack(SF_ACK, packet.getSeqno());
+        writeBuffer.enqueueFront(ack);
+    }
+    case SF_PACKET_NO_ACK:
+        // do nothing - fall through
+    default:
+        __atomic_fetch_add(&readPacketCount, 1, __ATOMIC_RELAXED);
+        // the read buffer makes room by dropping the oldest packet
+        if (!readBuffer.enqueueBack(packet))
+        {
+            __atomic_fetch_add(&droppedReadPacketCount, 1, __ATOMIC_RELAXED);
+            DEBUG("SerialComm::handlePacket : dropped packet")
         }
-	case SF_PACKET_NO_ACK:
-            // do nothing - fall through
-	default:
-            if (!readBuffer.isFull())
-	    {
-                ++readPacketCount;
-                // put silently into buffer...
-                readBuffer.enqueueBack(packet);
-	    }
-            else
-	    {
-                while(readBuffer.isFull()) {
-                    readBuffer.dequeue();
-                    ++droppedReadPacketCount;
-                }
-                readBuffer.enqueueBack(packet);
-                // DEBUG("SerialComm::readSerial : dropped packet")
-	    }
-	}
     }
 }
 
@@ -637,73 +596,103 @@ void* writeSerialThread(void* ob)
 void SerialComm::writeSerial()
 {
     SFPacket packet;
-    bool retry = false;
-    int retryCount = 0;
-    long long timeout;
-    
+    std::deque<SFPacket> frames;
+
     while (true)
     {
-        if (!retry)
-	{
-            cerr << " serial deqeue packet, empty: " << writeBuffer.isEmpty() << endl;
-            packet = writeBuffer.dequeue();
-	}
-        switch (packet.getType())
-	{
-	case SF_ACK:
-            // successful delivery
-            if (!writePacket(packet))
-	    {
-                DEBUG("SerialComm::writeSerial : writePacket failed (SF_ACK)")
+        // acks that arrived since the last round
+        pthread_mutex_lock(&ack.lock);
+        frames.swap(ack.frames);
+        pthread_mutex_unlock(&ack.lock);
+        while (!frames.empty())
+        {
+            window.receive(frames.front());
+            frames.pop_front();
+        }
+
+        while (window.isOpen() && (writeBuffer.tryDequeue(&packet, 1) == 1))
+        {
+            if (packet.getType() == SF_ACK)
+            {
+                // our ack for an SF_PACKET_ACK frame of the node
+                if (!writePacket(packet))
+                {
+                    DEBUG("SerialComm::writeSerial : writePacket failed (SF_ACK)")
                     reportError("SerialComm::writeSerial : writePacket(SF_ACK)", -1);
-	    }
-            break;
-	case SF_PACKET_ACK:
-            // do nothing - fall through
-	case SF_PACKET_NO_ACK:
-            // do nothing - fall through
-	default:
-            if (!retry)
-                ++writtenPacketCount;
-            // FIXME: this is the only currently supported type by the mote
-            packet.setType(SF_PACKET_ACK);
+                }
+                continue;
+            }
+            __atomic_fetch_add(&writtenPacketCount, 1, __ATOMIC_RELAXED);
+            window.send(packet);
+        }
+
+        int64_t now = SFPacket::getCurrentTime();
+        while (window.poll(packet, now))
+        {
             if (!writePacket(packet))
-	    {
+            {
                 DEBUG("SerialComm::writeSerial : writePacket failed (SF_PACKET)")
-                    reportError("SerialComm::writeSerial : writeFD(SF_PACKET)", -1);
-	    }
-            // wait for ack...
-            struct timeval currentTime;
-            struct timespec ackTime;
-            timeout = (long long)ackTimeout * (retryCount + 1);
-            
-            pthread_testcancel();
-            pthread_mutex_lock(&ack.lock);
-
-            gettimeofday(&currentTime, NULL);
-            ackTime.tv_sec = currentTime.tv_sec;
-            ackTime.tv_nsec = currentTime.tv_usec * 1000;
-
-            ackTime.tv_sec  +=  timeout / (1000*1000*1000);
-            ackTime.tv_nsec += timeout % (1000*1000*1000);
-
-            pthread_cleanup_push((void(*)(void*)) pthread_mutex_unlock, (void *) &ack.lock);
-            int retval = pthread_cond_timedwait(&ack.received, &ack.lock, &ackTime);
-            if (!((retryCount < maxRetries) && (retval == ETIMEDOUT)))
-	    {
-                if (retryCount >= maxRetries) ++droppedWritePacketCount;
-                retry = false;
-                retryCount = 0;
-	    }
-            else
-	    {
-                ++retryCount;
-                retry = true;
-                DEBUG("SerialComm::writeSerial : packet retryCount = " << retryCount);
-                ++sumRetries;
-	    }
-            // removes the cleanup handler and executes it (unlock mutex)
-            pthread_cleanup_pop(1);         }
+                reportError("SerialComm::writeSerial : writeFD(SF_PACKET)", -1);
+            }
+        }
+
+        // sleep until an ack, a new packet (if the window has room) or
+        // the next retransmission
+        fd_set fds;
+        FD_ZERO(&fds);
+        FD_SET(ack.wakeupFD[0], &fds);
+        int maxFD = ack.wakeupFD[0];
+        bool armed = false;
+        int wakeupFD = -1;
+        if (window.isOpen())
+        {
+            armed = writeBuffer.armWakeup();
+            if (!armed)
+            {
+                // packets arrived meanwhile
+                continue;
+            }
+            wakeupFD = writeBuffer.getWakeupFD();
+            if (wakeupFD >= 0)
+            {
+                FD_SET(wakeupFD, &fds);
+                maxFD = (wakeupFD > maxFD) ? wakeupFD : maxFD;
+            }
+        }
+        struct timeval tv;
+        struct timeval* timeout = NULL;
+        int64_t deadline = window.getDeadline();
+        if (deadline >= 0)
+        {
+            int64_t wait = deadline - SFPacket::getCurrentTime();
+            if (wait < 0)
+            {
+                wait = 0;
+            }
+            // round up, waking early only costs another round
+            wait = (wait + 999) / 1000;
+            tv.tv_sec = wait / (1000 * 1000);
+            tv.tv_usec = wait % (1000 * 1000);
+            timeout = &tv;
+        }
+        if (armed && (wakeupFD < 0) && ((timeout == NULL) || (tv.tv_sec > 0) || (tv.tv_usec > 1000)))
+        {
+            // no wakeup channel, poll the buffer
+            tv.tv_sec = 0;
+            tv.tv_usec = 1000;
+            timeout = &tv;
+        }
+        int ready = select(maxFD + 1, &fds, NULL, NULL, timeout);
+        if (armed)
+        {
+            writeBuffer.disarmWakeup((wakeupFD >= 0) && (ready > 0) && FD_ISSET(wakeupFD, &fds));
+        }
+        if ((ready > 0) && FD_ISSET(ack.wakeupFD[0], &fds))
+        {
+            char buf[64];
+            while ((read(ack.wakeupFD[0], buf, sizeof(buf)) < 0) && (errno == EINTR))
+                ;
+        }
     }
 }
 
@@ -783,11 +772,24 @@ void SerialComm::reportStatus(ostream& os)
 {
     os << "SF-Server ( SerialComm on device " << device << " ) : "
        << "baudrate = " << baudrate
-       << " , packets read = " << readPacketCount
-       << " ( dropped = " << droppedReadPacketCount 
-       << ", bad = " << badPacketCount << " )"
-       << " , packets written = " << writtenPacketCount
-       << " ( dropped = " << droppedWritePacketCount 
-       << ", total retries: " << sumRetries << " )"
+       << " , packets read = " << __atomic_load_n(&readPacketCount, __ATOMIC_RELAXED)
+       << " ( dropped = " << __atomic_load_n(&droppedReadPacketCount, __ATOMIC_RELAXED)
+       << ", bad = " << framer.getBadPacketCount() << " )"
+       << " , packets written = " << __atomic_load_n(&writtenPacketCount, __ATOMIC_RELAXED)
+       << " ( dropped = " << window.getDroppedCount()
+       << ", total retries: " << window.getRetryCount() << " ) , ";
+    window.reportStatus(os);
+    os << (lowLatency ? " , low-latency" : "")
        << endl;
 }
+
+void SerialComm::reportMetrics(Metrics& pMetrics, const string& pLabels)
+{
+    pMetrics.counter("sf_serial_packets_received_total", "Packets received from the node.", pLabels, __atomic_load_n(&readPacketCount, __ATOMIC_RELAXED));
+    pMetrics.counter("sf_serial_packets_unforwarded_total", "Packets from the node that no TCP client got.", pLabels, __atomic_load_n(&droppedReadPacketCount, __ATOMIC_RELAXED));
+    pMetrics.counter("sf_serial_bad_frames_total", "Frames from the node with a bad crc or length.", pLabels, framer.getBadPacketCount());
+    pMetrics.counter("sf_serial_bytes_received_total", "Bytes read from the serial device.", pLabels, __atomic_load_n(&readByteCount, __ATOMIC_RELAXED));
+    pMetrics.counter("sf_serial_packets_sent_total", "Packets written to the node.", pLabels, __atomic_load_n(&writtenPacketCount, __ATOMIC_RELAXED));
+    pMetrics.counter("sf_serial_bytes_sent_total", "Bytes written to the serial device, acks and retransmissions included.", pLabels, __atomic_load_n(&writtenByteCount, __ATOMIC_RELAXED));
+    window.reportMetrics(pMetrics, pLabels);
+}
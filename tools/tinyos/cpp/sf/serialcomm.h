@@ -37,6 +37,9 @@
 #include "sfpacket.h"
 #include "packetbuffer.h"
 #include "sharedinfo.h"
+#include "serialframer.h"
+#include "serialwindow.h"
+#include "sfmetrics.h"
 
 #include <sys/select.h>
 #include <pthread.h>
@@ -44,6 +47,7 @@
 #include <string>
 #include <sstream>
 #include <iostream>
+#include <deque>
 
 // #define DEBUG_SERIALCOMM
 // #define DEBUG_RAW_SERIALCOMM
@@ -61,33 +65,26 @@ class SerialComm : public BaseComm
 {
 
     /** Constants **/
-protected:
-    // max serial MTU
-    static const int maxMTU = (SFPacket::cMaxPacketLength+1)*2;
-    // min serial MTU
-    static const int minMTU = 4;
-    // byte count of serial header
-    static const int serialHeaderBytes = 5;
-    // byte offset of type field
-    static const int typeOffset = 0;
-    // byte offset of sequence number field
-    static const int seqnoOffset = 1;
-    // byte offset of payload field
-    static const int payloadOffset = 2;
-    // timeout for acks in s
+public:
+    // timeout for acks in ns
     static const int ackTimeout = 1000 * 1000 * 200;
     // max. reties for packets from pc to node
     static const int maxRetries = 25;
 
+protected:
+    // max serial MTU
+    static const int maxMTU = SerialFramer::maxMTU;
+
     // how many bytes do we attempt to read from the serial line in one go?
     static const int rawReadBytes = 20;
 
-    enum rx_states_t {
-        WAIT_FOR_SYNC,
-        IN_SYNC,
-        ESCAPED
-    };
-    
+    // read buffer of the low-latency mode
+    static const int cLowLatencyReadBytes = 4096;
+
+    // ack frames the reader hands to the writer at most (older ones are
+    // dropped, the newest sack covers them)
+    static const unsigned cMaxAckFrames = 32;
+
     /** Member vars */
 protected:
     /* pthread for serial reading */
@@ -100,16 +97,22 @@ protected:
 
     bool writerThreadRunning;
 
-    // thread safe ack
+    // ack frames from the node, from the reader to the writer thread
     typedef struct
     {
         // mutex lock for any of this vars
         pthread_mutex_t lock;
-        // notempty cond
-        pthread_cond_t received;
-    } ackCondition_t;
+        // frames the writer has not seen yet
+        std::deque<SFPacket> frames;
+        // a byte is written when frames becomes non-empty, the writer
+        // selects on it together with the write buffer
+        int wakeupFD[2];
+    } ackQueue_t;
+
+    ackQueue_t ack;
 
-    ackCondition_t ack;
+    /* packets sent to the node and not acked yet, only used by the writer */
+    SerialWindow window;
 
     /* raw read buffer */
     struct rawFifo_t {
@@ -129,27 +132,28 @@ protected:
     /* number of dropped (read) packets */
     int droppedReadPacketCount;
 
-    /* number of dropped (write) packets */
-    int droppedWritePacketCount;
-
     /* number of read packets */
     int readPacketCount;
 
     /* number of written packets */
     int writtenPacketCount;
 
-    /* number of bad packets read from serial line, counts resynchronizations! */
-    int badPacketCount;
+    /* bytes read from / written to the device, updated atomically */
+    uint64_t readByteCount;
+    uint64_t writtenByteCount;
+
+    /* deframes packets read from serial line, counts bad packets */
+    SerialFramer framer;
 
-    /* sum retry attempts for all packets */
-    int sumRetries;
-    
     /* device port of this sf */
     std::string device;
 
     /* baudrate of connected device */
     int baudrate;
 
+    /* read whatever is there as soon as it is there, see readSerialLowLatency() */
+    bool lowLatency;
+
     /* read fd set */
     fd_set rfds;
 
@@ -187,40 +191,6 @@ private:
 protected:
     char nextRaw();
     
-    /* claculates crc byte-wise */
-    inline static uint16_t byteCRC(uint8_t byte, uint16_t crc) {
-        crc = (uint8_t)(crc >> 8) | (crc << 8);
-        crc ^= byte;
-        crc ^= (uint8_t)(crc & 0xff) >> 4;
-        crc ^= crc << 12;
-        crc ^= (crc & 0xff) << 5;
-        return crc;
-    }
-    
-    inline static uint16_t calcCRC(uint8_t *bytes, uint16_t len) {
-        uint16_t crc = 0;
-        for(unsigned i = 0; i < len; i++) {
-            crc = SerialComm::byteCRC(bytes[i], crc);
-        }
-        return crc;
-    }
-
-    inline static uint16_t checkCrc(uint8_t *bytes, uint16_t count) {
-        bool crcOk = false;
-        if(count > 2) {
-            uint16_t crc = calcCRC(bytes, count - 2);
-            uint16_t packetCrc = (bytes[count-1] << 8) | bytes[count-2];
-            if(crc == packetCrc) crcOk = true;
-        }
-        return crcOk;
-    }
-
-    /* HDLC encode (byte stuff) count bytes from buffer from into buffer to.
-     * to must be at least count * 2 bytes large. Returns the number of bytes
-     * written into to.
-     */
-    int hdlcEncode(int count, const char* from, char *to);
-    
     /**
      *  try to read at least count bytes in one go, but may read up to maxCount bytes.
      */
@@ -232,22 +202,28 @@ protected:
     /* reads a packet (blocking) */
     bool readPacket(SFPacket &pPacket);
 
+    /* acks and forwards a packet read from the node */
+    void handlePacket(SFPacket &pPacket);
+
     /* writes a packet to serial source */
     bool writePacket(SFPacket &pPacket);
 
-    /* returns tcflag of requested baudrate */
-    static tcflag_t parseBaudrate(int requested);
-
     int reportError(const char *msg, int result);
 
     /* checks for messages from node - producer thread */
     void readSerial();
 
+    /* same, deframing everything a read() returns in one pass */
+    void readSerialLowLatency();
+
     /* write messages to serial / node - consumer thread */
     void writeSerial();
     
 public:
-    SerialComm(const char* pDevice, int pBaudrate, PacketBuffer &pReadBuffer, PacketBuffer &pWriteBuffer,  sharedControlInfo_t& pControl);
+    /* returns tcflag of requested baudrate */
+    static tcflag_t parseBaudrate(int requested);
+
+    SerialComm(const char* pDevice, int pBaudrate, PacketBuffer &pReadBuffer, PacketBuffer &pWriteBuffer,  sharedControlInfo_t& pControl, bool pLowLatency = false, int pWindow = SerialWindow::cMaxWindow);
 
     ~SerialComm();
 
@@ -258,8 +234,13 @@ public:
 
     int getBaudRate() const;
 
+    bool isLowLatency() const { return lowLatency; }
+
     void reportStatus(std::ostream& os);
 
+    /* adds the serial side metrics labeled pLabels */
+    void reportMetrics(Metrics& pMetrics, const std::string& pLabels);
+
     /* returns if error occurred */
     bool isErrorReported() { return errorReported; }
 };
@@ -0,0 +1,324 @@
+/*
+ * Copyright (c) 2007, Technische Universitaet Berlin
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without 
+ * modification, are permitted provided that the following conditions 
+ * are met:
+ * - Redistributions of source code must retain the above copyright notice,
+ *   this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright 
+ *   notice, this list of conditions and the following disclaimer in the 
+ *   documentation and/or other materials provided with the distribution.
+ * - Neither the name of the Technische Universitaet Berlin nor the names 
+ *   of its contributors may be used to endorse or promote products derived
+ *   from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS 
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT 
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT 
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, 
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED 
+ * TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, 
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY 
+ * OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT 
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE 
+ * USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+/**
+ * @author Philipp Huppertz <huppertz@tkn.tu-berlin.de>
+ */
+
+#include "serialframer.h"
+
+#include <cstring>
+
+// #define DEBUG_SERIALFRAMER
+
+#undef DEBUG
+#ifdef DEBUG_SERIALFRAMER
+#include <iostream>
+#define DEBUG(message) std::cout << message << std::endl;
+#else
+#define DEBUG(message)
+#endif
+
+/* what the decoder does with a byte */
+enum {
+    PLAIN_BYTE = 0,
+    FRAME_BYTE = 1
+};
+
+/* CRC-CCITT tables for slicing-by-4: crcTable[0] is the usual byte
+   table, crcTable[k] advances a byte by k more zero bytes */
+static uint16_t crcTable[4][256];
+
+/* classification of bytes inside a frame: sync and escape bytes end a
+   run of plain bytes */
+static uint8_t byteClass[256];
+
+static bool initTables()
+{
+    for (int b = 0; b < 256; b++) {
+        uint16_t crc = b << 8;
+        for (int i = 0; i < 8; i++) {
+            crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : (crc << 1);
+        }
+        crcTable[0][b] = crc;
+        byteClass[b] = PLAIN_BYTE;
+    }
+    for (int k = 1; k < 4; k++) {
+        for (int b = 0; b < 256; b++) {
+            uint16_t prev = crcTable[k-1][b];
+            crcTable[k][b] = (uint16_t)(prev << 8) ^ crcTable[0][prev >> 8];
+        }
+    }
+    byteClass[SYNC_BYTE] = FRAME_BYTE;
+    byteClass[ESCAPE_BYTE] = FRAME_BYTE;
+    return true;
+}
+
+// filled before main(), i.e. before any thread can use them
+static bool tablesReady = initTables();
+
+SerialFramer::SerialFramer() : state(WAIT_FOR_SYNC), count(0), badPacketCount(0)
+{
+    (void)tablesReady;
+}
+
+uint16_t SerialFramer::calcCRC(const uint8_t *bytes, int len, uint16_t crc)
+{
+    const uint8_t *end = bytes + len;
+    while (end - bytes >= 4) {
+        crc = crcTable[3][(crc >> 8) ^ bytes[0]] ^ crcTable[2][(crc & 0xff) ^ bytes[1]]
+            ^ crcTable[1][bytes[2]] ^ crcTable[0][bytes[3]];
+        bytes += 4;
+    }
+    while (bytes < end) {
+        crc = (uint16_t)(crc << 8) ^ crcTable[0][(crc >> 8) ^ *bytes++];
+    }
+    return crc;
+}
+
+void SerialFramer::reset()
+{
+    state = WAIT_FOR_SYNC;
+    count = 0;
+}
+
+int SerialFramer::getBadPacketCount() const
+{
+    return __atomic_load_n(&badPacketCount, __ATOMIC_RELAXED);
+}
+
+bool SerialFramer::decode(uint8_t nextByte, SFPacket &pPacket)
+{
+    if(state == WAIT_FOR_SYNC) {
+        if(nextByte == SYNC_BYTE) {
+            count = 0;
+            state = IN_SYNC;
+        }
+    }
+    else if(state == IN_SYNC) {
+        if(nextByte == SYNC_BYTE) {
+            return endOfFrame(pPacket);
+        }
+        else if(nextByte == ESCAPE_BYTE) {
+            state = ESCAPED;
+        }
+        else {
+            buffer[count++] = nextByte;
+            if(count >= maxMTU) {
+                DEBUG("SerialFramer::decode : packet too long, resynchronizing");
+                count = 0;
+                __atomic_fetch_add(&badPacketCount, 1, __ATOMIC_RELAXED);
+                state = WAIT_FOR_SYNC;
+            }
+        }
+    }
+    else if(state == ESCAPED) {
+        if(nextByte == SYNC_BYTE) {
+            DEBUG("SerialFramer::decode : state ESCAPED, packet got sync byte, resynchronizing");
+            count = 0;
+            __atomic_fetch_add(&badPacketCount, 1, __ATOMIC_RELAXED);
+            state = IN_SYNC;
+        }
+        else {
+            buffer[count++] = nextByte ^ 0x20;
+            if(count >= maxMTU) {
+                DEBUG("SerialFramer::decode : state ESCAPED, packet too long, resynchronizing");
+                count = 0;
+                __atomic_fetch_add(&badPacketCount, 1, __ATOMIC_RELAXED);
+                state = WAIT_FOR_SYNC;
+            }
+            else {
+                state = IN_SYNC;
+            }
+        }
+    }
+    return false;
+}
+
+bool SerialFramer::endOfFrame(SFPacket &pPacket)
+{
+    if(count < minMTU) {
+        DEBUG("SerialFramer::decode : frame too short - size = " << count << " : resynchronising ");
+        __atomic_fetch_add(&badPacketCount, 1, __ATOMIC_RELAXED);
+        count = 0;
+    }
+    else {
+        bool complete = true;
+        DEBUG("SerialFramer::decode : frame size = " << count);
+        if(checkCrc(buffer, count)) {
+            pPacket.setType(buffer[typeOffset]);
+            pPacket.setSeqno(buffer[seqnoOffset]);
+            switch (buffer[typeOffset]) {
+            case SF_ACK:
+                break;
+            case SF_PACKET_NO_ACK:
+                pPacket.setPayload((char *)(&buffer[payloadOffset]-1), count+1+1 - serialHeaderBytes);
+                break;
+            case SF_PACKET_ACK:
+            case SF_WINDOW:
+            case SF_SACK:
+                pPacket.setPayload((char *)(&buffer[payloadOffset]), count+1 - serialHeaderBytes);
+                break;
+            default:
+                complete = false;
+                DEBUG("SerialFramer::decode : unknown packet type = " \
+                      << static_cast<uint16_t>(buffer[typeOffset] & 0xff));
+                break;
+            }
+            count = 0;
+            if(complete) {
+                state = WAIT_FOR_SYNC;
+                return true;
+            }
+        }
+        else {
+            DEBUG("SerialFramer::decode : bad crc");
+            count = 0;
+            __atomic_fetch_add(&badPacketCount, 1, __ATOMIC_RELAXED);
+        }
+    }
+    return false;
+}
+
+/* same state machine as decode(byte), but copies runs of plain bytes in
+   one go and skips garbage between frames with memchr */
+bool SerialFramer::decode(const uint8_t* &pos, const uint8_t* end, SFPacket &pPacket)
+{
+    while(pos < end) {
+        if(state == WAIT_FOR_SYNC) {
+            const uint8_t* sync = (const uint8_t*)memchr(pos, SYNC_BYTE, end - pos);
+            if(sync == NULL) {
+                pos = end;
+                return false;
+            }
+            pos = sync + 1;
+            count = 0;
+            state = IN_SYNC;
+        }
+        else if(state == IN_SYNC) {
+            // room left before the frame is too long
+            const uint8_t* runEnd = pos + (maxMTU - count);
+            if(runEnd > end) {
+                runEnd = end;
+            }
+            const uint8_t* run = pos;
+            while((run < runEnd) && (byteClass[*run] == PLAIN_BYTE)) {
+                run++;
+            }
+            memcpy(buffer + count, pos, run - pos);
+            count += run - pos;
+            pos = run;
+            if(count >= maxMTU) {
+                DEBUG("SerialFramer::decode : packet too long, resynchronizing");
+                count = 0;
+                __atomic_fetch_add(&badPacketCount, 1, __ATOMIC_RELAXED);
+                state = WAIT_FOR_SYNC;
+            }
+            else if(pos < end) {
+                if(*pos++ == ESCAPE_BYTE) {
+                    state = ESCAPED;
+                }
+                else if(endOfFrame(pPacket)) {
+                    return true;
+                }
+            }
+        }
+        else {
+            if(decode(*pos++, pPacket)) {
+                // cannot happen in state ESCAPED
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+int SerialFramer::hdlcEncode(int count, const char* from, char *to) {
+    int offset = 0;
+    for(int i = 0; i < count; i++) {
+        if (from[i] == SYNC_BYTE || from[i] == ESCAPE_BYTE)
+        {
+            to[offset++] = ESCAPE_BYTE;
+            to[offset++] = from[i] ^ 0x20;
+        }
+        else {
+            to[offset++] = from[i];
+        }
+    }
+    return offset;
+}
+
+int SerialFramer::maxFrameLength(const SFPacket &pPacket)
+{
+    return 2*pPacket.getLength() + 20;
+}
+
+int SerialFramer::encode(SFPacket &pPacket, char *buffer)
+{
+    char type, byte = 0;
+    uint16_t crc = 0;
+    int offset = 0;
+
+    // put SFD into buffer 
+    buffer[offset++] = SYNC_BYTE;
+
+    // packet type
+    byte = type = pPacket.getType();
+    crc = byteCRC(byte, crc);
+    offset += hdlcEncode(1, &byte, buffer + offset);
+
+    // seqno
+    byte = pPacket.getSeqno();
+    crc = byteCRC(byte, crc);
+    offset += hdlcEncode(1, &byte, buffer + offset);
+    switch (type)
+    {
+    case SF_ACK:
+        break;
+    case SF_PACKET_NO_ACK:
+    case SF_PACKET_ACK:
+    case SF_PACKET_SEQ:
+    case SF_WINDOW:
+        // compute crc
+        crc = calcCRC((const uint8_t*)pPacket.getPayload(), pPacket.getLength(), crc);
+        offset += hdlcEncode(pPacket.getLength(), pPacket.getPayload(), buffer + offset);
+        break;
+    default:
+        return -1;
+    }
+
+    // crc two bytes
+    byte = crc & 0xff;
+    offset += hdlcEncode(1, &byte, buffer + offset);
+    byte = (crc >> 8) & 0xff;
+    offset += hdlcEncode(1, &byte, buffer + offset);
+    
+    // put SFD into buffer
+    buffer[offset++] = SYNC_BYTE;
+    return offset;
+}
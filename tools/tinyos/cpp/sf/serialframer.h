@@ -0,0 +1,138 @@
+/*
+ * Copyright (c) 2007, Technische Universitaet Berlin
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without 
+ * modification, are permitted provided that the following conditions 
+ * are met:
+ * - Redistributions of source code must retain the above copyright notice,
+ *   this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright 
+ *   notice, this list of conditions and the following disclaimer in the 
+ *   documentation and/or other materials provided with the distribution.
+ * - Neither the name of the Technische Universitaet Berlin nor the names 
+ *   of its contributors may be used to endorse or promote products derived
+ *   from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS 
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT 
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT 
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, 
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED 
+ * TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, 
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY 
+ * OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT 
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE 
+ * USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+/**
+ * @author Philipp Huppertz <huppertz@tkn.tu-berlin.de>
+ */
+
+#ifndef SERIALFRAMER_H
+#define SERIALFRAMER_H
+
+#include "sfpacket.h"
+
+#include <stdint.h>
+
+/*
+ * HDLC-like framing of the TinyOS serial protocol: byte stuffing,
+ * CRC and the packet type / seqno header. The decoder is fed one byte
+ * at a time (SerialComm) or a whole read() at once (SerialComm in
+ * low-latency mode, ReactorServer); both keep their state between
+ * calls, so frames may span reads.
+ */
+class SerialFramer
+{
+public:
+    // max serial MTU
+    static const int maxMTU = (SFPacket::cMaxPacketLength+1)*2;
+    // min serial MTU
+    static const int minMTU = 4;
+    // byte count of serial header
+    static const int serialHeaderBytes = 5;
+    // byte offset of type field
+    static const int typeOffset = 0;
+    // byte offset of sequence number field
+    static const int seqnoOffset = 1;
+    // byte offset of payload field
+    static const int payloadOffset = 2;
+
+protected:
+    enum rx_states_t {
+        WAIT_FOR_SYNC,
+        IN_SYNC,
+        ESCAPED
+    };
+
+    rx_states_t state;
+
+    /* unescaped bytes of the frame being received */
+    uint8_t buffer[maxMTU + 10];
+
+    int count;
+
+    /* number of bad packets, counts resynchronizations! */
+    int badPacketCount;
+
+    /* a sync byte ended the frame in buffer: returns true if it is a
+       valid packet, which is then stored in pPacket */
+    bool endOfFrame(SFPacket &pPacket);
+
+public:
+    SerialFramer();
+
+    /* feeds one byte from the serial line. returns true if it completed
+       a valid packet, which is then stored in pPacket */
+    bool decode(uint8_t byte, SFPacket &pPacket);
+
+    /* feeds the bytes from pos up to end. returns true as soon as a
+       packet is complete (pos then points behind its last byte, call
+       again for the rest), false once all bytes are consumed */
+    bool decode(const uint8_t* &pos, const uint8_t* end, SFPacket &pPacket);
+
+    /* forgets a partially received frame */
+    void reset();
+
+    int getBadPacketCount() const;
+
+    /* frames pPacket into buffer, which must hold at least
+       maxFrameLength(pPacket) bytes. returns the frame length or -1 if
+       the packet type cannot be sent */
+    static int encode(SFPacket &pPacket, char *buffer);
+
+    static int maxFrameLength(const SFPacket &pPacket);
+
+    /* HDLC encode (byte stuff) count bytes from buffer from into buffer to.
+     * to must be at least count * 2 bytes large. Returns the number of bytes
+     * written into to.
+     */
+    static int hdlcEncode(int count, const char* from, char *to);
+
+    /* claculates crc byte-wise */
+    inline static uint16_t byteCRC(uint8_t byte, uint16_t crc) {
+        crc = (uint8_t)(crc >> 8) | (crc << 8);
+        crc ^= byte;
+        crc ^= (uint8_t)(crc & 0xff) >> 4;
+        crc ^= crc << 12;
+        crc ^= (crc & 0xff) << 5;
+        return crc;
+    }
+
+    /* same crc as byteCRC (CRC-CCITT, MSB first), four bytes per step */
+    static uint16_t calcCRC(const uint8_t *bytes, int len, uint16_t crc = 0);
+
+    inline static bool checkCrc(const uint8_t *bytes, int count) {
+        bool crcOk = false;
+        if(count > 2) {
+            uint16_t crc = calcCRC(bytes, count - 2);
+            uint16_t packetCrc = (bytes[count-1] << 8) | bytes[count-2];
+            if(crc == packetCrc) crcOk = true;
+        }
+        return crcOk;
+    }
+};
+
+#endif
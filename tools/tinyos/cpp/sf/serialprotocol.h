@@ -14,5 +14,10 @@ enum {
     SERIAL_HDLC_FLAG_BYTE = 126,
     SERIAL_TOS_SERIAL_ACTIVE_MESSAGE_ID = 0,
     SERIAL_TOS_SERIAL_UNKNOWN_ID = 255,
-    SERIAL_SERIAL_PROTO_PACKET_ACK = 68
+    SERIAL_SERIAL_PROTO_PACKET_ACK = 68,
+    SERIAL_SERIAL_PROTO_WINDOW = 70,
+    SERIAL_SERIAL_PROTO_PACKET_SEQ = 71,
+    SERIAL_SERIAL_PROTO_SACK = 72,
+    SERIAL_SERIAL_WINDOW_VERSION = 1,
+    SERIAL_SERIAL_WINDOW_SIZE = 8
 };
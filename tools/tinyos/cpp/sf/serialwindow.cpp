@@ -0,0 +1,349 @@
+/*
+ * Copyright (c) 2007, Technische Universitaet Berlin
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without 
+ * modification, are permitted provided that the following conditions 
+ * are met:
+ * - Redistributions of source code must retain the above copyright notice,
+ *   this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright 
+ *   notice, this list of conditions and the following disclaimer in the 
+ *   documentation and/or other materials provided with the distribution.
+ * - Neither the name of the Technische Universitaet Berlin nor the names 
+ *   of its contributors may be used to endorse or promote products derived
+ *   from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS 
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT 
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT 
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, 
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED 
+ * TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, 
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY 
+ * OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT 
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE 
+ * USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+/**
+ * @author Philipp Huppertz <huppertz@tkn.tu-berlin.de>
+ */
+
+#include "serialwindow.h"
+
+using namespace std;
+
+SerialWindow::SerialWindow(int pWindow, int64_t pAckTimeout, int pMaxRetries, uint8_t pSeqno) : window(pWindow), granted(1), mode(STOP_AND_WAIT), ackTimeout(pAckTimeout), maxRetries(pMaxRetries), base(pSeqno), next(pSeqno), order(0), syncing(false), syncDeadline(0), syncAttempts(0), syncBase(pSeqno), retryCount(0), droppedCount(0), syncCount(0), rttHistogram(Histogram::cLatencyBounds, Histogram::cLatencyBoundCount), retryHistogram(Histogram::cRetryBounds, Histogram::cRetryBoundCount)
+{
+    if (window > cMaxWindow)
+    {
+        window = cMaxWindow;
+    }
+    for (int i = 0; i < cMaxWindow; i++)
+    {
+        slots[i].deadline = 0;
+        slots[i].sent = false;
+        slots[i].acked = false;
+        slots[i].retries = 0;
+        slots[i].sentAt = 0;
+        slots[i].order = 0;
+    }
+    if (window > 1)
+    {
+        mode = PROBING;
+        startSync();
+    }
+}
+
+bool SerialWindow::isOpen() const
+{
+    return !syncing && (outstanding() < limit());
+}
+
+void SerialWindow::send(const SFPacket &pPacket)
+{
+    slot_t &s = slot(next);
+    s.packet = pPacket;
+    s.packet.setType((mode == WINDOWED) ? SF_PACKET_SEQ : SF_PACKET_ACK);
+    s.packet.setSeqno(next);
+    s.deadline = 0;
+    s.sent = false;
+    s.acked = false;
+    s.retries = 0;
+    s.order = 0;
+    ++next;
+}
+
+bool SerialWindow::receive(const SFPacket &pPacket)
+{
+    int64_t now = (pPacket.getTimestamp() != 0) ? pPacket.getTimestamp() : SFPacket::getCurrentTime();
+    switch (pPacket.getType())
+    {
+    case SF_ACK:
+        // the node echoes the seqno of the SF_PACKET_ACK frame
+        if ((mode == STOP_AND_WAIT) && (outstanding() > 0) && slot(base).sent
+            && ((uint8_t)pPacket.getSeqno() == base))
+        {
+            ackSlot(base, now);
+            advance();
+        }
+        return true;
+    case SF_SACK:
+        receiveSack(pPacket, now);
+        return true;
+    case SF_WINDOW:
+        receiveWindow(pPacket);
+        return true;
+    default:
+        return false;
+    }
+}
+
+/* [cumulative seqno] [bit i: cumulative + 1 + i received] */
+void SerialWindow::receiveSack(const SFPacket &pPacket, int64_t now)
+{
+    if ((mode != WINDOWED) || syncing || (pPacket.getLength() < 1))
+    {
+        return;
+    }
+    uint8_t cumulative = pPacket.getSeqno();
+    uint8_t mask = pPacket.getPayload()[0];
+    if ((uint8_t)(cumulative - base) > outstanding())
+    {
+        // the node is behind our window: we dropped a frame it is
+        // still waiting for, or it lost its state
+        DEBUG("SerialWindow::receiveSack : node at " << (int)cumulative << ", base = " << (int)base << ", resynchronizing")
+        startSync();
+        return;
+    }
+    unsigned latest = 0;
+    for (uint8_t seqno = base; seqno != cumulative; seqno++)
+    {
+        unsigned sent = ackSlot(seqno, now);
+        latest = (sent > latest) ? sent : latest;
+    }
+    for (int i = 0; i < 8; i++)
+    {
+        uint8_t seqno = cumulative + 1 + i;
+        if ((mask & (1 << i)) && ((uint8_t)(seqno - base) < outstanding()))
+        {
+            unsigned sent = ackSlot(seqno, now);
+            latest = (sent > latest) ? sent : latest;
+        }
+    }
+    advance();
+    // the line does not reorder: what went out before an acked frame
+    // and is not acked is lost
+    for (uint8_t seqno = base; seqno != next; seqno++)
+    {
+        slot_t &s = slot(seqno);
+        if (s.sent && !s.acked && (s.order < latest))
+        {
+            s.sent = false;
+            s.deadline = 0;
+        }
+    }
+}
+
+/* [base] [version] [window], window 0 if the node lost its state */
+void SerialWindow::receiveWindow(const SFPacket &pPacket)
+{
+    if (pPacket.getLength() < 2)
+    {
+        return;
+    }
+    int size = (uint8_t)pPacket.getPayload()[1];
+    if (size == 0)
+    {
+        DEBUG("SerialWindow::receiveWindow : node lost its window")
+        if (mode == WINDOWED)
+        {
+            startSync();
+        }
+        return;
+    }
+    if (!syncing || ((uint8_t)pPacket.getSeqno() != syncBase))
+    {
+        // late answer to an earlier attempt
+        return;
+    }
+    syncing = false;
+    granted = (size < window) ? size : window;
+    mode = WINDOWED;
+    DEBUG("SerialWindow::receiveWindow : window = " << granted)
+    resendAll(SF_PACKET_SEQ);
+}
+
+bool SerialWindow::poll(SFPacket &pPacket, int64_t now)
+{
+    if (syncing)
+    {
+        if (syncDeadline > now)
+        {
+            return false;
+        }
+        if (syncAttempts < cSyncAttempts)
+        {
+            ++syncAttempts;
+            syncDeadline = now + ackTimeout;
+            char payload[2] = { SERIAL_SERIAL_WINDOW_VERSION, (char)window };
+            pPacket = SFPacket(SF_WINDOW, syncBase);
+            pPacket.setPayload(payload, sizeof(payload));
+            return true;
+        }
+        fallBack();
+    }
+    for (int i = 0; (i < outstanding()) && (i < limit()); i++)
+    {
+        slot_t &s = slot(base + i);
+        if (s.acked || (s.sent && (s.deadline > now)))
+        {
+            continue;
+        }
+        if (s.order != 0)
+        {
+            // timed out, or lost according to a sack
+            if (s.retries >= maxRetries)
+            {
+                DEBUG("SerialWindow::poll : dropping " << (int)(uint8_t)(base + i))
+                __atomic_fetch_add(&droppedCount, 1, __ATOMIC_RELAXED);
+                retryHistogram.observe(s.retries);
+                s.acked = true;
+                advance();
+                if (mode == WINDOWED)
+                {
+                    // move the node's window past the dropped frame
+                    startSync();
+                }
+                return poll(pPacket, now);
+            }
+            ++s.retries;
+            __atomic_fetch_add(&retryCount, 1, __ATOMIC_RELAXED);
+            if ((mode == WINDOWED) && s.sent && (s.retries == cSyncAttempts))
+            {
+                // the node went silent, check that it still speaks the
+                // windowed protocol (it may have been reprogrammed)
+                startSync();
+                return poll(pPacket, now);
+            }
+        }
+        s.sent = true;
+        s.sentAt = now;
+        s.order = ++order;
+        s.deadline = now + ackTimeout * (s.retries + 1);
+        pPacket = s.packet;
+        return true;
+    }
+    return false;
+}
+
+int64_t SerialWindow::getDeadline() const
+{
+    if (syncing)
+    {
+        return syncDeadline;
+    }
+    int64_t deadline = -1;
+    for (int i = 0; (i < outstanding()) && (i < limit()); i++)
+    {
+        const slot_t &s = slots[(uint8_t)(base + i) % cMaxWindow];
+        if (s.acked)
+        {
+            continue;
+        }
+        if (!s.sent)
+        {
+            return 0;
+        }
+        if ((deadline < 0) || (s.deadline < deadline))
+        {
+            deadline = s.deadline;
+        }
+    }
+    return deadline;
+}
+
+void SerialWindow::startSync()
+{
+    if (syncing)
+    {
+        return;
+    }
+    syncing = true;
+    syncDeadline = 0;
+    syncAttempts = 0;
+    syncBase = base;
+    __atomic_fetch_add(&syncCount, 1, __ATOMIC_RELAXED);
+}
+
+void SerialWindow::fallBack()
+{
+    DEBUG("SerialWindow::fallBack : no answer, using stop-and-wait")
+    syncing = false;
+    mode = STOP_AND_WAIT;
+    resendAll(SF_PACKET_ACK);
+}
+
+unsigned SerialWindow::ackSlot(uint8_t seqno, int64_t now)
+{
+    slot_t &s = slot(seqno);
+    if (s.acked)
+    {
+        return 0;
+    }
+    s.acked = true;
+    // an ack after a retransmission may belong to either transmission
+    if ((s.retries == 0) && s.sent && (now >= s.sentAt))
+    {
+        rttHistogram.observe(now - s.sentAt);
+    }
+    retryHistogram.observe(s.retries);
+    return s.order;
+}
+
+void SerialWindow::advance()
+{
+    while ((base != next) && slot(base).acked)
+    {
+        ++base;
+    }
+}
+
+void SerialWindow::resendAll(int pType)
+{
+    for (uint8_t seqno = base; seqno != next; seqno++)
+    {
+        slot_t &s = slot(seqno);
+        s.packet.setType(pType);
+        s.sent = false;
+        s.deadline = 0;
+    }
+}
+
+void SerialWindow::reportStatus(ostream& os) const
+{
+    os << "protocol = ";
+    switch (mode)
+    {
+    case PROBING:
+        os << "probing";
+        break;
+    case WINDOWED:
+        os << "windowed ( window = " << granted << ", resyncs = " << (__atomic_load_n(&syncCount, __ATOMIC_RELAXED) - 1) << " )";
+        break;
+    default:
+        os << "stop-and-wait";
+        break;
+    }
+}
+
+void SerialWindow::reportMetrics(Metrics& pMetrics, const string& pLabels) const
+{
+    pMetrics.gauge("sf_serial_window", "Unacknowledged packets allowed on the serial line (1 for stop-and-wait).", pLabels, limit());
+    pMetrics.counter("sf_serial_retries_total", "Retransmissions of packets to the node.", pLabels, __atomic_load_n(&retryCount, __ATOMIC_RELAXED));
+    pMetrics.counter("sf_serial_send_failures_total", "Packets to the node dropped without an ack after all retries.", pLabels, __atomic_load_n(&droppedCount, __ATOMIC_RELAXED));
+    pMetrics.counter("sf_serial_window_syncs_total", "Window negotiations with the node (start, node resets, drops).", pLabels, __atomic_load_n(&syncCount, __ATOMIC_RELAXED));
+    pMetrics.histogram("sf_serial_ack_rtt_seconds", "Time from sending a packet to the node until its ack, packets acked on the first transmission only.", pLabels, rttHistogram, 1e-9);
+    pMetrics.histogram("sf_serial_packet_retries", "Retransmissions per packet to the node.", pLabels, retryHistogram);
+}
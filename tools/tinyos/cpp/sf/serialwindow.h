@@ -0,0 +1,203 @@
+/*
+ * Copyright (c) 2007, Technische Universitaet Berlin
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without 
+ * modification, are permitted provided that the following conditions 
+ * are met:
+ * - Redistributions of source code must retain the above copyright notice,
+ *   this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright 
+ *   notice, this list of conditions and the following disclaimer in the 
+ *   documentation and/or other materials provided with the distribution.
+ * - Neither the name of the Technische Universitaet Berlin nor the names 
+ *   of its contributors may be used to endorse or promote products derived
+ *   from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS 
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT 
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT 
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, 
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED 
+ * TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, 
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY 
+ * OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT 
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE 
+ * USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+/**
+ * @author Philipp Huppertz <huppertz@tkn.tu-berlin.de>
+ */
+
+#ifndef SERIALWINDOW_H
+#define SERIALWINDOW_H
+
+#include "sfpacket.h"
+#include "sfmetrics.h"
+
+#include <stdint.h>
+#include <string>
+#include <ostream>
+
+// #define DEBUG_SERIALWINDOW
+
+#undef DEBUG
+#ifdef DEBUG_SERIALWINDOW
+#include <iostream>
+#define DEBUG(message) std::cout << message << std::endl;
+#else
+#define DEBUG(message)
+#endif
+
+/*
+ * Sending side of the serial ARQ (pc -> node). A node image that
+ * answers SF_WINDOW frames gets up to getWindow() SF_PACKET_SEQ frames
+ * back to back and acks them with cumulative/selective SF_SACK frames;
+ * a frame is retransmitted when its timer expires or as soon as a sack
+ * covers a frame sent after it (the serial line does not reorder).
+ * Images that do not answer get the old stop-and-wait protocol: one
+ * SF_PACKET_ACK frame at a time, acked by SF_ACK.
+ *
+ * The class does no I/O and no locking. Its owner hands it packets
+ * (send) and the node's ack frames (receive), writes whatever poll()
+ * returns and calls poll() again at getDeadline().
+ */
+class SerialWindow
+{
+public:
+    typedef enum
+    {
+        /* waiting for the answer to the first SF_WINDOW frame */
+        PROBING,
+        WINDOWED,
+        STOP_AND_WAIT
+    } mode_t;
+
+    static const int cMaxWindow = SERIAL_SERIAL_WINDOW_SIZE;
+
+    /* unanswered SF_WINDOW frames before falling back to stop-and-wait;
+       also the number of timeouts of a frame after which the window
+       is resynchronized */
+    static const int cSyncAttempts = 3;
+
+protected:
+    typedef struct
+    {
+        SFPacket packet;
+        /* next retransmission, 0 if the frame is due now */
+        int64_t deadline;
+        /* the frame was sent and is waiting for its ack */
+        bool sent;
+        bool acked;
+        int retries;
+        /* time of the last transmission */
+        int64_t sentAt;
+        /* transmission order, for retransmitting on a later frame's ack */
+        unsigned order;
+    } slot_t;
+
+    /* slot of seqno s is slots[s % cMaxWindow] */
+    slot_t slots[cMaxWindow];
+
+    /* window requested by the user, granted by the node */
+    int window;
+    int granted;
+
+    mode_t mode;
+
+    int64_t ackTimeout;
+
+    int maxRetries;
+
+    /* oldest seqno not acked yet, seqno of the next new packet */
+    uint8_t base;
+    uint8_t next;
+
+    unsigned order;
+
+    /* an SF_WINDOW exchange is going on, nothing else is sent */
+    bool syncing;
+    /* 0 if the SF_WINDOW frame is due now */
+    int64_t syncDeadline;
+    int syncAttempts;
+    uint8_t syncBase;
+
+    /* statistics */
+    int retryCount;
+    int droppedCount;
+    int syncCount;
+
+    /* time from sending a frame to its ack, only for frames acked on
+       their first transmission */
+    Histogram rttHistogram;
+
+    /* retransmissions of every acked or dropped packet */
+    Histogram retryHistogram;
+
+    slot_t& slot(uint8_t seqno) { return slots[seqno % cMaxWindow]; }
+
+    /* number of packets handed to send() and not acked or dropped */
+    int outstanding() const { return (uint8_t)(next - base); }
+
+    /* number of outstanding packets that may be on the line */
+    int limit() const { return (mode == WINDOWED) ? granted : 1; }
+
+    /* starts an SF_WINDOW exchange that restarts the node's window at base */
+    void startSync();
+
+    /* the node does not speak the windowed protocol */
+    void fallBack();
+
+    /* marks seqno as acked at time now, returns its transmission order */
+    unsigned ackSlot(uint8_t seqno, int64_t now);
+
+    /* moves base over acked slots */
+    void advance();
+
+    /* marks all outstanding frames for (re)transmission with type pType */
+    void resendAll(int pType);
+
+    void receiveSack(const SFPacket &pPacket, int64_t now);
+
+    void receiveWindow(const SFPacket &pPacket);
+
+public:
+    /* pWindow <= 1 means stop-and-wait without probing */
+    SerialWindow(int pWindow, int64_t pAckTimeout, int pMaxRetries, uint8_t pSeqno = 0);
+
+    /* true if send() accepts another packet */
+    bool isOpen() const;
+
+    /* true if nothing is outstanding */
+    bool isIdle() const { return (outstanding() == 0) && !syncing; }
+
+    /* queues a packet from a client, see poll() */
+    void send(const SFPacket &pPacket);
+
+    /* handles SF_ACK, SF_SACK and SF_WINDOW frames from the node,
+       returns false for all other packets */
+    bool receive(const SFPacket &pPacket);
+
+    /* returns true and the next frame to write if one is due at time now */
+    bool poll(SFPacket &pPacket, int64_t now);
+
+    /* time poll() has something to write, 0 for now, -1 for never */
+    int64_t getDeadline() const;
+
+    mode_t getMode() const { return mode; }
+
+    int getWindow() const { return limit(); }
+
+    int getRetryCount() const { return __atomic_load_n(&retryCount, __ATOMIC_RELAXED); }
+
+    int getDroppedCount() const { return __atomic_load_n(&droppedCount, __ATOMIC_RELAXED); }
+
+    /* prints mode, window and counters (no newline) */
+    void reportStatus(std::ostream& os) const;
+
+    /* adds window, retry and round trip metrics labeled pLabels */
+    void reportMetrics(Metrics& pMetrics, const std::string& pLabels) const;
+};
+
+#endif
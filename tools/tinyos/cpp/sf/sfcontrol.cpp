@@ -69,8 +69,13 @@ SFControl::SFControl()
     serverFD = -1;
     clientFD = -1;
     controlPort = -1;
+    metricsPort = -1;
+    metricsFD = -1;
     controlServerStarted = false;
     daemon = false;
+    nextReactor = 0;
+    lowLatency = false;
+    serialWindow = SerialWindow::cMaxWindow;
     reportError("SFControl::SFControl : pthread_create( &cancelThread, NULL, checkCancelThread, this)", pthread_create( &cancelThread, NULL, checkCancelThread, this));
 }
 
@@ -78,6 +83,14 @@ SFControl::SFControl()
 SFControl::~SFControl()
 {
     close(serverFD);
+    if (metricsFD >= 0)
+    {
+        close(metricsFD);
+    }
+    for (unsigned i = 0; i < reactors.size(); i++)
+    {
+        delete reactors[i];
+    }
     pthread_mutex_destroy(&sfControlInfo.lock);
     pthread_cond_destroy(&sfControlInfo.cancel);
 }
@@ -90,10 +103,20 @@ string SFControl::getHelpMessage(string msg)
         // genral help message for command line arguments
         helpMessage << "sf - Controls (starting/stopping) several SFs on one machine" << endl << endl
         << "Usage : sf" << endl
-        << "or    : sf control-port PORT_NUMBER daemon" << endl << endl
+        << "or    : sf control-port PORT_NUMBER daemon" << endl
+        << "        (both optionally preceded by: reactor [THREADS], low-latency, window SIZE" << endl
+        << "        and/or metrics-port PORT)" << endl << endl
         << "Arguments:" << endl
         << "        control-port PORT_NUMBER : TCP port on which commands are accepted" << endl 
-        << "        daemon : this switch (if present) makes sf aware that it may be running as a daemon " << endl << endl
+        << "        daemon : this switch (if present) makes sf aware that it may be running as a daemon " << endl
+        << "        reactor [THREADS] : serve all sf-servers from THREADS (default 1) event loops" << endl
+        << "                            instead of five threads per sf-server" << endl
+        << "        low-latency : read the serial devices as soon as data arrives, without the" << endl
+        << "                      per-read delay meant to collect whole frames (always on in reactor mode)" << endl
+        << "        window SIZE : up to SIZE (1-" << SerialWindow::cMaxWindow << ", default " << SerialWindow::cMaxWindow << ") unacknowledged packets to a node," << endl
+        << "                      if its image supports it (1 : always stop-and-wait)" << endl
+        << "        metrics-port PORT : answer HTTP GET /metrics on PORT with the counters, queue levels" << endl
+        << "                            and latency histograms of all sf-servers (Prometheus format)" << endl << endl
         << "Info:" << endl
         << "        If sf is started without arguments it listen on " << endl
         << "        standard input for commands (for a list type \"help\" when sf is running)." << endl
@@ -104,8 +127,14 @@ string SFControl::getHelpMessage(string msg)
     }
     else if (msg == "start")
     {
-        helpMessage << ">> start PORT DEVICE_NAME BAUDRATE:" << endl
+        helpMessage << ">> start PORT DEVICE_NAME BAUDRATE [BUFFER_DEPTH [CLIENT_POLICY [CLIENT_QUEUE]]]:" << endl
         << ">> Starts a sf-server on a given TCP port connecting to a given device with the given baudrate." << endl
+        << ">> BUFFER_DEPTH sets the number of packets queued in each direction (default " << PacketBuffer::cDefaultBufferSize << ")." << endl
+        << ">> Every TCP client has its own output queue of CLIENT_QUEUE packets (default " << TCPComm::cDefaultClientQueueSize << ")." << endl
+        << ">> CLIENT_POLICY says what happens when a client's queue is full:" << endl
+        << ">>   drop (default) - the client misses packets, disconnect - the client is dropped," << endl
+        << ">>   block - no new packets are forwarded until it caught up (the other clients still get theirs)." << endl
+        << ">> (The client options are ignored in reactor mode, where slow clients are disconnected.)" << endl
         << ">> The TCP port device name must be specified and must not" << endl
         << ">> overlap with any other TCP port or device name pair of an already running sf-server." << endl
         << ">> (e.g: \"start 9002 /dev/ttyUSB2 115200\" starts server on port 9002 and device /dev/ttyUSB2 with baudrate 115200)" << endl;
@@ -137,6 +166,13 @@ string SFControl::getHelpMessage(string msg)
         << ">> A List Entry contains the unique id, the TCP port and the device" << endl
         << ">> of a sf-server." << endl;
     }
+    else if (msg == "metrics")
+    {
+        helpMessage << ">> metrics:" << endl
+        << ">> Prints packet, byte and error counters, queue levels and latency histograms" << endl
+        << ">> of all sf-servers in the Prometheus text format." << endl
+        << ">> Start sf with metrics-port PORT to let Prometheus scrape them via HTTP." << endl;
+    }
     else if (msg == "close")
     {
         helpMessage << ">> close:" << endl
@@ -157,7 +193,8 @@ string SFControl::getHelpMessage(string msg)
         << ">> start - starts a sf-server on a given port and device" << endl
         << ">> stop  - stops a running sf-server" << endl
         << ">> list  - lists all running sf-servers" << endl
-        << ">> info  - prints out some information about a given sf-server" << endl;
+        << ">> info  - prints out some information about a given sf-server" << endl
+        << ">> metrics - prints the metrics of all sf-servers (Prometheus format)" << endl;
         if (controlServerStarted) {
           helpMessage << ">> close - closes the TCP connection to the control-client" << endl;
         }
@@ -174,6 +211,90 @@ string SFControl::getHelpMessage(string msg)
 
 void SFControl::parseArgs(int argc, char *argv[])
 {
+    /* strip "reactor [THREADS]", "low-latency", "window SIZE" and "metrics-port PORT", the remaining arguments are positional */
+    vector<char*> args;
+    unsigned reactorCount = 0;
+    for (int i = 0; i < argc; i++)
+    {
+        if ((i > 0) && (strcmp(argv[i], "reactor") == 0))
+        {
+            reactorCount = 1;
+            if (i + 1 < argc)
+            {
+                unsigned count = 0;
+                stringstream helpInt(argv[i + 1]);
+                if ((helpInt >> count) && helpInt.eof())
+                {
+                    if ((count == 0) || (count > maxReactors))
+                    {
+                        os << getHelpMessage("help arguments");
+                        deliverOutput();
+                        exit(1);
+                    }
+                    reactorCount = count;
+                    ++i;
+                }
+            }
+        }
+        else if ((i > 0) && (strcmp(argv[i], "low-latency") == 0))
+        {
+            lowLatency = true;
+        }
+        else if ((i > 0) && (strcmp(argv[i], "window") == 0))
+        {
+            int size = 0;
+            stringstream helpInt((i + 1 < argc) ? argv[i + 1] : "");
+            if (!((helpInt >> size) && helpInt.eof()) || (size < 1) || (size > SerialWindow::cMaxWindow))
+            {
+                os << getHelpMessage("help arguments");
+                deliverOutput();
+                exit(1);
+            }
+            serialWindow = size;
+            ++i;
+        }
+        else if ((i > 0) && (strcmp(argv[i], "metrics-port") == 0))
+        {
+            int port = 0;
+            stringstream helpInt((i + 1 < argc) ? argv[i + 1] : "");
+            if (!((helpInt >> port) && helpInt.eof()) || (port <= 0) || (port > 65535))
+            {
+                os << getHelpMessage("help arguments");
+                deliverOutput();
+                exit(1);
+            }
+            metricsPort = port;
+            ++i;
+        }
+        else
+        {
+            args.push_back(argv[i]);
+        }
+    }
+    for (unsigned i = 0; i < reactorCount; i++)
+    {
+        reactors.push_back(new Reactor());
+    }
+    argc = args.size();
+    argv = &args[0];
+
+    if (reactorCount > 0)
+    {
+        os << ">> Running sf-servers on " << reactorCount << " reactor thread(s)." << endl;
+    }
+    if (lowLatency)
+    {
+        os << ">> Reading serial devices in low-latency mode." << endl;
+    }
+    if (serialWindow != SerialWindow::cMaxWindow)
+    {
+        os << ">> Sending up to " << serialWindow << " unacknowledged packet(s) to the nodes." << endl;
+    }
+    if (metricsPort > 0)
+    {
+        startMetricsServer();
+        os << ">> Serving metrics on http://localhost:" << metricsPort << "/metrics" << endl;
+    }
     if (argc == 1)
     {
         os << ">> Starting sf-control." << endl;
@@ -218,16 +339,32 @@ void SFControl::parseArgs(int argc, char *argv[])
 }
 
 /* starts a sf-server */
-void SFControl::startServer(int port, string device, int baudrate)
+void SFControl::startServer(int port, string device, int baudrate, unsigned bufferDepth, TCPComm::clientPolicy_t clientPolicy, unsigned clientQueueSize)
 {
     pthread_testcancel();
     pthread_mutex_lock(&sfControlInfo.lock);
     sfServer_t newSFServer;
-    newSFServer.serial2tcp = new PacketBuffer();
-    newSFServer.tcp2serial = new PacketBuffer();
-    newSFServer.TcpServer = new TCPComm(port, *(newSFServer.tcp2serial), *(newSFServer.serial2tcp), sfControlInfo);
-    newSFServer.SerialDevice = new SerialComm(device.c_str(), baudrate, *(newSFServer.serial2tcp), *(newSFServer.tcp2serial), sfControlInfo);
     newSFServer.id = ++uniqueId;
+    if (!reactors.empty())
+    {
+        // the serial queue is bounded by bufferDepth, clients are flow-controlled
+        Reactor* reactor = reactors[nextReactor++ % reactors.size()];
+        newSFServer.serial2tcp = NULL;
+        newSFServer.tcp2serial = NULL;
+        newSFServer.TcpServer = NULL;
+        newSFServer.SerialDevice = NULL;
+        newSFServer.reactorServer = new ReactorServer(*reactor, port, device.c_str(), baudrate, bufferDepth, sfControlInfo, serialWindow);
+        servers.push_back(newSFServer);
+        pthread_mutex_unlock(&sfControlInfo.lock);
+        return;
+    }
+    newSFServer.reactorServer = NULL;
+    // packets from the mote must not stall the serial reader: drop the
+    // oldest ones. TCP clients are flow-controlled by the buffer.
+    newSFServer.serial2tcp = new PacketBuffer(bufferDepth, PacketBuffer::DROP_OLDEST);
+    newSFServer.tcp2serial = new PacketBuffer(bufferDepth, PacketBuffer::BLOCK);
+    newSFServer.TcpServer = new TCPComm(port, *(newSFServer.tcp2serial), *(newSFServer.serial2tcp), sfControlInfo, clientPolicy, clientQueueSize);
+    newSFServer.SerialDevice = new SerialComm(device.c_str(), baudrate, *(newSFServer.serial2tcp), *(newSFServer.tcp2serial), sfControlInfo, lowLatency, serialWindow);
     servers.push_back(newSFServer);
     pthread_mutex_unlock(&sfControlInfo.lock);
 }
@@ -243,20 +380,14 @@ bool SFControl::stopServer(int& id, int& port, string& device)
     while( (it != servers.end()) && (!found))
     {
         ++next;
-        if (((*it).SerialDevice->getDevice() == device) || ((*it).TcpServer->getPort() == port) || ((*it).id == id) )
+        if ((getDevice(*it) == device) || (getPort(*it) == port) || ((*it).id == id) )
         {
-            // cancel
-            (*it).TcpServer->cancel();
-            (*it).SerialDevice->cancel();
             // set id, port and device accordingly
             id = (*it).id;
-            port = (*it).TcpServer->getPort();
-            device = (*it).SerialDevice->getDevice();
-            // clean up
-            delete (*it).TcpServer;
-            delete (*it).SerialDevice;
-            delete (*it).tcp2serial;
-            delete (*it).serial2tcp;
+            port = getPort(*it);
+            device = getDevice(*it);
+            // cancel and clean up
+            destroyServer(*it);
             servers.erase(it);
             found = true;
         }
@@ -277,17 +408,28 @@ bool SFControl::showServerInfo(ostream& pOs, int id, int port, string device)
     while( it != servers.end() && (!found))
     {
         ++next;
-        if (((*it).SerialDevice->getDevice() == device) || ((*it).TcpServer->getPort() == port) || ((*it).id == id) )
+        if ((getDevice(*it) == device) || (getPort(*it) == port) || ((*it).id == id) )
         {
             pOs << ">> info for sf-server with id = " << (*it).id
-            << " ( port =  " << (*it).TcpServer->getPort()
-            << " , device = " << (*it).SerialDevice->getDevice()
-            << " , baudrate = " << (*it).SerialDevice->getBaudRate()
+            << " ( port =  " << getPort(*it)
+            << " , device = " << getDevice(*it)
+            << " , baudrate = " << getBaudRate(*it)
             << " )" << endl;
             pOs << ">> ";
-            (*it).TcpServer->reportStatus(os);
-            pOs << ">> ";
-            (*it).SerialDevice->reportStatus(os);
+            if ((*it).reactorServer)
+            {
+                (*it).reactorServer->reportStatus(os);
+            }
+            else
+            {
+                (*it).TcpServer->reportStatus(os);
+                pOs << ">> ";
+                (*it).SerialDevice->reportStatus(os);
+                pOs << ">> serial -> tcp buffer : ";
+                (*it).serial2tcp->reportStatus(os);
+                pOs << ">> tcp -> serial buffer : ";
+                (*it).tcp2serial->reportStatus(os);
+            }
             found = true;
         }
         it = next;
@@ -305,9 +447,9 @@ void SFControl::listServers(ostream& pOs)
     for ( it = servers.begin(); it != servers.end(); it++ )
     {
         pOs << ">> sf-server id = " << (*it).id
-        << " , port = " << (*it).TcpServer->getPort()
-        << " , device = " << (*it).SerialDevice->getDevice()
-        << " , baudrate = " << (*it).SerialDevice->getBaudRate() << endl;
+        << " , port = " << getPort(*it)
+        << " , device = " << getDevice(*it)
+        << " , baudrate = " << getBaudRate(*it) << endl;
     }
     if (servers.size() == 0)
     {
@@ -316,6 +458,33 @@ void SFControl::listServers(ostream& pOs)
     pthread_mutex_unlock(&sfControlInfo.lock);
 }
 
+/* writes the metrics of all servers */
+void SFControl::reportMetrics(ostream& pOs)
+{
+    Metrics metrics;
+    pthread_testcancel();
+    pthread_mutex_lock(&sfControlInfo.lock);
+    metrics.gauge("sf_servers", "Running sf-servers.", "", servers.size());
+    for (list<sfServer_t>::iterator it = servers.begin(); it != servers.end(); it++)
+    {
+        string labels = Metrics::label("id", (*it).id) + "," + Metrics::label("port", getPort(*it))
+            + "," + Metrics::label("device", getDevice(*it));
+        if ((*it).reactorServer)
+        {
+            (*it).reactorServer->reportMetrics(metrics, labels);
+        }
+        else
+        {
+            (*it).TcpServer->reportMetrics(metrics, labels);
+            (*it).SerialDevice->reportMetrics(metrics, labels);
+            (*it).serial2tcp->reportMetrics(metrics, labels + "," + Metrics::label("buffer", "serial2tcp"));
+            (*it).tcp2serial->reportMetrics(metrics, labels + "," + Metrics::label("buffer", "tcp2serial"));
+        }
+    }
+    pthread_mutex_unlock(&sfControlInfo.lock);
+    metrics.write(pOs);
+}
+
 void SFControl::parseInput(std::string arg)
 {
     /* silly, but works ... */
@@ -327,7 +496,25 @@ void SFControl::parseInput(std::string arg)
 
     if (tokens[0] == "start")
     {
-        if (tokens.size() == 4)
+        unsigned bufferDepth = PacketBuffer::cDefaultBufferSize;
+        TCPComm::clientPolicy_t clientPolicy = TCPComm::CLIENT_DROP;
+        unsigned clientQueueSize = TCPComm::cDefaultClientQueueSize;
+        bool valid = (tokens.size() >= 4) && (tokens.size() <= 7);
+        if (valid && (tokens.size() >= 5))
+        {
+            stringstream helpInt(tokens[4]);
+            valid = (helpInt >> bufferDepth) && (bufferDepth > 0);
+        }
+        if (valid && (tokens.size() >= 6))
+        {
+            valid = TCPComm::parseClientPolicy(tokens[5], clientPolicy);
+        }
+        if (valid && (tokens.size() >= 7))
+        {
+            stringstream helpInt(tokens[6]);
+            valid = (helpInt >> clientQueueSize) && (clientQueueSize > 0);
+        }
+        if (valid)
         {
             if (servers.size() < maxSFServers)
             {
@@ -335,6 +522,9 @@ void SFControl::parseInput(std::string arg)
                 << " ( port = " << tokens[1]
                 << " , device = " << tokens[2]
                 << " , baudrate = " << tokens[3]
+                << " , buffer depth = " << bufferDepth
+                << " , client policy = " << TCPComm::getClientPolicyName(clientPolicy)
+                << " , client queue = " << clientQueueSize
                 << " )" << endl;
                 deliverOutput();
                 stringstream helpInt;
@@ -342,7 +532,7 @@ void SFControl::parseInput(std::string arg)
                 int port = 0;
                 helpInt << tokens[3] << " " << tokens[1];
                 helpInt >> baudrate >> port;
-                startServer(port, tokens[2], baudrate);
+                startServer(port, tokens[2], baudrate, bufferDepth, clientPolicy, clientQueueSize);
             }
             else
             {
@@ -424,6 +614,11 @@ void SFControl::parseInput(std::string arg)
         listServers(os);
         deliverOutput();
     }
+    else if (tokens[0] == "metrics")
+    {
+        reportMetrics(os);
+        deliverOutput();
+    }
     else if (tokens[0] == "exit")
     {
         os << ">> exiting..." << endl;
@@ -520,6 +715,11 @@ void SFControl::waitOnInput()
             FD_SET(clientFD, &rfds);
             maxfd = (clientFD > maxfd) ? clientFD : maxfd;
         }
+        if (metricsFD >= 0)
+        {
+            FD_SET(metricsFD, &rfds);
+            maxfd = (metricsFD > maxfd) ? metricsFD : maxfd;
+        }
 
         reportError("SFControl::waitOnInput : select(maxfd+1, &rfds, NULL, NULL, NULL)", select(maxfd+1, &rfds, NULL, NULL, NULL));
 
@@ -540,6 +740,11 @@ void SFControl::waitOnInput()
             }
         }
         if (clientFD == -1) clientConnected = false;
+        if ((metricsFD >= 0) && FD_ISSET(metricsFD, &rfds))
+        {
+            FD_CLR(metricsFD, &rfds);
+            serveMetrics();
+        }
         if (controlServerStarted)
         {
             if (FD_ISSET(serverFD, &rfds))
@@ -611,22 +816,16 @@ void SFControl::checkThreadCancel()
         while( it != servers.end() )
         {
             ++next;
-            if ((*it).TcpServer->isErrorReported() || (*it).SerialDevice->isErrorReported())
+            if (isErrorReported(*it))
             {
-                // cancel
-                (*it).TcpServer->cancel();
-                (*it).SerialDevice->cancel();
                 // inform user
                 os << ">> FAIL: sf-server with id = " << (*it).id
-                << " ( port =  " << (*it).TcpServer->getPort()
-                << " , device = " << (*it).SerialDevice->getDevice()
+                << " ( port =  " << getPort(*it)
+                << " , device = " << getDevice(*it)
                 << " ) canceled" << endl;
                 deliverOutput();
-                // clean up
-                delete (*it).TcpServer;
-                delete (*it).SerialDevice;
-                delete (*it).tcp2serial;
-                delete (*it).serial2tcp;
+                // cancel and clean up
+                destroyServer(*it);
                 servers.erase(it);
             }
             it = next;
@@ -636,6 +835,50 @@ void SFControl::checkThreadCancel()
 }
 
 
+int SFControl::getPort(const sfServer_t& server)
+{
+    if (server.reactorServer)
+        return server.reactorServer->getPort();
+    return server.TcpServer->getPort();
+}
+
+string SFControl::getDevice(const sfServer_t& server)
+{
+    if (server.reactorServer)
+        return server.reactorServer->getDevice();
+    return server.SerialDevice->getDevice();
+}
+
+int SFControl::getBaudRate(const sfServer_t& server)
+{
+    if (server.reactorServer)
+        return server.reactorServer->getBaudRate();
+    return server.SerialDevice->getBaudRate();
+}
+
+bool SFControl::isErrorReported(const sfServer_t& server)
+{
+    if (server.reactorServer)
+        return server.reactorServer->isErrorReported();
+    return server.TcpServer->isErrorReported() || server.SerialDevice->isErrorReported();
+}
+
+void SFControl::destroyServer(sfServer_t& server)
+{
+    if (server.reactorServer)
+    {
+        // the destructor unregisters from the reactor
+        delete server.reactorServer;
+        return;
+    }
+    server.TcpServer->cancel();
+    server.SerialDevice->cancel();
+    delete server.TcpServer;
+    delete server.SerialDevice;
+    delete server.tcp2serial;
+    delete server.serial2tcp;
+}
+
 void SFControl::startControlServer()
 {
     struct sockaddr_in me;
@@ -654,6 +897,114 @@ void SFControl::startControlServer()
     controlServerStarted = true;
 }
 
+void SFControl::startMetricsServer()
+{
+    struct sockaddr_in me;
+    int opt = 1;
+
+    metricsFD = reportError("SFControl::startMetricsServer : socket(AF_INET, SOCK_STREAM, 0)", socket(AF_INET, SOCK_STREAM, 0));
+    reportError("SFControl::startMetricsServer : fcntl(metricsFD, F_SETFL, O_NONBLOCK)", fcntl(metricsFD, F_SETFL, O_NONBLOCK));
+
+    memset(&me, 0, sizeof me);
+    me.sin_family = AF_INET;
+    me.sin_port = htons(metricsPort);
+
+    reportError("SFControl::startMetricsServer : setsockopt(metricsFD, SOL_SOCKET, SO_REUSEADDR, (char *)&opt, sizeof(opt))", setsockopt(metricsFD, SOL_SOCKET, SO_REUSEADDR, (char *)&opt, sizeof(opt)));
+    reportError("SFControl::startMetricsServer : bind(metricsFD, (struct sockaddr *)&me, sizeof me)", bind(metricsFD, (struct sockaddr *)&me, sizeof me));
+    reportError("SFControl::startMetricsServer : listen(metricsFD, 8)", listen(metricsFD, 8));
+}
+
+/* time a metrics request may take from accept to close, in ns */
+static const int64_t cMetricsDeadline = 2000000000LL;
+
+/* sets the SO_RCVTIMEO or SO_SNDTIMEO of fd to the time left until
+   deadline, returns false once it has passed */
+static bool setTimeoutUntil(int fd, int option, int64_t deadline)
+{
+    int64_t left = deadline - SFPacket::getCurrentTime();
+    if (left <= 0)
+    {
+        return false;
+    }
+    struct timeval timeout;
+    timeout.tv_sec = left / 1000000000LL;
+    // a zero timeout would block forever
+    timeout.tv_usec = (left % 1000000000LL) / 1000 + 1;
+    return setsockopt(fd, SOL_SOCKET, option, (char *)&timeout, sizeof(timeout)) == 0;
+}
+
+/* answers GET /metrics */
+void SFControl::serveMetrics()
+{
+    int fd = accept(metricsFD, NULL, NULL);
+    if (fd < 0)
+    {
+        return;
+    }
+    // a scraper that trickles its request or does not read the answer
+    // must not stall the commands: every recv and send only gets what is
+    // left of one deadline for the whole request
+    fcntl(fd, F_SETFL, 0);
+    int64_t deadline = SFPacket::getCurrentTime() + cMetricsDeadline;
+    string request;
+    char buffer[1024];
+    while ((request.find("\r\n\r\n") == string::npos) && (request.find("\n\n") == string::npos)
+           && (request.size() < 8192))
+    {
+        if (!setTimeoutUntil(fd, SO_RCVTIMEO, deadline))
+        {
+            break;
+        }
+        int n = recv(fd, buffer, sizeof(buffer), 0);
+        if (n <= 0)
+        {
+            break;
+        }
+        request.append(buffer, n);
+    }
+    stringstream requestLine(request);
+    string method, path;
+    requestLine >> method >> path;
+    ostringstream body, response;
+    if ((method == "GET") && ((path == "/metrics") || (path == "/")))
+    {
+        reportMetrics(body);
+        response << "HTTP/1.0 200 OK\r\n"
+        << "Content-Type: text/plain; version=0.0.4\r\n";
+    }
+    else
+    {
+        body << "not found" << endl;
+        response << "HTTP/1.0 404 Not Found\r\n"
+        << "Content-Type: text/plain\r\n";
+    }
+    response << "Content-Length: " << body.str().size() << "\r\n"
+    << "Connection: close\r\n\r\n"
+    << body.str();
+    string message = response.str();
+    const char* pos = message.c_str();
+    int length = message.size();
+    while (length > 0)
+    {
+        if (!setTimeoutUntil(fd, SO_SNDTIMEO, deadline))
+        {
+            break;
+        }
+#ifdef __APPLE__
+        int n = send(fd, pos, length, 0);
+#else
+        int n = send(fd, pos, length, MSG_NOSIGNAL);
+#endif
+        if (n <= 0)
+        {
+            break;
+        }
+        length -= n;
+        pos += n;
+    }
+    close(fd);
+}
+
 void SFControl::deliverOutput()
 {
     if (!(clientFD < 0))
@@ -37,8 +37,12 @@
 #include "packetbuffer.h"
 #include "tcpcomm.h"
 #include "serialcomm.h"
+#include "reactor.h"
+#include "reactorserver.h"
+#include "sfmetrics.h"
 #include "pthread.h"
 #include <vector>
+#include <list>
 #include <string>
 
 class SFControl
@@ -51,6 +55,8 @@ protected:
         PacketBuffer* tcp2serial;
         TCPComm* TcpServer;
         SerialComm* SerialDevice;
+        /* set instead of the four above in reactor mode */
+        ReactorServer* reactorServer;
         int id;
     }
     sfServer_t;
@@ -64,6 +70,21 @@ protected:
     /* max. allowed sf-servers */
     static const unsigned int maxSFServers = 512;
 
+    /* max. reactor threads */
+    static const unsigned int maxReactors = 64;
+
+    /* event loops shared by all sf-servers, empty in threaded mode */
+    std::vector<Reactor*> reactors;
+
+    /* reactor the next sf-server is assigned to */
+    unsigned nextReactor;
+
+    /* serial devices are read without delay (threaded mode) */
+    bool lowLatency;
+
+    /* max. unacked packets on the serial line, 1 for stop-and-wait */
+    int serialWindow;
+
     /* pthread for thread cancel notification */
     pthread_t cancelThread;
 
@@ -88,6 +109,12 @@ protected:
     /* control-client fd */
     int clientFD;
 
+    /* tcp port answering HTTP GET /metrics, -1 if none */
+    int metricsPort;
+
+    /* listening socket of the metrics port */
+    int metricsFD;
+
     /* string stream for multiplexing output (cout and control-client) */
     std::ostringstream os;
 
@@ -128,7 +155,8 @@ protected:
     bool readFromClient(std::string& message);
 
     /* starts a sf-server */
-    void startServer(int port, std::string device, int baudrate);
+    void startServer(int port, std::string device, int baudrate, unsigned bufferDepth = PacketBuffer::cDefaultBufferSize,
+                     TCPComm::clientPolicy_t clientPolicy = TCPComm::CLIENT_DROP, unsigned clientQueueSize = TCPComm::cDefaultClientQueueSize);
 
     /* stops a given sf-server. returns false if specified server not running */
     bool stopServer(int& id, int& port, std::string& device);
@@ -139,11 +167,30 @@ protected:
     /* lists all running servers */
     void listServers(std::ostream& pOs);
 
+    /* writes the metrics of all servers in the Prometheus text format */
+    void reportMetrics(std::ostream& pOs);
+
+    /* opens the metrics port */
+    void startMetricsServer();
+
+    /* answers one HTTP request on the metrics port: GET /metrics is
+       served, everything else is not found */
+    void serveMetrics();
+
     /* send output to console and/or to connected control client */
     void deliverOutput();
 
     /* reports error to stderr */
     int reportError(const char *msg, int result);
+
+    /* accessors hiding the difference between threaded and reactor servers */
+    static int getPort(const sfServer_t& server);
+    static std::string getDevice(const sfServer_t& server);
+    static int getBaudRate(const sfServer_t& server);
+    static bool isErrorReported(const sfServer_t& server);
+
+    /* cancels and frees a server */
+    static void destroyServer(sfServer_t& server);
 };
 
 
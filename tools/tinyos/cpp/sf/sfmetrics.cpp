@@ -0,0 +1,192 @@
+/*
+ * Copyright (c) 2007, Technische Universitaet Berlin
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without 
+ * modification, are permitted provided that the following conditions 
+ * are met:
+ * - Redistributions of source code must retain the above copyright notice,
+ *   this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright 
+ *   notice, this list of conditions and the following disclaimer in the 
+ *   documentation and/or other materials provided with the distribution.
+ * - Neither the name of the Technische Universitaet Berlin nor the names 
+ *   of its contributors may be used to endorse or promote products derived
+ *   from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS 
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT 
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT 
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, 
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED 
+ * TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, 
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY 
+ * OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT 
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE 
+ * USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+/**
+ * @author Philipp Huppertz <huppertz@tkn.tu-berlin.de>
+ */
+
+
+#include "sfmetrics.h"
+
+#include <sstream>
+
+using namespace std;
+
+const int64_t Histogram::cLatencyBounds[] =
+{
+    50000LL, 100000LL, 250000LL, 500000LL, 1000000LL, 2500000LL,
+    5000000LL, 10000000LL, 25000000LL, 50000000LL, 100000000LL,
+    250000000LL, 500000000LL, 1000000000LL, 2500000000LL
+};
+const int Histogram::cLatencyBoundCount = sizeof(cLatencyBounds) / sizeof(cLatencyBounds[0]);
+
+const int64_t Histogram::cRetryBounds[] = { 0, 1, 2, 3, 5, 10, 15, 20, 25 };
+const int Histogram::cRetryBoundCount = sizeof(cRetryBounds) / sizeof(cRetryBounds[0]);
+
+Histogram::Histogram(const int64_t* pBounds, int pBoundCount) : bounds(pBounds), boundCount(pBoundCount), sum(0)
+{
+    if (boundCount > cMaxBounds)
+    {
+        boundCount = cMaxBounds;
+    }
+    for (int i = 0; i <= cMaxBounds; i++)
+    {
+        buckets[i] = 0;
+    }
+}
+
+void Histogram::observe(int64_t pValue, uint64_t pCount)
+{
+    int i = 0;
+    while ((i < boundCount) && (pValue > bounds[i]))
+    {
+        ++i;
+    }
+    __atomic_fetch_add(&buckets[i], pCount, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&sum, pValue * (int64_t)pCount, __ATOMIC_RELAXED);
+}
+
+uint64_t Histogram::getCumulativeCount(int pIndex) const
+{
+    uint64_t count = 0;
+    for (int i = 0; (i <= pIndex) && (i <= boundCount); i++)
+    {
+        count += __atomic_load_n(&buckets[i], __ATOMIC_RELAXED);
+    }
+    return count;
+}
+
+int64_t Histogram::getSum() const
+{
+    return __atomic_load_n(&sum, __ATOMIC_RELAXED);
+}
+
+Metrics::family_t& Metrics::family(const char* pName, const char* pType, const char* pHelp)
+{
+    map<string, family_t>::iterator it = families.find(pName);
+    if (it != families.end())
+    {
+        return it->second;
+    }
+    names.push_back(pName);
+    family_t& f = families[pName];
+    f.help = pHelp;
+    f.type = pType;
+    return f;
+}
+
+void Metrics::sample(string& pOut, const string& pName, const string& pLabels, const string& pValue)
+{
+    pOut += pName;
+    if (!pLabels.empty())
+    {
+        pOut += "{" + pLabels + "}";
+    }
+    pOut += " " + pValue + "\n";
+}
+
+void Metrics::counter(const char* pName, const char* pHelp, const string& pLabels, uint64_t pValue)
+{
+    ostringstream value;
+    value << pValue;
+    sample(family(pName, "counter", pHelp).samples, pName, pLabels, value.str());
+}
+
+void Metrics::gauge(const char* pName, const char* pHelp, const string& pLabels, double pValue)
+{
+    ostringstream value;
+    value << pValue;
+    sample(family(pName, "gauge", pHelp).samples, pName, pLabels, value.str());
+}
+
+void Metrics::histogram(const char* pName, const char* pHelp, const string& pLabels, const Histogram& pHistogram, double pScale)
+{
+    string& samples = family(pName, "histogram", pHelp).samples;
+    string name(pName);
+    string prefix = pLabels.empty() ? "" : pLabels + ",";
+    for (int i = 0; i <= pHistogram.getBoundCount(); i++)
+    {
+        ostringstream bound, value;
+        if (i < pHistogram.getBoundCount())
+        {
+            bound << pHistogram.getBound(i) * pScale;
+        }
+        else
+        {
+            bound << "+Inf";
+        }
+        value << pHistogram.getCumulativeCount(i);
+        sample(samples, name + "_bucket", prefix + label("le", bound.str()), value.str());
+    }
+    ostringstream sum, count;
+    sum << pHistogram.getSum() * pScale;
+    count << pHistogram.getCumulativeCount(pHistogram.getBoundCount());
+    sample(samples, name + "_sum", pLabels, sum.str());
+    sample(samples, name + "_count", pLabels, count.str());
+}
+
+void Metrics::write(ostream& os) const
+{
+    for (vector<string>::const_iterator it = names.begin(); it != names.end(); it++)
+    {
+        const family_t& f = families.find(*it)->second;
+        os << "# HELP " << *it << " " << f.help << "\n"
+           << "# TYPE " << *it << " " << f.type << "\n"
+           << f.samples;
+    }
+}
+
+string Metrics::label(const char* pName, const string& pValue)
+{
+    string escaped;
+    for (string::const_iterator it = pValue.begin(); it != pValue.end(); it++)
+    {
+        switch (*it)
+        {
+        case '\\':
+            escaped += "\\\\";
+            break;
+        case '"':
+            escaped += "\\\"";
+            break;
+        case '\n':
+            escaped += "\\n";
+            break;
+        default:
+            escaped += *it;
+        }
+    }
+    return string(pName) + "=\"" + escaped + "\"";
+}
+
+string Metrics::label(const char* pName, int pValue)
+{
+    ostringstream value;
+    value << pValue;
+    return label(pName, value.str());
+}
@@ -0,0 +1,127 @@
+/*
+ * Copyright (c) 2007, Technische Universitaet Berlin
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without 
+ * modification, are permitted provided that the following conditions 
+ * are met:
+ * - Redistributions of source code must retain the above copyright notice,
+ *   this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright 
+ *   notice, this list of conditions and the following disclaimer in the 
+ *   documentation and/or other materials provided with the distribution.
+ * - Neither the name of the Technische Universitaet Berlin nor the names 
+ *   of its contributors may be used to endorse or promote products derived
+ *   from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS 
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT 
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT 
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, 
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED 
+ * TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, 
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY 
+ * OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT 
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE 
+ * USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+/**
+ * @author Philipp Huppertz <huppertz@tkn.tu-berlin.de>
+ */
+
+
+#ifndef SFMETRICS_H
+#define SFMETRICS_H
+
+#include <stdint.h>
+#include <map>
+#include <string>
+#include <vector>
+#include <ostream>
+
+/*
+ * Histogram with fixed bucket bounds. observe() is called on the hot
+ * path of one thread and costs two relaxed atomic increments and an add;
+ * the control thread reads a (slightly racy, never torn) snapshot.
+ */
+class Histogram
+{
+public:
+    static const int cMaxBounds = 16;
+
+    /* ns, for the latency and round trip histograms */
+    static const int64_t cLatencyBounds[];
+    static const int cLatencyBoundCount;
+
+    /* retransmissions of a packet */
+    static const int64_t cRetryBounds[];
+    static const int cRetryBoundCount;
+
+protected:
+    const int64_t* bounds;
+    int boundCount;
+    /* buckets[i] counts values <= bounds[i] (and > bounds[i - 1]),
+       buckets[boundCount] the rest */
+    uint64_t buckets[cMaxBounds + 1];
+    int64_t sum;
+
+public:
+    /* pBounds must be sorted and outlive the histogram */
+    Histogram(const int64_t* pBounds, int pBoundCount);
+
+    void observe(int64_t pValue, uint64_t pCount = 1);
+
+    int getBoundCount() const { return boundCount; }
+
+    int64_t getBound(int pIndex) const { return bounds[pIndex]; }
+
+    /* values <= getBound(pIndex), or all values for getBoundCount() */
+    uint64_t getCumulativeCount(int pIndex) const;
+
+    int64_t getSum() const;
+};
+
+/*
+ * Collects samples in the Prometheus text exposition format. Samples of
+ * one metric may be added in any order (e.g. server by server), write()
+ * groups them by metric as the format requires.
+ */
+class Metrics
+{
+protected:
+    typedef struct
+    {
+        std::string help;
+        const char* type;
+        std::string samples;
+    } family_t;
+
+    /* metrics in the order they were first added */
+    std::vector<std::string> names;
+    std::map<std::string, family_t> families;
+
+    family_t& family(const char* pName, const char* pType, const char* pHelp);
+
+    static void sample(std::string& pOut, const std::string& pName, const std::string& pLabels, const std::string& pValue);
+
+public:
+    /* a monotonically increasing count */
+    void counter(const char* pName, const char* pHelp, const std::string& pLabels, uint64_t pValue);
+
+    /* a value that goes up and down */
+    void gauge(const char* pName, const char* pHelp, const std::string& pLabels, double pValue);
+
+    /* pScale converts bounds and sum to the unit of the metric, e.g.
+       1e-9 for ns to seconds */
+    void histogram(const char* pName, const char* pHelp, const std::string& pLabels, const Histogram& pHistogram, double pScale = 1.0);
+
+    void write(std::ostream& os) const;
+
+    /* name="value" with the value escaped, for building label sets */
+    static std::string label(const char* pName, const std::string& pValue);
+
+    static std::string label(const char* pName, int pValue);
+};
+
+#endif
@@ -32,11 +32,13 @@
 
 #include "sfpacket.h"
 #include <cstring>
+#include <time.h>
 
 SFPacket::SFPacket(int pType, int pSeqno) {
     length = 0;
     seqno = pSeqno;
     type = pType;
+    timestamp = 0;
 }
 
 // copy constructor
@@ -44,6 +46,7 @@ SFPacket::SFPacket(const SFPacket &pPacket) {
     length = pPacket.getLength();
     type = pPacket.getType();
     seqno = pPacket.getSeqno();
+    timestamp = pPacket.getTimestamp();
     setPayload(pPacket.getPayload(), length);
 }
 
@@ -54,7 +57,7 @@ SFPacket::~SFPacket()
 
 const char* SFPacket::getPayload() const
 {
-    if(((type == SF_PACKET_ACK) || (type == SF_PACKET_NO_ACK))) {
+    if(hasPayload(type)) {
         return buffer + 1;
     }
     else {
@@ -78,7 +81,7 @@ int SFPacket::getSeqno() const
 
 bool SFPacket::setPayload(const char* pBuffer, uint8_t pLength)
 {
-    if ((pLength > 0) && (pLength < cMaxPacketLength) && ((type == SF_PACKET_ACK) || (type == SF_PACKET_NO_ACK)))
+    if ((pLength > 0) && (pLength < cMaxPacketLength) && hasPayload(type))
     {
         length = pLength;
         memcpy(buffer + 1, pBuffer, pLength);
@@ -98,6 +101,38 @@ void SFPacket::setType(int pType)
     type = pType;
 }
 
+int64_t SFPacket::getTimestamp() const
+{
+    return timestamp;
+}
+
+void SFPacket::setTimestamp(int64_t pTimestamp)
+{
+    timestamp = pTimestamp;
+}
+
+int64_t SFPacket::getCurrentTime()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+bool SFPacket::hasPayload(int pType)
+{
+    switch (pType)
+    {
+    case SF_PACKET_ACK:
+    case SF_PACKET_NO_ACK:
+    case SF_PACKET_SEQ:
+    case SF_WINDOW:
+    case SF_SACK:
+        return true;
+    default:
+        return false;
+    }
+}
+
 int const SFPacket::getMaxPayloadLength()
 {
     return cMaxPacketLength;
@@ -108,7 +143,7 @@ bool SFPacket::operator==(SFPacket const& pPacket)
 {
     bool retval=false;
     if((pPacket.getType() == type) && (pPacket.getLength() == length) && (pPacket.getSeqno() == seqno)) {
-        if((type == SF_PACKET_ACK) || (type == SF_PACKET_NO_ACK)) {
+        if(hasPayload(type)) {
             retval = (memcmp(pPacket.getPayload(), getPayload(), length) == 0);
         }
     }
@@ -54,6 +54,9 @@ enum {
   SF_ACK = SERIAL_SERIAL_PROTO_ACK,
   SF_PACKET_ACK = SERIAL_SERIAL_PROTO_PACKET_ACK,
   SF_PACKET_NO_ACK = SERIAL_SERIAL_PROTO_PACKET_NOACK,
+  SF_WINDOW = SERIAL_SERIAL_PROTO_WINDOW,
+  SF_PACKET_SEQ = SERIAL_SERIAL_PROTO_PACKET_SEQ,
+  SF_SACK = SERIAL_SERIAL_PROTO_SACK,
   SF_UNKNOWN = SERIAL_SERIAL_PROTO_PACKET_UNKNOWN
 };
 
@@ -75,6 +78,8 @@ protected:
     int type;
     /* sequence number */
     int seqno;
+    /* arrival time in ns on the monotonic clock, 0 if unknown */
+    int64_t timestamp;
 
 
 /** member functions **/
@@ -114,6 +119,17 @@ public:
     /* sets the type */
     void setType(int pType);
 
+    /* arrival time of the packet, see getCurrentTime() */
+    int64_t getTimestamp() const;
+
+    void setTimestamp(int64_t pTimestamp);
+
+    /* monotonic clock in ns */
+    static int64_t getCurrentTime();
+
+    /* true for the packet types that carry a payload */
+    static bool hasPayload(int pType);
+
     /* returns max payload length */
     static const int getMaxPayloadLength();
 
@@ -0,0 +1,174 @@
+/*
+ * Copyright (c) 2007, Technische Universitaet Berlin
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without 
+ * modification, are permitted provided that the following conditions 
+ * are met:
+ * - Redistributions of source code must retain the above copyright notice,
+ *   this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright 
+ *   notice, this list of conditions and the following disclaimer in the 
+ *   documentation and/or other materials provided with the distribution.
+ * - Neither the name of the Technische Universitaet Berlin nor the names 
+ *   of its contributors may be used to endorse or promote products derived
+ *   from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS 
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT 
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT 
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, 
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED 
+ * TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, 
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY 
+ * OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT 
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE 
+ * USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+/**
+ * @author Philipp Huppertz <huppertz@tkn.tu-berlin.de>
+ */
+
+
+#include "sfprotocol.h"
+
+#include <time.h>
+
+using namespace std;
+
+const char SFProtocol::cVersion1;
+const char SFProtocol::cVersion2;
+const char SFProtocol::cVersion;
+const uint8_t SFProtocol::cTimestamp;
+const uint8_t SFProtocol::cGateway;
+const uint8_t SFProtocol::cOptions;
+
+static void putLittleEndian(char *pBuffer, uint64_t pValue, int pBytes)
+{
+    for (int i = 0; i < pBytes; i++)
+    {
+        pBuffer[i] = (char)(pValue >> (8 * i));
+    }
+}
+
+char SFProtocol::negotiate(char pVersion)
+{
+    char version = (pVersion < cVersion) ? pVersion : cVersion;
+    /* Add other cases here for later protocol versions */
+    switch (version)
+    {
+    case cVersion1:
+    case cVersion2:
+        return version;
+    default:
+        return 0;
+    }
+}
+
+int SFProtocol::encodeRecordHeader(char pVersion, uint8_t pOptions, const SFPacket &pPacket, uint16_t pGateway, int64_t pClockOffset, char *pHeader)
+{
+    int length = 0;
+    pHeader[length++] = (char)pPacket.getLength();
+    if (pVersion == cVersion1)
+    {
+        return length;
+    }
+    uint8_t flags = pOptions & cOptions;
+    if (pPacket.getTimestamp() == 0)
+    {
+        flags &= ~cTimestamp;
+    }
+    pHeader[length++] = (char)flags;
+    if (flags & cTimestamp)
+    {
+        putLittleEndian(pHeader + length, (pPacket.getTimestamp() + pClockOffset) / 1000, 8);
+        length += 8;
+    }
+    if (flags & cGateway)
+    {
+        putLittleEndian(pHeader + length, pGateway, 2);
+        length += 2;
+    }
+    return length;
+}
+
+void SFProtocol::appendRecord(string &pOut, char pVersion, uint8_t pOptions, const SFPacket &pPacket, uint16_t pGateway, int64_t pClockOffset)
+{
+    char header[cMaxRecordHeaderLength];
+    int length = encodeRecordHeader(pVersion, pOptions, pPacket, pGateway, pClockOffset, header);
+    pOut.append(header, length);
+    pOut.append(pPacket.getPayload(), pPacket.getLength());
+}
+
+void SFProtocol::encodeBatchHeader(int pLength, char *pHeader)
+{
+    putLittleEndian(pHeader, pLength, cBatchHeaderLength);
+}
+
+int SFProtocol::decode(char pVersion, const char *pData, int pLength, vector<SFPacket> &pPackets, unsigned pMax)
+{
+    const uint8_t *data = (const uint8_t *)pData;
+    int used = 0;
+    while (pPackets.size() < pMax)
+    {
+        if (pVersion == cVersion1)
+        {
+            if ((used >= pLength) || (used + 1 + data[used] > pLength))
+            {
+                break;
+            }
+            int length = data[used];
+            SFPacket packet;
+            if (!packet.setPayload(pData + used + 1, length))
+            {
+                return -1;
+            }
+            pPackets.push_back(packet);
+            used += 1 + length;
+            continue;
+        }
+        if (used + cBatchHeaderLength > pLength)
+        {
+            break;
+        }
+        int end = used + cBatchHeaderLength + (data[used] | (data[used + 1] << 8));
+        if (end > pLength)
+        {
+            break;
+        }
+        int pos = used + cBatchHeaderLength;
+        while (pos < end)
+        {
+            if (pos + 2 > end)
+            {
+                return -1;
+            }
+            int length = data[pos];
+            uint8_t flags = data[pos + 1];
+            pos += 2;
+            if (flags & ~cOptions)
+            {
+                return -1;
+            }
+            // the server keeps its own timestamps and gateway id
+            pos += ((flags & cTimestamp) ? 8 : 0) + ((flags & cGateway) ? 2 : 0);
+            SFPacket packet;
+            if ((pos + length > end) || !packet.setPayload(pData + pos, length))
+            {
+                return -1;
+            }
+            pPackets.push_back(packet);
+            pos += length;
+        }
+        used = end;
+    }
+    return used;
+}
+
+int64_t SFProtocol::getClockOffset()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    return (int64_t)ts.tv_sec * 1000000000LL + ts.tv_nsec - SFPacket::getCurrentTime();
+}
@@ -0,0 +1,105 @@
+/*
+ * Copyright (c) 2007, Technische Universitaet Berlin
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without 
+ * modification, are permitted provided that the following conditions 
+ * are met:
+ * - Redistributions of source code must retain the above copyright notice,
+ *   this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright 
+ *   notice, this list of conditions and the following disclaimer in the 
+ *   documentation and/or other materials provided with the distribution.
+ * - Neither the name of the Technische Universitaet Berlin nor the names 
+ *   of its contributors may be used to endorse or promote products derived
+ *   from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS 
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT 
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT 
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, 
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED 
+ * TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, 
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY 
+ * OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT 
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE 
+ * USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+/**
+ * @author Philipp Huppertz <huppertz@tkn.tu-berlin.de>
+ */
+
+
+#ifndef SFPROTOCOL_H
+#define SFPROTOCOL_H
+
+#include "sfpacket.h"
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+/*
+ * The TCP side of the serial forwarder protocol. Both ends send 'U'
+ * and their version byte and speak the lower of the two versions:
+ *
+ *  ' ' (v1): a stream of records [length][payload].
+ *
+ *  '!' (v2): the client sends one byte of options (cTimestamp,
+ *       cGateway) after the handshake. Both directions then carry
+ *       batches [batch length, 2 bytes][record]..., a record being
+ *       [length][flags][timestamp, 8 bytes][gateway, 2 bytes][payload]
+ *       where timestamp and gateway are only present if the flags say
+ *       so. The timestamp is the arrival time of the frame at the sf in
+ *       us since the epoch, the gateway identifies the sf-server (its
+ *       port). All multi-byte fields are little endian. A batch holds
+ *       any number of records, an empty batch is allowed.
+ *
+ * Clients of an older version get v1 and notice nothing.
+ */
+class SFProtocol
+{
+public:
+    static const char cVersion1 = ' ';
+    static const char cVersion2 = '!';
+    /* the version advertised by this sf */
+    static const char cVersion = cVersion2;
+
+    /* v2 options and record flags */
+    static const uint8_t cTimestamp = 0x01;
+    static const uint8_t cGateway = 0x02;
+    static const uint8_t cOptions = cTimestamp | cGateway;
+
+    static const int cBatchHeaderLength = 2;
+    static const int cMaxBatchLength = 0xffff;
+    static const int cMaxRecordHeaderLength = 1 + 1 + 8 + 2;
+
+    /* returns the version spoken with a peer that sent pVersion, 0 if
+       there is none */
+    static char negotiate(char pVersion);
+
+    /* writes the header of the record for pPacket (everything but the
+       payload, which follows it) into pHeader, which must hold
+       cMaxRecordHeaderLength bytes. pClockOffset is getClockOffset().
+       returns the header length */
+    static int encodeRecordHeader(char pVersion, uint8_t pOptions, const SFPacket &pPacket, uint16_t pGateway, int64_t pClockOffset, char *pHeader);
+
+    /* appends the record for pPacket to pOut */
+    static void appendRecord(std::string &pOut, char pVersion, uint8_t pOptions, const SFPacket &pPacket, uint16_t pGateway, int64_t pClockOffset);
+
+    static void encodeBatchHeader(int pLength, char *pHeader);
+
+    /* parses the bytes a client sent: complete records (v1) or batches
+       (v2) are appended to pPackets until pPackets holds pMax packets
+       (a v2 batch is never split, so pMax may be exceeded by one
+       batch). returns the number of bytes used or -1 if the data is
+       malformed */
+    static int decode(char pVersion, const char *pData, int pLength, std::vector<SFPacket> &pPackets, unsigned pMax);
+
+    /* wall clock minus monotonic clock in ns, turns packet timestamps
+       into wall clock time */
+    static int64_t getClockOffset();
+};
+
+#endif
@@ -33,15 +33,20 @@
 #include "sharedinfo.h"
 #include "tcpcomm.h"
 #include "sfpacket.h"
+#include "sfprotocol.h"
 #include "stdio.h"
 
 #include <iostream>
 #include <set>
+#include <vector>
 
 #include <cstring>
 #include <sys/types.h>
 #include <sys/socket.h>
+#include <sys/select.h>
+#include <sys/uio.h>
 #include <netinet/in.h>
+#include <arpa/inet.h>
 #include <netdb.h>
 #include <errno.h>
 #include <fcntl.h>
@@ -56,8 +61,34 @@ void* checkClientsThread(void*);
 void* readClientsThread(void*);
 void* writeClientsThread(void*);
 
+bool TCPComm::parseClientPolicy(const string& pName, clientPolicy_t& pPolicy)
+{
+    if (pName == "drop")
+        pPolicy = CLIENT_DROP;
+    else if (pName == "disconnect")
+        pPolicy = CLIENT_DISCONNECT;
+    else if (pName == "block")
+        pPolicy = CLIENT_BLOCK;
+    else
+        return false;
+    return true;
+}
+
+const char* TCPComm::getClientPolicyName(clientPolicy_t pPolicy)
+{
+    switch (pPolicy)
+    {
+    case CLIENT_DISCONNECT:
+        return "disconnect";
+    case CLIENT_BLOCK:
+        return "block";
+    default:
+        return "drop";
+    }
+}
+
 /* opens tcp server port for listening and start threads*/
-TCPComm::TCPComm(int pPort, PacketBuffer &pReadBuffer, PacketBuffer &pWriteBuffer, sharedControlInfo_t& pControl) : readBuffer(pReadBuffer), writeBuffer(pWriteBuffer), errorReported(false), errorMsg(""), control(pControl)
+TCPComm::TCPComm(int pPort, PacketBuffer &pReadBuffer, PacketBuffer &pWriteBuffer, sharedControlInfo_t& pControl, clientPolicy_t pClientPolicy, unsigned pClientQueueSize) : latencyHistogram(Histogram::cLatencyBounds, Histogram::cLatencyBoundCount), readBuffer(pReadBuffer), writeBuffer(pWriteBuffer), errorReported(false), errorMsg(""), control(pControl)
 {   
     // init values
     writerThreadRunning = false;
@@ -65,8 +96,17 @@ TCPComm::TCPComm(int pPort, PacketBuffer &pReadBuffer, PacketBuffer &pWriteBuffe
     serverThreadRunning = false;
     clientInfo.count = 0;
     clientInfo.FDs.clear();
+    clientInfo.lastId = 0;
     readPacketCount = 0;
     writtenPacketCount = 0;
+    readByteCount = 0;
+    writtenByteCount = 0;
+    clientPolicy = pClientPolicy;
+    clientQueueSize = (pClientQueueSize > 0) ? pClientQueueSize : 1;
+    disconnectedClientCount = 0;
+    latencyCount = 0;
+    latencySum = 0;
+    latencyMax = 0;
     port = pPort;
     
     pthread_mutex_init(&clientInfo.sleeplock, NULL);
@@ -146,6 +186,10 @@ TCPComm::~TCPComm()
     {
         close(*it);
     }
+    for (clientQueues_t::iterator qit = clientInfo.queues.begin(); qit != clientInfo.queues.end(); qit++)
+    {
+        clearQueue(qit->second);
+    }
     close(pipeWriteFD);
     close(pipeReadFD);
     pthread_mutex_destroy(&clientInfo.sleeplock);
@@ -158,33 +202,36 @@ int TCPComm::getPort()
     return port;
 }
 
-/* reads packet */
-bool TCPComm::readPacket(int pFD, SFPacket &pPacket)
+/* reads packets */
+bool TCPComm::readPackets(int pFD, clientInput_t& pInput)
 {
-    char l;
-    char* buffer[SFPacket::getMaxPayloadLength()];
-    int err;
-    
-    if (readFD(pFD, &l, 1, &err) != 1)
+    char buffer[cReadChunk];
+    int n = recv(pFD, buffer, sizeof(buffer), 0);
+    if (n < 0)
     {
-        return false;
+        return (errno == EINTR) || (errno == EAGAIN) || (errno == EWOULDBLOCK);
     }
-    if (l > SFPacket::getMaxPayloadLength())
+    if (n == 0)
     {
         return false;
     }
-    if (readFD(pFD, (char*) buffer, static_cast<int>(l), &err) != l)
+    __atomic_fetch_add(&readByteCount, n, __ATOMIC_RELAXED);
+    pInput.in.append(buffer, n);
+    vector<SFPacket> packets;
+    int used = SFProtocol::decode(pInput.version, pInput.in.data(), pInput.in.size(), packets, (unsigned)-1);
+    if (used < 0)
     {
         return false;
     }
-    if (pPacket.setPayload((char*)buffer ,l))
-    {
-        return true;
-    }
-    else
+    pInput.in.erase(0, used);
+    for (unsigned i = 0; i < packets.size(); i++)
     {
-        return false;
+        // this call blocks until buffer is not full
+        readBuffer.enqueueBack(packets[i]);
+        __atomic_fetch_add(&readPacketCount, 1, __ATOMIC_RELAXED);
     }
+    // a v2 batch is at most cMaxBatchLength bytes long
+    return pInput.in.size() <= (unsigned)SFProtocol::cMaxBatchLength + SFProtocol::cBatchHeaderLength;
 }
 
 int TCPComm::writeFD(int fd, const char *buffer, int count, int *err)
@@ -208,23 +255,14 @@ int TCPComm::writeFD(int fd, const char *buffer, int count, int *err)
     return actual;
 }
 
-/* writes packet */
-bool TCPComm::writePacket(int pFD, SFPacket &pPacket)
-{
-    int len = pPacket.getTcpLength();
-    int err;
-    return (writeFD(pFD, pPacket.getTcpPayload(), len, &err) == len);
-}
-
 /* checks for correct version of SF protocol */
-bool TCPComm::versionCheck(int clientFD)
+bool TCPComm::versionCheck(int clientFD, char& pVersion, uint8_t& pOptions)
 {
     char check[2], us[2];
-    int version;
     int err = 0;
     /* Indicate version and check if a TinyOS 2.0 serial forwarder on the other end */
     us[0] = 'U';
-    us[1] = ' ';
+    us[1] = SFProtocol::cVersion;
     
     if (writeFD(clientFD, us, 2, &err) != 2)
     {
@@ -239,15 +277,17 @@ bool TCPComm::versionCheck(int clientFD)
         return false;
     }
 
-    version = check[1];
-    if (us[1] < version)
-    {
-        version = us[1];
-    }
-    /* Add other cases here for later protocol versions */
-    switch (version)
+    pVersion = SFProtocol::negotiate(check[1]);
+    pOptions = 0;
+    switch (pVersion)
     {
-    case ' ':
+    case SFProtocol::cVersion1:
+        break;
+    case SFProtocol::cVersion2:
+        if (readFD(clientFD, (char*)&pOptions, 1, &err) != 1)
+        {
+            return false;
+        }
         break;
     default:
         return false;
@@ -257,7 +297,7 @@ bool TCPComm::versionCheck(int clientFD)
 }
 
 /* adds a client to the client list and wakes up all threads */
-void TCPComm::addClient(int clientFD)
+void TCPComm::addClient(int clientFD, const string& peer, char version, uint8_t options)
 {
     DEBUG("TCPComm::addClient : lock")
     pthread_testcancel();
@@ -269,6 +309,19 @@ void TCPComm::addClient(int clientFD)
     }
     ++clientInfo.count;
     clientInfo.FDs.insert(clientFD);
+    clientQueue_t& client = clientInfo.queues[clientFD];
+    client.peer = peer;
+    client.id = ++clientInfo.lastId;
+    client.version = version;
+    client.options = options;
+    client.inFlight = 0;
+    client.iovCount = 0;
+    client.iovNext = 0;
+    client.peak = 0;
+    client.written = 0;
+    client.writtenBytes = 0;
+    client.dropped = 0;
+    client.blocked = 0;
     if (wakeupClientThreads)
     {
         pthread_cond_broadcast( &clientInfo.wakeup );
@@ -283,9 +336,15 @@ void TCPComm::removeClient(int clientFD)
     DEBUG("TCPComm::removeClient : lock")
     pthread_testcancel();
     pthread_mutex_lock( &clientInfo.countlock );
-    if (clientInfo.count > 0)
+    // reader and writer may both find a client broken, remove it once
+    if ((clientInfo.count > 0) && (clientInfo.FDs.erase(clientFD) > 0))
     {
-        clientInfo.FDs.erase(clientFD);
+        clientQueues_t::iterator qit = clientInfo.queues.find(clientFD);
+        if (qit != clientInfo.queues.end())
+        {
+            clearQueue(qit->second);
+            clientInfo.queues.erase(qit);
+        }
         if (close(clientFD) != 0)
         {
             DEBUG("TCPComm::removeClient : error closing fd " << clientFD)
@@ -317,13 +376,19 @@ void TCPComm::connectClients()
 {
     while (true)
     {
-        int clientFD = accept(serverFD, NULL, NULL);
+        struct sockaddr_in client;
+        socklen_t clientAddrLen = sizeof(client);
+        int clientFD = accept(serverFD, (struct sockaddr*) &client, &clientAddrLen);
 	pthread_testcancel();
         if (clientFD >= 0)
         {
-            if (versionCheck(clientFD))
+            char version;
+            uint8_t options;
+            if (versionCheck(clientFD, version, options))
             {
-                addClient(clientFD);
+                ostringstream peer;
+                peer << inet_ntoa(client.sin_addr) << ":" << ntohs(client.sin_port);
+                addClient(clientFD, peer.str(), version, options);
             }
             else
             {
@@ -349,6 +414,7 @@ void* readClientsThread(void* ob)
 void TCPComm::readClients()
 {
     FD_t clientFDs;
+    clientInputs_t inputs;
     while (true)
     {
         pthread_cleanup_push((void(*)(void*)) pthread_mutex_unlock, (void *) &clientInfo.countlock);
@@ -361,6 +427,28 @@ void TCPComm::readClients()
         }
         // copy set in to temp set
         clientFDs = clientInfo.FDs;
+        // forget the input of clients that are gone
+        for (clientInputs_t::iterator iit = inputs.begin(); iit != inputs.end(); )
+        {
+            clientQueues_t::iterator qit = clientInfo.queues.find(iit->first);
+            if ((qit == clientInfo.queues.end()) || (qit->second.id != iit->second.id))
+            {
+                inputs.erase(iit++);
+            }
+            else
+            {
+                iit++;
+            }
+        }
+        for (clientQueues_t::iterator qit = clientInfo.queues.begin(); qit != clientInfo.queues.end(); qit++)
+        {
+            if (inputs.find(qit->first) == inputs.end())
+            {
+                clientInput_t& input = inputs[qit->first];
+                input.id = qit->second.id;
+                input.version = qit->second.version;
+            }
+        }
         // removes the cleanup handler and executes it (unlock mutex)
         pthread_cleanup_pop(1);
         // check all fds (work with temp set)...
@@ -391,13 +479,7 @@ void TCPComm::readClients()
             {
                 if (FD_ISSET(*it, &rfds))
                 {
-                    SFPacket packet;
-                    if(readPacket(*it, packet)) {
-                        // this call blocks until buffer is not full
-                        readBuffer.enqueueBack(packet);
-                        ++readPacketCount;
-                    }
-                    else {
+                    if(!readPackets(*it, inputs[*it])) {
                         DEBUG("TCPComm::readClients : removeClient")
                         removeClient(*it);
                     }
@@ -417,7 +499,7 @@ void* writeClientsThread(void* ob)
 /* writes to connected clients */
 void TCPComm::writeClients()
 {
-    FD_t clientFDs;
+    SFPacket packets[cWriteBatchSize];
     while (true)
     {
         pthread_cleanup_push((void(*)(void*)) pthread_mutex_unlock, (void *) &clientInfo.countlock);
@@ -431,30 +513,267 @@ void TCPComm::writeClients()
         // removes the cleanup handler and executes it (unlock mutex)
         pthread_cleanup_pop(1); 
 
-        // blocks until buffer is not empty
-        SFPacket packet = writeBuffer.dequeue();
         pthread_testcancel();
         pthread_mutex_lock( &clientInfo.countlock );
-        // copy client fd set into temp set
-        clientFDs = clientInfo.FDs;
+        // a client at its high-water mark with the block policy holds
+        // back new packets, the others keep draining their queues
+        bool stalled = false;
+        if (clientPolicy == CLIENT_BLOCK)
+        {
+            clientQueues_t::iterator it;
+            for (it = clientInfo.queues.begin(); (it != clientInfo.queues.end()) && !stalled; it++)
+            {
+                stalled = (it->second.queue.size() >= clientQueueSize);
+            }
+        }
         pthread_mutex_unlock( &clientInfo.countlock );
 
-        // check all fds (work with temp set)...
-        set<int>::iterator it;
-        // duplicate and send out packet to all connected clients
-        for( it = clientFDs.begin(); it != clientFDs.end(); it++ )
+        // takes what has piled up, never blocks
+        unsigned count = stalled ? 0 : writeBuffer.tryDequeue(packets, cWriteBatchSize);
+
+        fd_set rfds;
+        fd_set wfds;
+        FD_ZERO(&rfds);
+        FD_ZERO(&wfds);
+        int maxFD = -1;
+        FD_t failed;
+        pthread_mutex_lock( &clientInfo.countlock );
+        if (count > 0)
+        {
+            failed = queuePackets(packets, count);
+        }
+        for (clientQueues_t::iterator it = clientInfo.queues.begin(); it != clientInfo.queues.end(); it++)
         {
-            if (writePacket(*it, packet))
+            bool wouldBlock = false;
+            if (failed.count(it->first) || it->second.queue.empty())
             {
-                ++writtenPacketCount;
+                continue;
             }
-            else
+            if (!flushClient(it->first, it->second, wouldBlock))
+            {
+                failed.insert(it->first);
+            }
+            else if (wouldBlock)
+            {
+                FD_SET(it->first, &wfds);
+                maxFD = (it->first > maxFD) ? it->first : maxFD;
+            }
+        }
+        pthread_mutex_unlock( &clientInfo.countlock );
+
+        for (FD_t::iterator it = failed.begin(); it != failed.end(); it++)
+        {
+            DEBUG("TCPComm::writeClients : removeClient")
+            removeClient(*it);
+        }
+        if ((count > 0) || !failed.empty())
+        {
+            // look for more work before going to sleep
+            continue;
+        }
+
+        // sleep until new packets arrive or a full socket drains
+        bool armed = !stalled && writeBuffer.armWakeup();
+        if (!stalled && !armed)
+        {
+            // packets arrived meanwhile
+            continue;
+        }
+        int wakeupFD = writeBuffer.getWakeupFD();
+        struct timeval poll;
+        struct timeval* timeout = NULL;
+        if (armed && (wakeupFD >= 0))
+        {
+            FD_SET(wakeupFD, &rfds);
+            maxFD = (wakeupFD > maxFD) ? wakeupFD : maxFD;
+        }
+        else if (armed || (maxFD < 0))
+        {
+            // no wakeup channel (or the blocking client drained meanwhile)
+            poll.tv_sec = 0;
+            poll.tv_usec = 1000;
+            timeout = &poll;
+        }
+        // select is a cancellation point. a client fd closed by the reader
+        // thread meanwhile just makes it return early
+        int ready = select(maxFD + 1, &rfds, &wfds, NULL, timeout);
+        if (armed)
+        {
+            writeBuffer.disarmWakeup((wakeupFD >= 0) && (ready > 0) && FD_ISSET(wakeupFD, &rfds));
+        }
+    }
+}
+
+/* queues packets for all clients. countlock must be held */
+TCPComm::FD_t TCPComm::queuePackets(SFPacket* packets, unsigned count)
+{
+    FD_t failed;
+    for (unsigned i = 0; i < count; i++)
+    {
+        sharedPacket_t* shared = new sharedPacket_t;
+        shared->packet = packets[i];
+        // our own reference, dropped below
+        shared->refs = 1;
+        for (clientQueues_t::iterator it = clientInfo.queues.begin(); it != clientInfo.queues.end(); it++)
+        {
+            clientQueue_t& client = it->second;
+            if (failed.count(it->first))
+            {
+                continue;
+            }
+            if (client.queue.size() >= clientQueueSize)
+            {
+                if (clientPolicy == CLIENT_DROP)
+                {
+                    ++client.dropped;
+                    continue;
+                }
+                else if (clientPolicy == CLIENT_DISCONNECT)
+                {
+                    __atomic_fetch_add(&disconnectedClientCount, 1, __ATOMIC_RELAXED);
+                    failed.insert(it->first);
+                    continue;
+                }
+                // CLIENT_BLOCK: may overshoot by one batch
+            }
+            ++shared->refs;
+            client.queue.push_back(shared);
+            if (client.queue.size() > client.peak)
+            {
+                client.peak = client.queue.size();
+            }
+            if ((clientPolicy == CLIENT_BLOCK) && (client.queue.size() == clientQueueSize))
+            {
+                // the writer stalls from now on until this client caught up
+                ++client.blocked;
+            }
+        }
+        releasePacket(shared);
+    }
+    return failed;
+}
+
+/* writes as much as the socket takes. countlock must be held */
+bool TCPComm::flushClient(int clientFD, clientQueue_t& client, bool& wouldBlock)
+{
+    while (!client.queue.empty())
+    {
+        if (client.inFlight == 0)
+        {
+            prepareBatch(client);
+        }
+        struct msghdr msg;
+        memset(&msg, 0, sizeof(msg));
+        msg.msg_iov = client.iov + client.iovNext;
+        msg.msg_iovlen = client.iovCount - client.iovNext;
+#ifdef __APPLE__
+        int sent = sendmsg(clientFD, &msg, MSG_DONTWAIT);
+#else
+        int sent = sendmsg(clientFD, &msg, MSG_DONTWAIT | MSG_NOSIGNAL);
+#endif
+        if (sent < 0)
+        {
+            if ((errno == EAGAIN) || (errno == EWOULDBLOCK))
+            {
+                wouldBlock = true;
+                return true;
+            }
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            return false;
+        }
+        client.writtenBytes += sent;
+        __atomic_fetch_add(&writtenByteCount, sent, __ATOMIC_RELAXED);
+        while ((sent > 0) && (client.iovNext < client.iovCount))
+        {
+            struct iovec& iov = client.iov[client.iovNext];
+            if ((size_t)sent < iov.iov_len)
             {
-                DEBUG("TCPComm::writeClients : removeClient")
-                removeClient(*it);
+                iov.iov_base = (char*)iov.iov_base + sent;
+                iov.iov_len -= sent;
+                break;
             }
+            sent -= iov.iov_len;
+            ++client.iovNext;
         }
+        if (client.iovNext < client.iovCount)
+        {
+            continue;
+        }
+        // the whole batch is out
+        int64_t now = SFPacket::getCurrentTime();
+        for (; client.inFlight > 0; --client.inFlight)
+        {
+            sharedPacket_t* front = client.queue.front();
+            if (front->packet.getTimestamp() != 0)
+            {
+                int64_t latency = now - front->packet.getTimestamp();
+                ++latencyCount;
+                latencySum += latency;
+                latencyMax = (latency > latencyMax) ? latency : latencyMax;
+                latencyHistogram.observe(latency);
+            }
+            client.queue.pop_front();
+            releasePacket(front);
+            ++client.written;
+            __atomic_fetch_add(&writtenPacketCount, 1, __ATOMIC_RELAXED);
+        }
+    }
+    return true;
+}
+
+/* frames the head of the client's queue. countlock must be held */
+void TCPComm::prepareBatch(clientQueue_t& client)
+{
+    int64_t clockOffset = (client.options & SFProtocol::cTimestamp) ? SFProtocol::getClockOffset() : 0;
+    char* header = client.headers;
+    int length = 0;
+    client.iovCount = 0;
+    client.iovNext = 0;
+    if (client.version == SFProtocol::cVersion2)
+    {
+        // the batch header is filled in below
+        client.iov[client.iovCount].iov_base = header;
+        client.iov[client.iovCount++].iov_len = SFProtocol::cBatchHeaderLength;
+        header += SFProtocol::cBatchHeaderLength;
+    }
+    for (client.inFlight = 0; (client.inFlight < cWriteBatchSize) && (client.inFlight < client.queue.size()); client.inFlight++)
+    {
+        SFPacket& packet = client.queue[client.inFlight]->packet;
+        int headerLength = SFProtocol::encodeRecordHeader(client.version, client.options, packet, port, clockOffset, header);
+        client.iov[client.iovCount].iov_base = header;
+        client.iov[client.iovCount++].iov_len = headerLength;
+        client.iov[client.iovCount].iov_base = (void*)packet.getPayload();
+        client.iov[client.iovCount++].iov_len = packet.getLength();
+        header += headerLength;
+        length += headerLength + packet.getLength();
+    }
+    if (client.version == SFProtocol::cVersion2)
+    {
+        SFProtocol::encodeBatchHeader(length, client.headers);
+    }
+}
+
+void TCPComm::releasePacket(sharedPacket_t* packet)
+{
+    if (--packet->refs == 0)
+    {
+        delete packet;
+    }
+}
+
+void TCPComm::clearQueue(clientQueue_t& client)
+{
+    while (!client.queue.empty())
+    {
+        releasePacket(client.queue.front());
+        client.queue.pop_front();
     }
+    client.inFlight = 0;
+    client.iovCount = 0;
+    client.iovNext = 0;
 }
 
 /* cancels all running threads */
@@ -574,10 +893,54 @@ int TCPComm::reportError(const char *msg, int result)
 /* prints out status */
 void TCPComm::reportStatus(ostream& os)
 {
+    pthread_mutex_lock( &clientInfo.countlock );
     os << "SF-Server ( TCPComm on port " << port << " )"
     << " : clients = " << clientInfo.count
-    << " , packets read = " << readPacketCount
-    << " , packets written = " << writtenPacketCount << endl;
+    << " , packets read = " << __atomic_load_n(&readPacketCount, __ATOMIC_RELAXED)
+    << " , packets written = " << __atomic_load_n(&writtenPacketCount, __ATOMIC_RELAXED)
+    << " , client queue = " << clientQueueSize
+    << " ( " << getClientPolicyName(clientPolicy) << " )"
+    << " , disconnected = " << __atomic_load_n(&disconnectedClientCount, __ATOMIC_RELAXED);
+    if (latencyCount > 0)
+    {
+        os << " , serial -> tcp latency = " << (latencySum / latencyCount / 1000)
+        << " us ( max = " << (latencyMax / 1000) << " us )";
+    }
+    os << endl;
+    for (clientQueues_t::iterator it = clientInfo.queues.begin(); it != clientInfo.queues.end(); it++)
+    {
+        const clientQueue_t& client = it->second;
+        os << ">>   client " << client.peer
+        << " : queued = " << client.queue.size()
+        << " ( peak = " << client.peak << " )"
+        << " , written = " << client.written
+        << " , dropped = " << client.dropped
+        << " , blocked = " << client.blocked << endl;
+    }
+    pthread_mutex_unlock( &clientInfo.countlock );
+}
+
+void TCPComm::reportMetrics(Metrics& pMetrics, const string& pLabels)
+{
+    pthread_mutex_lock( &clientInfo.countlock );
+    pMetrics.gauge("sf_tcp_clients", "Connected TCP clients.", pLabels, clientInfo.count);
+    pMetrics.counter("sf_tcp_packets_received_total", "Packets received from TCP clients.", pLabels, __atomic_load_n(&readPacketCount, __ATOMIC_RELAXED));
+    pMetrics.counter("sf_tcp_bytes_received_total", "Bytes received from TCP clients.", pLabels, __atomic_load_n(&readByteCount, __ATOMIC_RELAXED));
+    pMetrics.counter("sf_tcp_packets_sent_total", "Packets sent to TCP clients (once per client).", pLabels, __atomic_load_n(&writtenPacketCount, __ATOMIC_RELAXED));
+    pMetrics.counter("sf_tcp_bytes_sent_total", "Bytes sent to TCP clients.", pLabels, __atomic_load_n(&writtenByteCount, __ATOMIC_RELAXED));
+    pMetrics.counter("sf_tcp_clients_disconnected_total", "Clients disconnected for not keeping up.", pLabels, __atomic_load_n(&disconnectedClientCount, __ATOMIC_RELAXED));
+    pMetrics.histogram("sf_serial_to_tcp_latency_seconds", "Time from the arrival of a frame on the serial line until it was sent to a client.", pLabels, latencyHistogram, 1e-9);
+    for (clientQueues_t::iterator it = clientInfo.queues.begin(); it != clientInfo.queues.end(); it++)
+    {
+        const clientQueue_t& client = it->second;
+        string labels = pLabels + "," + Metrics::label("client", client.peer);
+        pMetrics.gauge("sf_client_queued_packets", "Packets queued for a client.", labels, client.queue.size());
+        pMetrics.counter("sf_client_packets_sent_total", "Packets sent to a client.", labels, client.written);
+        pMetrics.counter("sf_client_bytes_sent_total", "Bytes sent to a client.", labels, client.writtenBytes);
+        pMetrics.counter("sf_client_packets_dropped_total", "Packets a client missed because its queue was full.", labels, client.dropped);
+        pMetrics.counter("sf_client_blocked_total", "Times a client stalled the others (block policy).", labels, client.blocked);
+    }
+    pthread_mutex_unlock( &clientInfo.countlock );
 }
 
 void TCPComm::stuffPipe() 
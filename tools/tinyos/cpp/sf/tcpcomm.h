@@ -35,12 +35,17 @@
 #define TCPCOMM_H
 
 #include "sfpacket.h"
+#include "sfprotocol.h"
+#include "sfmetrics.h"
 #include "packetbuffer.h"
 #include "basecomm.h"
 #include "sharedinfo.h"
 
 #include <pthread.h>
+#include <sys/uio.h>
 #include <set>
+#include <map>
+#include <deque>
 #include <string>
 #include <sstream>
 
@@ -56,6 +61,26 @@
 
 class TCPComm : public BaseComm
 {
+public:
+    /* what happens to a client whose output queue reached its high-water mark */
+    typedef enum
+    {
+        /* the client misses packets until it caught up */
+        CLIENT_DROP,
+        /* the client is disconnected */
+        CLIENT_DISCONNECT,
+        /* no new packets are taken from the buffer until the client caught
+           up; the other clients are still served from their queues */
+        CLIENT_BLOCK
+    } clientPolicy_t;
+
+    /* default high-water mark of a client output queue in packets */
+    static const unsigned cDefaultClientQueueSize = 128;
+
+    /* parses "drop", "disconnect" or "block", returns false if unknown */
+    static bool parseClientPolicy(const std::string& pName, clientPolicy_t& pPolicy);
+
+    static const char* getClientPolicyName(clientPolicy_t pPolicy);
 
     /** Member vars */
 protected:
@@ -76,6 +101,49 @@ protected:
 
     typedef std::set<int> FD_t;
 
+    /* max. packets the writer thread takes from the buffer at once, and
+       max. packets written to one client with one sendmsg() (one batch
+       for protocol v2 clients) */
+    static const unsigned cWriteBatchSize = 16;
+
+    /* a packet queued for several clients: the clients share one copy.
+       refs is only changed with clientInfo.countlock held. */
+    typedef struct
+    {
+        SFPacket packet;
+        int refs;
+    } sharedPacket_t;
+
+    /* output queue and counters of one client */
+    typedef struct
+    {
+        /* peer address, for reportStatus */
+        std::string peer;
+        /* tells a reused fd from the client that had it before */
+        unsigned long id;
+        /* negotiated protocol version and v2 options */
+        char version;
+        uint8_t options;
+        std::deque<sharedPacket_t*> queue;
+        /* the first inFlight packets of queue are being sent: iov[iovNext]
+           up to iov[iovCount - 1] is what is left of them. the record
+           headers live in headers */
+        unsigned inFlight;
+        struct iovec iov[2 * cWriteBatchSize + 1];
+        int iovCount;
+        int iovNext;
+        char headers[SFProtocol::cBatchHeaderLength + cWriteBatchSize * SFProtocol::cMaxRecordHeaderLength];
+        /* largest queue length seen */
+        unsigned peak;
+        unsigned long written;
+        uint64_t writtenBytes;
+        unsigned long dropped;
+        /* times the client stalled the writer (CLIENT_BLOCK) */
+        unsigned long blocked;
+    } clientQueue_t;
+
+    typedef std::map<int, clientQueue_t> clientQueues_t;
+
     // thread safe shared info about connected clients
     typedef struct
     {
@@ -89,8 +157,26 @@ protected:
         int count;
         /* container for client stuff */
         FD_t FDs;
+        /* output queues, only touched with countlock held */
+        clientQueues_t queues;
+        /* id of the last client added */
+        unsigned long lastId;
     } sharedClientInfo_t;
 
+    /* bytes read from a client but not yet parsed. only touched by the
+       reader thread */
+    typedef struct
+    {
+        unsigned long id;
+        char version;
+        std::string in;
+    } clientInput_t;
+
+    typedef std::map<int, clientInput_t> clientInputs_t;
+
+    /* bytes read from a client socket in one go */
+    static const int cReadChunk = 4096;
+
     /* information about clients */
     sharedClientInfo_t clientInfo;
 
@@ -100,6 +186,24 @@ protected:
     /* number of written packets */
     int writtenPacketCount;
 
+    /* bytes received from / sent to all clients, updated atomically */
+    uint64_t readByteCount;
+    uint64_t writtenByteCount;
+
+    /* slow-consumer handling */
+    clientPolicy_t clientPolicy;
+    unsigned clientQueueSize;
+
+    /* clients disconnected by CLIENT_DISCONNECT */
+    int disconnectedClientCount;
+
+    /* time from the arrival of a serial frame until it was written to a
+       client, in ns. protected by countlock */
+    unsigned long latencyCount;
+    int64_t latencySum;
+    int64_t latencyMax;
+    Histogram latencyHistogram;
+
     /* port of this sf */
     int port;
 
@@ -140,17 +244,16 @@ protected:
     /* performs blocking write on fd */
     virtual int writeFD(int fd, const char *buffer, int count, int *err);
 
-    /* checks SF client protocol version */
-    bool versionCheck(int clientFD);
+    /* checks SF client protocol version, returns the negotiated version
+       and the options of a v2 client */
+    bool versionCheck(int clientFD, char& pVersion, uint8_t& pOptions);
 
-    /* reads packet */
-    bool readPacket(int pFD, SFPacket &pPacket);
-
-    /* writes packet */
-    bool writePacket(int pFD, SFPacket &pPacket);
+    /* reads what is available from a client and queues the complete
+       packets. returns false if the client is gone or sent garbage */
+    bool readPackets(int pFD, clientInput_t& pInput);
 
     /* adds client to the list */
-    void addClient(int clientFD);
+    void addClient(int clientFD, const std::string& peer, char version, uint8_t options);
 
     /* removes client from the list */
     void removeClient(int clientFD);
@@ -164,6 +267,24 @@ protected:
     /* write messages to clients (duplicate) - consumer thread */
     void writeClients();
 
+    /* queues packets for all clients, returns clients to disconnect.
+       countlock must be held */
+    FD_t queuePackets(SFPacket* packets, unsigned count);
+
+    /* sends as much of the client's queue as the socket takes without
+       blocking. returns false on error. countlock must be held */
+    bool flushClient(int clientFD, clientQueue_t& client, bool& wouldBlock);
+
+    /* points the client's iov at the next packets of its queue, framed
+       for its protocol version. countlock must be held */
+    void prepareBatch(clientQueue_t& client);
+
+    /* drops a reference, frees the packet with the last one */
+    static void releasePacket(sharedPacket_t* packet);
+
+    /* frees the queue of a client. countlock must be held */
+    static void clearQueue(clientQueue_t& client);
+
     /* reports error to stderr */
     int reportError(const char *msg, int result);
 
@@ -175,7 +296,7 @@ protected:
 
 public:
     /* create SF TCP server - init and start threads */
-    TCPComm(int pPort, PacketBuffer &pReadBuffer, PacketBuffer &pWriteBuffer, sharedControlInfo_t& pControl);
+    TCPComm(int pPort, PacketBuffer &pReadBuffer, PacketBuffer &pWriteBuffer, sharedControlInfo_t& pControl, clientPolicy_t pClientPolicy = CLIENT_DROP, unsigned pClientQueueSize = cDefaultClientQueueSize);
 
     /* wait for threads, close fds and cleanup */
     ~TCPComm();
@@ -189,6 +310,9 @@ public:
     /* reports status info to stdout */
     void reportStatus(std::ostream& os);
 
+    /* adds the TCP side and per client metrics labeled pLabels */
+    void reportMetrics(Metrics& pMetrics, const std::string& pLabels);
+
     /* returns if error occurred */
     bool isErrorReported() { return errorReported; }
 };
@@ -26,6 +26,8 @@
 
 enum {
   N_RECONSTRUCTIONS = 3,        /* number of concurrent reconstructions */
+  RECONSTRUCTION_HEAP = 1300,   /* ip_malloc bytes partial packets may hold:
+                                   a full 1280-byte packet and its bitmap */
   N_CONCURRENT_SENDS = 3,       /* number of concurrent sends */
   N_FRAGMENTS = 12,             /* number of link-layer fragments to buffer */
 };
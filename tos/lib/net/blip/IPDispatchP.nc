@@ -126,7 +126,7 @@ int lowpan_extern_match_context(struct in6_addr *addr, uint8_t *ctx_id) {
   //
   //
 
-  table_t recon_cache;
+  struct lowpan_recon_table recon_table;
 
   // table of packets we are currently receiving fragments from, that
   // are destined to us
@@ -136,13 +136,6 @@ int lowpan_extern_match_context(struct in6_addr *addr, uint8_t *ctx_id) {
   //
   ////////////////////////////////////////
 
-  void reconstruct_clear(void *ent) {
-    struct lowpan_reconstruct *recon = (struct lowpan_reconstruct *)ent;
-    memclr((uint8_t *)&recon->r_meta, sizeof(struct ip6_metadata));
-    recon->r_timeout = T_UNUSED;
-    recon->r_buf = NULL;
-  }
-
   struct send_info *getSendInfo() {
     struct send_info *ret = call SendInfoPool.get();
     if (ret == NULL) return ret;
@@ -206,8 +199,8 @@ void SENDINFO_DECR(struct send_info *si) {
     call BlipStatistics.clear();
 
     /* set up our reconstruction cache */
-    table_init(&recon_cache, recon_data, sizeof(struct lowpan_reconstruct), N_RECONSTRUCTIONS);
-    table_map(&recon_cache, reconstruct_clear);
+    lowpan_recon_init(&recon_table, recon_data, N_RECONSTRUCTIONS,
+                      RECONSTRUCTION_HEAP);
 
     return SUCCESS;
   }
@@ -224,26 +217,20 @@ void SENDINFO_DECR(struct send_info *si) {
     /* the payload length field is always compressed, have to put it back here */
     iph->ip6_plen = htons(recon->r_bytes_rcvd - sizeof(struct ip6_hdr));
     signal IPLower.recv(iph, (void *)(iph + 1), &recon->r_meta);
-
-    // printf("ip_free(%p)\n", recon->r_buf);
-    ip_free(recon->r_buf);
-    recon->r_timeout = T_UNUSED;
-    recon->r_buf = NULL;
   }
 
   /*
    * Bulletproof recovery logic is very important to make sure we
    * don't get wedged with no free buffers.
    *
-   * The table is managed as follows:
-   *  - unused entries are marked T_UNUSED
-   *  - entries which
-   *     o have a buffer allocated
-   *     o have had a fragment reception before we fired
-   *     are marked T_ACTIVE
+   * The table is managed by lowpan_recon_input and lowpan_recon_age:
+   *  - entries which have had a fragment reception since the last
+   *     timer period are marked T_ACTIVE
    *  - entries which have not had a fragment reception during the last timer period
    *     and were active are marked T_ZOMBIE
    *  - zombie receptions are deleted: their buffer is freed and table entry marked unused.
+   *     Zombies are also deleted early when a new packet needs their
+   *     slot or heap space.
    *  - when a fragment is dropped, it is entered into the table as T_FAILED1.
    *     no buffer is allocated
    *  - when the timer fires, T_FAILED1 entries are aged to T_FAILED2.
@@ -253,30 +240,6 @@ void SENDINFO_DECR(struct send_info *si) {
    *     have already dropped fragments from.
    *
    */
-  void reconstruct_age(void *elt) {
-    struct lowpan_reconstruct *recon = (struct lowpan_reconstruct *)elt;
-    if (recon->r_timeout != T_UNUSED)
-      printf("recon src: 0x%x tag: 0x%x buf: %p recvd: %i/%i\n",
-                 recon->r_source_key, recon->r_tag, recon->r_buf,
-                 recon->r_bytes_rcvd, recon->r_size);
-    switch (recon->r_timeout) {
-    case T_ACTIVE:
-      recon->r_timeout = T_ZOMBIE; break; // age existing receptions
-    case T_FAILED1:
-      recon->r_timeout = T_FAILED2; break; // age existing receptions
-    case T_ZOMBIE:
-    case T_FAILED2:
-      // deallocate the space for reconstruction
-      printf("timing out buffer: src: %i tag: %i\n", recon->r_source_key, recon->r_tag);
-      if (recon->r_buf != NULL) {
-        printf("ip_free(%p)\n", recon->r_buf);
-        ip_free(recon->r_buf);
-      }
-      recon->r_timeout = T_UNUSED;
-      recon->r_buf = NULL;
-      break;
-    }
-  }
 
   void ip_print_heap() {
 #ifdef PRINTFUART_ENABLED
@@ -290,7 +253,7 @@ void SENDINFO_DECR(struct send_info *si) {
   }
 
   event void ExpireTimer.fired() {
-    table_map(&recon_cache, reconstruct_age);
+    lowpan_recon_age(&recon_table);
 
     //printf("Frag pool size: %i\n", call FragPool.size());
     //printf("SendInfo pool size: %i\n", call SendInfoPool.size());
@@ -300,39 +263,6 @@ void SENDINFO_DECR(struct send_info *si) {
     //printfflush();
   }
 
-  /*
-   * Return a structure for recording information about incoming fragments.
-   */
-
-  struct lowpan_reconstruct *get_reconstruct(uint16_t key, uint16_t tag) {
-    struct lowpan_reconstruct *ret = NULL;
-    int i;
-
-    for (i = 0; i < N_RECONSTRUCTIONS; i++) {
-      struct lowpan_reconstruct *recon = (struct lowpan_reconstruct *)&recon_data[i];
-
-      if (recon->r_tag == tag &&
-          recon->r_source_key == key) {
-
-        if (recon->r_timeout > T_UNUSED) {
-          recon->r_timeout = T_ACTIVE;
-          ret = recon;
-          goto done;
-
-        } else if (recon->r_timeout < T_UNUSED) {
-          // if we have already tried and failed to get a buffer, we
-          // need to drop remaining fragments.
-          ret = NULL;
-          goto done;
-        }
-      }
-      if (recon->r_timeout == T_UNUSED)
-        ret = recon;
-    }
-  done:
-    return ret;
-  }
-
 #if defined(PLATFORM_MICAZ) || defined(PLATFORM_IRIS) || defined(PLATFORM_UCMINI) || defined(PLATFORM_STORM)
   event message_t *BareReceive.receive(message_t *msg) {
     uint8_t len = call BarePacket.payloadLength(msg);
@@ -384,46 +314,23 @@ void SENDINFO_DECR(struct send_info *si) {
       // start reassembly
       int rv;
       struct lowpan_reconstruct *recon;
-      uint16_t tag, source_key;
 
-      source_key = ieee154_hashaddr(&frame_address.ieee_src);
-      getFragDgramTag(&lowmsg, &tag);
-      recon = get_reconstruct(source_key, tag);
-      if (!recon) {
+      rv = lowpan_recon_input(&recon_table, &frame_address, buf, buflen,
+                              &recon);
+      if (rv < 0) {
         goto fail;
       }
 
       /* fill in metadata: on fragmented packets, it applies to the
-         first fragment only  */
+         last fragment received */
       memcpy(&recon->r_meta.sender, &frame_address.ieee_src,
              sizeof(ieee154_addr_t));
       recon->r_meta.lqi = call ReadLqi.readLqi(msg);
       recon->r_meta.rssi = call ReadLqi.readRssi(msg);
 
-      if (hasFrag1Header(&lowmsg)) {
-        // Fail if the buffer is already allocated. In that case we have already
-        // received the Frag1 header.
-        if (recon->r_buf != NULL) goto fail;
-        rv = lowpan_recon_start(&frame_address, recon, buf, buflen);
-      } else {
-        // Fail if we try to reconstruct a packet without receiving the Frag1
-        // header first.
-        if (recon->r_buf == NULL) goto fail;
-        rv = lowpan_recon_add(recon, buf, buflen);
-      }
-
-      if (rv < 0) {
-        recon->r_timeout = T_FAILED1;
-        goto fail;
-      } else {
-        // printf("start recon buf: %p\n", recon->r_buf);
-        recon->r_timeout = T_ACTIVE;
-        recon->r_source_key = source_key;
-        recon->r_tag = tag;
-      }
-      if (recon->r_size == recon->r_bytes_rcvd) {
-
+      if (rv > 0) {
         deliver(recon);
+        lowpan_recon_release(&recon_table, recon);
       }
 
     } else {
@@ -443,12 +350,9 @@ void SENDINFO_DECR(struct send_info *si) {
       }
 
       if (recon.r_size == recon.r_bytes_rcvd) {
-
         deliver(&recon);
-      } else {
-        // printf("ip_free(%p)\n", recon.r_buf);
-        ip_free(recon.r_buf);
       }
+      ip_free(recon.r_buf);
     }
     goto done;
   fail:
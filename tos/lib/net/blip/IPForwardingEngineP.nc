@@ -12,6 +12,7 @@
 
 #include <iprouting.h>
 #include <lib6lowpan/ip.h>
+#include <lib6lowpan/route_trie.h>
 
 #include "blip_printf.h"
 
@@ -36,21 +37,30 @@ module IPForwardingEngineP {
   }
 } implementation {
 
-#define min(X,Y) (((X) < (Y)) ? (X) : (Y))
+#define max(X,Y) (((X) > (Y)) ? (X) : (Y))
+
+#include <lib6lowpan/route_trie.c>
 
   /* simple routing table for now */
   /* we can optimize memory consumption later since most of these
      address will have known prefixes -- either LL or the shared
      global prefix. */
-  /* the routing table is sorted by prefix length, so that the entries
-     with the longest prefix are at the top. */
-  /* if a route to the given prefix already exists, this updates it. */
+  /* entries stay where they are allocated; the trie indexes them by
+     prefix for longest-prefix match, and caches the routes to the
+     most recent destinations. */
   struct route_entry routing_table[ROUTE_TABLE_SZ];
+  struct route_trie route_index;
+  struct route_trie_node route_nodes[2 * ROUTE_TABLE_SZ];
+  struct route_cache_entry route_cache[ROUTE_CACHE_SZ];
 
   route_key_t last_key = 1;
 
   command error_t Init.init() {
     memset(routing_table, 0, sizeof(routing_table));
+    route_trie_init(&route_index, route_nodes, 2 * ROUTE_TABLE_SZ,
+                    routing_table[0].prefix.s6_addr, sizeof(struct route_entry),
+                    route_cache, ROUTE_CACHE_SZ);
+    return SUCCESS;
   }
 
   int alloc_key() {
@@ -65,31 +75,17 @@ module IPForwardingEngineP {
     return key;
   }
 
-  struct route_entry *alloc_entry(int pfxlen) {
+  struct route_entry *alloc_entry() {
     int i;
-    /* full table */
-    if (routing_table[ROUTE_TABLE_SZ-1].valid) return NULL;
-
     for (i = 0; i < ROUTE_TABLE_SZ; i++) {
-      /* if there's an invalid entry there are spare entries and we
-         don't have to insert in the middle of the table. */
-      if (!routing_table[i].valid) goto init_entry;
-      /* we keep the table sorted by prefix length so we skip all the
-         entries with longer prefixes. */
-      else if (routing_table[i].prefixlen >= pfxlen) continue;
-
-      /* we're pointing at a valid entry that is our new slot; we know
-         there's at least one free entry in the table, too. */
-      /* shift the table down and return the current entry; */
-      memmove((void *)&routing_table[i+1], (void *)&routing_table[i],
-              sizeof(struct route_entry) * (ROUTE_TABLE_SZ - i - 1));
-      goto init_entry;
+      if (!routing_table[i].valid) {
+        routing_table[i].valid = 1;
+        routing_table[i].key = alloc_key();
+        return &routing_table[i];
+      }
     }
+    /* full table */
     return NULL;
-  init_entry:
-    routing_table[i].valid = 1;
-    routing_table[i].key = alloc_key();
-    return &routing_table[i];
   }
 
   task void defaultRouteAddedTask() {
@@ -101,27 +97,35 @@ module IPForwardingEngineP {
                                                struct in6_addr *next_hop,
                                                uint8_t ifindex) {
     struct route_entry *entry;
+    uint16_t i;
     /* no reason to support non-byte length prefixes for now... */
     if (prefix_len_bits % 8 != 0 || prefix_len_bits > 128) return ROUTE_INVAL_KEY;
-    entry = call ForwardingTable.lookupRoute(prefix, prefix_len_bits);
-    if (entry == NULL || entry->prefixlen != prefix_len_bits) {
-      /* if there's no entry, or there's another entry but it has a
-         different prefix length, we allocate a new slot in the
-         table. */
-      entry = alloc_entry(prefix_len_bits);
+    i = route_trie_exact(&route_index, prefix, prefix_len_bits);
+    if (i != ROUTE_TRIE_NONE) {
+      entry = &routing_table[i];
+    } else {
+      /* no route to this prefix yet, so we allocate a new slot in
+         the table and index it. */
+      entry = alloc_entry();
+      if (entry == NULL)
+        return ROUTE_INVAL_KEY;
+      memset(&entry->prefix, 0, sizeof(struct in6_addr));
+      if (prefix_len_bits >= 8)
+        memcpy(&entry->prefix, prefix, prefix_len_bits / 8);
+      entry->prefixlen = prefix_len_bits;
+      if (route_trie_insert(&route_index, entry - routing_table,
+                            prefix_len_bits) < 0) {
+        entry->valid = 0;
+        return ROUTE_INVAL_KEY;
+      }
 
       /* got a default route and we didn't already have one */
       if (prefix_len_bits == 0) {
         post defaultRouteAddedTask();
       }
     }
-    if (entry == NULL)
-      return ROUTE_INVAL_KEY;
 
-    entry->prefixlen = prefix_len_bits;
     entry->ifindex = ifindex;
-    if (prefix_len_bits >= 8)
-      memcpy(&entry->prefix, prefix, prefix_len_bits / 8);
     if (next_hop)
       memcpy(&entry->next_hop, next_hop, sizeof(struct in6_addr));
     return entry->key;
@@ -130,15 +134,15 @@ module IPForwardingEngineP {
   command error_t ForwardingTable.delRoute(route_key_t key) {
     int i;
     for (i = 0; i < ROUTE_TABLE_SZ; i++) {
-      if (routing_table[i].key == key) {
+      if (routing_table[i].valid && routing_table[i].key == key) {
         /* remove the default route? */
         if (routing_table[i].prefixlen == 0) {
           signal ForwardingTableEvents.defaultRouteRemoved();
         }
 
-        memmove((void *)&routing_table[i], (void *)&routing_table[i+1],
-                sizeof(struct route_entry) * (ROUTE_TABLE_SZ - i - 1));
-        routing_table[ROUTE_TABLE_SZ-1].valid = 0;
+        route_trie_remove(&route_index, routing_table[i].prefix.s6_addr,
+                          routing_table[i].prefixlen);
+        routing_table[i].valid = 0;
         return SUCCESS;
       }
     }
@@ -148,23 +152,19 @@ module IPForwardingEngineP {
   /**
    * Look up the route to a prefix.
    *
-   * If next_hop is not NULL, the next hop will be written in there.
-   * @return the route key associated with this route.
+   * @return the route with the longest prefix, no longer than
+   * prefix_len_bits, that matches prefix; or NULL if there is none.
    */
   command struct route_entry *ForwardingTable.lookupRoute(const uint8_t *prefix,
                                                           int prefix_len_bits) {
-    int i;
-    for (i = 0; i < ROUTE_TABLE_SZ; i++) {
-      if (routing_table[i].valid &&
-          ((routing_table[i].prefixlen == 0) ||
-          (memcmp(prefix, routing_table[i].prefix.s6_addr,
-                  min(prefix_len_bits, routing_table[i].prefixlen) / 8) == 0 &&
-            prefix_len_bits))) {
-        /* match! */
-        return &routing_table[i];
-      }
-    }
-    return NULL;
+    uint16_t i;
+    if (prefix_len_bits >= 128)
+      i = route_trie_lookup_cached(&route_index, prefix);
+    else
+      i = route_trie_lookup(&route_index, prefix, max(prefix_len_bits, 0));
+    if (i == ROUTE_TRIE_NONE)
+      return NULL;
+    return &routing_table[i];
   }
   command struct route_entry *ForwardingTable.lookupRouteKey(route_key_t key) {
     int i;
@@ -63,6 +63,10 @@ module TcpP {
     if (cid < N_CLIENTS)
       signal Tcp.acked[cid]();
   }
+
+  uint32_t tcplib_extern_now() {
+    return call Timer.getNow();
+  }
 #include "libtcp/circ.c"
 #include "libtcp/tcplib.c"
 
@@ -98,7 +102,7 @@ module TcpP {
   }
 
   event void Boot.booted() {
-    call Timer.startPeriodic(512);
+    call Timer.startPeriodic(TCPLIB_TICK_MS);
   }
 
   event void Timer.fired() {
@@ -11,6 +11,11 @@ enum {
 #define ROUTE_TABLE_SZ 20
 #endif
 
+/* destinations whose route lookups are cached */
+#ifndef ROUTE_CACHE_SZ
+#define ROUTE_CACHE_SZ 4
+#endif
+
 enum {
   ROUTE_IFACE_ALL = 0,
   ROUTE_IFACE_154 = 1,
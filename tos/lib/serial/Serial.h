@@ -103,9 +103,18 @@ enum {
   SERIAL_PROTO_ACK = 67,
   SERIAL_PROTO_PACKET_ACK = 68,
   SERIAL_PROTO_PACKET_NOACK = 69,
+  SERIAL_PROTO_WINDOW = 70,
+  SERIAL_PROTO_PACKET_SEQ = 71,
+  SERIAL_PROTO_SACK = 72,
   SERIAL_PROTO_PACKET_UNKNOWN = 255
 };
 
+// Windowed pc -> mote transfer (SERIAL_PROTO_WINDOW), see README.txt
+enum {
+  SERIAL_WINDOW_VERSION = 1,
+  SERIAL_WINDOW_SIZE = 8,
+};
+
 typedef struct radio_stats {
   uint8_t version;
   uint8_t flags;
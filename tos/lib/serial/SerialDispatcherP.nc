@@ -108,6 +108,14 @@ implementation {
   message_t * ONE_NOK receiveTaskBuf = NULL;
   uint8_t receiveTaskSize = 0;
 
+  // A second packet completed while receiveTask was pending. It keeps
+  // its buffer locked and is delivered by the next receiveTask, so
+  // that every packet accepted by startPacket() is delivered: the
+  // serial protocol acknowledges it right after endPacket().
+  uint8_t receiveQueued = FALSE;
+  uart_id_t receiveQueuedType = 0;
+  uint8_t receiveQueuedSize = 0;
+
   command error_t Send.send[uint8_t id](message_t* msg, uint8_t len) {
     if (sendState != SEND_STATE_IDLE) {
       return EBUSY;
@@ -288,15 +296,34 @@ implementation {
     myBuf = signal Receive.receive[myType](myBuf, myBuf, mySize);
     atomic {
       messagePtrs[myWhich] = myBuf;
+      // A queued packet swapped receiveBuffer back to myWhich, i.e. to
+      // the buffer just given to Receive.receive: use the new one.
+      if (receiveState.which == myWhich) {
+        receiveBuffer = (uint8_t*)myBuf;
+      }
       unlockBuffer(myWhich);
       receiveTaskPending = FALSE;
+      if (receiveQueued) {
+        // the queued packet is in the other buffer
+        receiveQueued = FALSE;
+        receiveTaskPending = TRUE;
+        receiveTaskType = receiveQueuedType;
+        receiveTaskWhich = myWhich ? 0 : 1;
+        receiveTaskBuf = messagePtrs[receiveTaskWhich];
+        receiveTaskSize = receiveQueuedSize;
+        post receiveTask();
+      }
     }
   }
 
   async event void ReceiveBytePacket.endPacket(error_t result) {
     uint8_t postsignalreceive = FALSE;
     atomic {
-      if (!receiveTaskPending && result == SUCCESS){
+      if (receiveState.state == RECV_STATE_IDLE) {
+        // startPacket() refused this packet, the current buffer (if
+        // locked) belongs to a packet waiting for receiveTask.
+      }
+      else if (result == SUCCESS && !receiveTaskPending){
         postsignalreceive = TRUE;
         receiveTaskPending = TRUE;
         receiveTaskType = recvType;
@@ -305,9 +332,19 @@ implementation {
         receiveTaskSize = recvIndex;
         receiveBufferSwap();
         receiveState.state = RECV_STATE_IDLE;
+      }
+      else if (result == SUCCESS && !receiveQueued) {
+        // receiveTask delivers it next; startPacket() refuses
+        // further packets until then, as both buffers are locked.
+        receiveQueued = TRUE;
+        receiveQueuedType = recvType;
+        receiveQueuedSize = recvIndex;
+        receiveBufferSwap();
+        receiveState.state = RECV_STATE_IDLE;
       } else {
         // we can't deliver the packet, better free the current buffer.
         unlockBuffer(receiveState.which);
+        receiveState.state = RECV_STATE_IDLE;
       }
     }
     if (postsignalreceive){
@@ -48,6 +48,11 @@
  * acknowledgement to the sender which serves as a crude form of
  * flow-control.
  *
+ * A host that negotiated it with a SERIAL_PROTO_WINDOW frame may
+ * instead send SERIAL_PROTO_PACKET_SEQ frames back to back; these are
+ * deduplicated by their sequence number and acknowledged with
+ * cumulative/selective SERIAL_PROTO_SACK frames (see README.txt).
+ *
  * @author Phil Buonadonna
  * @author Lewis Girod
  * @author Ben Greenstein
@@ -84,6 +89,8 @@ implementation {
     SERIAL_MTU = 255,
     SERIAL_VERSION = 1,
     ACK_QUEUE_SIZE = 5,
+    RX_WINDOW = SERIAL_WINDOW_SIZE,
+    CTRL_FRAME_SIZE = 3,
   };
 
   enum {
@@ -164,6 +171,24 @@ implementation {
   /* Ack Queue */
   ack_queue_t ackQ;
 
+  /* Control frame (ack, sack, window) being sent */
+  uint8_t txCtrl[CTRL_FRAME_SIZE];
+  uint8_t txCtrlLen;
+
+  /* Payload of a received SERIAL_PROTO_WINDOW frame */
+  uint8_t rxCtrl[CTRL_FRAME_SIZE];
+
+  /* Windowed receive: winNext is the oldest seqno not received yet,
+     bit i of winMask stands for seqno winNext + i (bit 0 is always
+     clear). Only valid once a host synchronized us. */
+  bool winSynced;
+  uint8_t winNext;
+  uint8_t winMask;
+  bool sackPending;
+  bool winReplyPending;
+  uint8_t winReplyBase;
+  uint8_t winReplySize;
+
   bool offPending = FALSE;
 
   // Prototypes
@@ -171,6 +196,7 @@ implementation {
   inline void txInit();
   inline void rxInit();
   inline void ackInit();
+  inline void windowInit();
 
   inline bool ack_queue_is_full(); 
   inline bool ack_queue_is_empty(); 
@@ -217,11 +243,20 @@ implementation {
     ackQ.writePtr = ackQ.readPtr = 0;
   }
 
+  inline void windowInit(){
+    winSynced = FALSE;
+    winNext = 0;
+    winMask = 0;
+    sackPending = FALSE;
+    winReplyPending = FALSE;
+  }
+
   command error_t Init.init() {
 
     txInit();
     rxInit();
     ackInit();
+    windowInit();
 
     return SUCCESS;
   }
@@ -279,6 +314,52 @@ implementation {
   }
 
 
+  /*
+   * Windowed receive
+   */
+
+  /* a SERIAL_PROTO_WINDOW frame (re)starts the window at base */
+  void window_sync(uint8_t base, uint8_t size){
+    winSynced = TRUE;
+    winNext = base;
+    winMask = 0;
+    winReplyBase = base;
+    winReplySize = (size < RX_WINDOW) ? size : RX_WINDOW;
+    winReplyPending = TRUE;
+    MaybeScheduleTx();
+  }
+
+  /* returns TRUE if the SERIAL_PROTO_PACKET_SEQ frame seqno has not
+     been received before. Every frame is answered, duplicates too, so
+     that the host learns about lost acks. */
+  bool window_accept(uint8_t seqno){
+    uint8_t offset = seqno - winNext;
+    bool fresh = FALSE;
+    if (!winSynced) {
+      /* we rebooted since the host synchronized: ask it to do it again */
+      winReplyBase = seqno;
+      winReplySize = 0;
+      winReplyPending = TRUE;
+      MaybeScheduleTx();
+      return FALSE;
+    }
+    if (offset < RX_WINDOW && !(winMask & (1 << offset))) {
+      fresh = TRUE;
+      winMask |= (1 << offset);
+      while (winMask & 1) {
+        winMask >>= 1;
+        winNext++;
+      }
+    }
+    /* otherwise a duplicate, or the host is ahead of us because we
+       missed its SERIAL_PROTO_WINDOW frame: the sack tells it where
+       we are */
+    sackPending = TRUE;
+    MaybeScheduleTx();
+    return fresh;
+  }
+
+
   /* 
    * Buffer Manipulation
    */
@@ -402,6 +483,8 @@ implementation {
     switch (proto){
     case SERIAL_PROTO_PACKET_ACK: 
     case SERIAL_PROTO_PACKET_NOACK:
+    case SERIAL_PROTO_PACKET_SEQ:
+    case SERIAL_PROTO_WINDOW:
       return TRUE;
     case SERIAL_PROTO_ACK:
     default: 
@@ -427,11 +510,15 @@ implementation {
           goto nosync;
         
         rxCRC = crcByte(rxCRC,data);
-        if( rxProto == SERIAL_PROTO_PACKET_ACK )
+        if( rxProto == SERIAL_PROTO_PACKET_ACK ||
+            rxProto == SERIAL_PROTO_PACKET_SEQ ||
+            rxProto == SERIAL_PROTO_WINDOW )
           rxState = RXSTATE_TOKEN;
         else
           rxState = RXSTATE_INFO;
-        if (signal ReceiveBytePacket.startPacket() != SUCCESS){
+        /* window frames are for us, not for the dispatcher */
+        if (rxProto != SERIAL_PROTO_WINDOW &&
+            signal ReceiveBytePacket.startPacket() != SUCCESS){
           goto nosync;
         }
       }      
@@ -453,9 +540,18 @@ implementation {
         if (isDelimeter) { /* handle end of frame */
           if (rxByteCnt >= 2) {
             if (rx_current_crc() == rxCRC) {
-              signal ReceiveBytePacket.endPacket(SUCCESS);
-              if( rxProto == SERIAL_PROTO_PACKET_ACK)
-                ack_queue_push(rxSeqno);
+              if (rxProto == SERIAL_PROTO_WINDOW) {
+                if (rxByteCnt >= 4)
+                  window_sync(rxSeqno, rxCtrl[1]);
+              }
+              else if (rxProto == SERIAL_PROTO_PACKET_SEQ) {
+                signal ReceiveBytePacket.endPacket(window_accept(rxSeqno) ? SUCCESS : FAIL);
+              }
+              else {
+                signal ReceiveBytePacket.endPacket(SUCCESS);
+                if( rxProto == SERIAL_PROTO_PACKET_ACK)
+                  ack_queue_push(rxSeqno);
+              }
 	      rxInit();
 	      call SerialFrameComm.resetReceive();
 	      if (offPending) {
@@ -474,7 +570,13 @@ implementation {
 	}
         else { /* handle new bytes to save */
           if (rxByteCnt >= 2){ 
-            signal ReceiveBytePacket.byteReceived(rx_buffer_top());
+            if (rxProto == SERIAL_PROTO_WINDOW) {
+              if (rxByteCnt - 2 < CTRL_FRAME_SIZE)
+                rxCtrl[rxByteCnt - 2] = rx_buffer_top();
+            }
+            else {
+              signal ReceiveBytePacket.byteReceived(rx_buffer_top());
+            }
             rxCRC = crcByte(rxCRC,rx_buffer_pop());
           }
 	  rx_buffer_push(data);
@@ -589,8 +691,9 @@ implementation {
     if (done || fail) {
       atomic {
 	txSeqno++;
-	if (txProto == SERIAL_PROTO_ACK){
-	  ack_queue_pop();
+	if (txIndex == TX_ACK_INDEX){
+	  if (txProto == SERIAL_PROTO_ACK)
+	    ack_queue_pop();
 	}
 	else {
 	  result = done ? SUCCESS : FAIL;
@@ -617,15 +720,45 @@ implementation {
         }
         if (!ack_queue_is_empty() && myAckState == BUFFER_AVAILABLE) {
           atomic {
+            txCtrl[0] = ack_queue_top();
+            txCtrlLen = 1;
             txBuf[TX_ACK_INDEX].state = BUFFER_COMPLETE;
-            txBuf[TX_ACK_INDEX].buf = ack_queue_top();
+            txBuf[TX_ACK_INDEX].buf = txCtrl[0];
 
 	    txProto = SERIAL_PROTO_ACK;
 	    txIndex = TX_ACK_INDEX;
 	    start_it = TRUE;
 	  }
         }
-        else if (myDataState == BUFFER_FILLING || myDataState == BUFFER_COMPLETE){
+        else if (myAckState == BUFFER_AVAILABLE) {
+          /* window replies and sacks are built when they go out, so
+             that one sack covers everything received until then */
+          atomic {
+            if (winReplyPending) {
+              winReplyPending = FALSE;
+              txCtrl[0] = winReplyBase;
+              txCtrl[1] = SERIAL_WINDOW_VERSION;
+              txCtrl[2] = winReplySize;
+              txCtrlLen = 3;
+              txProto = SERIAL_PROTO_WINDOW;
+              start_it = TRUE;
+            }
+            else if (sackPending) {
+              sackPending = FALSE;
+              txCtrl[0] = winNext;
+              txCtrl[1] = winMask >> 1;
+              txCtrlLen = 2;
+              txProto = SERIAL_PROTO_SACK;
+              start_it = TRUE;
+            }
+            if (start_it) {
+              txBuf[TX_ACK_INDEX].state = BUFFER_COMPLETE;
+              txBuf[TX_ACK_INDEX].buf = txCtrl[0];
+              txIndex = TX_ACK_INDEX;
+            }
+          }
+        }
+        if (!start_it && (myDataState == BUFFER_FILLING || myDataState == BUFFER_COMPLETE)){
 	  atomic {
 	    txProto = SERIAL_PROTO_PACKET_NOACK;
 	    txIndex = TX_DATA_INDEX;
@@ -706,7 +839,10 @@ implementation {
 	      }
 	    }
 	    else { // TX_ACK_INDEX
-	      txState = TXSTATE_FCS1;
+	      if (txByteCnt >= txCtrlLen)
+		txState = TXSTATE_FCS1;
+	      else
+		txBuf[txIndex].buf = txCtrl[txByteCnt];
 	    }
 	  }
 	  break;
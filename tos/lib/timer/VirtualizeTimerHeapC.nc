@@ -0,0 +1,314 @@
+/* Copyright (c) 2000-2003 The Regents of the University of California.  
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the
+ *   distribution.
+ * - Neither the name of the copyright holder nor the names of
+ *   its contributors may be used to endorse or promote products derived
+ *   from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL
+ * THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * VirtualizeTimerHeapC uses a single Timer to create up to 255 virtual
+ * timers, like VirtualizeTimerC, but keeps the running timers in binary
+ * min-heaps rather than scanning all of them on every start and on
+ * every fire. Starting, stopping and firing a timer take O(log n) time
+ * and finding the next one due takes O(1). This pays off with more
+ * than a handful of timers; with few, VirtualizeTimerC is smaller.
+ *
+ * <p>The Timer interface behaves as with VirtualizeTimerC: periodic
+ * timers advance t0 by dt on every fire and so do not drift, at most
+ * one timer fires per task, and of the timers that are due, the one
+ * with the lowest number fires first. The only difference is that a
+ * timer started with a t0 in the future fires at t0 + dt, where
+ * VirtualizeTimerC may fire it early along with another timer.
+ *
+ * <p>To use it, wire it in place of VirtualizeTimerC, for instance in
+ * the platform's HilTimerMilliC. apps/tests/TestTimerHeap checks in
+ * TOSSIM that both fire the same timers at the same times.
+ *
+ * @param precision_tag A type indicating the precision of the Timer being 
+ *   virtualized.
+ * @param max_timers Number of virtual timers to create.
+ *
+ * @author Cory Sharp <cssharp@eecs.berkeley.edu> (VirtualizeTimerC)
+ */
+
+generic module VirtualizeTimerHeapC(typedef precision_tag, int max_timers) @safe()
+{
+  provides interface Timer<precision_tag> as Timer[uint8_t num];
+  uses interface Timer<precision_tag> as TimerFrom;
+}
+implementation
+{
+  enum
+    {
+      NUM_TIMERS = max_timers,
+      PENDING = 0,	/* running timers not due yet, by deadline */
+      DUE = 1,		/* timers that are due, by number */
+    };
+
+  typedef struct
+  {
+    uint32_t t0;
+    uint32_t dt;
+    bool isoneshot : 1;
+    bool isrunning : 1;
+    bool isdue : 1;
+    bool _reserved : 5;
+  } Timer_t;
+
+  Timer_t m_timers[NUM_TIMERS];
+
+  /* The PENDING and DUE heaps share m_slots: PENDING grows from the
+     front and DUE from the back. In either, the children of element i
+     are elements 2i+1 and 2i+2. */
+  uint8_t m_slots[NUM_TIMERS];
+  uint16_t m_count[2];
+  /* Where each running timer is in its heap. */
+  uint8_t m_pos[NUM_TIMERS];
+
+  task void updateFromTimer();
+
+  uint32_t deadline(uint8_t num)
+  {
+    return m_timers[num].t0 + m_timers[num].dt;
+  }
+
+  uint8_t get(uint8_t h, uint16_t i)
+  {
+    return m_slots[h == PENDING ? i : NUM_TIMERS - 1 - i];
+  }
+
+  void place(uint8_t h, uint16_t i, uint8_t num)
+  {
+    m_slots[h == PENDING ? i : NUM_TIMERS - 1 - i] = num;
+    m_pos[num] = i;
+  }
+
+  /* Whether timer a comes before timer b in heap h. Like
+     VirtualizeTimerC, this supports dt's up to MAXINT. */
+  bool before(uint8_t h, uint8_t a, uint8_t b)
+  {
+    int32_t d;
+
+    if (h == DUE)
+      return a < b;
+    d = deadline(a) - deadline(b);
+    return d < 0 || (d == 0 && a < b);
+  }
+
+  void siftUp(uint8_t h, uint16_t i)
+  {
+    uint8_t num = get(h, i);
+
+    while (i > 0)
+      {
+	uint16_t parent = (i - 1) / 2;
+
+	if (!before(h, num, get(h, parent)))
+	  break;
+	place(h, i, get(h, parent));
+	i = parent;
+      }
+    place(h, i, num);
+  }
+
+  void siftDown(uint8_t h, uint16_t i)
+  {
+    uint8_t num = get(h, i);
+
+    for (;;)
+      {
+	uint16_t child = 2 * i + 1;
+
+	if (child >= m_count[h])
+	  break;
+	if (child + 1 < m_count[h] && before(h, get(h, child + 1), get(h, child)))
+	  child++;
+	if (!before(h, get(h, child), num))
+	  break;
+	place(h, i, get(h, child));
+	i = child;
+      }
+    place(h, i, num);
+  }
+
+  void enqueue(uint8_t num)
+  {
+    uint8_t h = m_timers[num].isdue ? DUE : PENDING;
+
+    place(h, m_count[h], num);
+    m_count[h]++;
+    siftUp(h, m_count[h] - 1);
+  }
+
+  void dequeue(uint8_t num)
+  {
+    uint8_t h = m_timers[num].isdue ? DUE : PENDING;
+    uint16_t i = m_pos[num];
+    uint8_t last = get(h, --m_count[h]);
+
+    if (last != num)
+      {
+	/* the last timer takes num's place, and moves from there */
+	place(h, i, last);
+	if (i > 0 && before(h, last, get(h, (i - 1) / 2)))
+	  siftUp(h, i);
+	else
+	  siftDown(h, i);
+      }
+  }
+
+  void fireTimers(uint32_t now)
+  {
+    /* timers that have become due wait in DUE, by number */
+    while (m_count[PENDING] > 0
+	   && (int32_t)(deadline(get(PENDING, 0)) - now) <= 0)
+      {
+	uint8_t num = get(PENDING, 0);
+
+	dequeue(num);
+	m_timers[num].isdue = TRUE;
+	enqueue(num);
+      }
+
+    if (m_count[DUE] > 0)
+      {
+	uint8_t num = get(DUE, 0);
+	Timer_t* timer = &m_timers[num];
+
+	dequeue(num);
+	timer->isdue = FALSE;
+	if (timer->isoneshot)
+	  timer->isrunning = FALSE;
+	else // Update timer for next event
+	  {
+	    timer->t0 += timer->dt;
+	    enqueue(num);
+	  }
+
+	signal Timer.fired[num]();
+      }
+    post updateFromTimer();
+  }
+  
+  task void updateFromTimer()
+  {
+    uint32_t now = call TimerFrom.getNow();
+
+    call TimerFrom.stop();
+
+    if (m_count[DUE] > 0)
+      fireTimers(now);
+    else if (m_count[PENDING] > 0)
+      {
+	int32_t remaining = deadline(get(PENDING, 0)) - now;
+
+	if (remaining <= 0)
+	  fireTimers(now);
+	else
+	  call TimerFrom.startOneShotAt(now, remaining);
+      }
+  }
+  
+  event void TimerFrom.fired()
+  {
+    fireTimers(call TimerFrom.getNow());
+  }
+
+  void startTimer(uint8_t num, uint32_t t0, uint32_t dt, bool isoneshot)
+  {
+    Timer_t* timer = &m_timers[num];
+
+    if (timer->isrunning)
+      dequeue(num);
+    timer->t0 = t0;
+    timer->dt = dt;
+    timer->isoneshot = isoneshot;
+    timer->isrunning = TRUE;
+    timer->isdue = FALSE;
+    enqueue(num);
+    post updateFromTimer();
+  }
+
+  command void Timer.startPeriodic[uint8_t num](uint32_t dt)
+  {
+    startTimer(num, call TimerFrom.getNow(), dt, FALSE);
+  }
+
+  command void Timer.startOneShot[uint8_t num](uint32_t dt)
+  {
+    startTimer(num, call TimerFrom.getNow(), dt, TRUE);
+  }
+
+  command void Timer.stop[uint8_t num]()
+  {
+    if (m_timers[num].isrunning)
+      {
+	dequeue(num);
+	m_timers[num].isrunning = FALSE;
+	m_timers[num].isdue = FALSE;
+      }
+  }
+
+  command bool Timer.isRunning[uint8_t num]()
+  {
+    return m_timers[num].isrunning;
+  }
+
+  command bool Timer.isOneShot[uint8_t num]()
+  {
+    return m_timers[num].isoneshot;
+  }
+
+  command void Timer.startPeriodicAt[uint8_t num](uint32_t t0, uint32_t dt)
+  {
+    startTimer(num, t0, dt, FALSE);
+  }
+
+  command void Timer.startOneShotAt[uint8_t num](uint32_t t0, uint32_t dt)
+  {
+    startTimer(num, t0, dt, TRUE);
+  }
+
+  command uint32_t Timer.getNow[uint8_t num]()
+  {
+    return call TimerFrom.getNow();
+  }
+
+  command uint32_t Timer.gett0[uint8_t num]()
+  {
+    return m_timers[num].t0;
+  }
+
+  command uint32_t Timer.getdt[uint8_t num]()
+  {
+    return m_timers[num].dt;
+  }
+
+  default event void Timer.fired[uint8_t num]()
+  {
+  }
+}
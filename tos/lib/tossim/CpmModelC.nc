@@ -47,6 +47,7 @@
 
 #include <sim_gain.h>
 #include <sim_noise.h>
+#include <sim_pcap.h>
 #include <randomlib.h>
 #include "sim_lqi.c"
 
@@ -79,6 +80,7 @@ implementation {
 		receive_message_t* next;
 		uint8_t channel;   // MIKE_LIANG: Channel information for this message
 		uint8_t lqi;   // MIKE_LIANG
+		uint8_t lostReason; // First reason the packet was lost, for capture
 	};
 
 	receive_message_t* outstandingReceptionHead = NULL;
@@ -91,6 +93,7 @@ implementation {
 	bool checkReceive(receive_message_t* msg);
 	double packetNoise(receive_message_t* msg);
 	double checkPrr(receive_message_t* msg);
+	void markLost(receive_message_t* msg, uint8_t reason);
 
 	double timeInMs()   {
 		sim_time_t ftime = sim_time();
@@ -314,6 +317,72 @@ implementation {
 		return prr_estimate_from_snr(msg->power / packetNoise(msg));
 	}
 
+	void markLost(receive_message_t* msg, uint8_t reason) {
+		if (!msg->lost) {
+			msg->lostReason = reason;
+		}
+		msg->lost = 1;
+	}
+
+	/* Rebuild the 802.15.4 frame (less FCS) that a CC2420 would put on
+		 the air for this packet: a data frame with short addresses and
+		 PAN ID compression, followed by the AM payload. */
+	uint8_t pcapFrame(message_t* msg, bool ack, uint8_t* frame) {
+		tossim_header_t* hdr = (tossim_header_t*)(msg->data - sizeof(tossim_header_t));
+		uint16_t fcf = 0x8841 | (ack? 0x0020 : 0);
+		uint16_t dest = hdr->dest;
+		uint16_t src = hdr->src;
+		uint8_t len = hdr->length;
+		uint8_t i = 0;
+		if (len > TOSH_DATA_LENGTH) {
+			len = TOSH_DATA_LENGTH;
+		}
+		frame[i++] = fcf & 0xff;
+		frame[i++] = fcf >> 8;
+		frame[i++] = hdr->dsn;
+		frame[i++] = hdr->group;
+		frame[i++] = 0;
+		frame[i++] = dest & 0xff;
+		frame[i++] = dest >> 8;
+		frame[i++] = src & 0xff;
+		frame[i++] = src >> 8;
+#ifndef TFRAMES_ENABLED
+		frame[i++] = hdr->network;
+#endif
+		frame[i++] = hdr->type;
+		memcpy(frame + i, msg->data, len);
+		return i + len;
+	}
+
+	uint8_t pcapType(message_t* msg) {
+		tossim_header_t* hdr = (tossim_header_t*)(msg->data - sizeof(tossim_header_t));
+		return hdr->type;
+	}
+
+	void pcapReceive(receive_message_t* msg) {
+		uint8_t frame[sizeof(tossim_header_t) + TOSH_DATA_LENGTH + 2];
+		uint8_t len;
+		uint8_t reason = msg->lost? msg->lostReason : SIM_PCAP_RX_OK;
+		if (msg->channel != sim_mote_get_radio_channel(sim_node())) {
+			reason = SIM_PCAP_LOST_CHANNEL;
+		}
+		if (!sim_pcap_wants(msg->source, sim_node(), pcapType(msg->msg))) {
+			return;
+		}
+		len = pcapFrame(msg->msg, msg->ack, frame);
+		sim_pcap_rx(msg->source, sim_node(), msg->channel, msg->strength, msg->lqi, reason, frame, len);
+	}
+
+	void pcapTransmit(int dest, message_t* msg, bool ack) {
+		uint8_t frame[sizeof(tossim_header_t) + TOSH_DATA_LENGTH + 2];
+		uint8_t len;
+		if (!sim_pcap_wants(sim_node(), dest, pcapType(msg))) {
+			return;
+		}
+		len = pcapFrame(msg, ack, frame);
+		sim_pcap_tx(sim_node(), sim_mote_get_radio_channel(sim_node()), frame, len);
+	}
+
 
 	/* Handle a packet reception. If the packet is being acked,
 		 pass the corresponding receive_message_t* to the ack handler,
@@ -342,12 +411,16 @@ implementation {
 		dbg("CpmModelC,SNRLoss", "Packet from %i to %i\n", (int)mine->source, (int)sim_node());
 		if (!checkReceive(mine)) {
 			dbg("CpmModelC,SNRLoss", " - lost packet from %i as SNR was too low.\n", (int)mine->source);
-			mine->lost = 1;
+			markLost(mine, SIM_PCAP_LOST_SNR);
+		}
+		if (sim_pcap_enabled()) {
+			pcapReceive(mine);
 		}
 		// MIKE_LIANG: Checks for channel
 		if (mine->channel != sim_mote_get_radio_channel(sim_node())) {
 			free_receive_message(mine);
 			receiving = 0;
+			sim_energy_radio_rx_end(sim_node());
 			return;
 		}
 		if (!mine->lost) {
@@ -377,6 +450,7 @@ implementation {
 			}
 			// We're searching for new packets again
 			receiving = 0;
+			sim_energy_radio_rx_end(sim_node());
 		} // If the packet was lost, then we're searching for new packets again
 		else {
 			if (RandomUniform() < 0.001) {
@@ -393,6 +467,7 @@ implementation {
 				free_receive_message(mine);
 			}
 			receiving = 0;
+			sim_energy_radio_rx_end(sim_node());
 			dbg_clear("CpmModelC,SNRLoss", "  -packet was lost.\n");
 		}
 	}
@@ -416,6 +491,7 @@ implementation {
 		rcv->strength = (int8_t)(floor(10.0 * log(pow(10.0, power/10.0) + pow(10.0, noiseStr/10.0)) / log(10.0)));
 		rcv->msg = msg;
 		rcv->lost = 0;
+		rcv->lostReason = SIM_PCAP_RX_OK;
 		rcv->ack = receive;
 		rcv->channel = sim_mote_get_radio_channel(source);   // Sets to the current radio channel
 		// If I'm off, I never receive the packet, but I need to keep track of
@@ -425,25 +501,26 @@ implementation {
 
 		if (!sim_mote_is_on(sim_node())) { 
 			dbg("CpmModelC", "Lost packet from %i due to %i being off\n", source, sim_node());
-			rcv->lost = 1;
+			markLost(rcv, SIM_PCAP_LOST_OFF);
 		}
 		else if (!shouldReceive(power - noiseStr)) {
 			dbg("CpmModelC,SNRLoss", "Lost packet from %i to %i due to SNR being too low (%i)\n", source, sim_node(), (int)(power - noiseStr));
-			rcv->lost = 1;
+			markLost(rcv, SIM_PCAP_LOST_SNR);
 		}
 		else if (sim_mote_get_radio_channel(sim_node()) != sim_mote_get_radio_channel(source)) {   // MIKE_LIANG
-			rcv->lost = 1;
+			markLost(rcv, SIM_PCAP_LOST_CHANNEL);
 		}
 		else if (receiving) {
 			dbg("CpmModelC,SNRLoss", "Lost packet from %i due to %i being mid-reception\n", source, sim_node());
-			rcv->lost = 1;
+			markLost(rcv, SIM_PCAP_LOST_RECEIVING);
 		}
 		else if (transmitting && (rcv->start < transmissionEndTime) && (transmissionEndTime <= rcv->end)) {
 			dbg("CpmModelC,SNRLoss", "Lost packet from %i due to %i being mid-transmission, transmissionEndTime %llu\n", source, sim_node(), transmissionEndTime);
-			rcv->lost = 1;
+			markLost(rcv, SIM_PCAP_LOST_SENDING);
 		}
 		else {
 			receiving = 1;
+			sim_energy_radio_rx_start(sim_node());
 		}
 
 		list = outstandingReceptionHead;
@@ -454,7 +531,7 @@ implementation {
 			}
 			if (!shouldReceive(list->power - rcv->power)) {
 				dbg("Gain,SNRLoss", "Going to lose packet from %i with signal %lf as am receiving a packet from %i with signal %lf\n", list->source, list->power, source, rcv->power);
-				list->lost = 1;
+				markLost(list, SIM_PCAP_LOST_COLLISION);
 			}
 			list = list->next;
 		}
@@ -481,6 +558,9 @@ implementation {
 		outgoing = msg;
 		transmissionEndTime = endTime;
 		dbg("CpmModelC", "Node %i transmitting to %i, finishes at %llu.\n", sim_node(), dest, endTime);
+		if (sim_pcap_enabled()) {
+			pcapTransmit(dest, msg, ack);
+		}
 
 		while (neighborEntry != NULL) {
 			int other = neighborEntry->mote;
@@ -490,7 +570,7 @@ implementation {
 
 		list = outstandingReceptionHead;
 		while (list != NULL) {    
-			list->lost = 1;
+			markLost(list, SIM_PCAP_LOST_SENDING);
 			dbg("CpmModelC,SNRLoss", "Lost packet from %i because %i has outstanding reception, startTime %llu endTime %llu\n", list->source, sim_node(), list->start, list->end);
 			list = list->next;
 		}
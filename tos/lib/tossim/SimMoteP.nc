@@ -130,12 +130,14 @@ implementation {
       startTime = sim_time();
       dbg("SimMoteP", "Setting start time to %llu\n", startTime);
       isOn = TRUE;
+      sim_energy_node_power(sim_node(), TRUE);
       sim_main_start_mote();
     }
   }
 
   async command void SimMote.turnOff() {
     isOn = FALSE;
+    sim_energy_node_power(sim_node(), FALSE);
   }
 
   
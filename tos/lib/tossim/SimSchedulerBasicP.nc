@@ -186,6 +186,7 @@ implementation
       if( nextTask == NO_TASK )
       {
 	dbg("Scheduler", "Told to run next task, but no task to run.\n");
+	sim_energy_mcu_state(sim_node(), SIM_MCU_SLEEP);
 	return FALSE;
       }
     }
@@ -210,6 +211,7 @@ implementation
     }
     if (result == SUCCESS) {
       dbg("Scheduler", "Posting task %hhu.\n", id);
+      sim_energy_mcu_state(sim_node(), SIM_MCU_ACTIVE);
       sim_scheduler_submit_event();
     }
     else {
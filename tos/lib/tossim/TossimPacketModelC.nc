@@ -95,6 +95,9 @@ implementation {
 
   task void startDoneTask() {
     running = TRUE;
+    if (!transmitting) {
+      sim_energy_radio_state(sim_node(), (sending != NULL)? SIM_RADIO_BACKOFF : SIM_RADIO_LISTEN);
+    }
     signal Control.startDone(SUCCESS);
   }
 
@@ -118,6 +121,9 @@ implementation {
       return FAIL;
     }
     running = FALSE;
+    if (!transmitting) {
+      sim_energy_radio_state(sim_node(), SIM_RADIO_SLEEP);
+    }
     dbg("TossimPacketModelC", "TossimPacketModelC: Control.stop() called.\n");
     post stopDoneTask();
     return SUCCESS;
@@ -205,6 +211,7 @@ implementation {
     sendEvent.handle = send_backoff;
     sendEvent.cleanup = sim_queue_cleanup_none;
     sim_queue_insert(&sendEvent);
+    sim_energy_radio_state(sim_node(), SIM_RADIO_BACKOFF);
   }
 
 
@@ -241,6 +248,7 @@ implementation {
     else {
       message_t* rval = sending;
       sending = NULL;
+      sim_energy_radio_state(sim_node(), running? SIM_RADIO_LISTEN : SIM_RADIO_SLEEP);
       dbg("TossimPacketModelC", "PACKET: Failed to send packet due to busy channel.\n");
       signal Packet.sendDone(rval, EBUSY);
     }
@@ -267,6 +275,7 @@ implementation {
     evt->handle = send_transmit_done;
 
     dbg("TossimPacketModelC", "PACKET: Broadcasting packet to everyone.\n");
+    sim_energy_radio_state(sim_node(), SIM_RADIO_TX);
     call GainRadioModel.putOnAirTo(destNode, sending, metadata->ack, evt->time, 0.0, 0.0);
     metadata->ack = 0;
 
@@ -281,6 +290,7 @@ implementation {
     message_t* rval = sending;
     sending = NULL;
     transmitting = FALSE;
+    sim_energy_radio_state(sim_node(), running? SIM_RADIO_LISTEN : SIM_RADIO_SLEEP);
     dbg("TossimPacketModelC", "PACKET: Signaling send done at %llu.\n", sim_time());
     signal Packet.sendDone(rval, running? SUCCESS:EOFF);
   }
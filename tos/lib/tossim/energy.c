@@ -0,0 +1,104 @@
+/*
+ * Copyright (c) 2026 The stormport contributors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ *
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the
+ *   distribution.
+ *
+ * - Neither the name of the copyright holders nor the names of
+ *   its contributors may be used to endorse or promote products derived
+ *   from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL
+ * THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ *
+ * C++ interface to TOSSIM's radio and MCU energy accounting.
+ *
+ * @date   Oct 19 2026
+ */
+
+#include <energy.h>
+#include <sim_energy.h>
+
+Energy::Energy() : values(NULL), numValues(0) {}
+Energy::~Energy() {
+  free(values);
+}
+
+double Energy::voltage() {return sim_energy_voltage();}
+double Energy::radioSleepCurrent() {return sim_energy_radio_current(SIM_RADIO_SLEEP);}
+double Energy::radioListenCurrent() {return sim_energy_radio_current(SIM_RADIO_LISTEN);}
+double Energy::radioBackoffCurrent() {return sim_energy_radio_current(SIM_RADIO_BACKOFF);}
+double Energy::radioRxCurrent() {return sim_energy_radio_current(SIM_RADIO_RX);}
+double Energy::radioTxCurrent() {return sim_energy_radio_current(SIM_RADIO_TX);}
+double Energy::mcuSleepCurrent() {return sim_energy_mcu_current(SIM_MCU_SLEEP);}
+double Energy::mcuActiveCurrent() {return sim_energy_mcu_current(SIM_MCU_ACTIVE);}
+
+void Energy::setVoltage(double val) {sim_energy_set_voltage(val);}
+void Energy::setRadioSleepCurrent(double val) {sim_energy_set_radio_current(SIM_RADIO_SLEEP, val);}
+void Energy::setRadioListenCurrent(double val) {sim_energy_set_radio_current(SIM_RADIO_LISTEN, val);}
+void Energy::setRadioBackoffCurrent(double val) {sim_energy_set_radio_current(SIM_RADIO_BACKOFF, val);}
+void Energy::setRadioRxCurrent(double val) {sim_energy_set_radio_current(SIM_RADIO_RX, val);}
+void Energy::setRadioTxCurrent(double val) {sim_energy_set_radio_current(SIM_RADIO_TX, val);}
+void Energy::setMcuSleepCurrent(double val) {sim_energy_set_mcu_current(SIM_MCU_SLEEP, val);}
+void Energy::setMcuActiveCurrent(double val) {sim_energy_set_mcu_current(SIM_MCU_ACTIVE, val);}
+
+variable_string_t Energy::radioEnergies(int count) {
+  return bulk(sim_energy_radio_all, count);
+}
+
+variable_string_t Energy::mcuEnergies(int count) {
+  return bulk(sim_energy_mcu_all, count);
+}
+
+variable_string_t Energy::radioDutyCycles(int count) {
+  return bulk(sim_energy_radio_duty_cycle_all, count);
+}
+
+void Energy::reset() {
+  sim_energy_reset();
+}
+
+// Returned as a "double" array so the Python typemap for
+// Variable::getData turns it into a list.
+variable_string_t Energy::bulk(void (*fill)(double*, int), int count) {
+  if (count < 0) {
+    count = 0;
+  }
+  if (count > TOSSIM_MAX_NODES + 1) {
+    count = TOSSIM_MAX_NODES + 1;
+  }
+  if (count > numValues) {
+    free(values);
+    values = (double*)malloc(sizeof(double) * count);
+    numValues = count;
+  }
+  fill(values, count);
+  str.type = (char*)"double";
+  str.ptr = (char*)values;
+  str.len = sizeof(double) * count;
+  str.isArray = 1;
+  return str;
+}
@@ -0,0 +1,93 @@
+/*
+ * Copyright (c) 2026 The stormport contributors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ *
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the
+ *   distribution.
+ *
+ * - Neither the name of the copyright holders nor the names of
+ *   its contributors may be used to endorse or promote products derived
+ *   from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL
+ * THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ *
+ * Per-platform current table and bulk energy accessors for TOSSIM.
+ * Per-node state times and energies are on the Mote object.
+ * Currents are in mA and energies in mJ.
+ *
+ * The MCU is active from a task post until the task queue is empty,
+ * i.e. for the scheduler's task latency. Event and interrupt handlers
+ * run in zero simulated time, so the time they would take on a mote
+ * is counted as sleep: MCU energy is a lower bound, and is furthest
+ * off for code that does most of its work in handlers.
+ *
+ * @date   Oct 19 2026
+ */
+
+#ifndef ENERGY_H_INCLUDED
+#define ENERGY_H_INCLUDED
+
+#include <tossim.h>
+
+class Energy {
+ public:
+  Energy();
+  ~Energy();
+
+  double voltage();
+  double radioSleepCurrent();
+  double radioListenCurrent();
+  double radioBackoffCurrent();
+  double radioRxCurrent();
+  double radioTxCurrent();
+  double mcuSleepCurrent();
+  double mcuActiveCurrent();
+
+  void setVoltage(double val);
+  void setRadioSleepCurrent(double val);
+  void setRadioListenCurrent(double val);
+  void setRadioBackoffCurrent(double val);
+  void setRadioRxCurrent(double val);
+  void setRadioTxCurrent(double val);
+  void setMcuSleepCurrent(double val);
+  void setMcuActiveCurrent(double val);
+
+  // Lists of per-node values for nodes 0 .. count-1
+  variable_string_t radioEnergies(int count);
+  variable_string_t mcuEnergies(int count);
+  variable_string_t radioDutyCycles(int count);
+
+  void reset();
+
+ private:
+  variable_string_t bulk(void (*fill)(double*, int), int count);
+
+  double* values;
+  int numValues;
+  variable_string_t str;
+};
+
+#endif
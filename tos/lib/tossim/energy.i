@@ -0,0 +1,84 @@
+/*
+ * Copyright (c) 2026 The stormport contributors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ *
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the
+ *   distribution.
+ *
+ * - Neither the name of the copyright holders nor the names of
+ *   its contributors may be used to endorse or promote products derived
+ *   from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL
+ * THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * SWIG interface specification for TOSSIM's energy accounting. This
+ * file defines the Energy object, which holds the current table used
+ * to turn radio and MCU state times into energy and returns per-node
+ * energies for the whole network as lists. Per-node state times are
+ * on the Mote object.
+ *
+ * Note that changing this file only changes the Python interface:
+ * you must also change the underlying TOSSIM code so Python
+ * has the proper functions to call. Look at energy.h, energy.c, and
+ * sim_energy.c.
+ *
+ * @date   Oct 19 2026
+ */
+
+%module TOSSIMEnergy
+
+%{
+#include <energy.h>
+%}
+
+class Energy {
+ public:
+  Energy();
+  ~Energy();
+
+  double voltage();
+  double radioSleepCurrent();
+  double radioListenCurrent();
+  double radioBackoffCurrent();
+  double radioRxCurrent();
+  double radioTxCurrent();
+  double mcuSleepCurrent();
+  double mcuActiveCurrent();
+
+  void setVoltage(double val);
+  void setRadioSleepCurrent(double val);
+  void setRadioListenCurrent(double val);
+  void setRadioBackoffCurrent(double val);
+  void setRadioRxCurrent(double val);
+  void setRadioTxCurrent(double val);
+  void setMcuSleepCurrent(double val);
+  void setMcuActiveCurrent(double val);
+
+  variable_string_t radioEnergies(int count);
+  variable_string_t mcuEnergies(int count);
+  variable_string_t radioDutyCycles(int count);
+
+  void reset();
+};
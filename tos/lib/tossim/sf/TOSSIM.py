@@ -108,6 +108,41 @@ class Radio(_object):
 Radio_swigregister = _TOSSIM.Radio_swigregister
 Radio_swigregister(Radio)
 
+class Energy(_object):
+    __swig_setmethods__ = {}
+    __setattr__ = lambda self, name, value: _swig_setattr(self, Energy, name, value)
+    __swig_getmethods__ = {}
+    __getattr__ = lambda self, name: _swig_getattr(self, Energy, name)
+    __repr__ = _swig_repr
+    def __init__(self, *args): 
+        this = _TOSSIM.new_Energy(*args)
+        try: self.this.append(this)
+        except: self.this = this
+    __swig_destroy__ = _TOSSIM.delete_Energy
+    __del__ = lambda self : None;
+    def voltage(*args): return _TOSSIM.Energy_voltage(*args)
+    def radioSleepCurrent(*args): return _TOSSIM.Energy_radioSleepCurrent(*args)
+    def radioListenCurrent(*args): return _TOSSIM.Energy_radioListenCurrent(*args)
+    def radioBackoffCurrent(*args): return _TOSSIM.Energy_radioBackoffCurrent(*args)
+    def radioRxCurrent(*args): return _TOSSIM.Energy_radioRxCurrent(*args)
+    def radioTxCurrent(*args): return _TOSSIM.Energy_radioTxCurrent(*args)
+    def mcuSleepCurrent(*args): return _TOSSIM.Energy_mcuSleepCurrent(*args)
+    def mcuActiveCurrent(*args): return _TOSSIM.Energy_mcuActiveCurrent(*args)
+    def setVoltage(*args): return _TOSSIM.Energy_setVoltage(*args)
+    def setRadioSleepCurrent(*args): return _TOSSIM.Energy_setRadioSleepCurrent(*args)
+    def setRadioListenCurrent(*args): return _TOSSIM.Energy_setRadioListenCurrent(*args)
+    def setRadioBackoffCurrent(*args): return _TOSSIM.Energy_setRadioBackoffCurrent(*args)
+    def setRadioRxCurrent(*args): return _TOSSIM.Energy_setRadioRxCurrent(*args)
+    def setRadioTxCurrent(*args): return _TOSSIM.Energy_setRadioTxCurrent(*args)
+    def setMcuSleepCurrent(*args): return _TOSSIM.Energy_setMcuSleepCurrent(*args)
+    def setMcuActiveCurrent(*args): return _TOSSIM.Energy_setMcuActiveCurrent(*args)
+    def radioEnergies(*args): return _TOSSIM.Energy_radioEnergies(*args)
+    def mcuEnergies(*args): return _TOSSIM.Energy_mcuEnergies(*args)
+    def radioDutyCycles(*args): return _TOSSIM.Energy_radioDutyCycles(*args)
+    def reset(*args): return _TOSSIM.Energy_reset(*args)
+Energy_swigregister = _TOSSIM.Energy_swigregister
+Energy_swigregister(Energy)
+
 class Packet(_object):
     __swig_setmethods__ = {}
     __setattr__ = lambda self, name, value: _swig_setattr(self, Packet, name, value)
@@ -195,8 +230,14 @@ class Throttle(_object):
     __del__ = lambda self : None;
     def initialize(*args): return _TOSSIM.Throttle_initialize(*args)
     def finalize(*args): return _TOSSIM.Throttle_finalize(*args)
+    def setSpeed(*args): return _TOSSIM.Throttle_setSpeed(*args)
+    def getSpeed(*args): return _TOSSIM.Throttle_getSpeed(*args)
     def checkThrottle(*args): return _TOSSIM.Throttle_checkThrottle(*args)
     def printStatistics(*args): return _TOSSIM.Throttle_printStatistics(*args)
+    def getLag(*args): return _TOSSIM.Throttle_getLag(*args)
+    def getMaxLag(*args): return _TOSSIM.Throttle_getMaxLag(*args)
+    def getAverageLag(*args): return _TOSSIM.Throttle_getAverageLag(*args)
+    def getThrottleCount(*args): return _TOSSIM.Throttle_getThrottleCount(*args)
 Throttle_swigregister = _TOSSIM.Throttle_swigregister
 Throttle_swigregister(Throttle)
 
@@ -294,6 +335,17 @@ class Mote(_object):
     def addNoiseTraceReading(*args): return _TOSSIM.Mote_addNoiseTraceReading(*args)
     def createNoiseModel(*args): return _TOSSIM.Mote_createNoiseModel(*args)
     def generateNoise(*args): return _TOSSIM.Mote_generateNoise(*args)
+    def radioSleepTime(*args): return _TOSSIM.Mote_radioSleepTime(*args)
+    def radioListenTime(*args): return _TOSSIM.Mote_radioListenTime(*args)
+    def radioBackoffTime(*args): return _TOSSIM.Mote_radioBackoffTime(*args)
+    def radioRxTime(*args): return _TOSSIM.Mote_radioRxTime(*args)
+    def radioTxTime(*args): return _TOSSIM.Mote_radioTxTime(*args)
+    def radioDutyCycle(*args): return _TOSSIM.Mote_radioDutyCycle(*args)
+    def mcuSleepTime(*args): return _TOSSIM.Mote_mcuSleepTime(*args)
+    def mcuActiveTime(*args): return _TOSSIM.Mote_mcuActiveTime(*args)
+    def radioEnergy(*args): return _TOSSIM.Mote_radioEnergy(*args)
+    def mcuEnergy(*args): return _TOSSIM.Mote_mcuEnergy(*args)
+    def energy(*args): return _TOSSIM.Mote_energy(*args)
 Mote_swigregister = _TOSSIM.Mote_swigregister
 Mote_swigregister(Mote)
 
@@ -319,10 +371,17 @@ class Tossim(_object):
     def setCurrentNode(*args): return _TOSSIM.Tossim_setCurrentNode(*args)
     def addChannel(*args): return _TOSSIM.Tossim_addChannel(*args)
     def removeChannel(*args): return _TOSSIM.Tossim_removeChannel(*args)
+    def startCapture(*args): return _TOSSIM.Tossim_startCapture(*args)
+    def stopCapture(*args): return _TOSSIM.Tossim_stopCapture(*args)
+    def flushCapture(*args): return _TOSSIM.Tossim_flushCapture(*args)
+    def captureNode(*args): return _TOSSIM.Tossim_captureNode(*args)
+    def captureType(*args): return _TOSSIM.Tossim_captureType(*args)
+    def clearCaptureFilter(*args): return _TOSSIM.Tossim_clearCaptureFilter(*args)
     def randomSeed(*args): return _TOSSIM.Tossim_randomSeed(*args)
     def runNextEvent(*args): return _TOSSIM.Tossim_runNextEvent(*args)
     def mac(*args): return _TOSSIM.Tossim_mac(*args)
     def radio(*args): return _TOSSIM.Tossim_radio(*args)
+    def energy(*args): return _TOSSIM.Tossim_energy(*args)
     def newPacket(*args): return _TOSSIM.Tossim_newPacket(*args)
     def newSerialPacket(*args): return _TOSSIM.Tossim_newSerialPacket(*args)
 Tossim_swigregister = _TOSSIM.Tossim_swigregister
@@ -37,81 +37,172 @@
  *
  */
 
+#include <stdio.h>
+#include <sys/select.h>
+
 #include "Throttle.h"
+#include "sim_event_queue.h"
+#include "sim_serial_forwarder.h"
 
 Throttle::Throttle(Tossim* tossim, const int ms = 10) : 
-    sim(tossim), simStartTime(0.0), simEndTime(0.0), simPace(0), throttleCount(0) {
+    simStartTime(0.0), simEndTime(0.0), simPace(0.0), speed(1.0),
+    wallBase(0.0), simBase(0), sim(tossim), throttleCount(0), lagCount(0),
+    sfWakeups(0), sleepTotal(0.0), lastLag(0.0), maxLag(0.0), lagTotal(0.0) {
 
-        // Convert milliseconds to sim_time_t 
-        simPace =  ms * 10000000ULL;
+        // How far (in seconds) the simulation may run ahead of the wall
+        // clock before we sleep. 0 paces every event.
+        simPace = (ms > 0) ? ms / 1000.0 : 0.0;
 }
 
 Throttle::~Throttle() {}
 
 void Throttle::initialize() {
     simStartTime = getTime();
+    rebase();
 }
 
 void Throttle::finalize() {
     simEndTime = getTime();
 }
 
+void Throttle::setSpeed(double factor) {
+    speed = factor;
+    // Measure from here, so changing speed mid-run does not jump
+    rebase();
+}
+
+double Throttle::getSpeed() {
+    return speed;
+}
+
 void Throttle::checkThrottle() {
-    
-    double secondsElasped = getTime() - simStartTime;
-    sim_time_t ticksElasped = (sim_time_t) secondsElasped*sim->ticksPerSecond();
 
-    sim_time_t difference = sim->time() - ticksElasped;
+    if (speed <= 0.0) {
+        return;
+    }
+
+    // Pace against the event about to run, not the one that just did
+    double target = wallTimeAt(nextEventTime());
+    double now = getTime();
+    double ahead = target - now;
 
-    if (difference > simPace) {
+    if (ahead > simPace) {
         throttleCount++;
-        double sleepDifference = (double) difference / sim->ticksPerSecond();
-        simSleep(sleepDifference);
+        simSleep(ahead);
+        lastLag = 0.0;
+    }
+    else if (ahead < 0.0) {
+        lastLag = -ahead;
+        lagCount++;
+        lagTotal += lastLag;
+        if (lastLag > maxLag) {
+            maxLag = lastLag;
+        }
+    }
+    else {
+        lastLag = 0.0;
     }
-
 }
 
-inline double Throttle::toDouble(struct timeval* tv) {
-    return tv->tv_sec + tv->tv_usec/1e6;
+inline double Throttle::toDouble(struct timespec* ts) {
+    return ts->tv_sec + ts->tv_nsec/1e9;
 }
 
 double Throttle::getTime() {
-    struct timeval tv;
-    gettimeofday (&tv, NULL);
-    return toDouble(&tv);  
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return toDouble(&ts);  
+}
+
+void Throttle::rebase() {
+    wallBase = getTime();
+    simBase = sim->time();
+}
+
+double Throttle::wallTimeAt(sim_time_t t) {
+    return wallBase + (double)(t - simBase) / sim->ticksPerSecond() / speed;
+}
+
+sim_time_t Throttle::simTimeAt(double wall) {
+    return simBase + (sim_time_t)((wall - wallBase) * speed * sim->ticksPerSecond());
+}
+
+sim_time_t Throttle::nextEventTime() {
+    sim_time_t next = sim_queue_peek_time();
+    sim_time_t now = sim->time();
+    return (next < now) ? now : next;
 }
 
 int Throttle::simSleep(double seconds) {
 
-     struct timespec tv;
-     /* Construct the timespec from the number of whole seconds... */
-     tv.tv_sec = (time_t) seconds;
-     /* ... and the remainder in nanoseconds. */
-     tv.tv_nsec = (long) ((seconds - tv.tv_sec) * 1e+9);
+    double start = getTime();
+    double target = start + seconds;
+
+    while (1)
+    {
+        fd_set rfds;
+        struct timeval tv;
+        double remaining = target - getTime();
+        int maxfd;
+        int rval;
+
+        if (remaining <= 0.0)
+            break;
+
+        tv.tv_sec = (time_t) remaining;
+        tv.tv_usec = (suseconds_t) ((remaining - tv.tv_sec) * 1e6);
+
+        FD_ZERO(&rfds);
+        maxfd = sim_sf_wait_fds(&rfds);
+
+        rval = select(maxfd + 1, (maxfd >= 0) ? &rfds : NULL, NULL, NULL, &tv);
+
+        if (rval > 0) {
+            /* Serial forwarder activity: hand injected packets to the
+               simulation at the time they really arrived, then recompute
+               the deadline since they may have scheduled an earlier event. */
+            sim_time_t when = simTimeAt(getTime());
+            sim_time_t next = nextEventTime();
+            if (when > next)
+                when = next;
+            sim_sf_process_fds(&rfds, when);
+            sfWakeups++;
+            target = wallTimeAt(nextEventTime());
+        }
+        else if (rval < 0 && errno != EINTR) {
+            /* Some other error; bail out. */
+            sleepTotal += getTime() - start;
+            return rval;
+        }
+    }
+
+    sleepTotal += getTime() - start;
+    return 0;
+}
+
+double Throttle::getLag() {
+    return lastLag;
+}
 
-     while (1)
-     {
-         /* Sleep for the time specified in tv. If interrupted by a
-         signal, place the remaining time left to sleep back into tv. */
-         int rval = nanosleep (&tv, &tv);
+double Throttle::getMaxLag() {
+    return maxLag;
+}
 
-         if (rval == 0)
-             /* Completed the entire sleep time; all done. */
-             return 0;
-         else if (errno == EINTR)
-             /* Interrupted by a signal. Try again. */
-             continue;
-         else 
-             /* Some other error; bail out. */
-             return rval;
-     }
+double Throttle::getAverageLag() {
+    return lagCount ? lagTotal / lagCount : 0.0;
+}
 
-     return 0;
+unsigned long Throttle::getThrottleCount() {
+    return throttleCount;
 }
 
 void Throttle::printStatistics() {
 
     printf("Number of throttle events %lu\n", throttleCount);
+    printf("Time spent sleeping: %.6f\n", sleepTotal);
+    printf("Serial forwarder wakeups while sleeping: %lu\n", sfWakeups);
+    printf("Number of late events %lu (max lag %.6f, average lag %.6f)\n",
+           lagCount, maxLag, getAverageLag());
 
     if (simEndTime > 0.0) {
         printf("Total Sim Time: %.6f\n", simEndTime - simStartTime);
@@ -35,6 +35,14 @@
  *
  * A simple Throttle to slow a simulation to near real time.
  *
+ * The throttle paces the simulation against the monotonic clock. The
+ * speed is a time-warp factor: 1.0 is real time, 2.0 runs the simulation
+ * twice as fast as real time, 0.5 half as fast, and 0 (or anything
+ * negative) disables pacing so the simulation runs at full speed. While
+ * the throttle sleeps it waits on the serial forwarder sockets, so that
+ * injected packets are delivered at the simulation time matching their
+ * real arrival time.
+ *
  */
 #ifndef  _THROTTLE_H_
 #define  _THROTTLE_H_
@@ -55,21 +63,44 @@ class Throttle {
         void initialize();
         void finalize();
 
+        void setSpeed(double factor);
+        double getSpeed();
+
         void checkThrottle();
         void printStatistics();
 
+        double getLag();
+        double getMaxLag();
+        double getAverageLag();
+        unsigned long getThrottleCount();
+
     private:
 
         double simStartTime;
         double simEndTime;
-        sim_time_t simPace;
+        double simPace;
+        double speed;
+
+        // The wall clock and simulation times pacing is measured from
+        double wallBase;
+        sim_time_t simBase;
 
         Tossim* sim;
 
         unsigned long throttleCount;
+        unsigned long lagCount;
+        unsigned long sfWakeups;
+        double sleepTotal;
+        double lastLag;
+        double maxLag;
+        double lagTotal;
 
         double getTime();
-        double toDouble(struct timeval* tv);
+        double toDouble(struct timespec* ts);
+        void rebase();
+        double wallTimeAt(sim_time_t t);
+        sim_time_t simTimeAt(double wall);
+        sim_time_t nextEventTime();
         int simSleep(double seconds);
 };
 #endif   // ----- #ifndef _THROTTLE_H_  ----- 
@@ -54,7 +54,15 @@ class Throttle {
         void initialize();
         void finalize();
 
+        void setSpeed(double factor);
+        double getSpeed();
+
         void checkThrottle();
         void printStatistics();
 
+        double getLag();
+        double getMaxLag();
+        double getAverageLag();
+        unsigned long getThrottleCount();
+
 };
@@ -88,6 +88,8 @@ extern uint16_t TOS_NODE_ID;
 #include <sim_tossim.h>
 #include <sim_mote.h>
 #include <sim_log.h>
+#include <sim_energy.h>
+#include <sim_pcap.h>
 
 // We only want to include these files if we are compiling TOSSIM proper,
 // that is, the C file representing the TinyOS application. The TinyOS
@@ -105,6 +107,8 @@ struct @exactlyonce { };
 #include <sim_tossim.c>
 #include <sim_mac.c>
 #include <sim_packet.c>
+#include <sim_energy.c>
+#include <sim_pcap.c>
 #include <sim_serial_packet.c>
 #endif
 
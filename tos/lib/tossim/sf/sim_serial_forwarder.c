@@ -54,7 +54,7 @@
 #include "sim_tossim.h"
 
 struct sim_sf_client_list *sim_sf_clients;
-int sim_sf_server_socket;
+int sim_sf_server_socket = -1;
 int sim_sf_packets_read, sim_sf_packets_written, sim_sf_num_clients;
 
 int sim_sf_unix_check(const char *msg, int result)
@@ -126,6 +126,11 @@ void sim_sf_new_client(int fd)
 }
 
 void sim_sf_check_clients(fd_set *fds)
+{
+    sim_sf_check_clients_at(fds, sim_time());
+}
+
+void sim_sf_check_clients_at(fd_set *fds, sim_time_t when)
 {
     struct sim_sf_client_list **c;
 
@@ -140,7 +145,7 @@ void sim_sf_check_clients(fd_set *fds)
 
             if (packet)
             {
-                sim_sf_forward_packet(packet, len);
+                sim_sf_forward_packet_at(packet, len, when);
                 free((void *)packet);
             }
             else
@@ -211,6 +216,11 @@ void sim_sf_check_new_client(void)
 }
 
 void sim_sf_forward_packet(const void *packet, int len)
+{
+    sim_sf_forward_packet_at(packet, len, sim_time());
+}
+
+void sim_sf_forward_packet_at(const void *packet, int len, sim_time_t when)
 {
     char* forwardPacket = (char*)packet + 1;
 
@@ -218,32 +228,53 @@ void sim_sf_forward_packet(const void *packet, int len)
 
     sim_serial_packet_deliver(addr, 
                              (struct sim_serial_packet*)forwardPacket,
-                             sim_time());
+                             when);
     sim_sf_packets_read++;
 }
 
+int sim_sf_wait_fds(fd_set *fds)
+/* Effects: adds the server socket and every client socket to fds, so
+     callers that block (e.g., the Throttle) can wake up on serial
+     forwarder activity
+   Returns: the highest file descriptor added, or -1 if there are none
+*/
+{
+    int maxfd = -1;
+
+    if (sim_sf_server_socket >= 0)
+        sim_sf_fd_wait(fds, &maxfd, sim_sf_server_socket);
+    sim_sf_wait_clients(fds, &maxfd);
+
+    return maxfd;
+}
+
+void sim_sf_process_fds(fd_set *fds, sim_time_t when)
+/* Effects: accepts new clients and reads packets from the sockets in fds
+     that are ready, delivering injected packets at simulation time when
+*/
+{
+    if (sim_sf_server_socket >= 0 && FD_ISSET(sim_sf_server_socket, fds))
+        sim_sf_check_new_client();
+
+    sim_sf_check_clients_at(fds, when);
+}
+
 void sim_sf_process ()
 {
 
         fd_set rfds;
-        int maxfd = -1;
+        int maxfd;
         struct timeval zero;
         int ret;
 
         zero.tv_sec = zero.tv_usec = 0;
 
         FD_ZERO(&rfds);
-        sim_sf_fd_wait(&rfds, &maxfd, sim_sf_server_socket);
-        sim_sf_wait_clients(&rfds, &maxfd);
+        maxfd = sim_sf_wait_fds(&rfds);
 
         ret = select(maxfd + 1, &rfds, NULL, NULL, &zero);
         if (ret >= 0)
-        {
-            if (FD_ISSET(sim_sf_server_socket, &rfds))
-                sim_sf_check_new_client();
-
-            sim_sf_check_clients(&rfds);
-        }
+            sim_sf_process_fds(&rfds, sim_time());
 }
 
 int sim_sf_saferead(int fd, void *buffer, int count)
@@ -40,6 +40,8 @@
 #ifndef  _SIM_SERIAL_FORWARDER_H_
 #define  _SIM_SERIAL_FORWARDER_H_
 #include <sys/types.h>
+#include <sys/select.h>
+#include "sim_tossim.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -55,6 +57,8 @@ void sim_sf_forward_packet(const void *packet, int len);
 void sim_sf_dispatch_packet(const void *packet, int len);
 void sim_sf_open_server_socket(int port);
 void sim_sf_process ();
+int sim_sf_wait_fds(fd_set *fds);
+void sim_sf_process_fds(fd_set *fds, sim_time_t when);
 
 int sim_sf_unix_check(const char *msg, int result);
 void *sim_sf_xmalloc(size_t s);
@@ -64,9 +68,11 @@ void sim_sf_add_client(int fd);
 void sim_sf_rem_client(struct sim_sf_client_list **c);
 void sim_sf_new_client(int fd);
 void sim_sf_check_clients(fd_set *fds);
+void sim_sf_check_clients_at(fd_set *fds, sim_time_t when);
 void sim_sf_wait_clients(fd_set *fds, int *maxfd);
 void sim_sf_check_new_client(void);
 void sim_sf_forward_packet(const void *packet, int len);
+void sim_sf_forward_packet_at(const void *packet, int len, sim_time_t when);
 int sim_sf_saferead(int fd, void *buffer, int count);
 int sim_sf_safewrite(int fd, const void *buffer, int count);
 int sim_sf_open_source(const char *host, int port);
@@ -45,6 +45,7 @@
 #include <tossim.h>
 #include <sim_tossim.h>
 #include <sim_mote.h>
+#include <sim_pcap.h>
 #include <stdlib.h>
 #include <stdio.h>
 #include <string.h>
@@ -53,6 +54,7 @@
 #include <mac.c>
 #include <radio.c>
 #include <packet.c>
+#include <energy.c>
 #include <SerialPacket.c>
 #include <sim_noise.h>
 
@@ -175,6 +177,54 @@ void Mote::setID(unsigned long val) {
   nodeID = val;
 }
 
+static double toSeconds(sim_time_t ticks) {
+  return (double)ticks / sim_ticks_per_sec();
+}
+
+double Mote::radioSleepTime() {
+  return toSeconds(sim_energy_radio_time(nodeID, SIM_RADIO_SLEEP));
+}
+
+double Mote::radioListenTime() {
+  return toSeconds(sim_energy_radio_time(nodeID, SIM_RADIO_LISTEN));
+}
+
+double Mote::radioBackoffTime() {
+  return toSeconds(sim_energy_radio_time(nodeID, SIM_RADIO_BACKOFF));
+}
+
+double Mote::radioRxTime() {
+  return toSeconds(sim_energy_radio_time(nodeID, SIM_RADIO_RX));
+}
+
+double Mote::radioTxTime() {
+  return toSeconds(sim_energy_radio_time(nodeID, SIM_RADIO_TX));
+}
+
+double Mote::radioDutyCycle() {
+  return sim_energy_radio_duty_cycle(nodeID);
+}
+
+double Mote::mcuSleepTime() {
+  return toSeconds(sim_energy_mcu_time(nodeID, SIM_MCU_SLEEP));
+}
+
+double Mote::mcuActiveTime() {
+  return toSeconds(sim_energy_mcu_time(nodeID, SIM_MCU_ACTIVE));
+}
+
+double Mote::radioEnergy() {
+  return sim_energy_radio(nodeID);
+}
+
+double Mote::mcuEnergy() {
+  return sim_energy_mcu(nodeID);
+}
+
+double Mote::energy() {
+  return radioEnergy() + mcuEnergy();
+}
+
 Variable* Mote::getVariable(char* name) {
   char* typeStr = (char*)"";
   int isArray;
@@ -280,6 +330,30 @@ bool Tossim::removeChannel(char* channel, FILE* file) {
   return sim_remove_channel(channel, file);
 }
 
+bool Tossim::startCapture(char* path) {
+  return sim_pcap_open(path);
+}
+
+void Tossim::stopCapture() {
+  sim_pcap_close();
+}
+
+void Tossim::flushCapture() {
+  sim_pcap_flush();
+}
+
+void Tossim::captureNode(unsigned long nodeID) {
+  sim_pcap_filter_node(nodeID, true);
+}
+
+void Tossim::captureType(int type) {
+  sim_pcap_filter_type(type, true);
+}
+
+void Tossim::clearCaptureFilter() {
+  sim_pcap_filter_clear();
+}
+
 void Tossim::randomSeed(int seed) {
   return sim_random_seed(seed);
 }
@@ -296,6 +370,10 @@ Radio* Tossim::radio() {
   return new Radio();
 }
 
+Energy* Tossim::energy() {
+  return new Energy();
+}
+
 Packet* Tossim::newPacket() {
   return new Packet();
 }
@@ -52,6 +52,8 @@
 #include <SerialPacket.h>
 #include <hashtable.h>
 
+class Energy;
+
 typedef struct variable_string {
   char* type;
   char* ptr;
@@ -107,6 +109,18 @@ class Mote {
   int generateNoise(int when);
   
   Variable* getVariable(char* name);
+
+  double radioSleepTime();
+  double radioListenTime();
+  double radioBackoffTime();
+  double radioRxTime();
+  double radioTxTime();
+  double radioDutyCycle();
+  double mcuSleepTime();
+  double mcuActiveTime();
+  double radioEnergy();
+  double mcuEnergy();
+  double energy();
   
  private:
   unsigned long nodeID;
@@ -132,12 +146,21 @@ class Tossim {
 
   void addChannel(char* channel, FILE* file);
   bool removeChannel(char* channel, FILE* file);
+
+  // 802.15.4 pcapng capture of radio traffic
+  bool startCapture(char* path);
+  void stopCapture();
+  void flushCapture();
+  void captureNode(unsigned long nodeID);
+  void captureType(int type);
+  void clearCaptureFilter();
   void randomSeed(int seed);
   
   bool runNextEvent();
 
   MAC* mac();
   Radio* radio();
+  Energy* energy();
   Packet* newPacket();
   SerialPacket* newSerialPacket();
 
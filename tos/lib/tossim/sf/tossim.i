@@ -241,6 +241,7 @@ PyObject* listFromArray(char* type, char* ptr, int len) {
 
 %include mac.i
 %include radio.i
+%include energy.i
 %include packet.i
 %include SerialPacket.i
 %include SerialForwarder.i
@@ -368,6 +369,18 @@ class Mote {
   void addNoiseTraceReading(int val);
   void createNoiseModel();
   int generateNoise(int when);
+
+  double radioSleepTime();
+  double radioListenTime();
+  double radioBackoffTime();
+  double radioRxTime();
+  double radioTxTime();
+  double radioDutyCycle();
+  double mcuSleepTime();
+  double mcuActiveTime();
+  double radioEnergy();
+  double mcuEnergy();
+  double energy();
 };
 
 class Tossim {
@@ -388,11 +401,19 @@ class Tossim {
 
   void addChannel(char* channel, FILE* file);
   bool removeChannel(char* channel, FILE* file);
+
+  bool startCapture(char* path);
+  void stopCapture();
+  void flushCapture();
+  void captureNode(unsigned long nodeID);
+  void captureType(int type);
+  void clearCaptureFilter();
   void randomSeed(int seed);
 
   bool runNextEvent();
   MAC* mac();
   Radio* radio();
+  Energy* energy();
   Packet* newPacket();
   SerialPacket* newSerialPacket();
 };
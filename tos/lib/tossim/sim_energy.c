@@ -0,0 +1,255 @@
+/*
+ * Copyright (c) 2026 The stormport contributors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ *
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the
+ *   distribution.
+ *
+ * - Neither the name of the copyright holders nor the names of
+ *   its contributors may be used to endorse or promote products derived
+ *   from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL
+ * THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ *
+ * Radio and MCU state-time accounting for TOSSIM.
+ *
+ * @date   Oct 19 2026
+ */
+
+#include <sim_energy.h>
+
+typedef struct sim_energy_node {
+  bool on;
+  uint8_t radioState;
+  uint8_t radioResume;   // State to return to when a reception ends
+  uint8_t mcuState;
+  sim_time_t since;      // Start of the interval in progress
+  sim_time_t radioTicks[SIM_RADIO_STATES];
+  sim_time_t mcuTicks[SIM_MCU_STATES];
+} sim_energy_node_t;
+
+sim_energy_node_t energyNodes[TOSSIM_MAX_NODES + 1];
+
+double energyVoltage = SIM_ENERGY_VOLTAGE;
+double energyRadioCurrent[SIM_RADIO_STATES] = {
+  SIM_ENERGY_RADIO_SLEEP_CURRENT,
+  SIM_ENERGY_RADIO_LISTEN_CURRENT,
+  SIM_ENERGY_RADIO_BACKOFF_CURRENT,
+  SIM_ENERGY_RADIO_RX_CURRENT,
+  SIM_ENERGY_RADIO_TX_CURRENT,
+};
+double energyMcuCurrent[SIM_MCU_STATES] = {
+  SIM_ENERGY_MCU_SLEEP_CURRENT,
+  SIM_ENERGY_MCU_ACTIVE_CURRENT,
+};
+
+static sim_energy_node_t* sim_energy_node(int mote) {
+  if (mote < 0 || mote > TOSSIM_MAX_NODES) {
+    mote = TOSSIM_MAX_NODES;
+  }
+  return &energyNodes[mote];
+}
+
+/* Charge the time since the last transition to the current states. */
+static void sim_energy_account(sim_energy_node_t* n) {
+  sim_time_t now = sim_time();
+  if (n->on && now > n->since) {
+    n->radioTicks[n->radioState] += now - n->since;
+    n->mcuTicks[n->mcuState] += now - n->since;
+  }
+  n->since = now;
+}
+
+void sim_energy_node_power(int mote, bool on) __attribute__ ((C, spontaneous)) {
+  sim_energy_node_t* n = sim_energy_node(mote);
+  sim_energy_account(n);
+  n->on = on;
+  // A node boots with the radio off and the MCU running
+  n->radioState = SIM_RADIO_SLEEP;
+  n->radioResume = SIM_RADIO_SLEEP;
+  n->mcuState = on? SIM_MCU_ACTIVE : SIM_MCU_SLEEP;
+  dbg("Energy", "Node %i powered %s.\n", mote, on? "on" : "off");
+}
+
+void sim_energy_radio_state(int mote, int state) __attribute__ ((C, spontaneous)) {
+  sim_energy_node_t* n = sim_energy_node(mote);
+  if (state < 0 || state >= SIM_RADIO_STATES || n->radioState == state) {
+    return;
+  }
+  sim_energy_account(n);
+  dbg("Energy", "Radio state %i -> %i.\n", (int)n->radioState, state);
+  n->radioState = state;
+}
+
+void sim_energy_radio_rx_start(int mote) __attribute__ ((C, spontaneous)) {
+  sim_energy_node_t* n = sim_energy_node(mote);
+  // Only a radio that is on and not sending can lock on to a packet
+  if (n->radioState == SIM_RADIO_LISTEN || n->radioState == SIM_RADIO_BACKOFF) {
+    n->radioResume = n->radioState;
+    sim_energy_radio_state(mote, SIM_RADIO_RX);
+  }
+}
+
+void sim_energy_radio_rx_end(int mote) __attribute__ ((C, spontaneous)) {
+  sim_energy_node_t* n = sim_energy_node(mote);
+  if (n->radioState == SIM_RADIO_RX) {
+    sim_energy_radio_state(mote, n->radioResume);
+  }
+}
+
+void sim_energy_mcu_state(int mote, int state) __attribute__ ((C, spontaneous)) {
+  sim_energy_node_t* n = sim_energy_node(mote);
+  if (state < 0 || state >= SIM_MCU_STATES || n->mcuState == state) {
+    return;
+  }
+  sim_energy_account(n);
+  n->mcuState = state;
+}
+
+int sim_energy_get_radio_state(int mote) __attribute__ ((C, spontaneous)) {
+  return sim_energy_node(mote)->radioState;
+}
+
+int sim_energy_get_mcu_state(int mote) __attribute__ ((C, spontaneous)) {
+  return sim_energy_node(mote)->mcuState;
+}
+
+sim_time_t sim_energy_radio_time(int mote, int state) __attribute__ ((C, spontaneous)) {
+  sim_energy_node_t* n = sim_energy_node(mote);
+  if (state < 0 || state >= SIM_RADIO_STATES) {
+    return 0;
+  }
+  sim_energy_account(n);
+  return n->radioTicks[state];
+}
+
+sim_time_t sim_energy_mcu_time(int mote, int state) __attribute__ ((C, spontaneous)) {
+  sim_energy_node_t* n = sim_energy_node(mote);
+  if (state < 0 || state >= SIM_MCU_STATES) {
+    return 0;
+  }
+  sim_energy_account(n);
+  return n->mcuTicks[state];
+}
+
+double sim_energy_radio(int mote) __attribute__ ((C, spontaneous)) {
+  sim_energy_node_t* n = sim_energy_node(mote);
+  double charge = 0.0;
+  int i;
+  sim_energy_account(n);
+  for (i = 0; i < SIM_RADIO_STATES; i++) {
+    charge += energyRadioCurrent[i] * (double)n->radioTicks[i];
+  }
+  return energyVoltage * charge / sim_ticks_per_sec();
+}
+
+double sim_energy_mcu(int mote) __attribute__ ((C, spontaneous)) {
+  sim_energy_node_t* n = sim_energy_node(mote);
+  double charge = 0.0;
+  int i;
+  sim_energy_account(n);
+  for (i = 0; i < SIM_MCU_STATES; i++) {
+    charge += energyMcuCurrent[i] * (double)n->mcuTicks[i];
+  }
+  return energyVoltage * charge / sim_ticks_per_sec();
+}
+
+/* Fraction of powered-on time the radio was not asleep. */
+double sim_energy_radio_duty_cycle(int mote) __attribute__ ((C, spontaneous)) {
+  sim_energy_node_t* n = sim_energy_node(mote);
+  sim_time_t total = 0;
+  int i;
+  sim_energy_account(n);
+  for (i = 0; i < SIM_RADIO_STATES; i++) {
+    total += n->radioTicks[i];
+  }
+  if (total == 0) {
+    return 0.0;
+  }
+  return (double)(total - n->radioTicks[SIM_RADIO_SLEEP]) / (double)total;
+}
+
+void sim_energy_radio_all(double* out, int count) __attribute__ ((C, spontaneous)) {
+  int i;
+  for (i = 0; i < count && i <= TOSSIM_MAX_NODES; i++) {
+    out[i] = sim_energy_radio(i);
+  }
+}
+
+void sim_energy_mcu_all(double* out, int count) __attribute__ ((C, spontaneous)) {
+  int i;
+  for (i = 0; i < count && i <= TOSSIM_MAX_NODES; i++) {
+    out[i] = sim_energy_mcu(i);
+  }
+}
+
+void sim_energy_radio_duty_cycle_all(double* out, int count) __attribute__ ((C, spontaneous)) {
+  int i;
+  for (i = 0; i < count && i <= TOSSIM_MAX_NODES; i++) {
+    out[i] = sim_energy_radio_duty_cycle(i);
+  }
+}
+
+/* Discard accumulated times, keeping every node's current state. */
+void sim_energy_reset() __attribute__ ((C, spontaneous)) {
+  int i;
+  for (i = 0; i <= TOSSIM_MAX_NODES; i++) {
+    sim_energy_node_t* n = &energyNodes[i];
+    memset(n->radioTicks, 0, sizeof(n->radioTicks));
+    memset(n->mcuTicks, 0, sizeof(n->mcuTicks));
+    n->since = sim_time();
+  }
+}
+
+double sim_energy_voltage() __attribute__ ((C, spontaneous)) {
+  return energyVoltage;
+}
+double sim_energy_radio_current(int state) __attribute__ ((C, spontaneous)) {
+  if (state < 0 || state >= SIM_RADIO_STATES) {
+    return 0.0;
+  }
+  return energyRadioCurrent[state];
+}
+double sim_energy_mcu_current(int state) __attribute__ ((C, spontaneous)) {
+  if (state < 0 || state >= SIM_MCU_STATES) {
+    return 0.0;
+  }
+  return energyMcuCurrent[state];
+}
+
+void sim_energy_set_voltage(double val) __attribute__ ((C, spontaneous)) {
+  energyVoltage = val;
+}
+void sim_energy_set_radio_current(int state, double val) __attribute__ ((C, spontaneous)) {
+  if (state >= 0 && state < SIM_RADIO_STATES) {
+    energyRadioCurrent[state] = val;
+  }
+}
+void sim_energy_set_mcu_current(int state, double val) __attribute__ ((C, spontaneous)) {
+  if (state >= 0 && state < SIM_MCU_STATES) {
+    energyMcuCurrent[state] = val;
+  }
+}
@@ -0,0 +1,143 @@
+/*
+ * Copyright (c) 2026 The stormport contributors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ *
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the
+ *   distribution.
+ *
+ * - Neither the name of the copyright holders nor the names of
+ *   its contributors may be used to endorse or promote products derived
+ *   from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL
+ * THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ *
+ * Radio and MCU state-time accounting for TOSSIM. The radio stack
+ * (TossimPacketModelC, CpmModelC) and the scheduler report state
+ * transitions; this file integrates the time each node spends in
+ * each state and turns it into energy using a per-platform current
+ * table. The default currents model a micaz (CC2420 + ATmega128L);
+ * other platforms can override them with -D flags or at run time
+ * through the Energy object.
+ *
+ * @date   Oct 19 2026
+ */
+
+#ifndef SIM_ENERGY_H_INCLUDED
+#define SIM_ENERGY_H_INCLUDED
+
+#include <sim_tossim.h>
+
+enum {
+  SIM_RADIO_SLEEP   = 0, // Radio off (Control.stop)
+  SIM_RADIO_LISTEN  = 1, // Radio on, idle listening
+  SIM_RADIO_BACKOFF = 2, // CSMA backoff and clear channel sampling
+  SIM_RADIO_RX      = 3, // Receiving a packet
+  SIM_RADIO_TX      = 4, // Transmitting a packet (and awaiting its ack)
+  SIM_RADIO_STATES  = 5,
+};
+
+enum {
+  SIM_MCU_SLEEP     = 0, // Task queue empty
+  SIM_MCU_ACTIVE    = 1, // Tasks pending or running; handlers take no time
+  SIM_MCU_STATES    = 2,
+};
+
+// Currents are in mA, so times in seconds give energy in mJ
+
+#ifndef SIM_ENERGY_VOLTAGE
+#define SIM_ENERGY_VOLTAGE 3.0
+#endif
+
+#ifndef SIM_ENERGY_RADIO_SLEEP_CURRENT
+#define SIM_ENERGY_RADIO_SLEEP_CURRENT 0.02
+#endif
+
+#ifndef SIM_ENERGY_RADIO_LISTEN_CURRENT
+#define SIM_ENERGY_RADIO_LISTEN_CURRENT 19.7
+#endif
+
+#ifndef SIM_ENERGY_RADIO_BACKOFF_CURRENT
+#define SIM_ENERGY_RADIO_BACKOFF_CURRENT SIM_ENERGY_RADIO_LISTEN_CURRENT
+#endif
+
+#ifndef SIM_ENERGY_RADIO_RX_CURRENT
+#define SIM_ENERGY_RADIO_RX_CURRENT 19.7
+#endif
+
+// 0 dBm
+#ifndef SIM_ENERGY_RADIO_TX_CURRENT
+#define SIM_ENERGY_RADIO_TX_CURRENT 17.4
+#endif
+
+#ifndef SIM_ENERGY_MCU_SLEEP_CURRENT
+#define SIM_ENERGY_MCU_SLEEP_CURRENT 0.015
+#endif
+
+#ifndef SIM_ENERGY_MCU_ACTIVE_CURRENT
+#define SIM_ENERGY_MCU_ACTIVE_CURRENT 8.0
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+  // State transitions, called from the simulated node's context
+  void sim_energy_node_power(int mote, bool on);
+  void sim_energy_radio_state(int mote, int state);
+  void sim_energy_radio_rx_start(int mote);
+  void sim_energy_radio_rx_end(int mote);
+  void sim_energy_mcu_state(int mote, int state);
+  int sim_energy_get_radio_state(int mote);
+  int sim_energy_get_mcu_state(int mote);
+
+  // Accumulated ticks, including the interval in progress
+  sim_time_t sim_energy_radio_time(int mote, int state);
+  sim_time_t sim_energy_mcu_time(int mote, int state);
+
+  // Energy in mJ
+  double sim_energy_radio(int mote);
+  double sim_energy_mcu(int mote);
+  double sim_energy_radio_duty_cycle(int mote);
+
+  // Bulk accessors: fill out[0..count-1] for nodes 0..count-1
+  void sim_energy_radio_all(double* out, int count);
+  void sim_energy_mcu_all(double* out, int count);
+  void sim_energy_radio_duty_cycle_all(double* out, int count);
+
+  void sim_energy_reset();
+
+  double sim_energy_voltage();
+  double sim_energy_radio_current(int state);
+  double sim_energy_mcu_current(int state);
+  void sim_energy_set_voltage(double val);
+  void sim_energy_set_radio_current(int state, double val);
+  void sim_energy_set_mcu_current(int state, double val);
+
+#ifdef __cplusplus
+}
+#endif
+  
+#endif // SIM_ENERGY_H_INCLUDED
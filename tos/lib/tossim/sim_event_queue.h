@@ -47,6 +47,10 @@
 
 #include <sim_tossim.h>
 
+#ifdef __cplusplus
+extern "C" {
+#endif
+
 struct sim_event;
 typedef struct sim_event sim_event_t;
 
@@ -75,5 +79,8 @@ void sim_queue_cleanup_event(sim_event_t* e);
 void sim_queue_cleanup_data(sim_event_t* e) ;
 void sim_queue_cleanup_total(sim_event_t* e);
 
+#ifdef __cplusplus
+}
+#endif
 
 #endif // EVENT_QUEUE_H_INCLUDED
@@ -0,0 +1,361 @@
+/*
+ * Copyright (c) 2026 The stormport contributors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ *
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the
+ *   distribution.
+ *
+ * - Neither the name of the copyright holders nor the names of
+ *   its contributors may be used to endorse or promote products derived
+ *   from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL
+ * THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ *
+ * pcapng writer for simulated 802.15.4 traffic.
+ *
+ * @date   Oct 19 2026
+ */
+
+#include <sim_pcap.h>
+
+enum {
+  PCAPNG_SHB = 0x0A0D0D0A,
+  PCAPNG_IDB = 0x00000001,
+  PCAPNG_EPB = 0x00000006,
+  PCAPNG_BOM = 0x1A2B3C4D,
+  PCAPNG_OPT_END = 0,
+  PCAPNG_OPT_COMMENT = 1,
+  PCAPNG_IF_NAME = 2,
+  PCAPNG_IF_TSRESOL = 9,
+  PCAPNG_EPB_FLAGS = 2,
+  PCAPNG_FLAG_INBOUND = 1,
+  PCAPNG_FLAG_OUTBOUND = 2,
+  LINKTYPE_IEEE802_15_4_TAP = 283,
+  TAP_FCS_TYPE = 0,
+  TAP_RSS = 1,
+  TAP_CHANNEL = 3,
+  TAP_LQI = 10,
+  TAP_HEADER_MAX = 4 + 8 + 8 + 8 + 8,
+  PCAP_COMMENT_MAX = 64,
+};
+
+int simPcapActive = 0;
+
+static FILE* pcapFile = NULL;
+static uint8_t pcapBuffer[SIM_PCAP_BUFFER_SIZE];
+static int pcapUsed = 0;
+static int pcapInterface[TOSSIM_MAX_NODES + 1];
+static int pcapInterfaces = 0;
+static uint8_t pcapNodeFilter[(TOSSIM_MAX_NODES + 8) / 8];
+static int pcapNodeFilters = 0;
+static uint8_t pcapTypeFilter[256 / 8];
+static int pcapTypeFilters = 0;
+
+static const char* pcapReasons[SIM_PCAP_REASONS] = {
+  "ok", "off", "snr", "channel", "receiving", "sending", "collision",
+};
+
+const char* sim_pcap_reason(int reason) __attribute__ ((C, spontaneous)) {
+  if (reason < 0 || reason >= SIM_PCAP_REASONS) {
+    return "unknown";
+  }
+  return pcapReasons[reason];
+}
+
+static void sim_pcap_write_out() {
+  if (pcapUsed > 0 && pcapFile != NULL) {
+    if (fwrite(pcapBuffer, 1, pcapUsed, pcapFile) != (size_t)pcapUsed) {
+      dbgerror("Pcap", "Short write to capture file, closing it.\n");
+      fclose(pcapFile);
+      pcapFile = NULL;
+      simPcapActive = 0;
+    }
+  }
+  pcapUsed = 0;
+}
+
+/* Reserve len bytes of the buffer, draining it first if necessary.
+   Blocks are far smaller than the buffer, so this always succeeds. */
+static uint8_t* sim_pcap_reserve(int len) {
+  uint8_t* p;
+  if (pcapUsed + len > SIM_PCAP_BUFFER_SIZE) {
+    sim_pcap_write_out();
+  }
+  p = pcapBuffer + pcapUsed;
+  memset(p, 0, len);
+  pcapUsed += len;
+  return p;
+}
+
+static int pad4(int len) {
+  return (len + 3) & ~3;
+}
+
+static void put16(uint8_t* p, uint16_t val) {
+  memcpy(p, &val, 2);
+}
+
+static void put32(uint8_t* p, uint32_t val) {
+  memcpy(p, &val, 4);
+}
+
+static void put16le(uint8_t* p, uint16_t val) {
+  p[0] = val & 0xff;
+  p[1] = val >> 8;
+}
+
+/* Write an option and return its padded size. */
+static int sim_pcap_option(uint8_t* p, uint16_t code, const void* val, int len) {
+  put16(p, code);
+  put16(p + 2, len);
+  memcpy(p + 4, val, len);
+  return 4 + pad4(len);
+}
+
+static void sim_pcap_header() {
+  uint8_t* p = sim_pcap_reserve(28);
+  int64_t sectionLength = -1;
+  put32(p, PCAPNG_SHB);
+  put32(p + 4, 28);
+  put32(p + 8, PCAPNG_BOM);
+  put16(p + 12, 1);
+  put16(p + 14, 0);
+  memcpy(p + 16, &sectionLength, 8);
+  put32(p + 24, 28);
+}
+
+/* Interfaces are described lazily, the first time a node appears. */
+static int sim_pcap_interface(int mote) {
+  char name[16];
+  uint8_t resolution = 9; // Nanoseconds
+  int nameLen;
+  int len;
+  uint8_t* p;
+  if (mote < 0 || mote > TOSSIM_MAX_NODES) {
+    mote = TOSSIM_MAX_NODES;
+  }
+  if (pcapInterface[mote] >= 0) {
+    return pcapInterface[mote];
+  }
+  nameLen = snprintf(name, sizeof(name), "node%i", mote);
+  len = 20 + (4 + pad4(nameLen)) + (4 + 4) + 4;
+  p = sim_pcap_reserve(len);
+  put32(p, PCAPNG_IDB);
+  put32(p + 4, len);
+  put16(p + 8, LINKTYPE_IEEE802_15_4_TAP);
+  put32(p + 12, 0);
+  p += 16;
+  p += sim_pcap_option(p, PCAPNG_IF_NAME, name, nameLen);
+  p += sim_pcap_option(p, PCAPNG_IF_TSRESOL, &resolution, 1);
+  put32(p, PCAPNG_OPT_END);
+  put32(p + 4, len);
+  pcapInterface[mote] = pcapInterfaces++;
+  return pcapInterface[mote];
+}
+
+static uint64_t sim_pcap_timestamp() {
+  sim_time_t tps = sim_ticks_per_sec();
+  sim_time_t now = sim_time();
+  return (uint64_t)(now / tps) * 1000000000ULL +
+    (uint64_t)((now % tps) * 1000000000ULL / tps);
+}
+
+/* TAP header (always little-endian). rssi is only present for
+   receptions. */
+static int sim_pcap_tap(uint8_t* tap, uint8_t channel, bool rx, int8_t rssi, uint8_t lqi) {
+  int len = 4;
+  put16le(tap + len, TAP_FCS_TYPE);
+  put16le(tap + len + 2, 1);
+  tap[len + 4] = 0; // Simulated frames carry no FCS
+  len += 8;
+  put16le(tap + len, TAP_CHANNEL);
+  put16le(tap + len + 2, 3);
+  put16le(tap + len + 4, channel);
+  tap[len + 6] = 0;
+  len += 8;
+  if (rx) {
+    float rss = rssi;
+    uint32_t bits;
+    memcpy(&bits, &rss, 4);
+    put16le(tap + len, TAP_RSS);
+    put16le(tap + len + 2, 4);
+    put16le(tap + len + 4, bits & 0xffff);
+    put16le(tap + len + 6, bits >> 16);
+    len += 8;
+    put16le(tap + len, TAP_LQI);
+    put16le(tap + len + 2, 1);
+    tap[len + 4] = lqi;
+    len += 8;
+  }
+  tap[0] = 0;
+  tap[1] = 0;
+  put16le(tap + 2, len);
+  return len;
+}
+
+static void sim_pcap_block(int mote, uint32_t flags, const uint8_t* tap, int tapLen,
+                           const uint8_t* frame, int frameLen, const char* comment) {
+  int iface = sim_pcap_interface(mote);
+  uint64_t ts = sim_pcap_timestamp();
+  int dataLen = tapLen + frameLen;
+  int commentLen = strlen(comment);
+  int len = 28 + pad4(dataLen) + (4 + 4) + (4 + pad4(commentLen)) + 4 + 4;
+  uint8_t* p = sim_pcap_reserve(len);
+  put32(p, PCAPNG_EPB);
+  put32(p + 4, len);
+  put32(p + 8, iface);
+  put32(p + 12, (uint32_t)(ts >> 32));
+  put32(p + 16, (uint32_t)ts);
+  put32(p + 20, dataLen);
+  put32(p + 24, dataLen);
+  memcpy(p + 28, tap, tapLen);
+  memcpy(p + 28 + tapLen, frame, frameLen);
+  p += 28 + pad4(dataLen);
+  p += sim_pcap_option(p, PCAPNG_EPB_FLAGS, &flags, 4);
+  p += sim_pcap_option(p, PCAPNG_OPT_COMMENT, comment, commentLen);
+  put32(p, PCAPNG_OPT_END);
+  put32(p + 4, len);
+}
+
+bool sim_pcap_open(const char* path) __attribute__ ((C, spontaneous)) {
+  sim_pcap_close();
+  pcapFile = fopen(path, "wb");
+  if (pcapFile == NULL) {
+    dbgerror("Pcap", "Could not open capture file %s.\n", path);
+    return FALSE;
+  }
+  memset(pcapInterface, 0xff, sizeof(pcapInterface));
+  pcapInterfaces = 0;
+  pcapUsed = 0;
+  sim_pcap_header();
+  simPcapActive = 1;
+  return TRUE;
+}
+
+void sim_pcap_flush() __attribute__ ((C, spontaneous)) {
+  sim_pcap_write_out();
+  if (pcapFile != NULL) {
+    fflush(pcapFile);
+  }
+}
+
+void sim_pcap_close() __attribute__ ((C, spontaneous)) {
+  if (pcapFile == NULL) {
+    return;
+  }
+  sim_pcap_write_out();
+  if (pcapFile != NULL) {
+    fclose(pcapFile);
+  }
+  pcapFile = NULL;
+  simPcapActive = 0;
+}
+
+void sim_pcap_filter_node(int mote, bool capture) __attribute__ ((C, spontaneous)) {
+  uint8_t bit;
+  if (mote < 0 || mote > TOSSIM_MAX_NODES) {
+    return;
+  }
+  bit = 1 << (mote & 7);
+  if (capture && !(pcapNodeFilter[mote >> 3] & bit)) {
+    pcapNodeFilter[mote >> 3] |= bit;
+    pcapNodeFilters++;
+  }
+  else if (!capture && (pcapNodeFilter[mote >> 3] & bit)) {
+    pcapNodeFilter[mote >> 3] &= ~bit;
+    pcapNodeFilters--;
+  }
+}
+
+void sim_pcap_filter_type(int type, bool capture) __attribute__ ((C, spontaneous)) {
+  uint8_t bit;
+  if (type < 0 || type > 255) {
+    return;
+  }
+  bit = 1 << (type & 7);
+  if (capture && !(pcapTypeFilter[type >> 3] & bit)) {
+    pcapTypeFilter[type >> 3] |= bit;
+    pcapTypeFilters++;
+  }
+  else if (!capture && (pcapTypeFilter[type >> 3] & bit)) {
+    pcapTypeFilter[type >> 3] &= ~bit;
+    pcapTypeFilters--;
+  }
+}
+
+void sim_pcap_filter_clear() __attribute__ ((C, spontaneous)) {
+  memset(pcapNodeFilter, 0, sizeof(pcapNodeFilter));
+  memset(pcapTypeFilter, 0, sizeof(pcapTypeFilter));
+  pcapNodeFilters = 0;
+  pcapTypeFilters = 0;
+}
+
+static bool sim_pcap_node_match(int mote) {
+  return mote >= 0 && mote <= TOSSIM_MAX_NODES &&
+    (pcapNodeFilter[mote >> 3] & (1 << (mote & 7)));
+}
+
+bool sim_pcap_wants(int src, int dest, uint8_t type) __attribute__ ((C, spontaneous)) {
+  if (pcapTypeFilters > 0 && !(pcapTypeFilter[type >> 3] & (1 << (type & 7)))) {
+    return FALSE;
+  }
+  if (pcapNodeFilters > 0 && !sim_pcap_node_match(src) &&
+      (dest < 0 || !sim_pcap_node_match(dest))) {
+    return FALSE;
+  }
+  return TRUE;
+}
+
+void sim_pcap_tx(int src, uint8_t channel, const uint8_t* frame, int len) __attribute__ ((C, spontaneous)) {
+  uint8_t tap[TAP_HEADER_MAX];
+  char comment[PCAP_COMMENT_MAX];
+  int tapLen;
+  if (!simPcapActive) {
+    return;
+  }
+  tapLen = sim_pcap_tap(tap, channel, FALSE, 0, 0);
+  snprintf(comment, sizeof(comment), "tx node %i", src);
+  sim_pcap_block(src, PCAPNG_FLAG_OUTBOUND, tap, tapLen, frame, len, comment);
+}
+
+void sim_pcap_rx(int src, int dest, uint8_t channel,
+                 int8_t rssi, uint8_t lqi, int reason,
+                 const uint8_t* frame, int len) __attribute__ ((C, spontaneous)) {
+  uint8_t tap[TAP_HEADER_MAX];
+  char comment[PCAP_COMMENT_MAX];
+  int tapLen;
+  if (!simPcapActive) {
+    return;
+  }
+  tapLen = sim_pcap_tap(tap, channel, TRUE, rssi, lqi);
+  if (reason == SIM_PCAP_RX_OK) {
+    snprintf(comment, sizeof(comment), "rx node %i from %i", dest, src);
+  }
+  else {
+    snprintf(comment, sizeof(comment), "lost node %i from %i: %s", dest, src, sim_pcap_reason(reason));
+  }
+  sim_pcap_block(dest, PCAPNG_FLAG_INBOUND, tap, tapLen, frame, len, comment);
+}
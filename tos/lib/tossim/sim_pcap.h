@@ -0,0 +1,102 @@
+/*
+ * Copyright (c) 2026 The stormport contributors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ *
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the
+ *   distribution.
+ *
+ * - Neither the name of the copyright holders nor the names of
+ *   its contributors may be used to endorse or promote products derived
+ *   from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL
+ * THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ *
+ * Packet capture of simulated radio traffic. When a capture file is
+ * open, every transmission and every per-receiver reception outcome
+ * is written as a pcapng Enhanced Packet Block with the IEEE 802.15.4
+ * TAP link type (LINKTYPE_IEEE802_15_4_TAP), so traces open directly
+ * in Wireshark. Each node gets its own interface ("node<N>"); the TAP
+ * header carries the channel and, for receptions, the RSSI and LQI,
+ * and the block comment records the sender and, for lost packets,
+ * why the packet was lost.
+ *
+ * Writes go through an in-memory buffer. When no capture is open the
+ * radio model only pays for a test of sim_pcap_enabled().
+ *
+ * @date   Oct 19 2026
+ */
+
+#ifndef SIM_PCAP_H_INCLUDED
+#define SIM_PCAP_H_INCLUDED
+
+#include <sim_tossim.h>
+
+// Reception outcomes, recorded in the comment of each rx block
+enum {
+  SIM_PCAP_RX_OK           = 0,
+  SIM_PCAP_LOST_OFF        = 1, // Receiver was off
+  SIM_PCAP_LOST_SNR        = 2, // Signal too weak over the noise floor
+  SIM_PCAP_LOST_CHANNEL    = 3, // Receiver on a different channel
+  SIM_PCAP_LOST_RECEIVING  = 4, // Receiver already locked on to a packet
+  SIM_PCAP_LOST_SENDING    = 5, // Receiver was transmitting
+  SIM_PCAP_LOST_COLLISION  = 6, // Corrupted by a later, stronger packet
+  SIM_PCAP_REASONS         = 7,
+};
+
+#ifndef SIM_PCAP_BUFFER_SIZE
+#define SIM_PCAP_BUFFER_SIZE 65536
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+  extern int simPcapActive;
+#define sim_pcap_enabled() (simPcapActive)
+
+  bool sim_pcap_open(const char* path);
+  void sim_pcap_close();
+  void sim_pcap_flush();
+
+  // Filters: an empty set captures everything. A node filter matches
+  // the sender or the receiver of a frame.
+  void sim_pcap_filter_node(int mote, bool capture);
+  void sim_pcap_filter_type(int type, bool capture);
+  void sim_pcap_filter_clear();
+  bool sim_pcap_wants(int src, int dest, uint8_t type);
+
+  // frame is an 802.15.4 MAC frame without FCS
+  void sim_pcap_tx(int src, uint8_t channel, const uint8_t* frame, int len);
+  void sim_pcap_rx(int src, int dest, uint8_t channel,
+                   int8_t rssi, uint8_t lqi, int reason,
+                   const uint8_t* frame, int len);
+  const char* sim_pcap_reason(int reason);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // SIM_PCAP_H_INCLUDED
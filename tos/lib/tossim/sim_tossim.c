@@ -78,6 +78,7 @@ void sim_init() __attribute__ ((C, spontaneous)) {
 }
 
 void sim_end() __attribute__ ((C, spontaneous)) {
+  sim_pcap_close();
   sim_queue_init();
 }
 
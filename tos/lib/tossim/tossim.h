@@ -50,6 +50,8 @@
 #include <packet.h>
 #include <hashtable.h>
 
+class Energy;
+
 typedef struct variable_string {
   char* type;
   char* ptr;
@@ -105,6 +107,18 @@ class Mote {
   int generateNoise(int when);
   
   Variable* getVariable(char* name);
+
+  double radioSleepTime();
+  double radioListenTime();
+  double radioBackoffTime();
+  double radioRxTime();
+  double radioTxTime();
+  double radioDutyCycle();
+  double mcuSleepTime();
+  double mcuActiveTime();
+  double radioEnergy();
+  double mcuEnergy();
+  double energy();
   
  private:
   unsigned long nodeID;
@@ -130,12 +144,21 @@ class Tossim {
 
   void addChannel(char* channel, FILE* file);
   bool removeChannel(char* channel, FILE* file);
+
+  // 802.15.4 pcapng capture of radio traffic
+  bool startCapture(char* path);
+  void stopCapture();
+  void flushCapture();
+  void captureNode(unsigned long nodeID);
+  void captureType(int type);
+  void clearCaptureFilter();
   void randomSeed(int seed);
   
   bool runNextEvent();
 
   MAC* mac();
   Radio* radio();
+  Energy* energy();
   Packet* newPacket();
 
  private: